@@ -12,6 +12,16 @@
  * @{
  * @brief       mtd flash emulation for native
  *
+ * The flash is emulated by a file, which is mapped into memory on the first
+ * access and keeps the content across runs. Like NOR flash, writes can only
+ * clear bits and erases work on whole sectors.
+ *
+ * The driver counts operations and transferred bytes in
+ * mtd_native_dev_t::stats, and erases per sector in
+ * mtd_native_dev_t::sector_erases if set, to profile file systems and flash
+ * wear on the host. mtd_native_dev_t::latency simulates the duration of
+ * operations of a real flash.
+ *
  * @file
  *
  * @author      Vincent Dupont <vincent@otakeys.com>
@@ -24,12 +34,42 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #include "mtd.h"
 
+/**
+ * @brief   Operation counters of a native mtd
+ */
+typedef struct {
+    uint32_t read_count;        /**< read operations */
+    uint32_t read_bytes;        /**< bytes read */
+    uint32_t write_count;       /**< write operations */
+    uint32_t write_bytes;       /**< bytes written */
+    uint32_t write_unerased;    /**< writes that tried to set bits, which
+                                     were ignored */
+    uint32_t erase_count;       /**< erase operations */
+    uint32_t erase_sectors;     /**< sectors erased */
+} mtd_native_stats_t;
+
+/**
+ * @brief   Simulated latencies of a native mtd [in usec], 0 for none
+ */
+typedef struct {
+    uint32_t read;              /**< per read operation */
+    uint32_t write;             /**< per write operation (at most a page) */
+    uint32_t erase;             /**< per erased sector */
+} mtd_native_latency_t;
+
 /** mtd native descriptor */
 typedef struct mtd_native_dev {
     mtd_dev_t dev;      /**< mtd generic device */
     const char *fname;  /**< filename to use for memory emulation */
+    mtd_native_latency_t latency;   /**< simulated latencies */
+    uint32_t *sector_erases;        /**< erases per sector (`sector_count`
+                                         entries), or NULL */
+    mtd_native_stats_t stats;       /**< operation counters */
+    uint8_t *map;                   /**< mapped file, private */
 } mtd_native_dev_t;
 
 /**
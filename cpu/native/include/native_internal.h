@@ -133,6 +133,10 @@ extern int (*real_fputc)(int c, FILE *stream);
 extern int (*real_fgetc)(FILE *stream);
 extern mode_t (*real_umask)(mode_t cmask);
 extern ssize_t (*real_writev)(int fildes, const struct iovec *iov, int iovcnt);
+extern off_t (*real_lseek)(int fd, off_t offset, int whence);
+extern int (*real_ftruncate)(int fd, off_t length);
+extern void* (*real_mmap)(void *addr, size_t length, int prot, int flags,
+                          int fd, off_t offset);
 
 #ifdef __MACH__
 #else
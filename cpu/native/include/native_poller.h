@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/**
+ * @ingroup     cpu_native
+ * @{
+ *
+ * @file
+ * @brief       Batched frame reception on file descriptors
+ *
+ * A host thread waits for all registered file descriptors with `epoll()`
+ * and drains them into per-descriptor receive rings (using `recvmmsg()` for
+ * sockets). RIOT is only interrupted once per batch of frames instead of once
+ * per frame, and the drivers take the frames from the ring without any
+ * further system call.
+ *
+ * The host thread never touches RIOT state besides the ring of the
+ * descriptor it reads from, so it can run in parallel to RIOT.
+ *
+ * @note    Only available on Linux hosts
+ */
+#ifndef NATIVE_POLLER_H
+#define NATIVE_POLLER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Maximum number of file descriptors handled by the poller
+ */
+#ifndef NATIVE_POLLER_NUMOF
+#define NATIVE_POLLER_NUMOF         (2U)
+#endif
+
+/**
+ * @brief   Number of frames a receive ring can hold
+ *
+ * @note    Must be a power of two
+ */
+#ifndef NATIVE_POLLER_RING_SIZE
+#define NATIVE_POLLER_RING_SIZE     (32U)
+#endif
+
+/**
+ * @brief   Maximum length of a frame in a receive ring
+ */
+#ifndef NATIVE_POLLER_FRAME_LEN
+#define NATIVE_POLLER_FRAME_LEN     (1536U)
+#endif
+
+/**
+ * @brief   Callback type to signal a new batch of frames
+ *
+ * Called in interrupt context.
+ *
+ * @param[in] arg   Argument given to native_poller_add()
+ */
+typedef void (*native_poller_cb_t)(void *arg);
+
+/**
+ * @brief   A frame in the receive ring
+ */
+typedef struct {
+    uint16_t len;                               /**< length of the frame */
+    uint8_t data[NATIVE_POLLER_FRAME_LEN];      /**< the frame */
+} native_poller_frame_t;
+
+/**
+ * @brief   Receive ring of a file descriptor
+ *
+ * @note    All members but the statistics are private
+ */
+typedef struct {
+    native_poller_frame_t ring[NATIVE_POLLER_RING_SIZE]; /**< the frames */
+    native_poller_cb_t cb;      /**< callback for new frames */
+    void *arg;                  /**< argument for native_poller_t::cb */
+    unsigned head;              /**< ring index written by the poller */
+    unsigned tail;              /**< ring index written by RIOT */
+    int fd;                     /**< file descriptor read by the poller */
+    uint8_t is_sock;            /**< native_poller_t::fd is a socket */
+    uint8_t stalled;            /**< ring was full, reading is suspended */
+    /**
+     * @brief   Statistics
+     * @{
+     */
+    uint32_t batches;           /**< number of batches received */
+    uint32_t frames;            /**< number of frames received */
+    uint32_t truncated;         /**< number of frames that did not fit */
+    /** @} */
+} native_poller_t;
+
+/**
+ * @brief   Start receiving from a file descriptor
+ *
+ * Starts the poller thread on first use.
+ *
+ * @param[out] poller   Receive ring for @p fd
+ * @param[in] fd        The file descriptor to read frames from
+ * @param[in] cb        Called in interrupt context when new frames are in
+ *                      @p poller
+ * @param[in] arg       Argument for @p cb
+ */
+void native_poller_add(native_poller_t *poller, int fd,
+                       native_poller_cb_t cb, void *arg);
+
+/**
+ * @brief   Get the oldest frame from a receive ring
+ *
+ * @param[in] poller    A receive ring
+ *
+ * @return  The oldest frame in @p poller. It stays valid until
+ *          native_poller_pop() is called.
+ * @return  NULL, if @p poller is empty
+ */
+native_poller_frame_t *native_poller_peek(native_poller_t *poller);
+
+/**
+ * @brief   Remove the oldest frame from a receive ring
+ *
+ * @pre `native_poller_peek(poller) != NULL`
+ *
+ * @param[in] poller    A receive ring
+ */
+void native_poller_pop(native_poller_t *poller);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NATIVE_POLLER_H */
+/** @} */
@@ -28,6 +28,9 @@ extern "C" {
 #include "net/netdev.h"
 
 #include "net/ethernet/hdr.h"
+#ifdef MODULE_NATIVE_POLLER
+#include "native_poller.h"
+#endif
 
 #ifdef __MACH__
 #include "net/if_var.h"
@@ -44,6 +47,9 @@ typedef struct netdev_tap {
     int tap_fd;                         /**< host file descriptor for the TAP */
     uint8_t addr[ETHERNET_ADDR_LEN];    /**< The MAC address of the TAP */
     uint8_t promiscous;                 /**< Flag for promiscous mode */
+#if defined(MODULE_NATIVE_POLLER) || defined(DOXYGEN)
+    native_poller_t poller;             /**< receive ring for the TAP */
+#endif
 } netdev_tap_t;
 
 /**
@@ -13,6 +13,15 @@
  *
  * @see @ref net_zep for protocol definitions
  *
+ * With the `socket_zep_ack` module, frames requesting an acknowledgement are
+ * acknowledged by the receiving device with a ZEPv2 ACK carrying the ZEP sequence number of the frame. The
+ * sender retransmits the frame up to @ref SOCKET_ZEP_FRAME_RETRIES times if
+ * no ACK arrives within @ref SOCKET_ZEP_ACK_TIMEOUT and reports the outcome
+ * with @ref NETDEV_EVENT_TX_COMPLETE or @ref NETDEV_EVENT_TX_NOACK. Together
+ * with a lossy ZEP hub this provides link-layer feedback on native. All
+ * devices on the hub must use the module then. Without it, no ACKs are
+ * requested or sent and every frame is reported as sent.
+ *
  * @{
  *
  * @file
@@ -26,11 +35,33 @@
 #include "net/netdev.h"
 #include "net/netdev/ieee802154.h"
 #include "net/zep.h"
+#ifdef MODULE_SOCKET_ZEP_ACK
+#include "xtimer.h"
+#endif
+#ifdef MODULE_NATIVE_POLLER
+#include "native_poller.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if defined(MODULE_SOCKET_ZEP_ACK) || defined(DOXYGEN)
+/**
+ * @brief   Time to wait for the ACK of a frame [in us]
+ */
+#ifndef SOCKET_ZEP_ACK_TIMEOUT
+#define SOCKET_ZEP_ACK_TIMEOUT      (50U * US_PER_MS)
+#endif
+
+/**
+ * @brief   Maximum number of retransmissions of an unacknowledged frame
+ */
+#ifndef SOCKET_ZEP_FRAME_RETRIES
+#define SOCKET_ZEP_FRAME_RETRIES    (3U)
+#endif
+#endif /* MODULE_SOCKET_ZEP_ACK */
+
 /**
  * @brief   ZEP device state
  */
@@ -48,6 +79,20 @@ typedef struct {
      */
     uint8_t snd_hdr_buf[sizeof(zep_v2_data_hdr_t)];
     uint16_t chksum_buf;            /**< buffer for send checksum calculation */
+#if defined(MODULE_SOCKET_ZEP_ACK) || defined(DOXYGEN)
+    /**
+     * @brief   Copy of the last frame for retransmissions
+     */
+    uint8_t snd_buf[sizeof(zep_v2_data_hdr_t) + IEEE802154_FRAME_LEN_MAX];
+    size_t snd_len;                 /**< length of socket_zep_t::snd_buf */
+    xtimer_t ack_timer;             /**< ACK timeout of the last frame */
+    uint8_t tx_retries;             /**< retransmissions of the last frame */
+    bool ack_pending;               /**< last frame awaits its ACK */
+    volatile bool ack_timeout;      /**< ACK timeout needs handling */
+#endif
+#if defined(MODULE_NATIVE_POLLER) || defined(DOXYGEN)
+    native_poller_t poller;         /**< receive ring for the socket */
+#endif
 } socket_zep_t;
 
 /**
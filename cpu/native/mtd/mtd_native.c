@@ -19,58 +19,93 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
 
 #include "mtd.h"
 #include "mtd_native.h"
+#include "xtimer.h"
 
 #include "native_internal.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
-static int _init(mtd_dev_t *dev)
+static size_t _size(mtd_dev_t *dev)
 {
-    mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
+    return dev->sector_count * dev->pages_per_sector * dev->page_size;
+}
+
+/* Maps the file on first access; it is opened only once */
+static int _map(mtd_native_dev_t *dev)
+{
+    size_t size = _size(&dev->dev);
 
-    DEBUG("mtd_native: init, filename=%s\n", _dev->fname);
+    if (dev->map) {
+        return 0;
+    }
 
-    FILE *f = real_fopen(_dev->fname, "r");
+    DEBUG("mtd_native: mapping file %s\n", dev->fname);
 
-    if (!f) {
-        DEBUG("mtd_native: init: creating file %s\n", _dev->fname);
-        f = real_fopen(_dev->fname, "w+");
-        if (!f) {
-            return -EIO;
-        }
-        size_t size = dev->sector_count * dev->pages_per_sector * dev->page_size;
-        for (size_t i = 0; i < size; i++) {
-            real_fputc(0xff, f);
-        }
+    int fd = real_open(dev->fname, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return -EIO;
+    }
+    off_t len = real_lseek(fd, 0, SEEK_END);
+    if ((len < 0) || (((size_t)len < size) && real_ftruncate(fd, size))) {
+        real_close(fd);
+        return -EIO;
+    }
+    void *map = real_mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                          fd, 0);
+    /* the mapping stays valid without the file descriptor */
+    real_close(fd);
+    if (map == MAP_FAILED) {
+        return -EIO;
     }
+    dev->map = map;
 
-    real_fclose(f);
+    if ((size_t)len < size) {
+        DEBUG("mtd_native: init: creating file %s\n", dev->fname);
+        memset(dev->map + len, 0xff, size - len);
+    }
 
     return 0;
 }
 
+static void _delay(uint32_t us)
+{
+    if (us) {
+        xtimer_usleep(us);
+    }
+}
+
+static int _init(mtd_dev_t *dev)
+{
+    DEBUG("mtd_native: init, filename=%s\n", ((mtd_native_dev_t *)dev)->fname);
+
+    return _map((mtd_native_dev_t *)dev);
+}
+
 static int _read(mtd_dev_t *dev, void *buff, uint32_t addr, uint32_t size)
 {
     mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
-    size_t mtd_size = dev->sector_count * dev->pages_per_sector * dev->page_size;
+    size_t mtd_size = _size(dev);
 
     DEBUG("mtd_native: read from page %" PRIu32 " count %" PRIu32 "\n", addr, size);
 
-    if (addr + size > mtd_size) {
+    if ((addr > mtd_size) || (size > mtd_size - addr)) {
         return -EOVERFLOW;
     }
-
-    FILE *f = real_fopen(_dev->fname, "r");
-    if (!f) {
+    if (_map(_dev)) {
         return -EIO;
     }
-    real_fseek(f, addr, SEEK_SET);
-    size = real_fread(buff, 1, size, f);
-    real_fclose(f);
+
+    memcpy(buff, _dev->map + addr, size);
+    _dev->stats.read_count++;
+    _dev->stats.read_bytes += size;
+    _delay(_dev->latency.read);
 
     return size;
 }
@@ -78,28 +113,35 @@ static int _read(mtd_dev_t *dev, void *buff, uint32_t addr, uint32_t size)
 static int _write(mtd_dev_t *dev, const void *buff, uint32_t addr, uint32_t size)
 {
     mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
-    size_t mtd_size = dev->sector_count * dev->pages_per_sector * dev->page_size;
+    size_t mtd_size = _size(dev);
+    const uint8_t *src = buff;
+    uint8_t unerased = 0;
 
     DEBUG("mtd_native: write from 0x%" PRIx32 " count %" PRIu32 "\n", addr, size);
 
-    if (addr + size > mtd_size) {
+    if ((addr > mtd_size) || (size > mtd_size - addr)) {
         return -EOVERFLOW;
     }
     if (((addr % dev->page_size) + size) > dev->page_size) {
         return -EOVERFLOW;
     }
-
-    FILE *f = real_fopen(_dev->fname, "r+");
-    if (!f) {
+    if (_map(_dev)) {
         return -EIO;
     }
-    real_fseek(f, addr, SEEK_SET);
+
+    /* programming can only clear bits */
+    uint8_t *dst = _dev->map + addr;
     for (size_t i = 0; i < size; i++) {
-        uint8_t c = real_fgetc(f);
-        real_fseek(f, -1, SEEK_CUR);
-        real_fputc(c & ((uint8_t*)buff)[i], f);
+        unerased |= src[i] & ~dst[i];
+        dst[i] &= src[i];
+    }
+    if (unerased) {
+        DEBUG("mtd_native: write to unerased memory at 0x%" PRIx32 "\n", addr);
+        _dev->stats.write_unerased++;
     }
-    real_fclose(f);
+    _dev->stats.write_count++;
+    _dev->stats.write_bytes += size;
+    _delay(_dev->latency.write);
 
     return size;
 }
@@ -107,27 +149,31 @@ static int _write(mtd_dev_t *dev, const void *buff, uint32_t addr, uint32_t size
 static int _erase(mtd_dev_t *dev, uint32_t addr, uint32_t size)
 {
     mtd_native_dev_t *_dev = (mtd_native_dev_t*) dev;
-    size_t mtd_size = dev->sector_count * dev->pages_per_sector * dev->page_size;
+    size_t mtd_size = _size(dev);
     size_t sector_size = dev->pages_per_sector * dev->page_size;
 
     DEBUG("mtd_native: erase from sector %" PRIu32 " count %" PRIu32 "\n", addr, size);
 
-    if (addr + size > mtd_size) {
+    if ((addr > mtd_size) || (size > mtd_size - addr)) {
         return -EOVERFLOW;
     }
     if (((addr % sector_size) != 0) || ((size % sector_size) != 0)) {
         return -EOVERFLOW;
     }
-
-    FILE *f = real_fopen(_dev->fname, "r+");
-    if (!f) {
+    if (_map(_dev)) {
         return -EIO;
     }
-    real_fseek(f, addr, SEEK_SET);
-    for (size_t i = 0; i < size; i++) {
-        real_fputc(0xff, f);
+
+    memset(_dev->map + addr, 0xff, size);
+    _dev->stats.erase_count++;
+    for (uint32_t sector = addr / sector_size;
+         sector < (addr + size) / sector_size; sector++) {
+        if (_dev->sector_erases) {
+            _dev->sector_erases[sector]++;
+        }
+        _dev->stats.erase_sectors++;
+        _delay(_dev->latency.erase);
     }
-    real_fclose(f);
 
     return 0;
 }
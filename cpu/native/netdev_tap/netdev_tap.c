@@ -97,7 +97,17 @@ static inline int _set_promiscous(netdev_t *netdev, int value)
 static inline void _isr(netdev_t *netdev)
 {
     if (netdev->event_callback) {
+#ifdef MODULE_NATIVE_POLLER
+        netdev_tap_t *dev = (netdev_tap_t*)netdev;
+
+        /* hand the whole batch to the upper layer */
+        for (unsigned i = 0; (i < NATIVE_POLLER_RING_SIZE) &&
+                             (native_poller_peek(&dev->poller) != NULL); i++) {
+            netdev->event_callback(netdev, NETDEV_EVENT_RX_COMPLETE);
+        }
+#else
         netdev->event_callback(netdev, NETDEV_EVENT_RX_COMPLETE);
+#endif
     }
 #if DEVELHELP
     else {
@@ -177,6 +187,51 @@ static inline bool _is_addr_multicast(uint8_t *addr)
     return (addr[0] & 0x01);
 }
 
+#ifdef MODULE_NATIVE_POLLER
+static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
+{
+    netdev_tap_t *dev = (netdev_tap_t*)netdev;
+    native_poller_frame_t *frame = native_poller_peek(&dev->poller);
+    int res;
+
+    (void)info;
+    if (frame == NULL) {
+        return (buf == NULL) ? 0 : -1;
+    }
+    if (!buf) {
+        if (len > 0) {
+            /* no memory available in pktbuf, discarding the frame */
+            DEBUG("netdev_tap: discarding the frame\n");
+            native_poller_pop(&dev->poller);
+        }
+        return frame->len;
+    }
+    res = frame->len;
+    DEBUG("netdev_tap: read %d bytes\n", res);
+    if ((unsigned)res > len) {
+        DEBUG("netdev_tap: frame does not fit, discarding the frame\n");
+        res = -ENOBUFS;
+    }
+    else {
+        ethernet_hdr_t *hdr = (ethernet_hdr_t *)frame->data;
+
+        if (!(dev->promiscous) && !_is_addr_multicast(hdr->dst) &&
+            !_is_addr_broadcast(hdr->dst) &&
+            (memcmp(hdr->dst, dev->addr, ETHERNET_ADDR_LEN) != 0)) {
+            DEBUG("netdev_tap: received for %02x:%02x:%02x:%02x:%02x:%02x\n"
+                  "That's not me => Dropped\n",
+                  hdr->dst[0], hdr->dst[1], hdr->dst[2],
+                  hdr->dst[3], hdr->dst[4], hdr->dst[5]);
+            res = 0;
+        }
+        else {
+            memcpy(buf, frame->data, res);
+        }
+    }
+    native_poller_pop(&dev->poller);
+    return res;
+}
+#else /* MODULE_NATIVE_POLLER */
 static void _continue_reading(netdev_tap_t *dev)
 {
     /* work around lost signals */
@@ -272,6 +327,7 @@ static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
 
     return -1;
 }
+#endif /* MODULE_NATIVE_POLLER */
 
 static int _send(netdev_t *netdev, const iolist_t *iolist)
 {
@@ -296,9 +352,14 @@ void netdev_tap_setup(netdev_tap_t *dev, const netdev_tap_params_t *params) {
     dev->tap_name[IFNAMSIZ - 1] = '\0';
 }
 
+#ifdef MODULE_NATIVE_POLLER
+static void _tap_isr(void *arg)
+{
+#else
 static void _tap_isr(int fd, void *arg) {
     (void) fd;
 
+#endif
     netdev_t *netdev = (netdev_t *)arg;
 
     if (netdev->event_callback) {
@@ -380,9 +441,14 @@ static int _init(netdev_t *netdev)
             dev->addr[0], dev->addr[1], dev->addr[2],
             dev->addr[3], dev->addr[4], dev->addr[5]);
 
+#ifdef MODULE_NATIVE_POLLER
+    /* receive in batches from the poller thread */
+    native_poller_add(&dev->poller, dev->tap_fd, _tap_isr, netdev);
+#else
     /* configure signal handler for fds */
     native_async_read_setup();
     native_async_read_add_handler(dev->tap_fd, netdev, _tap_isr);
+#endif
 
     DEBUG("gnrc_tapnet: initialized.\n");
     return 0;
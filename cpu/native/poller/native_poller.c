@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/**
+ * @ingroup cpu_native
+ * @{
+ *
+ * @file
+ * @brief   Batched frame reception on file descriptors
+ *
+ * The poller thread is a host thread, not a RIOT thread: it must not call any
+ * function native wraps (malloc(), printf(), ...) since those may switch RIOT
+ * contexts. It only uses the real_* functions and plain system calls.
+ * @}
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     /* for recvmmsg() */
+#endif
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "async_read.h"
+#include "native_internal.h"
+#include "native_poller.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#ifndef __linux__
+#error "native_poller is only available on Linux hosts"
+#endif
+
+#if (NATIVE_POLLER_RING_SIZE & (NATIVE_POLLER_RING_SIZE - 1)) != 0
+#error "NATIVE_POLLER_RING_SIZE must be a power of two"
+#endif
+
+#define RING_MASK           (NATIVE_POLLER_RING_SIZE - 1)
+
+/* <pthread.h> clashes with RIOT's sched.h, so only declare what is needed
+ * (pthread_t is an unsigned long on Linux) */
+typedef int (*_pthread_create_t)(unsigned long *thread, const void *attr,
+                                 void *(*start)(void *), void *arg);
+
+static native_poller_t *_pollers[NATIVE_POLLER_NUMOF];
+static unsigned _pollers_numof;
+static int _epoll_fd = -1;
+/* poller thread -> RIOT: one byte per batch, signalled via SIGIO */
+static int _notify_pipe[2];
+/* RIOT -> poller thread: resume reading into stalled rings */
+static int _kick_pipe[2];
+
+static inline unsigned _ring_fill(unsigned head, unsigned tail)
+{
+    return head - tail;
+}
+
+static void _arm(native_poller_t *poller)
+{
+    struct epoll_event event = { .events = EPOLLIN | EPOLLONESHOT,
+                                 .data = { .ptr = poller } };
+
+    epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, poller->fd, &event);
+}
+
+/* runs in poller thread */
+static unsigned _drain_sock(native_poller_t *poller, unsigned head,
+                            unsigned space)
+{
+    struct mmsghdr msgs[NATIVE_POLLER_RING_SIZE];
+    struct iovec iov[NATIVE_POLLER_RING_SIZE];
+    int res;
+
+    memset(msgs, 0, space * sizeof(struct mmsghdr));
+    for (unsigned i = 0; i < space; i++) {
+        iov[i].iov_base = poller->ring[(head + i) & RING_MASK].data;
+        iov[i].iov_len = NATIVE_POLLER_FRAME_LEN;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    res = recvmmsg(poller->fd, msgs, space, MSG_DONTWAIT, NULL);
+    if (res <= 0) {
+        return 0;
+    }
+    for (int i = 0; i < res; i++) {
+        if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            poller->truncated++;
+        }
+        poller->ring[(head + i) & RING_MASK].len = msgs[i].msg_len;
+    }
+    return res;
+}
+
+/* runs in poller thread */
+static unsigned _drain_fd(native_poller_t *poller, unsigned head,
+                          unsigned space)
+{
+    unsigned got;
+
+    for (got = 0; got < space; got++) {
+        native_poller_frame_t *frame = &poller->ring[(head + got) & RING_MASK];
+        ssize_t res = real_read(poller->fd, frame->data, sizeof(frame->data));
+
+        if (res <= 0) {
+            break;
+        }
+        frame->len = res;
+    }
+    return got;
+}
+
+/* runs in poller thread, returns true if new frames were received */
+static bool _drain(native_poller_t *poller)
+{
+    unsigned head = poller->head;
+    unsigned tail = __atomic_load_n(&poller->tail, __ATOMIC_ACQUIRE);
+    unsigned space = NATIVE_POLLER_RING_SIZE - _ring_fill(head, tail);
+    unsigned got = 0;
+
+    if (space > 0) {
+        got = (poller->is_sock) ? _drain_sock(poller, head, space)
+                                : _drain_fd(poller, head, space);
+    }
+    if (got > 0) {
+        poller->frames += got;
+        poller->batches++;
+        __atomic_store_n(&poller->head, head + got, __ATOMIC_RELEASE);
+    }
+    if (got == space) {
+        /* ring is full: stop reading until RIOT made room again */
+        __atomic_store_n(&poller->stalled, 1, __ATOMIC_RELEASE);
+        /* RIOT may have made room in the meantime */
+        tail = __atomic_load_n(&poller->tail, __ATOMIC_ACQUIRE);
+        if ((_ring_fill(head + got, tail) > (NATIVE_POLLER_RING_SIZE / 2)) ||
+            !__atomic_exchange_n(&poller->stalled, 0, __ATOMIC_ACQ_REL)) {
+            return (got > 0);
+        }
+    }
+    _arm(poller);
+    return (got > 0);
+}
+
+/* runs in poller thread */
+static void _resume(void)
+{
+    unsigned numof = __atomic_load_n(&_pollers_numof, __ATOMIC_ACQUIRE);
+    uint8_t buf[8];
+
+    while (real_read(_kick_pipe[0], buf, sizeof(buf)) > 0) {}
+    for (unsigned i = 0; i < numof; i++) {
+        if (!__atomic_load_n(&_pollers[i]->stalled, __ATOMIC_ACQUIRE)) {
+            /* re-arming an armed file descriptor is harmless */
+            _arm(_pollers[i]);
+        }
+    }
+}
+
+static void *_poller_thread(void *arg)
+{
+    struct epoll_event events[NATIVE_POLLER_NUMOF + 1];
+
+    (void)arg;
+    while (1) {
+        bool notify = false;
+        int n = epoll_wait(_epoll_fd, events, NATIVE_POLLER_NUMOF + 1, -1);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return NULL;
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == NULL) {
+                _resume();
+            }
+            else {
+                notify |= _drain(events[i].data.ptr);
+            }
+        }
+        if (notify) {
+            static const uint8_t batch = 1;
+
+            /* if the pipe is full RIOT was not notified yet anyway */
+            real_write(_notify_pipe[1], &batch, sizeof(batch));
+        }
+    }
+    return NULL;
+}
+
+static void _notify_isr(int fd, void *arg)
+{
+    uint8_t buf[16];
+
+    (void)arg;
+    while (real_read(fd, buf, sizeof(buf)) > 0) {}
+    for (unsigned i = 0; i < _pollers_numof; i++) {
+        native_poller_t *poller = _pollers[i];
+
+        if (native_poller_peek(poller) != NULL) {
+            poller->cb(poller->arg);
+        }
+    }
+    native_async_read_continue(fd);
+}
+
+static void _init(void)
+{
+    struct epoll_event event = { .events = EPOLLIN, .data = { .ptr = NULL } };
+    _pthread_create_t create;
+    sigset_t sigmask, old_sigmask;
+    unsigned long thread;
+
+    /* native may provide its own (RIOT) pthread_create() */
+    *(void **)(&create) = dlsym(RTLD_NEXT, "pthread_create");
+    if (create == NULL) {
+        errx(EXIT_FAILURE, "native_poller: unable to find pthread_create()");
+    }
+    if ((_epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        err(EXIT_FAILURE, "native_poller: epoll_create1");
+    }
+    if ((real_pipe(_notify_pipe) < 0) || (real_pipe(_kick_pipe) < 0)) {
+        err(EXIT_FAILURE, "native_poller: pipe");
+    }
+    real_fcntl(_notify_pipe[1], F_SETFL, O_NONBLOCK);
+    real_fcntl(_kick_pipe[0], F_SETFL, O_NONBLOCK);
+    real_fcntl(_kick_pipe[1], F_SETFL, O_NONBLOCK);
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _kick_pipe[0], &event) < 0) {
+        err(EXIT_FAILURE, "native_poller: epoll_ctl");
+    }
+    native_async_read_setup();
+    native_async_read_add_handler(_notify_pipe[0], NULL, _notify_isr);
+    /* all signals are handled by RIOT's "CPU", i.e. the main thread */
+    sigfillset(&sigmask);
+    sigprocmask(SIG_BLOCK, &sigmask, &old_sigmask);
+    if (create(&thread, NULL, _poller_thread, NULL) != 0) {
+        errx(EXIT_FAILURE, "native_poller: unable to create poller thread");
+    }
+    sigprocmask(SIG_SETMASK, &old_sigmask, NULL);
+}
+
+void native_poller_add(native_poller_t *poller, int fd,
+                       native_poller_cb_t cb, void *arg)
+{
+    struct epoll_event event = { .events = EPOLLIN | EPOLLONESHOT,
+                                 .data = { .ptr = poller } };
+    struct stat st;
+
+    if (_pollers_numof >= NATIVE_POLLER_NUMOF) {
+        errx(EXIT_FAILURE, "native_poller_add(): too many file descriptors");
+    }
+    if (_epoll_fd < 0) {
+        _init();
+    }
+    memset(poller, 0, sizeof(native_poller_t));
+    poller->fd = fd;
+    poller->cb = cb;
+    poller->arg = arg;
+    poller->is_sock = (fstat(fd, &st) == 0) && S_ISSOCK(st.st_mode);
+    if (real_fcntl(fd, F_SETFL, O_NONBLOCK) == -1) {
+        err(EXIT_FAILURE, "native_poller_add(): fcntl(F_SETFL)");
+    }
+    _pollers[_pollers_numof] = poller;
+    __atomic_store_n(&_pollers_numof, _pollers_numof + 1, __ATOMIC_RELEASE);
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        err(EXIT_FAILURE, "native_poller_add(): epoll_ctl");
+    }
+    DEBUG("native_poller: added fd %d (%s)\n", fd,
+          (poller->is_sock) ? "socket" : "file");
+}
+
+native_poller_frame_t *native_poller_peek(native_poller_t *poller)
+{
+    unsigned head = __atomic_load_n(&poller->head, __ATOMIC_ACQUIRE);
+
+    if (head == poller->tail) {
+        return NULL;
+    }
+    return &poller->ring[poller->tail & RING_MASK];
+}
+
+void native_poller_pop(native_poller_t *poller)
+{
+    unsigned head = __atomic_load_n(&poller->head, __ATOMIC_ACQUIRE);
+    unsigned tail = poller->tail + 1;
+
+    assert(head != poller->tail);
+    __atomic_store_n(&poller->tail, tail, __ATOMIC_RELEASE);
+    /* let the poller thread resume reading once the ring drained to half */
+    if ((_ring_fill(head, tail) <= (NATIVE_POLLER_RING_SIZE / 2)) &&
+        __atomic_load_n(&poller->stalled, __ATOMIC_ACQUIRE) &&
+        __atomic_exchange_n(&poller->stalled, 0, __ATOMIC_ACQ_REL)) {
+        static const uint8_t kick = 1;
+
+        _native_syscall_enter();
+        real_write(_kick_pipe[1], &kick, sizeof(kick));
+        _native_syscall_leave();
+    }
+}
@@ -98,14 +98,94 @@ static size_t _prep_vector(socket_zep_t *dev, const iolist_t *iolist,
     return bytes;
 }
 
+#ifdef MODULE_SOCKET_ZEP_ACK
+static void _ack_timeout(void *arg)
+{
+    socket_zep_t *dev = arg;
+
+    /* retransmit from thread context */
+    dev->ack_timeout = true;
+    dev->netdev.netdev.event_callback(&dev->netdev.netdev, NETDEV_EVENT_ISR);
+}
+
+static void _keep_for_retransmission(socket_zep_t *dev, const struct iovec *v,
+                                     unsigned n)
+{
+    dev->snd_len = 0;
+    for (unsigned i = 0; i < n; i++) {
+        memcpy(&dev->snd_buf[dev->snd_len], v[i].iov_base, v[i].iov_len);
+        dev->snd_len += v[i].iov_len;
+    }
+    dev->ack_pending = true;
+    xtimer_set(&dev->ack_timer, SOCKET_ZEP_ACK_TIMEOUT);
+}
+
+static void _handle_ack_timeout(socket_zep_t *dev)
+{
+    netdev_t *netdev = &dev->netdev.netdev;
+
+    if (!dev->ack_pending) {
+        return;     /* ACK arrived in the meantime */
+    }
+    if (dev->tx_retries < SOCKET_ZEP_FRAME_RETRIES) {
+        struct iovec v = { .iov_base = dev->snd_buf, .iov_len = dev->snd_len };
+
+        DEBUG("socket_zep::isr: retransmitting frame %u\n",
+              (unsigned)dev->seq);
+        dev->tx_retries++;
+        real_writev(dev->sock_fd, &v, 1);
+        xtimer_set(&dev->ack_timer, SOCKET_ZEP_ACK_TIMEOUT);
+        return;
+    }
+    dev->ack_pending = false;
+    netdev->event_callback(netdev, NETDEV_EVENT_TX_NOACK);
+}
+
+static void _send_ack(socket_zep_t *dev, network_uint32_t seq)
+{
+    zep_v2_ack_hdr_t ack = { .hdr = { .preamble = { 'E', 'X' }, .version = 2 },
+                             .type = ZEP_V2_TYPE_ACK, .seq = seq };
+    struct iovec v = { .iov_base = &ack, .iov_len = sizeof(ack) };
+
+    real_writev(dev->sock_fd, &v, 1);
+}
+
+static void _handle_ack(socket_zep_t *dev, const zep_v2_ack_hdr_t *ack)
+{
+    netdev_t *netdev = &dev->netdev.netdev;
+
+    if (!dev->ack_pending || (byteorder_ntohl(ack->seq) != dev->seq)) {
+        return;
+    }
+    xtimer_remove(&dev->ack_timer);
+    dev->ack_pending = false;
+    /* called from recv(), so already in thread context */
+    if (netdev->event_callback) {
+        netdev->event_callback(netdev, NETDEV_EVENT_TX_COMPLETE);
+    }
+}
+#endif /* MODULE_SOCKET_ZEP_ACK */
+
 static int _send(netdev_t *netdev, const iolist_t *iolist)
 {
     socket_zep_t *dev = (socket_zep_t *)netdev;
     unsigned n = iolist_count(iolist);
     struct iovec v[n + 2];
+    bool ack_req = false;
     int res;
 
     assert((dev != NULL) && (dev->sock_fd != 0));
+    dev->seq = (dev->seq & 0xffff0000) | ((dev->seq + 1) & 0xffff);
+#ifdef MODULE_SOCKET_ZEP_ACK
+    if (dev->ack_pending) {
+        /* the upper layer gave up on the previous frame */
+        xtimer_remove(&dev->ack_timer);
+        dev->ack_pending = false;
+    }
+    dev->tx_retries = 0;
+    ack_req = (iolist->iol_len > 0) &&
+              (((uint8_t *)iolist->iol_base)[0] & IEEE802154_FCF_ACK_REQ);
+#endif
     _prep_vector(dev, iolist, n, v);
     DEBUG("socket_zep::send(%p, %p, %u)\n", (void *)netdev, (void *)iolist, n);
     /* simulate TX_STARTED interrupt */
@@ -114,13 +194,19 @@ static int _send(netdev_t *netdev, const iolist_t *iolist)
         netdev->event_callback(netdev, NETDEV_EVENT_ISR);
         thread_yield();
     }
-    res = writev(dev->sock_fd, v, n + 2);
+    res = real_writev(dev->sock_fd, v, n + 2);
     if (res < 0) {
         DEBUG("socket_zep::send: error writing packet: %s\n", strerror(errno));
         return res;
     }
+#ifdef MODULE_SOCKET_ZEP_ACK
+    if (ack_req) {
+        /* TX_COMPLETE or TX_NOACK follows once the ACK arrived or not */
+        _keep_for_retransmission(dev, v, n + 2);
+    }
+#endif
     /* simulate TX_COMPLETE interrupt */
-    if (netdev->event_callback) {
+    if (!ack_req && netdev->event_callback) {
         dev->last_event = NETDEV_EVENT_TX_COMPLETE;
         netdev->event_callback(netdev, NETDEV_EVENT_ISR);
         thread_yield();
@@ -129,6 +215,108 @@ static int _send(netdev_t *netdev, const iolist_t *iolist)
     return res - v[0].iov_len - v[n + 1].iov_len;
 }
 
+static inline bool _dst_not_me(socket_zep_t *dev, const void *buf)
+{
+    uint8_t dst_addr[IEEE802154_LONG_ADDRESS_LEN] = { 0 };
+    int dst_len;
+    le_uint16_t dst_pan = { .u16 = 0 };
+
+    dst_len = ieee802154_get_dst(buf, dst_addr,
+                                 &dst_pan);
+    switch (dst_len) {
+        case IEEE802154_LONG_ADDRESS_LEN:
+            return memcmp(dst_addr, dev->netdev.long_addr, dst_len) != 0;
+        case IEEE802154_SHORT_ADDRESS_LEN:
+            return (memcmp(dst_addr, ieee802154_addr_bcast, dst_len) != 0) &&
+                   (memcmp(dst_addr, dev->netdev.short_addr, dst_len) != 0);
+        default:
+            return false;    /* better safe than sorry ;-) */
+    }
+}
+
+static int _parse(socket_zep_t *dev, const uint8_t *frame, int size,
+                  void *buf, size_t len, void *info)
+{
+    zep_hdr_t *tmp = (zep_hdr_t *)frame;
+
+    if ((tmp->preamble[0] != 'E') || (tmp->preamble[1] != 'X')) {
+        DEBUG("socket_zep::recv: invalid ZEP header");
+        return -1;
+    }
+    switch (tmp->version) {
+        case 2: {
+            zep_v2_data_hdr_t *zep = (zep_v2_data_hdr_t *)tmp;
+            const void *payload = &frame[sizeof(zep_v2_data_hdr_t)];
+
+#ifdef MODULE_SOCKET_ZEP_ACK
+            if (zep->type == ZEP_V2_TYPE_ACK) {
+                if ((unsigned)size >= sizeof(zep_v2_ack_hdr_t)) {
+                    _handle_ack(dev, (zep_v2_ack_hdr_t *)tmp);
+                }
+                return -1;
+            }
+#endif
+            if (zep->type != ZEP_V2_TYPE_DATA) {
+                DEBUG("socket_zep::recv: unexpect ZEP type\n");
+                return -1;
+            }
+            if (((sizeof(zep_v2_data_hdr_t) + zep->length) != (unsigned)size) ||
+                (zep->length > len) || (zep->chan != dev->netdev.chan) ||
+                /* TODO promiscous mode */
+                _dst_not_me(dev, payload)) {
+                /* TODO: check checksum */
+                return -1;
+            }
+#ifdef MODULE_SOCKET_ZEP_ACK
+            if (((const uint8_t *)payload)[0] & IEEE802154_FCF_ACK_REQ) {
+                /* only set for frames addressed to us (not broadcast) */
+                _send_ack(dev, zep->seq);
+            }
+#endif
+            /* don't hand FCS to stack */
+            size = zep->length - sizeof(uint16_t);
+            if (buf != NULL) {
+                memcpy(buf, payload, size);
+                if (info != NULL) {
+                    struct netdev_radio_rx_info *rx_info = info;
+                    rx_info->lqi = zep->lqi_val;
+                    rx_info->rssi = UINT8_MAX;
+                }
+            }
+            break;
+        }
+        default:
+            DEBUG("socket_zep::recv: unexpected ZEP version\n");
+            return -1;
+    }
+    return size;
+}
+
+#ifdef MODULE_NATIVE_POLLER
+static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
+{
+    socket_zep_t *dev = (socket_zep_t *)netdev;
+    native_poller_frame_t *frame = native_poller_peek(&dev->poller);
+    int size;
+
+    DEBUG("socket_zep::recv(%p, %p, %u, %p)\n", (void *)netdev, buf,
+          (unsigned)len, (void *)info);
+    if (frame == NULL) {
+        return ((buf == NULL) && (len == 0)) ? 0 : -1;
+    }
+    if ((buf == NULL) || (len == 0)) {
+        size = frame->len;
+        if ((buf == NULL) && (len > 0)) {
+            DEBUG("socket_zep::recv: discarding the frame\n");
+            native_poller_pop(&dev->poller);
+        }
+        return size;
+    }
+    size = _parse(dev, frame->data, frame->len, buf, len, info);
+    native_poller_pop(&dev->poller);
+    return size;
+}
+#else /* MODULE_NATIVE_POLLER */
 static void _continue_reading(socket_zep_t *dev)
 {
     /* work around lost signals */
@@ -154,25 +342,6 @@ static void _continue_reading(socket_zep_t *dev)
     _native_in_syscall--;
 }
 
-static inline bool _dst_not_me(socket_zep_t *dev, const void *buf)
-{
-    uint8_t dst_addr[IEEE802154_LONG_ADDRESS_LEN] = { 0 };
-    int dst_len;
-    le_uint16_t dst_pan = { .u16 = 0 };
-
-    dst_len = ieee802154_get_dst(buf, dst_addr,
-                                 &dst_pan);
-    switch (dst_len) {
-        case IEEE802154_LONG_ADDRESS_LEN:
-            return memcmp(dst_addr, dev->netdev.long_addr, dst_len) != 0;
-        case IEEE802154_SHORT_ADDRESS_LEN:
-            return (memcmp(dst_addr, ieee802154_addr_bcast, dst_len) != 0) &&
-                   (memcmp(dst_addr, dev->netdev.short_addr, dst_len) != 0);
-        default:
-            return false;    /* better safe than sorry ;-) */
-    }
-}
-
 static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
 {
     socket_zep_t *dev = (socket_zep_t *)netdev;
@@ -196,44 +365,9 @@ static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
         size = real_read(dev->sock_fd, dev->rcv_buf, sizeof(dev->rcv_buf));
 
         if (size > 0) {
-            zep_hdr_t *tmp = (zep_hdr_t *)&dev->rcv_buf;
-
-            if ((tmp->preamble[0] != 'E') || (tmp->preamble[1] != 'X')) {
-                DEBUG("socket_zep::recv: invalid ZEP header");
-                return -1;
-            }
-            switch (tmp->version) {
-                case 2: {
-                    zep_v2_data_hdr_t *zep = (zep_v2_data_hdr_t *)tmp;
-                    void *payload = &dev->rcv_buf[sizeof(zep_v2_data_hdr_t)];
-
-                    if (zep->type != ZEP_V2_TYPE_DATA) {
-                        DEBUG("socket_zep::recv: unexpect ZEP type\n");
-                        /* don't support ACK frames for now*/
-                        return -1;
-                    }
-                    if (((sizeof(zep_v2_data_hdr_t) + zep->length) != (unsigned)size) ||
-                        (zep->length > len) || (zep->chan != dev->netdev.chan) ||
-                        /* TODO promiscous mode */
-                        _dst_not_me(dev, payload)) {
-                        /* TODO: check checksum */
-                        return -1;
-                    }
-                    /* don't hand FCS to stack */
-                    size = zep->length - sizeof(uint16_t);
-                    if (buf != NULL) {
-                        memcpy(buf, payload, size);
-                        if (info != NULL) {
-                            struct netdev_radio_rx_info *rx_info = info;
-                            rx_info->lqi = zep->lqi_val;
-                            rx_info->rssi = UINT8_MAX;
-                        }
-                    }
-                    break;
-                }
-                default:
-                    DEBUG("socket_zep::recv: unexpected ZEP version\n");
-                    return -1;
+            size = _parse(dev, dev->rcv_buf, size, buf, len, info);
+            if (size < 0) {
+                return size;
             }
         }
         else if (size == 0) {
@@ -255,18 +389,45 @@ static int _recv(netdev_t *netdev, void *buf, size_t len, void *info)
 
     return size;
 }
+#endif /* MODULE_NATIVE_POLLER */
 
 static void _isr(netdev_t *netdev)
 {
     if (netdev->event_callback) {
         socket_zep_t *dev = (socket_zep_t *)netdev;
 
+#ifdef MODULE_SOCKET_ZEP_ACK
+        if (dev->ack_timeout) {
+            dev->ack_timeout = false;
+            _handle_ack_timeout(dev);
+            return;
+        }
+#endif
         DEBUG("socket_zep::isr: firing %u\n", (unsigned)dev->last_event);
+#ifdef MODULE_NATIVE_POLLER
+        if (dev->last_event == NETDEV_EVENT_RX_COMPLETE) {
+            /* hand the whole batch to the upper layer */
+            for (unsigned i = 0; (i < NATIVE_POLLER_RING_SIZE) &&
+                                 (native_poller_peek(&dev->poller) != NULL);
+                 i++) {
+                netdev->event_callback(netdev, NETDEV_EVENT_RX_COMPLETE);
+            }
+            return;
+        }
+#endif
         netdev->event_callback(netdev, dev->last_event);
     }
     return;
 }
 
+#ifdef MODULE_NATIVE_POLLER
+static void _socket_isr(void *arg)
+{
+    netdev_t *netdev = (netdev_t *)arg;
+
+    DEBUG("socket_zep::_socket_isr: %p (netdev == %p)\n",
+          arg, (void *)netdev);
+#else
 static void _socket_isr(int fd, void *arg)
 {
     (void)fd;
@@ -275,6 +436,7 @@ static void _socket_isr(int fd, void *arg)
 
     DEBUG("socket_zep::_socket_isr: %d, %p (netdev == %p)\n",
           fd, arg, (void *)netdev);
+#endif
     if (netdev == NULL) {
         return;
     }
@@ -294,6 +456,10 @@ static int _init(netdev_t *netdev)
 
     assert(dev != NULL);
     dev->netdev.chan = IEEE802154_DEFAULT_CHANNEL;
+#ifdef MODULE_SOCKET_ZEP_ACK
+    /* frames are acknowledged like on a real radio */
+    dev->netdev.flags |= NETDEV_IEEE802154_ACK_REQ;
+#endif
 
     return 0;
 }
@@ -301,6 +467,15 @@ static int _init(netdev_t *netdev)
 static int _get(netdev_t *netdev, netopt_t opt, void *value, size_t max_len)
 {
     assert(netdev != NULL);
+#ifdef MODULE_SOCKET_ZEP_ACK
+    if (opt == NETOPT_TX_RETRIES_NEEDED) {
+        if (max_len < sizeof(uint8_t)) {
+            return -EOVERFLOW;
+        }
+        *((uint8_t *)value) = ((socket_zep_t *)netdev)->tx_retries;
+        return sizeof(uint8_t);
+    }
+#endif
     return netdev_ieee802154_get((netdev_ieee802154_t *)netdev, opt, value, max_len);
 }
 
@@ -333,6 +508,10 @@ void socket_zep_setup(socket_zep_t *dev, const socket_zep_params_t *params)
            (params->remote_addr != NULL) && (params->remote_port != NULL));
     memset(dev, 0, sizeof(socket_zep_t));
     dev->netdev.netdev.driver = &socket_zep_driver;
+#ifdef MODULE_SOCKET_ZEP_ACK
+    dev->ack_timer.callback = _ack_timeout;
+    dev->ack_timer.arg = dev;
+#endif
     /* bind and connect socket */
     if ((res = real_getaddrinfo(params->local_addr, params->local_port, &hints,
                                 &ai)) < 0) {
@@ -393,8 +572,17 @@ void socket_zep_setup(socket_zep_t *dev, const socket_zep_params_t *params)
     }
     dev->netdev.short_addr[0] = dev->netdev.long_addr[6];
     dev->netdev.short_addr[1] = dev->netdev.long_addr[7];
+    /* ACKs carry no addresses, so the upper half of the sequence numbers
+     * tells frames of different devices apart */
+    dev->seq = ((uint32_t)dev->netdev.short_addr[0] << 24) |
+               ((uint32_t)dev->netdev.short_addr[1] << 16);
+#ifdef MODULE_NATIVE_POLLER
+    /* receive in batches from the poller thread */
+    native_poller_add(&dev->poller, dev->sock_fd, _socket_isr, dev);
+#else
     native_async_read_setup();
     native_async_read_add_handler(dev->sock_fd, dev, _socket_isr);
+#endif
 }
 
 void socket_zep_cleanup(socket_zep_t *dev)
@@ -98,6 +98,10 @@ int (*real_fputc)(int c, FILE *stream);
 int (*real_fgetc)(FILE *stream);
 mode_t (*real_umask)(mode_t cmask);
 ssize_t (*real_writev)(int fildes, const struct iovec *iov, int iovcnt);
+off_t (*real_lseek)(int fd, off_t offset, int whence);
+int (*real_ftruncate)(int fd, off_t length);
+void* (*real_mmap)(void *addr, size_t length, int prot, int flags,
+                   int fd, off_t offset);
 
 #ifdef __MACH__
 #else
@@ -488,6 +492,9 @@ void _native_init_syscalls(void)
     *(void **)(&real_fseek) = dlsym(RTLD_NEXT, "fseek");
     *(void **)(&real_fputc) = dlsym(RTLD_NEXT, "fputc");
     *(void **)(&real_fgetc) = dlsym(RTLD_NEXT, "fgetc");
+    *(void **)(&real_lseek) = dlsym(RTLD_NEXT, "lseek");
+    *(void **)(&real_ftruncate) = dlsym(RTLD_NEXT, "ftruncate");
+    *(void **)(&real_mmap) = dlsym(RTLD_NEXT, "mmap");
 #ifdef __MACH__
 #else
     *(void **)(&real_clock_gettime) = dlsym(RTLD_NEXT, "clock_gettime");
@@ -20,9 +20,13 @@ def mkconstfs(root_path, mount_point, constfs_name):
             target_fname = os.path.join(target_dirname, fname)
             print_file_data(local_fname, target_fname)
 
+    # sorted by hash for the binary search in constfs
+    files = sorted((djb2(target_name), target_name, mangled_name)
+                   for mangled_name, target_name, _ in FILES)
+
     print("\nstatic const constfs_file_t _files[] = {")
 
-    for mangled_name, target_name, _ in FILES:
+    for _, target_name, mangled_name in files:
         print("    {")
         print("    .path = \"%s\"," % target_name)
         print("    .data = %s," % mangled_name)
@@ -30,10 +34,17 @@ def mkconstfs(root_path, mount_point, constfs_name):
         print("    },")
     print("};")
 
+    print("\n/* djb2 hashes of the paths, the files are sorted by them */")
+    print("static const uint32_t _hashes[] = {")
+    for h, _, _ in files:
+        print("    0x%08x," % h)
+    print("};")
+
     print("""
 static const constfs_t _fs_data = {
     .files = _files,
     .nfiles = sizeof(_files) / sizeof(_files[0]),
+    .hashes = _hashes,
 };
 
 vfs_mount_t %s = {
@@ -44,6 +55,14 @@ vfs_mount_t %s = {
     """ % (constfs_name, mount_point))
 
 
+def djb2(path):
+    """Hash of a path as computed by djb2_hash() in sys/hashes"""
+    h = 5381
+    for b in path.encode('utf-8'):
+        h = (h * 33 + b) & 0xffffffff
+    return h
+
+
 def mangle_name(fname):
     fname = fname.replace("/", "__")
     fname = fname.replace(".", "__")
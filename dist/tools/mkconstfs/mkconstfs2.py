@@ -31,6 +31,7 @@ C_FOOTER = """
 static const constfs_t _fs_data = {{
     .files = _files,
     .nfiles = sizeof(_files) / sizeof(_files[0]),
+    .hashes = _hashes,
 }};
 
 vfs_mount_t {constfs_name} = {{
@@ -44,6 +45,14 @@ FILES_DECL = """
 static const constfs_file_t _files[] = {
 """
 
+HASHES_DECL = """
+/* djb2 hashes of the paths, the files are sorted by them */
+static const uint32_t _hashes[] = {
+"""
+
+HASH_TEMPLATE = """  0x{hash:08x},
+"""
+
 BLOB_DECL = """
 /** {fname} **/
 static const uint8_t {varname}[] = {{
@@ -71,11 +80,21 @@ def mkconstfs(files, root_path, mount_point, constfs_name):
     yield from itertools.chain.from_iterable(
                 print_file_data(local_f, *f_data) for local_f, f_data in filemap.items())
 
+    # sorted by hash for the binary search in constfs
+    entries = sorted((_djb2(_addroot(relp)), _addroot(relp), ident)
+                     for ident, relp in filemap.values())
+
     yield FILES_DECL
 
-    yield from (FILE_TEMPLATE.format(target_name=_addroot(relp),
+    yield from (FILE_TEMPLATE.format(target_name=target_name,
                                      buff_name=ident)
-                for ident, relp in sorted(filemap.values()))
+                for _, target_name, ident in entries)
+
+    yield "};\n"
+
+    yield HASHES_DECL
+
+    yield from (HASH_TEMPLATE.format(hash=h) for h, _, _ in entries)
 
     yield "};\n"
 
@@ -86,6 +105,14 @@ def _addroot(fname):
     return "/" + fname if not fname.startswith("/") else fname
 
 
+def _djb2(path):
+    """Hash of a path as computed by djb2_hash() in sys/hashes"""
+    h = 5381
+    for b in path.encode('utf-8'):
+        h = (h * 33 + b) & 0xffffffff
+    return h
+
+
 def _mkident(k):
     return "_file{:02X}".format(k)
 
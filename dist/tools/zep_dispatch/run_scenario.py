@@ -0,0 +1,313 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2019 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+"""
+Spawn N native nodes connected by zep_dispatch and measure end-to-end
+throughput and latency.
+
+All nodes but node 0 (the sink) send `ping6` to the sink concurrently. The
+nodes must run a GNRC application with the shell commands `ifconfig` and
+`ping6` and a socket_zep interface, e.g. `examples/gnrc_networking` built
+with `USEMODULE=socket_zep`. With `--rpl` the nodes form an RPL DODAG rooted
+at the sink so multi-hop topologies can be used. The hop count of a node's
+route is derived from the hop limit of the echo replies, so the delivery
+ratio and the latency per hop of different objective functions can be
+compared on the same topology. With `--rpl` the time until every node has
+joined the DODAG is reported as well and, if the nodes are built with
+`USEMODULE=netstats_rpl`, the RPL control traffic all nodes sent.
+"""
+
+import argparse
+import os
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+import pexpect
+
+HUB = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                   "bin", "zep_dispatch")
+PROMPT = "> "
+SINK_PREFIX = "2001:db8::"
+SINK_ADDR = SINK_PREFIX + "1"
+
+PING_STATS = re.compile(r"(\d+) packets transmitted, (\d+) packets received")
+PING_TTL = re.compile(r"icmp_seq=\d+ ttl=(\d+)")
+PING_RTT = re.compile(r"round-trip min/avg/max = "
+                      r"([\d.]+)/([\d.]+)/([\d.]+) ms")
+RPL_STATS = re.compile(r"(DIO|DIS|DAO|DAO-ACK)\s+#(packets|bytes):\s+\d+ / (\d+)"
+                       r"\s+\d+ / (\d+)")
+RPL_DAO_STATS = re.compile(r"DAO TX  #targets:\s+(\d+)\s+#retries:\s+(\d+)"
+                           r"\s+#unacked:\s+(\d+)")
+
+
+def topology(kind, numof):
+    """Returns the links of a generated topology as (a, b) index pairs"""
+    if kind == "mesh":
+        return [(a, b) for a in range(numof) for b in range(a + 1, numof)]
+    if kind == "line":
+        return [(a, a + 1) for a in range(numof - 1)]
+    if kind == "ring":
+        return [(a, (a + 1) % numof) for a in range(numof)] if numof > 2 \
+            else topology("line", numof)
+    if kind == "star":
+        return [(0, b) for b in range(1, numof)]
+    if kind == "grid":
+        width = max(1, int(round(numof ** 0.5)))
+        res = []
+        for a in range(numof):
+            if (a % width) < (width - 1) and (a + 1) < numof:
+                res.append((a, a + 1))
+            if (a + width) < numof:
+                res.append((a, a + width))
+        return res
+    raise ValueError("unknown topology {}".format(kind))
+
+
+def write_topology(f, args):
+    for i in range(args.nodes):
+        f.write("node n{} ::1 {}\n".format(i, args.port + 1 + i))
+    if args.topology_file:
+        with open(args.topology_file) as links:
+            f.write(links.read())
+    else:
+        for a, b in topology(args.topology, args.nodes):
+            f.write("n{} n{} {} {} {}\n".format(a, b, args.loss, args.delay,
+                                                args.jitter))
+    f.flush()
+
+
+def cmd(node, line, timeout=10):
+    node.sendline(line)
+    node.expect_exact(PROMPT, timeout=timeout)
+    return node.before
+
+
+def zep_iface(node):
+    """Returns interface number and link-local address of the ZEP iface"""
+    for block in cmd(node, "ifconfig").split("Iface")[1:]:
+        if "Channel:" not in block:
+            continue
+        iface = block.split()[0]
+        match = re.search(r"inet6 addr: (fe80:[0-9a-f:]+)", block)
+        return iface, match.group(1) if match else None
+    raise RuntimeError("node has no ZEP interface")
+
+
+def spawn_nodes(args):
+    nodes = []
+    for i in range(args.nodes):
+        argv = args.node_args + ["-z", "[::1]:{},[::1]:{}".format(
+            args.port + 1 + i, args.port)]
+        node = pexpect.spawnu(args.elf, argv, timeout=10,
+                              codec_errors="replace", echo=False)
+        if args.verbose:
+            node.logfile_read = sys.stdout
+        nodes.append(node)
+    for node in nodes:
+        node.expect_exact(PROMPT)
+    return nodes
+
+
+def setup_rpl(nodes, ifaces):
+    sink = nodes[0]
+    cmd(sink, "ifconfig {} add {}/64".format(ifaces[0][0], SINK_ADDR))
+    for node, (iface, _) in zip(nodes, ifaces):
+        cmd(node, "rpl init {}".format(iface))
+    cmd(sink, "rpl root 0 {}".format(SINK_ADDR))
+
+
+def wait_dodag(args, nodes):
+    """Returns the seconds until all nodes have an RPL parent"""
+    start = time.time()
+    joined = set()
+    while len(joined) < (len(nodes) - 1):
+        if (time.time() - start) > args.formation_timeout:
+            print("only {} of {} nodes joined the DODAG".format(
+                len(joined), len(nodes) - 1))
+            break
+        for i, node in enumerate(nodes[1:], 1):
+            if (i not in joined) and ("parent [addr:" in cmd(node, "rpl")):
+                joined.add(i)
+        time.sleep(0.1)
+    return time.time() - start
+
+
+def rpl_stats(nodes):
+    """Sums up the RPL control traffic sent by all nodes"""
+    tx = {"packets": 0, "bytes": 0}
+    dao = [0, 0, 0]
+    for node in nodes:
+        out = cmd(node, "rpl stats")
+        for _, unit, ucast, mcast in RPL_STATS.findall(out):
+            tx[unit] += int(ucast) + int(mcast)
+        match = RPL_DAO_STATS.search(out)
+        if match:
+            dao = [x + int(y) for x, y in zip(dao, match.groups())]
+    if not tx["packets"]:
+        return None
+    return tx["packets"], tx["bytes"], dao
+
+
+def run_pings(args, nodes, ifaces):
+    for i, node in enumerate(nodes[1:], 1):
+        if args.rpl:
+            dst = SINK_ADDR
+        else:
+            dst = "{}%{}".format(ifaces[0][1], ifaces[i][0])
+        node.sendline("ping6 -c {} -i {} -s {} -W {} {}".format(
+            args.count, args.interval, args.size, args.ping_timeout, dst))
+    start = time.time()
+    results = []
+    timeout = (args.count * (args.interval + args.ping_timeout)) / 1000 + 10
+    for i, node in enumerate(nodes[1:], 1):
+        node.expect(PING_STATS, timeout=timeout)
+        sent, recv = int(node.match.group(1)), int(node.match.group(2))
+        # the reply leaves the sink with the hop limit and every router on
+        # the way back decrements it
+        hops = [args.hop_limit + 1 - int(ttl)
+                for ttl in PING_TTL.findall(node.before)]
+        node.expect_exact(PROMPT, timeout=timeout)
+        rtt = PING_RTT.search(node.before)
+        results.append((i, sent, recv,
+                        [float(x) for x in rtt.groups()] if rtt else None,
+                        (sum(hops) / len(hops)) if hops else None))
+    return results, time.time() - start
+
+
+def report(args, results, duration):
+    print("\n{:<6} {:>6} {:>6} {:>7} {:>10} {:>10} {:>10} {:>6} {:>10}".format(
+        "node", "sent", "recv", "loss %", "min ms", "avg ms", "max ms", "hops",
+        "ms/hop"))
+    sent = recv = 0
+    rtt_min, rtt_max, rtt_sum = float("inf"), 0.0, 0.0
+    hops_sum = hop_lat_sum = 0.0
+    for i, s, r, rtt, hops in results:
+        sent += s
+        recv += r
+        hop_lat = None
+        if rtt:
+            rtt_min = min(rtt_min, rtt[0])
+            rtt_max = max(rtt_max, rtt[2])
+            rtt_sum += rtt[1] * r
+        if rtt and hops:
+            # one-way latency per hop
+            hop_lat = rtt[1] / (2 * hops)
+            hops_sum += hops * r
+            hop_lat_sum += hop_lat * r
+        print("n{:<5} {:>6} {:>6} {:>7.1f} {:>10} {:>10} {:>10} {:>6} "
+              "{:>10}".format(
+                  i, s, r, (100.0 * (s - r) / s) if s else 0.0,
+                  *(["{:.3f}".format(x) for x in rtt] if rtt else ["-"] * 3),
+                  "{:.2f}".format(hops) if hops else "-",
+                  "{:.3f}".format(hop_lat) if hop_lat else "-"))
+    print("\n{{ \"nodes\" : {}, \"sent\" : {}, \"received\" : {}, "
+          "\"loss_percent\" : {:.1f}, \"delivery_ratio\" : {:.3f}, "
+          "\"duration_s\" : {:.3f}, \"throughput_Bps\" : {:.1f}, "
+          "\"rtt_min_ms\" : {:.3f}, \"rtt_avg_ms\" : {:.3f}, "
+          "\"rtt_max_ms\" : {:.3f}, \"hops_avg\" : {:.2f}, "
+          "\"hop_latency_ms\" : {:.3f} }}".format(
+              len(results) + 1, sent, recv,
+              (100.0 * (sent - recv) / sent) if sent else 0.0,
+              (recv / sent) if sent else 0.0, duration,
+              (recv * args.size) / duration if duration else 0.0,
+              rtt_min if recv else 0.0, (rtt_sum / recv) if recv else 0.0,
+              rtt_max, (hops_sum / recv) if recv else 0.0,
+              (hop_lat_sum / recv) if recv else 0.0))
+
+
+def main(args):
+    if not os.path.exists(args.hub):
+        sys.exit("{} not found, run make first".format(args.hub))
+    with tempfile.NamedTemporaryFile("w", suffix=".topo") as topo:
+        write_topology(topo, args)
+        hub_argv = [args.hub, "-t", topo.name, "-s", str(args.seed)]
+        if args.pcap:
+            hub_argv += ["-w", args.pcap]
+        hub = subprocess.Popen(hub_argv + ["::1", str(args.port)],
+                               stdout=subprocess.PIPE,
+                               universal_newlines=True)
+        nodes = []
+        try:
+            nodes = spawn_nodes(args)
+            ifaces = [zep_iface(node) for node in nodes]
+            if args.rpl:
+                setup_rpl(nodes, ifaces)
+                formation = wait_dodag(args, nodes)
+            time.sleep(args.settle)
+            results, duration = run_pings(args, nodes, ifaces)
+            report(args, results, duration)
+            if args.rpl:
+                stats = rpl_stats(nodes)
+                print("{{ \"formation_s\" : {:.3f}".format(formation), end="")
+                if stats:
+                    print(", \"rpl_tx_packets\" : {}, \"rpl_tx_bytes\" : {}, "
+                          "\"dao_targets\" : {}, \"dao_retries\" : {}, "
+                          "\"dao_unacked\" : {}".format(stats[0], stats[1],
+                                                         *stats[2]), end="")
+                print(" }")
+        finally:
+            for node in nodes:
+                node.terminate(force=True)
+            hub.send_signal(signal.SIGINT)
+            hub_stats = hub.communicate()[0]
+        print("\nzep_dispatch statistics:\n" + hub_stats)
+
+
+if __name__ == "__main__":
+    p = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    p.add_argument("elf", help="native binary of the node application")
+    p.add_argument("-n", "--nodes", type=int, default=4,
+                   help="number of nodes (default: %(default)s)")
+    p.add_argument("-t", "--topology", default="mesh",
+                   choices=["mesh", "line", "ring", "star", "grid"],
+                   help="generated topology (default: %(default)s)")
+    p.add_argument("-T", "--topology-file",
+                   help="links in zep_dispatch format (nodes are n0..nN-1) "
+                        "instead of a generated topology")
+    p.add_argument("-l", "--loss", type=float, default=0,
+                   help="loss per link in percent")
+    p.add_argument("-d", "--delay", type=float, default=0,
+                   help="delay per link in ms")
+    p.add_argument("-j", "--jitter", type=float, default=0,
+                   help="maximum jitter per link in ms")
+    p.add_argument("-s", "--seed", type=int, default=1,
+                   help="seed for the link models (default: %(default)s)")
+    p.add_argument("-w", "--pcap", help="capture all frames to this file")
+    p.add_argument("-r", "--rpl", action="store_true",
+                   help="build an RPL DODAG rooted at the sink")
+    p.add_argument("-c", "--count", type=int, default=100,
+                   help="pings per node (default: %(default)s)")
+    p.add_argument("-i", "--interval", type=int, default=100,
+                   help="ping interval in ms (default: %(default)s)")
+    p.add_argument("-S", "--size", type=int, default=32,
+                   help="ping payload size (default: %(default)s)")
+    p.add_argument("-W", "--ping-timeout", type=int, default=1000,
+                   help="ping timeout in ms (default: %(default)s)")
+    p.add_argument("--hop-limit", type=int, default=64,
+                   help="hop limit the sink sends replies with (default: "
+                        "%(default)s)")
+    p.add_argument("--formation-timeout", type=float, default=60,
+                   help="seconds to wait for all nodes to join the DODAG "
+                        "(default: %(default)s)")
+    p.add_argument("--settle", type=float, default=5,
+                   help="seconds to wait before sending (default: "
+                        "%(default)s)")
+    p.add_argument("-p", "--port", type=int, default=17754,
+                   help="hub port, nodes use the following ports "
+                        "(default: %(default)s)")
+    p.add_argument("--hub", default=HUB, help="zep_dispatch binary")
+    p.add_argument("--node-args", nargs=argparse.REMAINDER, default=[],
+                   help="additional arguments for each node, e.g. a tap "
+                        "interface")
+    p.add_argument("-v", "--verbose", action="store_true",
+                   help="show the nodes' output")
+    main(p.parse_args())
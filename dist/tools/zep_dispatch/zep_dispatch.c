@@ -0,0 +1,618 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser General
+ * Public License v2.1. See the file LICENSE in the top level directory for
+ * more details.
+ */
+
+/**
+ * @file
+ * @brief   ZEP hub to connect native instances using socket_zep
+ *
+ * Every frame received from a node is forwarded to all nodes it has a link
+ * to. Links drop frames with a given probability and delay them by a given
+ * time (plus jitter). All random decisions are taken from a seeded PRNG in
+ * the order the frames arrive, so a scenario replays identically as long as
+ * the nodes send the same frames in the same order.
+ *
+ * See README.md for usage and the topology file format.
+ */
+
+#define _GNU_SOURCE     /* for ppoll() */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef NODES_MAX
+#define NODES_MAX       (64U)       /**< maximum number of nodes */
+#endif
+
+#ifndef QUEUE_MAX
+#define QUEUE_MAX       (1024U)     /**< maximum number of delayed frames */
+#endif
+
+#define NAME_LEN        (16U)
+#define FRAME_MAX       (256U)      /**< ZEPv2 header + 127 byte PSDU fit */
+#define LINE_MAX_LEN    (256U)
+
+#define ZEP_V1_HDR_LEN  (16U)
+#define ZEP_V2_HDR_LEN  (32U)
+#define ZEP_V2_TYPE_DATA    (1U)
+
+#define PCAP_LINKTYPE_IEEE802_15_4  (195U)  /**< 802.15.4 with FCS */
+
+#define US_PER_MS       (1000LU)
+#define PPM             (1000000LU)
+
+typedef struct {
+    struct sockaddr_in6 addr;
+    char name[NAME_LEN];
+    bool bound;             /**< node::addr is valid */
+    unsigned long rx;       /**< frames received from node */
+    unsigned long tx;       /**< frames sent to node */
+} node_t;
+
+typedef struct {
+    bool up;
+    uint32_t loss;          /**< loss probability in ppm */
+    uint32_t delay;         /**< delay in us */
+    uint32_t jitter;        /**< maximum additional delay in us */
+    uint64_t last_due;      /**< keeps frames on a link in order */
+    unsigned long fwd;      /**< frames forwarded over the link */
+    unsigned long lost;     /**< frames dropped by the link */
+} link_t;
+
+typedef struct {
+    uint64_t due;
+    uint64_t seq;           /**< orders frames with the same due time */
+    unsigned dst;
+    unsigned len;
+    uint8_t data[FRAME_MAX];
+} delayed_t;
+
+static node_t _nodes[NODES_MAX];
+static unsigned _nodes_numof;
+static link_t _links[NODES_MAX][NODES_MAX];
+static link_t _mesh;        /**< link model for all pairs without topology */
+static bool _use_mesh = true;
+
+static delayed_t *_queue[QUEUE_MAX];    /* min-heap on (due, seq) */
+static unsigned _queue_len;
+static uint64_t _queue_seq;
+
+static unsigned long _unknown, _invalid, _overflow;
+static uint64_t _prng_state;
+static FILE *_pcap;
+static int _sock;
+
+static volatile sig_atomic_t _quit;
+static volatile sig_atomic_t _dump;
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: zep_dispatch [-t <topology file>] [-l <loss %%>] "
+            "[-d <delay ms>]\n"
+            "                    [-j <jitter ms>] [-s <seed>] "
+            "[-w <pcap file>] <address> <port>\n");
+}
+
+/* xorshift64* */
+static uint32_t _rand(void)
+{
+    _prng_state ^= _prng_state >> 12;
+    _prng_state ^= _prng_state << 25;
+    _prng_state ^= _prng_state >> 27;
+    return (_prng_state * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+static uint64_t _now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * PPM + ts.tv_nsec / 1000;
+}
+
+static void _sig_handler(int sig)
+{
+    if (sig == SIGUSR1) {
+        _dump = 1;
+    }
+    else {
+        _quit = 1;
+    }
+}
+
+static const char *_addr_str(const struct sockaddr_in6 *addr)
+{
+    static char str[INET6_ADDRSTRLEN + 8];
+    char tmp[INET6_ADDRSTRLEN];
+
+    inet_ntop(AF_INET6, &addr->sin6_addr, tmp, sizeof(tmp));
+    snprintf(str, sizeof(str), "[%s]:%u", tmp, ntohs(addr->sin6_port));
+    return str;
+}
+
+static int _resolve(const char *addr, const char *port,
+                    struct sockaddr_in6 *res)
+{
+    struct addrinfo hint = { .ai_family = AF_INET6,
+                             .ai_socktype = SOCK_DGRAM,
+                             .ai_flags = AI_NUMERICHOST | AI_V4MAPPED };
+    struct addrinfo *ai;
+
+    if (getaddrinfo(addr, port, &hint, &ai) != 0) {
+        return -1;
+    }
+    memcpy(res, ai->ai_addr, sizeof(*res));
+    freeaddrinfo(ai);
+    return 0;
+}
+
+/* ------------------------------------------------------------------------ */
+/* topology                                                                 */
+/* ------------------------------------------------------------------------ */
+
+static int _node_by_name(const char *name, bool create)
+{
+    for (unsigned i = 0; i < _nodes_numof; i++) {
+        if (strcmp(_nodes[i].name, name) == 0) {
+            return i;
+        }
+    }
+    if (!create || (_nodes_numof >= NODES_MAX) || (strlen(name) >= NAME_LEN)) {
+        return -1;
+    }
+    strcpy(_nodes[_nodes_numof].name, name);
+    return _nodes_numof++;
+}
+
+static int _node_by_addr(const struct sockaddr_in6 *addr)
+{
+    for (unsigned i = 0; i < _nodes_numof; i++) {
+        if (_nodes[i].bound &&
+            (_nodes[i].addr.sin6_port == addr->sin6_port) &&
+            (memcmp(&_nodes[i].addr.sin6_addr, &addr->sin6_addr,
+                    sizeof(addr->sin6_addr)) == 0)) {
+            return i;
+        }
+    }
+    /* declared but unbound nodes are bound in the order senders appear */
+    for (unsigned i = 0; i < _nodes_numof; i++) {
+        if (!_nodes[i].bound) {
+            _nodes[i].addr = *addr;
+            _nodes[i].bound = true;
+            return i;
+        }
+    }
+    if (!_use_mesh || (_nodes_numof >= NODES_MAX)) {
+        return -1;
+    }
+    snprintf(_nodes[_nodes_numof].name, NAME_LEN, "%u", _nodes_numof);
+    _nodes[_nodes_numof].addr = *addr;
+    _nodes[_nodes_numof].bound = true;
+    return _nodes_numof++;
+}
+
+static int _parse_link_params(char **tok, unsigned numof, link_t *link)
+{
+    double loss = 0, delay = 0, jitter = 0;
+    char *end;
+
+    if (numof > 0) {
+        loss = strtod(tok[0], &end);
+        if ((*end != '\0') || (loss < 0) || (loss > 100)) {
+            return -1;
+        }
+    }
+    if (numof > 1) {
+        delay = strtod(tok[1], &end);
+        if ((*end != '\0') || (delay < 0)) {
+            return -1;
+        }
+    }
+    if (numof > 2) {
+        jitter = strtod(tok[2], &end);
+        if ((*end != '\0') || (jitter < 0)) {
+            return -1;
+        }
+    }
+    if (numof > 3) {
+        return -1;
+    }
+    link->up = true;
+    link->loss = loss * (PPM / 100);
+    link->delay = delay * US_PER_MS;
+    link->jitter = jitter * US_PER_MS;
+    return 0;
+}
+
+static int _parse_topology(const char *path)
+{
+    char line[LINE_MAX_LEN];
+    unsigned lineno = 0;
+    FILE *f = fopen(path, "r");
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    _use_mesh = false;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char *tok[8], *save, *t;
+        unsigned numof = 0;
+        int a, b;
+        bool both = true;
+        link_t link = { 0 };
+
+        lineno++;
+        if ((t = strchr(line, '#')) != NULL) {
+            *t = '\0';
+        }
+        for (t = strtok_r(line, " \t\r\n", &save); t && (numof < 8);
+             t = strtok_r(NULL, " \t\r\n", &save)) {
+            tok[numof++] = t;
+        }
+        if (numof == 0) {
+            continue;
+        }
+        if (strcmp(tok[0], "node") == 0) {
+            if ((numof != 4) || ((a = _node_by_name(tok[1], true)) < 0) ||
+                (_resolve(tok[2], tok[3], &_nodes[a].addr) < 0)) {
+                goto error;
+            }
+            _nodes[a].bound = true;
+            continue;
+        }
+        if ((numof >= 3) && (strcmp(tok[1], ">") == 0)) {
+            /* <a> > <b>: unidirectional link */
+            both = false;
+            tok[1] = tok[2];
+            memmove(&tok[2], &tok[3], (numof - 3) * sizeof(char *));
+            numof--;
+        }
+        if ((numof < 2) || ((a = _node_by_name(tok[0], true)) < 0) ||
+            ((b = _node_by_name(tok[1], true)) < 0) || (a == b) ||
+            (_parse_link_params(&tok[2], numof - 2, &link) < 0)) {
+            goto error;
+        }
+        _links[a][b] = link;
+        if (both) {
+            _links[b][a] = link;
+        }
+    }
+    fclose(f);
+    return 0;
+
+error:
+    fprintf(stderr, "%s:%u: invalid line\n", path, lineno);
+    fclose(f);
+    return -1;
+}
+
+static link_t *_link(unsigned src, unsigned dst)
+{
+    if (_use_mesh) {
+        /* lazily copy the mesh model so every pair keeps its own state */
+        if (!_links[src][dst].up) {
+            _links[src][dst] = _mesh;
+        }
+    }
+    return (_links[src][dst].up) ? &_links[src][dst] : NULL;
+}
+
+/* ------------------------------------------------------------------------ */
+/* delay queue                                                              */
+/* ------------------------------------------------------------------------ */
+
+static bool _before(const delayed_t *a, const delayed_t *b)
+{
+    return (a->due < b->due) || ((a->due == b->due) && (a->seq < b->seq));
+}
+
+static void _swap(unsigned a, unsigned b)
+{
+    delayed_t *tmp = _queue[a];
+
+    _queue[a] = _queue[b];
+    _queue[b] = tmp;
+}
+
+static int _queue_push(uint64_t due, unsigned dst, const uint8_t *data,
+                       unsigned len)
+{
+    delayed_t *entry;
+    unsigned i = _queue_len;
+
+    if ((_queue_len >= QUEUE_MAX) ||
+        ((entry = malloc(sizeof(*entry))) == NULL)) {
+        return -1;
+    }
+    entry->due = due;
+    entry->seq = _queue_seq++;
+    entry->dst = dst;
+    entry->len = len;
+    memcpy(entry->data, data, len);
+    _queue[_queue_len++] = entry;
+    while ((i > 0) && _before(_queue[i], _queue[(i - 1) / 2])) {
+        _swap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    return 0;
+}
+
+static delayed_t *_queue_pop(void)
+{
+    delayed_t *res = _queue[0];
+    unsigned i = 0;
+
+    _queue[0] = _queue[--_queue_len];
+    while (1) {
+        unsigned l = 2 * i + 1, r = l + 1, min = i;
+
+        if ((l < _queue_len) && _before(_queue[l], _queue[min])) {
+            min = l;
+        }
+        if ((r < _queue_len) && _before(_queue[r], _queue[min])) {
+            min = r;
+        }
+        if (min == i) {
+            break;
+        }
+        _swap(i, min);
+        i = min;
+    }
+    return res;
+}
+
+/* ------------------------------------------------------------------------ */
+/* frame handling                                                           */
+/* ------------------------------------------------------------------------ */
+
+static void _pcap_init(FILE *f)
+{
+    const uint32_t hdr[] = { 0xa1b2c3d4, 0x00040002, 0, 0, 0xffff,
+                             PCAP_LINKTYPE_IEEE802_15_4 };
+
+    fwrite(hdr, sizeof(hdr), 1, f);
+}
+
+static void _pcap_write(const uint8_t *data, unsigned len)
+{
+    unsigned hdr_len;
+    struct timeval tv;
+    uint32_t rec[4];
+
+    if (data[2] == 1) {
+        hdr_len = ZEP_V1_HDR_LEN;
+    }
+    else if ((data[2] == 2) && (len > 3) && (data[3] == ZEP_V2_TYPE_DATA)) {
+        hdr_len = ZEP_V2_HDR_LEN;
+    }
+    else {
+        return;     /* ZEPv2 ACKs carry no frame */
+    }
+    if (len < hdr_len) {
+        return;
+    }
+    len -= hdr_len;
+    if (data[hdr_len - 1] < len) {
+        len = data[hdr_len - 1];
+    }
+    gettimeofday(&tv, NULL);
+    rec[0] = tv.tv_sec;
+    rec[1] = tv.tv_usec;
+    rec[2] = len;
+    rec[3] = len;
+    fwrite(rec, sizeof(rec), 1, _pcap);
+    fwrite(data + hdr_len, len, 1, _pcap);
+}
+
+static void _send(unsigned dst, const uint8_t *data, unsigned len)
+{
+    if (sendto(_sock, data, len, 0, (struct sockaddr *)&_nodes[dst].addr,
+               sizeof(_nodes[dst].addr)) < 0) {
+        /* node may not be running (yet), that's like a node out of range */
+        return;
+    }
+    _nodes[dst].tx++;
+}
+
+static void _recv(uint64_t now)
+{
+    uint8_t buf[FRAME_MAX];
+    struct sockaddr_in6 addr;
+    socklen_t addr_len = sizeof(addr);
+    ssize_t len = recvfrom(_sock, buf, sizeof(buf), MSG_TRUNC,
+                           (struct sockaddr *)&addr, &addr_len);
+    int src;
+
+    if (len < 0) {
+        return;
+    }
+    if ((len < 3) || (len > (ssize_t)sizeof(buf)) ||
+        (buf[0] != 'E') || (buf[1] != 'X')) {
+        _invalid++;
+        return;
+    }
+    if ((src = _node_by_addr(&addr)) < 0) {
+        _unknown++;
+        return;
+    }
+    _nodes[src].rx++;
+    if (_pcap) {
+        _pcap_write(buf, len);
+    }
+    for (unsigned dst = 0; dst < _nodes_numof; dst++) {
+        link_t *link;
+        uint64_t due;
+
+        if ((dst == (unsigned)src) || !_nodes[dst].bound ||
+            ((link = _link(src, dst)) == NULL)) {
+            continue;
+        }
+        if ((link->loss > 0) && ((_rand() % PPM) < link->loss)) {
+            link->lost++;
+            continue;
+        }
+        due = now + link->delay;
+        if (link->jitter > 0) {
+            due += _rand() % (link->jitter + 1);
+        }
+        if (due < link->last_due) {
+            due = link->last_due;
+        }
+        link->last_due = due;
+        link->fwd++;
+        if ((due <= now) && (_queue_len == 0)) {
+            _send(dst, buf, len);
+        }
+        else if (_queue_push(due, dst, buf, len) < 0) {
+            _overflow++;
+        }
+    }
+}
+
+static void _print_stats(void)
+{
+    printf("%-16s %-32s %10s %10s\n", "node", "address", "rx", "tx");
+    for (unsigned i = 0; i < _nodes_numof; i++) {
+        printf("%-16s %-32s %10lu %10lu\n", _nodes[i].name,
+               (_nodes[i].bound) ? _addr_str(&_nodes[i].addr) : "-",
+               _nodes[i].rx, _nodes[i].tx);
+    }
+    printf("\n%-34s %10s %10s\n", "link", "fwd", "lost");
+    for (unsigned i = 0; i < _nodes_numof; i++) {
+        for (unsigned j = 0; j < _nodes_numof; j++) {
+            if (_links[i][j].up && (_links[i][j].fwd || _links[i][j].lost)) {
+                printf("%-16s > %-16s %10lu %10lu\n", _nodes[i].name,
+                       _nodes[j].name, _links[i][j].fwd, _links[i][j].lost);
+            }
+        }
+    }
+    printf("\ninvalid: %lu, unknown sender: %lu, queue overflow: %lu\n",
+           _invalid, _unknown, _overflow);
+    fflush(stdout);
+    if (_pcap) {
+        fflush(_pcap);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    struct sockaddr_in6 local;
+    struct sigaction sa = { .sa_handler = _sig_handler };
+    unsigned long seed = 1;
+    char *tok[3] = { "0", "0", "0" };
+    int c;
+
+    while ((c = getopt(argc, argv, "t:l:d:j:s:w:h")) != -1) {
+        switch (c) {
+            case 't':
+                if (_parse_topology(optarg) < 0) {
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'l':
+                tok[0] = optarg;
+                break;
+            case 'd':
+                tok[1] = optarg;
+                break;
+            case 'j':
+                tok[2] = optarg;
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                if ((_pcap = fopen(optarg, "wb")) == NULL) {
+                    perror(optarg);
+                    return EXIT_FAILURE;
+                }
+                _pcap_init(_pcap);
+                break;
+            default:
+                usage();
+                return EXIT_FAILURE;
+        }
+    }
+    if ((argc - optind) != 2) {
+        usage();
+        return EXIT_FAILURE;
+    }
+    if (_parse_link_params(tok, 3, &_mesh) < 0) {
+        fprintf(stderr, "invalid link parameters\n");
+        return EXIT_FAILURE;
+    }
+    /* the state must never be 0 for xorshift */
+    _prng_state = ((uint64_t)seed << 1) | 1;
+    if (_resolve(argv[optind], argv[optind + 1], &local) < 0) {
+        fprintf(stderr, "invalid address %s %s\n", argv[optind],
+                argv[optind + 1]);
+        return EXIT_FAILURE;
+    }
+    if (((_sock = socket(AF_INET6, SOCK_DGRAM, 0)) < 0) ||
+        (bind(_sock, (struct sockaddr *)&local, sizeof(local)) < 0)) {
+        perror("zep_dispatch");
+        return EXIT_FAILURE;
+    }
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+    fprintf(stderr, "listening on %s\n", _addr_str(&local));
+
+    while (!_quit) {
+        struct pollfd pfd = { .fd = _sock, .events = POLLIN };
+        struct timespec timeout, *tp = NULL;
+        uint64_t now = _now();
+
+        while ((_queue_len > 0) && (_queue[0]->due <= now)) {
+            delayed_t *entry = _queue_pop();
+
+            _send(entry->dst, entry->data, entry->len);
+            free(entry);
+        }
+        if (_queue_len > 0) {
+            uint64_t wait = _queue[0]->due - now;
+
+            timeout.tv_sec = wait / PPM;
+            timeout.tv_nsec = (wait % PPM) * 1000;
+            tp = &timeout;
+        }
+        if (ppoll(&pfd, 1, tp, NULL) < 0) {
+            if (errno != EINTR) {
+                perror("ppoll");
+                break;
+            }
+        }
+        else if (pfd.revents & POLLIN) {
+            _recv(_now());
+        }
+        if (_dump) {
+            _dump = 0;
+            _print_stats();
+        }
+    }
+    _print_stats();
+    if (_pcap) {
+        fclose(_pcap);
+    }
+    close(_sock);
+    return EXIT_SUCCESS;
+}
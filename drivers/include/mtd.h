@@ -27,6 +27,9 @@
 #if MODULE_VFS
 #include "vfs.h"
 #endif
+#if MODULE_MTD_ASYNC
+#include "event.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -52,6 +55,11 @@ enum mtd_power_state {
  */
 typedef struct mtd_desc mtd_desc_t;
 
+/**
+ * @brief   Asynchronous MTD request, see mtd_submit()
+ */
+typedef struct mtd_req mtd_req_t;
+
 /**
  * @brief   MTD device descriptor
  */
@@ -60,8 +68,55 @@ typedef struct {
     uint32_t sector_count;     /**< Number of sector in the MTD */
     uint32_t pages_per_sector; /**< Number of pages by sector in the MTD */
     uint32_t page_size;        /**< Size of the pages in the MTD */
+#if defined(MODULE_MTD_ASYNC) || defined(DOXYGEN)
+    mtd_req_t *queue;          /**< Pending asynchronous requests */
+#endif
 } mtd_dev_t;
 
+#if defined(MODULE_MTD_ASYNC) || defined(DOXYGEN)
+/**
+ * @brief   Operations of asynchronous MTD requests
+ */
+typedef enum {
+    MTD_REQ_READ,       /**< mtd_read() */
+    MTD_REQ_WRITE,      /**< mtd_write() */
+    MTD_REQ_ERASE,      /**< mtd_erase() */
+} mtd_req_op_t;
+
+/**
+ * @brief   Callback for a completed asynchronous MTD request
+ *
+ * Called in the context of the mtd_async thread. The request may be
+ * submitted again from the callback.
+ *
+ * @param[in] req       The request, with mtd_req_t::res set.
+ */
+typedef void (*mtd_req_cb_t)(mtd_req_t *req);
+
+/**
+ * @brief   Asynchronous MTD request
+ *
+ * The request must not be modified while it is pending.
+ */
+struct mtd_req {
+    event_t event;          /**< Event of the mtd_async thread, private */
+    mtd_req_t *next;        /**< Next request for the device, private */
+    mtd_req_t *next_wait;   /**< Next request waiting for its device,
+                                 private */
+    uint32_t wake;          /**< Time to call the driver again, private */
+    mtd_dev_t *dev;         /**< Device of the request, private */
+    mtd_req_op_t op;        /**< Operation */
+    void *buf;              /**< Data to write, or buffer to read into */
+    uint32_t addr;          /**< Start address */
+    uint32_t size;          /**< Number of bytes */
+    uint32_t done;          /**< Progress, for the driver */
+    uint8_t state;          /**< State, for the driver, 0 on start */
+    int res;                /**< Result, as of the blocking function */
+    mtd_req_cb_t cb;        /**< Completion callback, may be NULL */
+    void *arg;              /**< Application context, for @p cb */
+};
+#endif
+
 /**
  * @brief   MTD driver interface
  *
@@ -146,6 +201,24 @@ struct mtd_desc {
      * @return < 0 value on error
      */
     int (*power)(mtd_dev_t *dev, enum mtd_power_state power);
+
+#if defined(MODULE_MTD_ASYNC) || defined(DOXYGEN)
+    /**
+     * @brief   Runs an asynchronous request, optional
+     *
+     * Called in the context of the mtd_async thread, first with
+     * mtd_req_t::state set to 0, then again after each delay returned, so
+     * the device can be polled without blocking the thread. Without this
+     * function, requests are run with the blocking functions.
+     *
+     * @param[in] dev       Pointer to the selected driver
+     * @param[in,out] req   The request
+     *
+     * @return 0, when the request is complete and mtd_req_t::res is set
+     * @return delay in microseconds, to be called again
+     */
+    uint32_t (*async)(mtd_dev_t *dev, mtd_req_t *req);
+#endif
 };
 
 /**
@@ -229,6 +302,52 @@ int mtd_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t count);
  */
 int mtd_power(mtd_dev_t *mtd, enum mtd_power_state power);
 
+#if defined(MODULE_MTD_ASYNC) || defined(DOXYGEN)
+/**
+ * @brief   Stack size of the mtd_async thread
+ */
+#ifndef MTD_ASYNC_STACKSIZE
+#define MTD_ASYNC_STACKSIZE     (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief   Priority of the mtd_async thread
+ */
+#ifndef MTD_ASYNC_PRIO
+#define MTD_ASYNC_PRIO          (THREAD_PRIORITY_MAIN - 1)
+#endif
+
+/**
+ * @brief   Submits an asynchronous request to a MTD device
+ *
+ * Returns immediately. The requests of a device are run one after the other
+ * in the order they were submitted, by the mtd_async thread, and
+ * mtd_req_t::cb is called after each. While a driver waits for the device,
+ * e.g. for an erase to complete, the thread serves other devices and the
+ * caller can continue.
+ *
+ * Set mtd_req_t::op, mtd_req_t::buf, mtd_req_t::addr, mtd_req_t::size and
+ * mtd_req_t::cb before. The same constraints as for mtd_read(), mtd_write()
+ * and mtd_erase() apply.
+ *
+ * May be called from interrupt context.
+ *
+ * @param      mtd   the device
+ * @param[in]  req   the request, must stay valid until completion
+ *
+ * @return 0, if the request was queued
+ * @return -ENODEV if @p mtd is not a valid device
+ */
+int mtd_submit(mtd_dev_t *mtd, mtd_req_t *req);
+
+/**
+ * @brief   Starts the mtd_async thread
+ *
+ * Called by auto_init.
+ */
+void mtd_async_init(void);
+#endif
+
 #if defined(MODULE_VFS) || defined(DOXYGEN)
 /**
  * @brief   MTD driver for VFS
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_cache Write-back cache for mtd devices
+ * @ingroup     drivers_mtd
+ * @brief       MTD device that caches another MTD device in RAM
+ *
+ * The cache is itself an MTD device and can be used by any file system in
+ * place of the device it caches. It keeps @ref MTD_CACHE_LINES lines of
+ * @ref MTD_CACHE_LINE_SIZE bytes each; the least recently used line is
+ * evicted when a new one is needed.
+ *
+ * - Reads are served from the cache. A miss loads the whole line, so
+ *   small reads of metadata cost one transfer per line. When reads are
+ *   sequential, up to @ref MTD_CACHE_READAHEAD following lines are loaded
+ *   with the same transfer. Reads of whole lines that are not cached bypass
+ *   the cache.
+ * - Writes only update the cache. Dirty lines are written back when they are
+ *   evicted, on mtd_cache_flush() and before powering the device down.
+ * - Erasing a sector discards the cached lines in it, including unwritten
+ *   data.
+ *
+ * Data that was not flushed is lost on a reset, so file systems that depend
+ * on the order of writes for consistency need to flush at their sync points.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for the mtd cache
+ */
+
+#ifndef MTD_CACHE_H
+#define MTD_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief   Number of cache lines
+ */
+#ifndef MTD_CACHE_LINES
+#define MTD_CACHE_LINES         (4U)
+#endif
+
+/**
+ * @brief   Size of a cache line in bytes
+ *
+ * Must be a multiple of the page size and a divisor of the sector size of
+ * the cached device.
+ */
+#ifndef MTD_CACHE_LINE_SIZE
+#define MTD_CACHE_LINE_SIZE     (256U)
+#endif
+
+/**
+ * @brief   Number of lines read ahead on sequential reads
+ *
+ * Must be smaller than @ref MTD_CACHE_LINES.
+ */
+#ifndef MTD_CACHE_READAHEAD
+#define MTD_CACHE_READAHEAD     (1U)
+#endif
+
+/**
+ * @brief   State of a cache line
+ */
+typedef struct {
+    uint32_t addr;              /**< device address of the line */
+    uint32_t last_use;          /**< time of the last access, for LRU */
+    uint16_t dirty_start;       /**< start of the unwritten data */
+    uint16_t dirty_end;         /**< end of the unwritten data, 0 if clean */
+    bool valid;                 /**< line holds data */
+} mtd_cache_line_t;
+
+/**
+ * @brief   Device descriptor for the mtd cache
+ *
+ * This is an extension of the @c mtd_dev_t struct. Only @p mtd and
+ * @p overwrite need to be set, the geometry is copied from the cached device
+ * by mtd_init().
+ */
+typedef struct {
+    mtd_dev_t base;             /**< inherit from mtd_dev_t object */
+    mtd_dev_t *mtd;             /**< cached device */
+    bool overwrite;             /**< writes to the cached device overwrite
+                                     data, instead of clearing bits like on
+                                     flash */
+    mutex_t lock;               /**< protects the cache */
+    uint32_t tick;              /**< access counter, for LRU */
+    uint32_t next_addr;         /**< end of the last read */
+    mtd_cache_line_t lines[MTD_CACHE_LINES];            /**< line states */
+    uint8_t data[MTD_CACHE_LINES][MTD_CACHE_LINE_SIZE]; /**< line data */
+} mtd_cache_t;
+
+/**
+ * @brief   mtd cache operations table
+ */
+extern const mtd_desc_t mtd_cache_driver;
+
+/**
+ * @brief   Writes all dirty lines back to the cached device
+ *
+ * @param[in] dev   The cache.
+ *
+ * @return  0 on success
+ * @return  < 0 on error of the cached device
+ */
+int mtd_cache_flush(mtd_cache_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_CACHE_H */
+/** @} */
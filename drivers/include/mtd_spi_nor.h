@@ -12,6 +12,18 @@
  * @ingroup     drivers_storage
  * @brief       Driver for serial NOR flash memory technology devices attached via SPI
  *
+ * Reads are done with a single command for the whole range, with the
+ * `read_fast` opcode if @ref SPI_NOR_F_FAST_READ is set. Writes may span
+ * several pages; they are programmed page by page while the bus is held.
+ * Erases use the largest erase unit (chip, 64 KiB, 32 KiB, 4 KiB, sector)
+ * that fits the remaining range and that the device supports.
+ *
+ * With the `mtd_spi_nor_sfdp` module, mtd_init() reads the Serial Flash
+ * Discoverable Parameters (JESD216) of the device. If present, they replace
+ * the configured page size, sector size, sector count, the erase opcodes
+ * and the erase flags, so the same configuration works for different chips.
+ * Devices without SFDP keep the configured values.
+ *
  * @{
  *
  * @file
@@ -24,6 +36,7 @@
 #ifndef MTD_SPI_NOR_H
 #define MTD_SPI_NOR_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "periph_conf.h"
@@ -82,6 +95,29 @@ typedef struct __attribute__((packed)) {
  * @brief   Flag to set when the device support 32KiB block erase (block_erase_32k opcode)
  */
 #define SPI_NOR_F_SECT_32K  (2)
+/**
+ * @brief   Flag to set when the device support 64KiB block erase (block_erase opcode)
+ */
+#define SPI_NOR_F_SECT_64K  (4)
+/**
+ * @brief   Flag to set to read with the read_fast opcode
+ *
+ * The opcode is followed by a dummy byte. Most devices allow a higher clock
+ * for fast reads than for plain reads.
+ */
+#define SPI_NOR_F_FAST_READ (8)
+/**
+ * @brief   Flag set by SFDP detection if the device supports dual I/O reads
+ *
+ * Informational only, periph_spi transfers on a single data line.
+ */
+#define SPI_NOR_F_READ_DUAL (16)
+/**
+ * @brief   Flag set by SFDP detection if the device supports quad I/O reads
+ *
+ * Informational only, periph_spi transfers on a single data line.
+ */
+#define SPI_NOR_F_READ_QUAD (32)
 
 /**
  * @brief   Device descriptor for serial flash memory devices
@@ -110,6 +146,22 @@ typedef struct {
      */
     uint32_t sec_addr_mask;
     uint8_t addr_width;      /**< Number of bytes in addresses, usually 3 for small devices */
+#if defined(MODULE_MTD_ASYNC) || defined(DOXYGEN)
+    /**
+     * @brief   an asynchronous request started a program or erase
+     *
+     * Managed by the driver, no need to touch outside the driver.
+     */
+    bool busy;
+#endif
+#if defined(MODULE_MTD_SPI_NOR_SFDP) || defined(DOXYGEN)
+    /**
+     * @brief   opcode table with the erase opcodes detected by SFDP
+     *
+     * Filled by mtd_spi_nor_init, no need to touch outside the driver.
+     */
+    mtd_spi_nor_opcode_t sfdp_opcode;
+#endif
     /**
      * @brief   number of right shifts to get the address to the start of the page
      *
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#if MODULE_MTD_ASYNC
+
+/**
+ * @ingroup     drivers_mtd
+ * @{
+ *
+ * @file
+ * @brief       Asynchronous MTD requests
+ *
+ * All requests are run by a single thread. Each device has a queue of
+ * requests, of which only the first one is active. Drivers that implement
+ * mtd_desc_t::async return a delay instead of waiting for the device, so the
+ * thread can serve the other devices meanwhile. Requests that wait are kept
+ * in a list sorted by the time they are due, the thread sleeps until the
+ * first of them is due or a new request is submitted.
+ *
+ * @}
+ */
+
+#include <errno.h>
+
+#include "irq.h"
+#include "kernel_defines.h"
+#include "mtd.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+static event_queue_t _queue;
+static char _stack[MTD_ASYNC_STACKSIZE];
+
+/* only accessed by the mtd_async thread */
+static mtd_req_t *_waiting;
+
+static void _wait(mtd_req_t *req, uint32_t delay)
+{
+    req->wake = xtimer_now_usec() + delay;
+
+    mtd_req_t **pos = &_waiting;
+    while (*pos && ((int32_t)((*pos)->wake - req->wake) <= 0)) {
+        pos = &(*pos)->next_wait;
+    }
+    req->next_wait = *pos;
+    *pos = req;
+}
+
+static int _run_blocking(mtd_dev_t *mtd, mtd_req_t *req)
+{
+    switch (req->op) {
+        case MTD_REQ_READ:
+            return mtd_read(mtd, req->buf, req->addr, req->size);
+        case MTD_REQ_WRITE:
+            return mtd_write(mtd, req->buf, req->addr, req->size);
+        case MTD_REQ_ERASE:
+            return mtd_erase(mtd, req->addr, req->size);
+    }
+    return -EINVAL;
+}
+
+static void _run(mtd_req_t *req)
+{
+    mtd_dev_t *mtd = req->dev;
+
+    if (mtd->driver->async) {
+        uint32_t delay = mtd->driver->async(mtd, req);
+        if (delay > 0) {
+            _wait(req, delay);
+            return;
+        }
+    }
+    else {
+        req->res = _run_blocking(mtd, req);
+    }
+    DEBUG("mtd_async: %p done: %d\n", (void *)req, req->res);
+
+    unsigned state = irq_disable();
+    mtd_req_t *next = req->next;
+    mtd->queue = next;
+    irq_restore(state);
+
+    if (next) {
+        event_post(&_queue, &next->event);
+    }
+    if (req->cb) {
+        req->cb(req);
+    }
+}
+
+static void _handler(event_t *event)
+{
+    _run(container_of(event, mtd_req_t, event));
+}
+
+static void *_thread(void *arg)
+{
+    (void)arg;
+
+    event_queue_claim(&_queue);
+    while (1) {
+        event_t *event;
+        if (_waiting) {
+            int32_t delay = _waiting->wake - xtimer_now_usec();
+            event = (delay > 0) ? event_wait_timeout(&_queue, delay)
+                                : event_get(&_queue);
+        }
+        else {
+            event = event_wait(&_queue);
+        }
+        if (event) {
+            event->handler(event);
+        }
+
+        while (_waiting && ((int32_t)(_waiting->wake - xtimer_now_usec()) <= 0)) {
+            mtd_req_t *req = _waiting;
+            _waiting = req->next_wait;
+            _run(req);
+        }
+    }
+
+    return NULL;
+}
+
+int mtd_submit(mtd_dev_t *mtd, mtd_req_t *req)
+{
+    if (!mtd || !mtd->driver) {
+        return -ENODEV;
+    }
+
+    req->event.handler  = _handler;
+    req->event.list_node.next = NULL;
+    req->next  = NULL;
+    req->dev   = mtd;
+    req->done  = 0;
+    req->state = 0;
+    req->res   = 0;
+
+    unsigned state = irq_disable();
+    mtd_req_t **tail = &mtd->queue;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    *tail = req;
+    irq_restore(state);
+
+    if (tail == &mtd->queue) {
+        /* the device was idle */
+        event_post(&_queue, &req->event);
+    }
+    return 0;
+}
+
+void mtd_async_init(void)
+{
+    event_queue_init_detached(&_queue);
+    thread_create(_stack, sizeof(_stack), MTD_ASYNC_PRIO,
+                  THREAD_CREATE_STACKTEST, _thread, NULL, "mtd_async");
+}
+
+#else
+typedef int dont_be_pedantic;
+#endif /* MODULE_MTD_ASYNC */
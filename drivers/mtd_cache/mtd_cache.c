@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_cache
+ * @{
+ *
+ * @file
+ * @brief       Write-back cache for mtd devices
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "mtd.h"
+#include "mtd_cache.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#if MTD_CACHE_READAHEAD >= MTD_CACHE_LINES
+#error "mtd_cache: MTD_CACHE_READAHEAD must be smaller than MTD_CACHE_LINES"
+#endif
+
+#if MTD_CACHE_LINE_SIZE > UINT16_MAX
+#error "mtd_cache: MTD_CACHE_LINE_SIZE is too large"
+#endif
+
+static int mtd_cache_init(mtd_dev_t *mtd);
+static int mtd_cache_read(mtd_dev_t *mtd, void *dest, uint32_t addr,
+                          uint32_t size);
+static int mtd_cache_write(mtd_dev_t *mtd, const void *src, uint32_t addr,
+                           uint32_t size);
+static int mtd_cache_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size);
+static int mtd_cache_power(mtd_dev_t *mtd, enum mtd_power_state power);
+
+const mtd_desc_t mtd_cache_driver = {
+    .init = mtd_cache_init,
+    .read = mtd_cache_read,
+    .write = mtd_cache_write,
+    .erase = mtd_cache_erase,
+    .power = mtd_cache_power,
+};
+
+static uint32_t _size(mtd_cache_t *dev)
+{
+    return dev->base.sector_count * dev->base.pages_per_sector
+           * dev->base.page_size;
+}
+
+static uint8_t *_data(mtd_cache_t *dev, mtd_cache_line_t *line)
+{
+    return dev->data[line - dev->lines];
+}
+
+/* Accesses since the last use; invalid lines are the oldest */
+static uint32_t _age(mtd_cache_t *dev, mtd_cache_line_t *line)
+{
+    return line->valid ? dev->tick - line->last_use : UINT32_MAX;
+}
+
+static mtd_cache_line_t *_find(mtd_cache_t *dev, uint32_t addr)
+{
+    for (unsigned i = 0; i < MTD_CACHE_LINES; i++) {
+        if (dev->lines[i].valid && (dev->lines[i].addr == addr)) {
+            return &dev->lines[i];
+        }
+    }
+    return NULL;
+}
+
+/* Writes the dirty part of a line back page by page */
+static int _flush_line(mtd_cache_t *dev, mtd_cache_line_t *line)
+{
+    uint8_t *data = _data(dev, line);
+
+    while (line->dirty_start < line->dirty_end) {
+        unsigned pos = line->dirty_start;
+        unsigned len = dev->base.page_size - (pos % dev->base.page_size);
+        if (len > (unsigned)(line->dirty_end - pos)) {
+            len = line->dirty_end - pos;
+        }
+
+        int res = mtd_write(dev->mtd, &data[pos], line->addr + pos, len);
+        if (res < 0) {
+            DEBUG("mtd_cache: write back of 0x%" PRIx32 " failed: %d\n",
+                  line->addr + pos, res);
+            return res;
+        }
+        line->dirty_start += len;
+    }
+    line->dirty_start = 0;
+    line->dirty_end   = 0;
+    return 0;
+}
+
+/*
+ * Loads the line at addr, and up to n - 1 following lines that are not
+ * cached, into consecutive slots with a single read.
+ */
+static int _fetch(mtd_cache_t *dev, uint32_t addr, unsigned n,
+                  mtd_cache_line_t **line)
+{
+    unsigned num = 1;
+    while ((num < n) && ((addr + num * MTD_CACHE_LINE_SIZE) < _size(dev))
+           && !_find(dev, addr + num * MTD_CACHE_LINE_SIZE)) {
+        num++;
+    }
+
+    /* use the slots whose most recently used line is the oldest */
+    unsigned start = 0;
+    uint32_t start_age = 0;
+    for (unsigned s = 0; (s + num) <= MTD_CACHE_LINES; s++) {
+        uint32_t age = UINT32_MAX;
+        for (unsigned i = s; i < (s + num); i++) {
+            uint32_t line_age = _age(dev, &dev->lines[i]);
+            if (line_age < age) {
+                age = line_age;
+            }
+        }
+        if ((s == 0) || (age > start_age)) {
+            start     = s;
+            start_age = age;
+        }
+    }
+
+    for (unsigned i = start; i < (start + num); i++) {
+        int res = _flush_line(dev, &dev->lines[i]);
+        if (res < 0) {
+            return res;
+        }
+        dev->lines[i].valid = false;
+    }
+
+    DEBUG("mtd_cache: load 0x%" PRIx32 " (%u lines)\n", addr, num);
+    int res = mtd_read(dev->mtd, dev->data[start], addr,
+                       num * MTD_CACHE_LINE_SIZE);
+    if (res < 0) {
+        return res;
+    }
+    for (unsigned i = 0; i < num; i++) {
+        mtd_cache_line_t *l = &dev->lines[start + i];
+        l->addr     = addr + i * MTD_CACHE_LINE_SIZE;
+        l->last_use = dev->tick;
+        l->valid    = true;
+    }
+    *line = &dev->lines[start];
+    return 0;
+}
+
+static int _flush(mtd_cache_t *dev)
+{
+    for (unsigned i = 0; i < MTD_CACHE_LINES; i++) {
+        int res = _flush_line(dev, &dev->lines[i]);
+        if (res < 0) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+static int mtd_cache_init(mtd_dev_t *mtd)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+
+    if (dev->mtd == NULL) {
+        return -ENODEV;
+    }
+    int res = mtd_init(dev->mtd);
+    if (res < 0) {
+        return res;
+    }
+
+    uint32_t sector_size = dev->mtd->pages_per_sector * dev->mtd->page_size;
+    if (((MTD_CACHE_LINE_SIZE % dev->mtd->page_size) != 0)
+            || ((sector_size % MTD_CACHE_LINE_SIZE) != 0)) {
+        DEBUG("mtd_cache: line size does not match the device\n");
+        return -EINVAL;
+    }
+
+    /* init is also called on every mount, so keep the cached lines */
+    mutex_lock(&dev->lock);
+    mtd->sector_count     = dev->mtd->sector_count;
+    mtd->pages_per_sector = dev->mtd->pages_per_sector;
+    mtd->page_size        = dev->mtd->page_size;
+    res = _flush(dev);
+    mutex_unlock(&dev->lock);
+
+    return res;
+}
+
+static int mtd_cache_read(mtd_dev_t *mtd, void *dest, uint32_t addr,
+                          uint32_t size)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+    uint8_t *dst = dest;
+    uint32_t end = addr + size;
+    int res = size;
+
+    if ((addr > _size(dev)) || (size > (_size(dev) - addr))) {
+        return -EOVERFLOW;
+    }
+
+    mutex_lock(&dev->lock);
+    bool sequential = (addr == dev->next_addr);
+    while (addr < end) {
+        uint32_t line_addr = addr - (addr % MTD_CACHE_LINE_SIZE);
+        uint32_t off = addr - line_addr;
+        uint32_t len = MTD_CACHE_LINE_SIZE - off;
+        if (len > (end - addr)) {
+            len = end - addr;
+        }
+
+        mtd_cache_line_t *line = _find(dev, line_addr);
+        if ((line == NULL) && (len == MTD_CACHE_LINE_SIZE)) {
+            /* read whole lines that are not cached directly */
+            while (((end - addr - len) >= MTD_CACHE_LINE_SIZE)
+                   && !_find(dev, addr + len)) {
+                len += MTD_CACHE_LINE_SIZE;
+            }
+            res = mtd_read(dev->mtd, dst, addr, len);
+            if (res < 0) {
+                break;
+            }
+        }
+        else {
+            if (line == NULL) {
+                res = _fetch(dev, line_addr,
+                             sequential ? (1 + MTD_CACHE_READAHEAD) : 1,
+                             &line);
+                if (res < 0) {
+                    break;
+                }
+            }
+            line->last_use = ++dev->tick;
+            memcpy(dst, &_data(dev, line)[off], len);
+        }
+        addr += len;
+        dst  += len;
+    }
+    if (res >= 0) {
+        dev->next_addr = end;
+        res = size;
+    }
+    mutex_unlock(&dev->lock);
+
+    return res;
+}
+
+static int mtd_cache_write(mtd_dev_t *mtd, const void *src, uint32_t addr,
+                           uint32_t size)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+    const uint8_t *data = src;
+
+    if ((addr > _size(dev)) || (size > (_size(dev) - addr))) {
+        return -EOVERFLOW;
+    }
+    if (((addr % mtd->page_size) + size) > mtd->page_size) {
+        return -EOVERFLOW;
+    }
+
+    mutex_lock(&dev->lock);
+    uint32_t line_addr = addr - (addr % MTD_CACHE_LINE_SIZE);
+    mtd_cache_line_t *line = _find(dev, line_addr);
+    if (line == NULL) {
+        int res = _fetch(dev, line_addr, 1, &line);
+        if (res < 0) {
+            mutex_unlock(&dev->lock);
+            return res;
+        }
+    }
+
+    unsigned off = addr - line_addr;
+    uint8_t *dst = &_data(dev, line)[off];
+    if (dev->overwrite) {
+        memcpy(dst, data, size);
+    }
+    else {
+        /* keep the cached data equal to what the flash will contain */
+        for (uint32_t i = 0; i < size; i++) {
+            dst[i] &= data[i];
+        }
+    }
+
+    if (line->dirty_end == 0) {
+        line->dirty_start = off;
+        line->dirty_end   = off + size;
+    }
+    else {
+        if (off < line->dirty_start) {
+            line->dirty_start = off;
+        }
+        if ((off + size) > line->dirty_end) {
+            line->dirty_end = off + size;
+        }
+    }
+    line->last_use = ++dev->tick;
+    mutex_unlock(&dev->lock);
+
+    return size;
+}
+
+static int mtd_cache_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+    uint32_t sector_size = mtd->pages_per_sector * mtd->page_size;
+
+    if ((addr > _size(dev)) || (size > (_size(dev) - addr))) {
+        return -EOVERFLOW;
+    }
+    if (((addr % sector_size) != 0) || ((size % sector_size) != 0)) {
+        return -EOVERFLOW;
+    }
+
+    mutex_lock(&dev->lock);
+    for (unsigned i = 0; i < MTD_CACHE_LINES; i++) {
+        mtd_cache_line_t *line = &dev->lines[i];
+        if ((line->addr >= addr) && ((line->addr - addr) < size)) {
+            line->valid       = false;
+            line->dirty_start = 0;
+            line->dirty_end   = 0;
+        }
+    }
+    int res = mtd_erase(dev->mtd, addr, size);
+    mutex_unlock(&dev->lock);
+
+    return res;
+}
+
+static int mtd_cache_power(mtd_dev_t *mtd, enum mtd_power_state power)
+{
+    mtd_cache_t *dev = (mtd_cache_t *)mtd;
+
+    if (power == MTD_POWER_DOWN) {
+        int res = mtd_cache_flush(dev);
+        if (res < 0) {
+            return res;
+        }
+    }
+    return mtd_power(dev->mtd, power);
+}
+
+int mtd_cache_flush(mtd_cache_t *dev)
+{
+    mutex_lock(&dev->lock);
+    int res = _flush(dev);
+    mutex_unlock(&dev->lock);
+
+    return res;
+}
@@ -25,9 +25,9 @@
 #include <errno.h>
 
 #include "mtd.h"
+#include "timex.h"
 #if MODULE_XTIMER
 #include "xtimer.h"
-#include "timex.h"
 #else
 #include "thread.h"
 #endif
@@ -48,6 +48,16 @@
 #define MTD_SPI_NOR_WRITE_WAIT_US (50 * US_PER_MS)
 #endif
 
+#ifndef MTD_SPI_NOR_PROGRAM_POLL_US
+#define MTD_SPI_NOR_PROGRAM_POLL_US (100U)
+#endif
+
+#define SFDP_OPCODE         (0x5a)
+#define SFDP_SIGNATURE      (0x50444653)    /* "SFDP" */
+#define SFDP_BFPT_DWORDS    (11)            /* DWORDs of the BFPT that are used */
+
+#define MTD_64K             (65536ul)
+#define MTD_64K_ADDR_MASK   (0xFFFF)
 #define MTD_32K             (32768ul)
 #define MTD_32K_ADDR_MASK   (0x7FFF)
 #define MTD_4K              (4096ul)
@@ -58,6 +68,9 @@ static int mtd_spi_nor_read(mtd_dev_t *mtd, void *dest, uint32_t addr, uint32_t
 static int mtd_spi_nor_write(mtd_dev_t *mtd, const void *src, uint32_t addr, uint32_t size);
 static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size);
 static int mtd_spi_nor_power(mtd_dev_t *mtd, enum mtd_power_state power);
+#ifdef MODULE_MTD_ASYNC
+static uint32_t mtd_spi_nor_async(mtd_dev_t *mtd, mtd_req_t *req);
+#endif
 
 const mtd_desc_t mtd_spi_nor_driver = {
     .init = mtd_spi_nor_init,
@@ -65,6 +78,9 @@ const mtd_desc_t mtd_spi_nor_driver = {
     .write = mtd_spi_nor_write,
     .erase = mtd_spi_nor_erase,
     .power = mtd_spi_nor_power,
+#ifdef MODULE_MTD_ASYNC
+    .async = mtd_spi_nor_async,
+#endif
 };
 
 /**
@@ -74,11 +90,13 @@ const mtd_desc_t mtd_spi_nor_driver = {
  * @param[in]  dev    pointer to device descriptor
  * @param[in]  opcode command opcode
  * @param[in]  addr   address (big endian)
+ * @param[in]  dummy  number of dummy bytes to send after the address
  * @param[out] dest   read buffer
  * @param[in]  count  number of bytes to read after the address has been sent
  */
 static void mtd_spi_cmd_addr_read(const mtd_spi_nor_t *dev, uint8_t opcode,
-                                  be_uint32_t addr, void *dest, uint32_t count)
+                                  be_uint32_t addr, uint8_t dummy,
+                                  void *dest, uint32_t count)
 {
     TRACE("mtd_spi_cmd_addr_read: %p, %02x, (%02x %02x %02x %02x), %p, %" PRIu32 "\n",
           (void *)dev, (unsigned int)opcode, addr.u8[0], addr.u8[1], addr.u8[2],
@@ -97,6 +115,9 @@ static void mtd_spi_cmd_addr_read(const mtd_spi_nor_t *dev, uint8_t opcode,
         /* Send opcode followed by address */
         spi_transfer_byte(dev->spi, dev->cs, true, opcode);
         spi_transfer_bytes(dev->spi, dev->cs, true, (char *)addr_buf, NULL, dev->addr_width);
+        while (dummy--) {
+            spi_transfer_byte(dev->spi, dev->cs, true, 0);
+        }
 
         /* Read data */
         spi_transfer_bytes(dev->spi, dev->cs, false, NULL, dest, count);
@@ -256,7 +277,7 @@ static int mtd_spi_read_jedec_id(const mtd_spi_nor_t *dev, mtd_jedec_id_t *out)
     return status;
 }
 
-static inline void wait_for_write_complete(const mtd_spi_nor_t *dev)
+static inline void wait_for_write_complete(const mtd_spi_nor_t *dev, uint32_t poll_us)
 {
     do {
         uint8_t status;
@@ -267,13 +288,146 @@ static inline void wait_for_write_complete(const mtd_spi_nor_t *dev)
             break;
         }
 #if MODULE_XTIMER
-        xtimer_usleep(MTD_SPI_NOR_WRITE_WAIT_US);
+        xtimer_usleep(poll_us);
 #else
+        (void)poll_us;
         thread_yield();
 #endif
     } while (1);
 }
 
+/* waits for a program or erase started by an asynchronous request */
+static inline void wait_for_async(const mtd_spi_nor_t *dev)
+{
+#ifdef MODULE_MTD_ASYNC
+    if (dev->busy) {
+        wait_for_write_complete(dev, MTD_SPI_NOR_PROGRAM_POLL_US);
+    }
+#else
+    (void)dev;
+#endif
+}
+
+#ifdef MODULE_MTD_SPI_NOR_SFDP
+static inline uint32_t _le32(const uint8_t *buf)
+{
+    return buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) |
+           ((uint32_t)buf[3] << 24);
+}
+
+/**
+ * @internal
+ * @brief Read from the SFDP area
+ *
+ * SFDP is always addressed with 3 bytes and followed by 8 dummy clocks,
+ * regardless of the address width of the device.
+ */
+static void mtd_spi_sfdp_read(const mtd_spi_nor_t *dev, uint32_t addr,
+                              void *dest, uint32_t count)
+{
+    uint8_t cmd[] = { SFDP_OPCODE, addr >> 16, addr >> 8, addr, 0 };
+
+    spi_transfer_bytes(dev->spi, dev->cs, true, cmd, NULL, sizeof(cmd));
+    spi_transfer_bytes(dev->spi, dev->cs, false, NULL, dest, count);
+}
+
+/**
+ * @internal
+ * @brief Detect geometry, erase opcodes and read modes from the Basic Flash
+ *        Parameter Table (JESD216)
+ */
+static int mtd_spi_read_sfdp(mtd_spi_nor_t *dev)
+{
+    mtd_dev_t *mtd = &dev->base;
+    uint8_t hdr[16];    /* SFDP header and first parameter header */
+    uint8_t bfpt[SFDP_BFPT_DWORDS * 4];
+
+    mtd_spi_sfdp_read(dev, 0, hdr, sizeof(hdr));
+    /* the first parameter header always describes the BFPT */
+    if ((_le32(&hdr[0]) != SFDP_SIGNATURE) || (hdr[8] != 0x00) ||
+        (hdr[11] < 9)) {
+        DEBUG("mtd_spi_nor_init: no SFDP\n");
+        return -ENOTSUP;
+    }
+    unsigned len = (hdr[11] < SFDP_BFPT_DWORDS) ? hdr[11] : SFDP_BFPT_DWORDS;
+    mtd_spi_sfdp_read(dev, _le32(&hdr[12]) & 0xffffff, bfpt, len * 4);
+
+    uint32_t dword = _le32(&bfpt[0]);
+    uint16_t flag = dev->flag & ~(SPI_NOR_F_SECT_4K | SPI_NOR_F_SECT_32K |
+                                  SPI_NOR_F_SECT_64K | SPI_NOR_F_READ_DUAL |
+                                  SPI_NOR_F_READ_QUAD);
+    if (dword & ((1 << 16) | (1 << 20))) {
+        /* 1-1-2 or 1-2-2 fast read */
+        flag |= SPI_NOR_F_READ_DUAL;
+    }
+    if (dword & ((1 << 21) | (1 << 22))) {
+        /* 1-4-4 or 1-1-4 fast read */
+        flag |= SPI_NOR_F_READ_QUAD;
+    }
+
+    uint32_t size;
+    dword = _le32(&bfpt[4]);
+    if (dword & 0x80000000) {
+        dword &= 0x7fffffff;
+        if ((dword < 3) || (dword > 34)) {
+            return -ENOTSUP;
+        }
+        size = 1ul << (dword - 3);
+    }
+    else {
+        size = (dword >> 3) + 1;
+    }
+
+    uint32_t page_size = 256;
+    if (len >= 11) {
+        page_size = 1ul << ((bfpt[40] >> 4) & 0xf);
+    }
+
+    /* erase types 1 to 4 are (size exponent, opcode) pairs in DWORDs 8 and 9 */
+    mtd_spi_nor_opcode_t opcode = *dev->opcode;
+    unsigned sector_shift = 0;
+    for (unsigned i = 0; i < 4; i++) {
+        unsigned shift = bfpt[28 + 2 * i];
+        uint8_t op = bfpt[29 + 2 * i];
+        switch (shift) {
+            case 12:
+                opcode.sector_erase = op;
+                flag |= SPI_NOR_F_SECT_4K;
+                break;
+            case 15:
+                opcode.block_erase_32k = op;
+                flag |= SPI_NOR_F_SECT_32K;
+                break;
+            case 16:
+                opcode.block_erase = op;
+                flag |= SPI_NOR_F_SECT_64K;
+                break;
+            default:
+                continue;
+        }
+        if ((sector_shift == 0) || (shift < sector_shift)) {
+            sector_shift = shift;
+        }
+    }
+    uint32_t sector_size = 1ul << sector_shift;
+    if ((sector_shift == 0) || (sector_size < page_size) || (size < sector_size)) {
+        return -ENOTSUP;
+    }
+
+    /* the erase opcodes of the BFPT take 3 byte addresses */
+    if (dev->addr_width == 3) {
+        dev->sfdp_opcode = opcode;
+        dev->opcode = &dev->sfdp_opcode;
+    }
+    dev->flag = flag;
+    mtd->page_size = page_size;
+    mtd->pages_per_sector = sector_size / page_size;
+    mtd->sector_count = size / sector_size;
+
+    return 0;
+}
+#endif
+
 static int mtd_spi_nor_init(mtd_dev_t *mtd)
 {
     DEBUG("mtd_spi_nor_init: %p\n", (void *)mtd);
@@ -309,6 +463,14 @@ static int mtd_spi_nor_init(mtd_dev_t *mtd)
     DEBUG("mtd_spi_nor_init: Found chip with ID: (%d, 0x%02x, 0x%02x, 0x%02x)\n",
           dev->jedec_id.bank, dev->jedec_id.manuf, dev->jedec_id.device[0], dev->jedec_id.device[1]);
 
+#ifdef MODULE_MTD_SPI_NOR_SFDP
+    if (mtd_spi_read_sfdp(dev) == 0) {
+        DEBUG("mtd_spi_nor_init: SFDP: %" PRIu32 " sectors of %" PRIu32
+              " pages of %" PRIu32 " bytes, flags 0x%x\n", mtd->sector_count,
+              mtd->pages_per_sector, mtd->page_size, (unsigned)dev->flag);
+    }
+#endif
+
     uint8_t status;
     mtd_spi_cmd_read(dev, dev->opcode->rdsr, &status, sizeof(status));
     spi_release(dev->spi);
@@ -359,72 +521,97 @@ static int mtd_spi_nor_read(mtd_dev_t *mtd, void *dest, uint32_t addr, uint32_t
     if (addr > chipsize) {
         return -EOVERFLOW;
     }
-    if (size > mtd->page_size) {
-        size = mtd->page_size;
-    }
-    if ((addr + size) > chipsize) {
+    if (size > (chipsize - addr)) {
         size = chipsize - addr;
     }
-    uint32_t page_addr_mask = dev->page_addr_mask;
-    if ((addr & page_addr_mask) != ((addr + size - 1) & page_addr_mask)) {
-        /* Reads across page boundaries must be split */
-        size = mtd->page_size - (addr & ~(page_addr_mask));
-    }
     if (size == 0) {
         return 0;
     }
     be_uint32_t addr_be = byteorder_htonl(addr);
 
+    /* the read commands continue across page boundaries, so a single command
+     * covers the whole range */
     spi_acquire(dev->spi, dev->cs, dev->mode, dev->clk);
-    mtd_spi_cmd_addr_read(dev, dev->opcode->read, addr_be, dest, size);
+    wait_for_async(dev);
+    if (dev->flag & SPI_NOR_F_FAST_READ) {
+        mtd_spi_cmd_addr_read(dev, dev->opcode->read_fast, addr_be, 1, dest, size);
+    }
+    else {
+        mtd_spi_cmd_addr_read(dev, dev->opcode->read, addr_be, 0, dest, size);
+    }
     spi_release(dev->spi);
 
     return size;
 }
 
-static int mtd_spi_nor_write(mtd_dev_t *mtd, const void *src, uint32_t addr, uint32_t size)
+static int _check_write(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
 {
     uint32_t total_size = mtd->page_size * mtd->pages_per_sector * mtd->sector_count;
 
+    if ((addr > total_size) || (size > (total_size - addr))) {
+        return -EOVERFLOW;
+    }
+    return 0;
+}
+
+/**
+ * @internal
+ * @brief Starts to program the data that falls into the page at addr
+ *
+ * @return number of bytes that are being programmed
+ */
+static uint32_t _program(const mtd_spi_nor_t *dev, const void *src, uint32_t addr,
+                         uint32_t size)
+{
+    uint32_t page_size = dev->base.page_size;
+    be_uint32_t addr_be = byteorder_htonl(addr);
+
+    /* a page program wraps around within the page, so stop at its end */
+    uint32_t len = page_size - (addr % page_size);
+    if (len > size) {
+        len = size;
+    }
+
+    /* write enable */
+    mtd_spi_cmd(dev, dev->opcode->wren);
+
+    /* Page program */
+    mtd_spi_cmd_addr_write(dev, dev->opcode->page_program, addr_be, src, len);
+
+    return len;
+}
+
+static int mtd_spi_nor_write(mtd_dev_t *mtd, const void *src, uint32_t addr, uint32_t size)
+{
     DEBUG("mtd_spi_nor_write: %p, %p, 0x%" PRIx32 ", 0x%" PRIx32 "\n",
           (void *)mtd, src, addr, size);
     if (size == 0) {
         return 0;
     }
     const mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
-    if (size > mtd->page_size) {
-        DEBUG("mtd_spi_nor_write: ERR: page program >1 page (%" PRIu32 ")!\n", mtd->page_size);
-        return -EOVERFLOW;
-    }
-    if (dev->page_addr_mask &&
-        ((addr & dev->page_addr_mask) != ((addr + size - 1) & dev->page_addr_mask))) {
-        DEBUG("mtd_spi_nor_write: ERR: page program spans page boundary!\n");
-        return -EOVERFLOW;
-    }
-    if (addr + size > total_size) {
-        return -EOVERFLOW;
+    int res = _check_write(mtd, addr, size);
+    if (res < 0) {
+        return res;
     }
-    be_uint32_t addr_be = byteorder_htonl(addr);
 
+    /* program page by page, without releasing the bus in between */
     spi_acquire(dev->spi, dev->cs, dev->mode, dev->clk);
-    /* write enable */
-    mtd_spi_cmd(dev, dev->opcode->wren);
+    wait_for_async(dev);
+    for (uint32_t done = 0; done < size;) {
+        done += _program(dev, (const uint8_t *)src + done, addr + done,
+                         size - done);
 
-    /* Page program */
-    mtd_spi_cmd_addr_write(dev, dev->opcode->page_program, addr_be, src, size);
-
-    /* waiting for the command to complete before returning */
-    wait_for_write_complete(dev);
+        /* waiting for the command to complete before continuing */
+        wait_for_write_complete(dev, MTD_SPI_NOR_PROGRAM_POLL_US);
+    }
 
     spi_release(dev->spi);
     return size;
 }
 
-static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
+static int _check_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
 {
-    DEBUG("mtd_spi_nor_erase: %p, 0x%" PRIx32 ", 0x%" PRIx32 "\n",
-          (void *)mtd, addr, size);
-    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+    const mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
     uint32_t sector_size = mtd->page_size * mtd->pages_per_sector;
     uint32_t total_size = sector_size * mtd->sector_count;
 
@@ -443,39 +630,73 @@ static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
     if (size % sector_size != 0) {
         return -EOVERFLOW;
     }
+    return 0;
+}
+
+/**
+ * @internal
+ * @brief Starts to erase the largest erase unit at addr that fits into size
+ *
+ * @return number of bytes that are being erased
+ */
+static uint32_t _erase_unit(const mtd_spi_nor_t *dev, uint32_t addr, uint32_t size)
+{
+    const mtd_dev_t *mtd = &dev->base;
+    uint32_t sector_size = mtd->page_size * mtd->pages_per_sector;
+    uint32_t total_size = sector_size * mtd->sector_count;
+    be_uint32_t addr_be = byteorder_htonl(addr);
+
+    /* write enable */
+    mtd_spi_cmd(dev, dev->opcode->wren);
+
+    if (size == total_size) {
+        mtd_spi_cmd(dev, dev->opcode->chip_erase);
+        return total_size;
+    }
+    else if ((dev->flag & SPI_NOR_F_SECT_64K) && (size >= MTD_64K) &&
+             ((addr & MTD_64K_ADDR_MASK) == 0)) {
+        /* 64 KiB blocks can be erased with block erase command */
+        mtd_spi_cmd_addr_write(dev, dev->opcode->block_erase, addr_be, NULL, 0);
+        return MTD_64K;
+    }
+    else if ((dev->flag & SPI_NOR_F_SECT_32K) && (size >= MTD_32K) &&
+             ((addr & MTD_32K_ADDR_MASK) == 0)) {
+        /* 32 KiB blocks can be erased with block erase command */
+        mtd_spi_cmd_addr_write(dev, dev->opcode->block_erase_32k, addr_be, NULL, 0);
+        return MTD_32K;
+    }
+    else if ((dev->flag & SPI_NOR_F_SECT_4K) && (size >= MTD_4K) &&
+             ((addr & MTD_4K_ADDR_MASK) == 0)) {
+        /* 4 KiB sectors can be erased with sector erase command */
+        mtd_spi_cmd_addr_write(dev, dev->opcode->sector_erase, addr_be, NULL, 0);
+        return MTD_4K;
+    }
+    else {
+        mtd_spi_cmd_addr_write(dev, dev->opcode->block_erase, addr_be, NULL, 0);
+        return sector_size;
+    }
+}
+
+static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
+{
+    DEBUG("mtd_spi_nor_erase: %p, 0x%" PRIx32 ", 0x%" PRIx32 "\n",
+          (void *)mtd, addr, size);
+    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+
+    int res = _check_erase(mtd, addr, size);
+    if (res < 0) {
+        return res;
+    }
 
     spi_acquire(dev->spi, dev->cs, dev->mode, dev->clk);
+    wait_for_async(dev);
     while (size) {
-        be_uint32_t addr_be = byteorder_htonl(addr);
-        /* write enable */
-        mtd_spi_cmd(dev, dev->opcode->wren);
-
-        if (size == total_size) {
-            mtd_spi_cmd(dev, dev->opcode->chip_erase);
-            size -= total_size;
-        }
-        else if ((dev->flag & SPI_NOR_F_SECT_32K) && (size >= MTD_32K) &&
-                 ((addr & MTD_32K_ADDR_MASK) == 0)) {
-            /* 32 KiB blocks can be erased with block erase command */
-            mtd_spi_cmd_addr_write(dev, dev->opcode->block_erase_32k, addr_be, NULL, 0);
-            addr += MTD_32K;
-            size -= MTD_32K;
-        }
-        else if ((dev->flag & SPI_NOR_F_SECT_4K) && (size >= MTD_4K) &&
-                 ((addr & MTD_4K_ADDR_MASK) == 0)) {
-            /* 4 KiB sectors can be erased with sector erase command */
-            mtd_spi_cmd_addr_write(dev, dev->opcode->sector_erase, addr_be, NULL, 0);
-            addr += MTD_4K;
-            size -= MTD_4K;
-        }
-        else {
-            mtd_spi_cmd_addr_write(dev, dev->opcode->block_erase, addr_be, NULL, 0);
-            addr += sector_size;
-            size -= sector_size;
-        }
+        uint32_t len = _erase_unit(dev, addr, size);
+        addr += len;
+        size -= len;
 
         /* waiting for the command to complete before continuing */
-        wait_for_write_complete(dev);
+        wait_for_write_complete(dev, MTD_SPI_NOR_WRITE_WAIT_US);
     }
     spi_release(dev->spi);
 
@@ -487,6 +708,7 @@ static int mtd_spi_nor_power(mtd_dev_t *mtd, enum mtd_power_state power)
     mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
 
     spi_acquire(dev->spi, dev->cs, dev->mode, dev->clk);
+    wait_for_async(dev);
     switch (power) {
         case MTD_POWER_UP:
             mtd_spi_cmd(dev, dev->opcode->wake);
@@ -499,3 +721,76 @@ static int mtd_spi_nor_power(mtd_dev_t *mtd, enum mtd_power_state power)
 
     return 0;
 }
+
+#ifdef MODULE_MTD_ASYNC
+/*
+ * Programs pages or erases units one by one, and polls the status register
+ * in between instead of waiting, so the SPI bus and the mtd_async thread are
+ * free while the chip is busy.
+ */
+static uint32_t mtd_spi_nor_async(mtd_dev_t *mtd, mtd_req_t *req)
+{
+    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+
+    if (dev->busy) {
+        uint8_t status;
+        spi_acquire(dev->spi, dev->cs, dev->mode, dev->clk);
+        mtd_spi_cmd_read(dev, dev->opcode->rdsr, &status, sizeof(status));
+        spi_release(dev->spi);
+
+        TRACE("mtd_spi_nor: async device status = 0x%02x\n", (unsigned int)status);
+        if (status & 1) {
+            return (req->op == MTD_REQ_ERASE) ? MTD_SPI_NOR_WRITE_WAIT_US
+                                              : MTD_SPI_NOR_PROGRAM_POLL_US;
+        }
+        dev->busy = false;
+    }
+
+    switch (req->op) {
+        case MTD_REQ_READ:
+            req->res = mtd_spi_nor_read(mtd, req->buf, req->addr, req->size);
+            return 0;
+        case MTD_REQ_WRITE:
+            if (req->state == 0) {
+                req->res = _check_write(mtd, req->addr, req->size);
+                if (req->res < 0) {
+                    return 0;
+                }
+                req->state = 1;
+            }
+            if (req->done < req->size) {
+                spi_acquire(dev->spi, dev->cs, dev->mode, dev->clk);
+                req->done += _program(dev, (uint8_t *)req->buf + req->done,
+                                      req->addr + req->done,
+                                      req->size - req->done);
+                /* before releasing the bus, so that no blocking caller
+                 * can use the chip while it is busy */
+                dev->busy = true;
+                spi_release(dev->spi);
+                return MTD_SPI_NOR_PROGRAM_POLL_US;
+            }
+            req->res = req->size;
+            return 0;
+        case MTD_REQ_ERASE:
+            if (req->state == 0) {
+                req->res = _check_erase(mtd, req->addr, req->size);
+                if (req->res < 0) {
+                    return 0;
+                }
+                req->state = 1;
+            }
+            if (req->done < req->size) {
+                spi_acquire(dev->spi, dev->cs, dev->mode, dev->clk);
+                req->done += _erase_unit(dev, req->addr + req->done,
+                                         req->size - req->done);
+                dev->busy = true;
+                spi_release(dev->spi);
+                return MTD_SPI_NOR_WRITE_WAIT_US;
+            }
+            req->res = 0;
+            return 0;
+    }
+    req->res = -EINVAL;
+    return 0;
+}
+#endif
@@ -22,6 +22,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <stdbool.h>
 #include <sys/stat.h> /* for struct stat */
 #include <string.h>
 
@@ -222,6 +223,49 @@ static ssize_t _read(vfs_file_t *filp, void *dest, size_t nbytes)
     return (ssize_t)br;
 }
 
+static ssize_t _prw(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                    off_t off, bool is_write)
+{
+    fatfs_file_desc_t *fd = (fatfs_file_desc_t *)filp->private_data.buffer;
+    off_t pos = f_tell(&fd->file);
+    ssize_t total = 0;
+
+    FRESULT res = f_lseek(&fd->file, off);
+
+    for (int i = 0; (res == FR_OK) && (i < iovcnt); i++) {
+        UINT n;
+        if (is_write) {
+            res = f_write(&fd->file, iov[i].iov_base, iov[i].iov_len, &n);
+        }
+        else {
+            res = f_read(&fd->file, iov[i].iov_base, iov[i].iov_len, &n);
+        }
+        total += n;
+        if (n < iov[i].iov_len) {
+            break;
+        }
+    }
+    f_lseek(&fd->file, pos);
+
+    if ((res != FR_OK) && (total == 0)) {
+        return fatfs_err_to_errno(res);
+    }
+
+    return total;
+}
+
+static ssize_t _preadv(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                       off_t off)
+{
+    return _prw(filp, iov, iovcnt, off, false);
+}
+
+static ssize_t _pwritev(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                        off_t off)
+{
+    return _prw(filp, iov, iovcnt, off, true);
+}
+
 static off_t _lseek(vfs_file_t *filp, off_t off, int whence)
 {
     fatfs_file_desc_t *fd = (fatfs_file_desc_t *)filp->private_data.buffer;
@@ -452,6 +496,8 @@ static const vfs_file_ops_t fatfs_file_ops = {
     .write = _write,
     .lseek = _lseek,
     .fstat = _fstat,
+    .preadv = _preadv,
+    .pwritev = _pwritev,
 };
 
 static const vfs_dir_ops_t fatfs_dir_ops = {
@@ -22,6 +22,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include "fs/littlefs_fs.h"
@@ -367,6 +368,58 @@ static ssize_t _read(vfs_file_t *filp, void *dest, size_t nbytes)
     return littlefs_err_to_errno(ret);
 }
 
+static ssize_t _prw(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                    off_t off, bool is_write)
+{
+    littlefs_desc_t *fs = filp->mp->private_data;
+    lfs_file_t *fp = (lfs_file_t *)&filp->private_data.buffer;
+
+    mutex_lock(&fs->lock);
+
+    DEBUG("littlefs: %s: filp=%p, fp=%p, iovcnt=%d, off=%ld\n",
+          is_write ? "pwritev" : "preadv", (void *)filp, (void *)fp, iovcnt,
+          (long)off);
+
+    /* the whole transfer is done with the lock held, so other users of the
+     * file system never see the temporary file position */
+    lfs_soff_t pos = lfs_file_tell(&fs->fs, fp);
+    ssize_t ret = (pos < 0) ? pos : lfs_file_seek(&fs->fs, fp, off, LFS_SEEK_SET);
+    if (ret >= 0) {
+        ret = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            lfs_ssize_t n = is_write
+                ? lfs_file_write(&fs->fs, fp, iov[i].iov_base, iov[i].iov_len)
+                : lfs_file_read(&fs->fs, fp, iov[i].iov_base, iov[i].iov_len);
+            if (n < 0) {
+                if (ret == 0) {
+                    ret = n;
+                }
+                break;
+            }
+            ret += n;
+            if ((size_t)n < iov[i].iov_len) {
+                break;
+            }
+        }
+        lfs_file_seek(&fs->fs, fp, pos, LFS_SEEK_SET);
+    }
+    mutex_unlock(&fs->lock);
+
+    return littlefs_err_to_errno(ret);
+}
+
+static ssize_t _preadv(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                       off_t off)
+{
+    return _prw(filp, iov, iovcnt, off, false);
+}
+
+static ssize_t _pwritev(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                        off_t off)
+{
+    return _prw(filp, iov, iovcnt, off, true);
+}
+
 static off_t _lseek(vfs_file_t *filp, off_t off, int whence)
 {
     littlefs_desc_t *fs = filp->mp->private_data;
@@ -516,6 +569,8 @@ static const vfs_file_ops_t littlefs_file_ops = {
     .read = _read,
     .write = _write,
     .lseek = _lseek,
+    .preadv = _preadv,
+    .pwritev = _pwritev,
 };
 
 static const vfs_dir_ops_t littlefs_dir_ops = {
@@ -178,4 +178,12 @@ ssize_t sock_ip_send(sock_ip_t *sock, const void *data, size_t len,
                           (struct _sock_tl_ep *)remote, NETCONN_RAW);
 }
 
+ssize_t sock_ip_sendv(sock_ip_t *sock, const iolist_t *snips, uint8_t proto,
+                      const sock_ip_ep_t *remote)
+{
+    assert((sock != NULL) || (remote != NULL));
+    return lwip_sock_sendv(&sock->conn, snips, proto,
+                           (struct _sock_tl_ep *)remote, NETCONN_RAW);
+}
+
 /** @} */
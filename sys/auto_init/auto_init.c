@@ -72,6 +72,10 @@
 #include "net/gcoap.h"
 #endif
 
+#ifdef MODULE_MTD_ASYNC
+#include "mtd.h"
+#endif
+
 #ifdef MODULE_GNRC_IPV6_NIB
 #include "net/gnrc/ipv6/nib.h"
 #endif
@@ -145,6 +149,10 @@ void auto_init(void)
     DEBUG("Auto init gcoap module.\n");
     gcoap_init();
 #endif
+#ifdef MODULE_MTD_ASYNC
+    DEBUG("Auto init mtd_async module.\n");
+    mtd_async_init();
+#endif
 #ifdef MODULE_DEVFS
     DEBUG("Mounting /dev\n");
     extern void auto_init_devfs(void);
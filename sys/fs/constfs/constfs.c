@@ -27,6 +27,7 @@
 #include <errno.h>
 
 #include "fs/constfs.h"
+#include "hashes.h"
 #include "vfs.h"
 
 #define ENABLE_DEBUG (0)
@@ -46,6 +47,8 @@ static off_t constfs_lseek(vfs_file_t *filp, off_t off, int whence);
 static int constfs_open(vfs_file_t *filp, const char *name, int flags, mode_t mode, const char *abs_path);
 static ssize_t constfs_read(vfs_file_t *filp, void *dest, size_t nbytes);
 static ssize_t constfs_write(vfs_file_t *filp, const void *src, size_t nbytes);
+static ssize_t constfs_preadv(vfs_file_t *filp, const struct iovec *iov, int iovcnt, off_t off);
+static ssize_t constfs_mmap(vfs_file_t *filp, const void **data);
 
 /* Directory operations */
 static int constfs_opendir(vfs_DIR *dirp, const char *dirname, const char *abs_path);
@@ -67,6 +70,8 @@ static const vfs_file_ops_t constfs_file_ops = {
     .open  = constfs_open,
     .read  = constfs_read,
     .write = constfs_write,
+    .preadv = constfs_preadv,
+    .mmap = constfs_mmap,
 };
 
 static const vfs_dir_ops_t constfs_dir_ops = {
@@ -92,6 +97,18 @@ const vfs_file_system_t constfs_file_system = {
  */
 static void _constfs_write_stat(const constfs_file_t *fp, struct stat *restrict buf);
 
+/**
+ * @internal
+ * @brief Find a file by its path
+ *
+ * @param[in]  fs     file system to search
+ * @param[in]  name   file system relative path
+ *
+ * @return index of the file in the files array
+ * @return -ENOENT if there is no such file
+ */
+static int _constfs_find(const constfs_t *fs, const char *name);
+
 static int constfs_mount(vfs_mount_t *mountp)
 {
     /* perform any extra initialization here */
@@ -122,18 +139,14 @@ static int constfs_stat(vfs_mount_t *mountp, const char *restrict name, struct s
         return -EFAULT;
     }
     constfs_t *fs = mountp->private_data;
-    /* linear search through the files array */
-    for (size_t i = 0; i < fs->nfiles; ++i) {
-        DEBUG("constfs_stat ? \"%s\"\n", fs->files[i].path);
-        if (strcmp(fs->files[i].path, name) == 0) {
-            DEBUG("constfs_stat: Found :)\n");
-            _constfs_write_stat(&fs->files[i], buf);
-            buf->st_ino = i;
-            return 0;
-        }
+    int i = _constfs_find(fs, name);
+    if (i < 0) {
+        DEBUG("constfs_stat: Not found :(\n");
+        return i;
     }
-    DEBUG("constfs_stat: Not found :(\n");
-    return -ENOENT;
+    _constfs_write_stat(&fs->files[i], buf);
+    buf->st_ino = i;
+    return 0;
 }
 
 static int constfs_statvfs(vfs_mount_t *mountp, const char *restrict path, struct statvfs *restrict buf)
@@ -215,17 +228,13 @@ static int constfs_open(vfs_file_t *filp, const char *name, int flags, mode_t mo
     if ((flags & O_ACCMODE) != O_RDONLY) {
         return -EROFS;
     }
-    /* linear search through the files array */
-    for (size_t i = 0; i < fs->nfiles; ++i) {
-        DEBUG("constfs_open ? \"%s\"\n", fs->files[i].path);
-        if (strcmp(fs->files[i].path, name) == 0) {
-            DEBUG("constfs_open: Found :)\n");
-            filp->private_data.ptr = (void *)&fs->files[i];
-            return 0;
-        }
+    int i = _constfs_find(fs, name);
+    if (i < 0) {
+        DEBUG("constfs_open: Not found :(\n");
+        return i;
     }
-    DEBUG("constfs_open: Not found :(\n");
-    return -ENOENT;
+    filp->private_data.ptr = (void *)&fs->files[i];
+    return 0;
 }
 
 static ssize_t constfs_read(vfs_file_t *filp, void *dest, size_t nbytes)
@@ -258,6 +267,31 @@ static ssize_t constfs_write(vfs_file_t *filp, const void *src, size_t nbytes)
     return -EBADF;
 }
 
+static ssize_t constfs_preadv(vfs_file_t *filp, const struct iovec *iov, int iovcnt, off_t off)
+{
+    constfs_file_t *fp = filp->private_data.ptr;
+    DEBUG("constfs_preadv: %p, %p, %d, %ld\n", (void *)filp, (void *)iov, iovcnt, (long)off);
+    ssize_t total = 0;
+    /* the file position is not used, so this needs no locking */
+    for (int i = 0; (i < iovcnt) && ((size_t)off < fp->size); ++i) {
+        size_t nbytes = iov[i].iov_len;
+        if (nbytes > (fp->size - off)) {
+            nbytes = fp->size - off;
+        }
+        memcpy(iov[i].iov_base, fp->data + off, nbytes);
+        off += nbytes;
+        total += nbytes;
+    }
+    return total;
+}
+
+static ssize_t constfs_mmap(vfs_file_t *filp, const void **data)
+{
+    constfs_file_t *fp = filp->private_data.ptr;
+    *data = fp->data;
+    return fp->size;
+}
+
 static int constfs_opendir(vfs_DIR *dirp, const char *dirname, const char *abs_path)
 {
     (void) abs_path;
@@ -317,3 +351,36 @@ static void _constfs_write_stat(const constfs_file_t *fp, struct stat *restrict
     buf->st_blocks = fp->size;
     buf->st_blksize = sizeof(uint8_t);
 }
+
+static int _constfs_find(const constfs_t *fs, const char *name)
+{
+    size_t i = 0;
+    if (fs->hashes != NULL) {
+        /* binary search for the first file with the same hash */
+        uint32_t hash = djb2_hash((const uint8_t *)name, strlen(name));
+        size_t end = fs->nfiles;
+        while (i < end) {
+            size_t mid = i + (end - i) / 2;
+            if (fs->hashes[mid] < hash) {
+                i = mid + 1;
+            }
+            else {
+                end = mid;
+            }
+        }
+        for (; (i < fs->nfiles) && (fs->hashes[i] == hash); ++i) {
+            if (strcmp(fs->files[i].path, name) == 0) {
+                return i;
+            }
+        }
+        return -ENOENT;
+    }
+    /* linear search through the files array */
+    for (; i < fs->nfiles; ++i) {
+        DEBUG("constfs_find ? \"%s\"\n", fs->files[i].path);
+        if (strcmp(fs->files[i].path, name) == 0) {
+            return i;
+        }
+    }
+    return -ENOENT;
+}
@@ -0,0 +1,731 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_hsfile
+ * @{
+ *
+ * @file
+ * @brief       Compressed files
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hsfile.h"
+#include "vfs.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/* "HS", window and lookahead bits of the encoder */
+#define FILE_HDR_SIZE   (4U)
+/* uncompressed and stored length, 16 bit little endian each */
+#define CHUNK_HDR_SIZE  (4U)
+/* flag in the stored length of chunks that are not compressed */
+#define STORED          (0x8000U)
+/* size, stride and number of entries of the index, 32 bit little endian
+ * each, and "HSIX" */
+#define FOOTER_SIZE     (16U)
+
+#define NO_CHUNK        (UINT32_MAX)
+
+#if (HSFILE_CHUNK_SIZE < 1) || (HSFILE_CHUNK_SIZE >= STORED)
+#error "HSFILE_CHUNK_SIZE must be between 1 and 32767"
+#endif
+
+#if HSFILE_INDEX_SIZE < 2
+#error "HSFILE_INDEX_SIZE must be at least 2"
+#endif
+
+static const uint8_t _file_hdr[FILE_HDR_SIZE] = {
+    'H', 'S', HEATSHRINK_STATIC_WINDOW_BITS, HEATSHRINK_STATIC_LOOKAHEAD_BITS
+};
+
+static const uint8_t _index_magic[4] = { 'H', 'S', 'I', 'X' };
+
+/* position of a chunk in the file */
+typedef struct {
+    uint32_t idx;
+    uint32_t off;               /* of the chunk header */
+    uint16_t raw;
+    uint16_t stored;
+} _chunk_t;
+
+static ssize_t _read_full(int fd, void *dest, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+        ssize_t res = vfs_read(fd, (uint8_t *)dest + done, len - done);
+        if (res < 0) {
+            return res;
+        }
+        if (res == 0) {
+            break;
+        }
+        done += res;
+    }
+    return done;
+}
+
+static int _write_full(int fd, const void *src, size_t len)
+{
+    size_t done = 0;
+    while (done < len) {
+        ssize_t res = vfs_write(fd, (const uint8_t *)src + done, len - done);
+        if (res < 0) {
+            return res;
+        }
+        done += res;
+    }
+    return 0;
+}
+
+static uint32_t _get_u32(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8) | ((uint32_t)buf[2] << 16)
+           | ((uint32_t)buf[3] << 24);
+}
+
+static void _put_u32(uint8_t *buf, uint32_t val)
+{
+    buf[0] = val & 0xff;
+    buf[1] = (val >> 8) & 0xff;
+    buf[2] = (val >> 16) & 0xff;
+    buf[3] = val >> 24;
+}
+
+/* Reads the chunk header at off, returns 0 at the end of the chunks */
+static int _read_hdr(hsfile_t *f, uint32_t off, _chunk_t *c)
+{
+    uint8_t hdr[CHUNK_HDR_SIZE];
+
+    if (off >= f->end) {
+        return 0;
+    }
+    off_t pos = vfs_lseek(f->fd, off, SEEK_SET);
+    if (pos < 0) {
+        return pos;
+    }
+    ssize_t res = _read_full(f->fd, hdr, sizeof(hdr));
+    if (res <= 0) {
+        return res;
+    }
+    if (res != sizeof(hdr)) {
+        return -EILSEQ;
+    }
+
+    c->off = off;
+    c->raw = hdr[0] | (hdr[1] << 8);
+    c->stored = hdr[2] | (hdr[3] << 8);
+    /* the index follows the chunks behind an empty header */
+    if ((c->raw == 0) && (c->stored == 0)) {
+        return 0;
+    }
+    uint16_t len = c->stored & ~STORED;
+    if ((c->raw == 0) || (c->raw > HSFILE_CHUNK_SIZE)
+        || (len > HSFILE_CHUNK_SIZE)
+        || ((c->stored & STORED) && (len != c->raw))
+        || ((uint64_t)off + CHUNK_HDR_SIZE + len > f->end)) {
+        DEBUG("hsfile: invalid chunk header at %u\n", (unsigned)off);
+        return -EILSEQ;
+    }
+    return 1;
+}
+
+/* Finds the header of chunk idx, or of the last chunk if the file ends
+ * before. Walks forward from the closest indexed chunk before idx, or from
+ * the current chunk if that is closer. */
+static int _locate(hsfile_t *f, uint32_t idx, _chunk_t *c)
+{
+    uint32_t start = 0;
+    uint32_t off = FILE_HDR_SIZE;
+
+    if (f->index_len > 0) {
+        uint32_t i = idx / f->index_stride;
+        if (i >= f->index_len) {
+            i = f->index_len - 1;
+        }
+        start = i * f->index_stride;
+        off = f->index[i];
+    }
+
+    if ((f->chunk != NO_CHUNK) && (f->chunk <= idx) && (f->chunk >= start)) {
+        c->idx = f->chunk;
+        c->off = f->chunk_off;
+        c->raw = f->len;
+        c->stored = f->chunk_stored;
+    }
+    else {
+        int res = _read_hdr(f, off, c);
+        if (res < 0) {
+            return res;
+        }
+        if (res == 0) {
+            /* only the first chunk may be missing, in an empty file */
+            return (start > 0) ? -EILSEQ : -ENOENT;
+        }
+        c->idx = start;
+    }
+
+    while (c->idx < idx) {
+        _chunk_t next;
+        /* only the last chunk may be short */
+        if (c->raw != HSFILE_CHUNK_SIZE) {
+            break;
+        }
+        int res = _read_hdr(f, c->off + CHUNK_HDR_SIZE
+                                + (c->stored & ~STORED), &next);
+        if (res < 0) {
+            return res;
+        }
+        if (res == 0) {
+            break;
+        }
+        next.idx = c->idx + 1;
+        *c = next;
+    }
+    return 0;
+}
+
+static int _compress(hsfile_t *f)
+{
+    heatshrink_encoder *enc = &f->codec.enc;
+    /* only keep the result if the chunk shrinks */
+    size_t cap = f->len - 1;
+    size_t in = 0;
+    size_t out = 0;
+
+    heatshrink_encoder_reset(enc);
+    while (1) {
+        if (in < f->len) {
+            size_t n;
+            if (heatshrink_encoder_sink(enc, &f->buf[in], f->len - in,
+                                        &n) < 0) {
+                return -EIO;
+            }
+            in += n;
+        }
+        else if (heatshrink_encoder_finish(enc) == HSER_FINISH_DONE) {
+            return out;
+        }
+
+        HSE_poll_res pres;
+        do {
+            size_t n;
+            if (out >= cap) {
+                return -ENOSPC;
+            }
+            pres = heatshrink_encoder_poll(enc, &f->cbuf[out], cap - out, &n);
+            if (pres < 0) {
+                return -EIO;
+            }
+            out += n;
+        } while (pres == HSER_POLL_MORE);
+    }
+}
+
+static int _decompress(hsfile_t *f, size_t len, size_t raw)
+{
+    heatshrink_decoder *dec = &f->codec.dec;
+    size_t in = 0;
+    size_t out = 0;
+
+    heatshrink_decoder_reset(dec);
+    while (1) {
+        size_t sunk = 0;
+        size_t polled = 0;
+        if (in < len) {
+            if (heatshrink_decoder_sink(dec, &f->cbuf[in], len - in,
+                                        &sunk) < 0) {
+                return -EIO;
+            }
+            in += sunk;
+        }
+        else if (heatshrink_decoder_finish(dec) == HSDR_FINISH_DONE) {
+            break;
+        }
+        if (out < raw) {
+            if (heatshrink_decoder_poll(dec, &f->buf[out], raw - out,
+                                        &polled) < 0) {
+                return -EILSEQ;
+            }
+            out += polled;
+        }
+        /* no progress: the chunk holds more data than its header says */
+        if ((sunk == 0) && (polled == 0)) {
+            return -EILSEQ;
+        }
+    }
+    return (out == raw) ? 0 : -EILSEQ;
+}
+
+/* Adds the chunk at off to the index if it is due. A full index keeps
+ * every other entry, so the chunks of the whole file stay covered. */
+static void _index_add(hsfile_t *f, uint32_t idx, uint32_t off)
+{
+    if (idx % f->index_stride) {
+        return;
+    }
+    if (f->index_len == HSFILE_INDEX_SIZE) {
+        f->index_len = (HSFILE_INDEX_SIZE + 1) / 2;
+        for (unsigned i = 1; i < f->index_len; i++) {
+            f->index[i] = f->index[2 * i];
+        }
+        f->index_stride *= 2;
+        if (idx % f->index_stride) {
+            return;
+        }
+    }
+    f->index[f->index_len++] = off;
+}
+
+/* Compresses and writes the buffered chunk. If this fails, the chunk stays
+ * buffered and is written again from its start by the next call. */
+static int _flush(hsfile_t *f)
+{
+    uint8_t hdr[CHUNK_HDR_SIZE];
+    const uint8_t *data = f->cbuf;
+
+    if (f->len == 0) {
+        return 0;
+    }
+
+    int len = _compress(f);
+    if (len == -ENOSPC) {
+        len = f->len;
+        data = f->buf;
+        hdr[2] = len & 0xff;
+        hdr[3] = (len | STORED) >> 8;
+    }
+    else if (len < 0) {
+        return len;
+    }
+    else {
+        hdr[2] = len & 0xff;
+        hdr[3] = len >> 8;
+    }
+    hdr[0] = f->len & 0xff;
+    hdr[1] = f->len >> 8;
+
+    /* a previous attempt might have written a part of the chunk */
+    off_t pos = vfs_lseek(f->fd, f->chunk_off, SEEK_SET);
+    if (pos < 0) {
+        return pos;
+    }
+    int res = _write_full(f->fd, hdr, sizeof(hdr));
+    if (res == 0) {
+        res = _write_full(f->fd, data, len);
+    }
+    if (res == 0) {
+        _index_add(f, (f->pos - f->len) / HSFILE_CHUNK_SIZE, f->chunk_off);
+        f->chunk_off += sizeof(hdr) + len;
+        f->len = 0;
+    }
+    return res;
+}
+
+/* Writes an empty chunk header, the index and the footer behind the last
+ * chunk */
+static int _write_index(hsfile_t *f)
+{
+    uint8_t buf[FOOTER_SIZE];
+
+    off_t pos = vfs_lseek(f->fd, f->chunk_off, SEEK_SET);
+    if (pos < 0) {
+        return pos;
+    }
+    memset(buf, 0, CHUNK_HDR_SIZE);
+    int res = _write_full(f->fd, buf, CHUNK_HDR_SIZE);
+    for (unsigned i = 0; (res == 0) && (i < f->index_len); i++) {
+        _put_u32(buf, f->index[i]);
+        res = _write_full(f->fd, buf, sizeof(uint32_t));
+    }
+    if (res < 0) {
+        return res;
+    }
+    _put_u32(&buf[0], f->pos);
+    _put_u32(&buf[4], f->index_stride);
+    _put_u32(&buf[8], f->index_len);
+    memcpy(&buf[12], _index_magic, sizeof(_index_magic));
+    return _write_full(f->fd, buf, sizeof(buf));
+}
+
+/* Loads the index of a file. A file without a valid index is still read
+ * by walking its chunk headers, so this only fails on errors of VFS. */
+static int _read_index(hsfile_t *f)
+{
+    uint8_t buf[FOOTER_SIZE];
+
+    off_t end = vfs_lseek(f->fd, 0, SEEK_END);
+    if (end < 0) {
+        return end;
+    }
+    if ((end < (off_t)(FILE_HDR_SIZE + CHUNK_HDR_SIZE + FOOTER_SIZE))
+        || ((uint64_t)end > UINT32_MAX)) {
+        return 0;
+    }
+    off_t pos = vfs_lseek(f->fd, end - FOOTER_SIZE, SEEK_SET);
+    if (pos < 0) {
+        return pos;
+    }
+    ssize_t n = _read_full(f->fd, buf, sizeof(buf));
+    if (n < 0) {
+        return n;
+    }
+    if ((n != sizeof(buf))
+        || memcmp(&buf[12], _index_magic, sizeof(_index_magic))) {
+        return 0;
+    }
+
+    uint32_t size = _get_u32(&buf[0]);
+    uint32_t stride = _get_u32(&buf[4]);
+    uint32_t count = _get_u32(&buf[8]);
+    uint32_t chunks = size / HSFILE_CHUNK_SIZE
+                      + ((size % HSFILE_CHUNK_SIZE) != 0);
+    if ((stride == 0) || (count > HSFILE_INDEX_SIZE)
+        || (count != chunks / stride + ((chunks % stride) != 0))
+        || ((uint32_t)end < FILE_HDR_SIZE + CHUNK_HDR_SIZE
+                            + count * sizeof(uint32_t) + FOOTER_SIZE)) {
+        return 0;
+    }
+
+    /* offset of the empty chunk header in front of the index */
+    uint32_t trailer = (uint32_t)end - FOOTER_SIZE - count * sizeof(uint32_t)
+                       - CHUNK_HDR_SIZE;
+    pos = vfs_lseek(f->fd, trailer, SEEK_SET);
+    if (pos < 0) {
+        return pos;
+    }
+    n = _read_full(f->fd, buf, CHUNK_HDR_SIZE);
+    if (n < 0) {
+        return n;
+    }
+    if ((n != CHUNK_HDR_SIZE) || (_get_u32(buf) != 0)) {
+        return 0;
+    }
+    for (unsigned i = 0; i < count; i++) {
+        n = _read_full(f->fd, buf, sizeof(uint32_t));
+        if (n < 0) {
+            return n;
+        }
+        if (n != sizeof(uint32_t)) {
+            return 0;
+        }
+        uint32_t off = _get_u32(buf);
+        if ((off >= trailer) || ((i == 0) && (off != FILE_HDR_SIZE))
+            || ((i > 0) && (off <= f->index[i - 1]))) {
+            return 0;
+        }
+        f->index[i] = off;
+    }
+
+    f->index_len = count;
+    f->index_stride = stride;
+    f->end = trailer;
+    f->size = size;
+    return 0;
+}
+
+/* Decompresses chunk idx into buf, returns 0 if the file ends before */
+static int _load(hsfile_t *f, uint32_t idx)
+{
+    _chunk_t c;
+
+    int res = _locate(f, idx, &c);
+    if (res == -ENOENT) {
+        return 0;
+    }
+    if (res < 0) {
+        return res;
+    }
+    if (c.idx != idx) {
+        return 0;
+    }
+
+    f->chunk = NO_CHUNK;
+    off_t pos = vfs_lseek(f->fd, c.off + CHUNK_HDR_SIZE, SEEK_SET);
+    if (pos < 0) {
+        return pos;
+    }
+    size_t len = c.stored & ~STORED;
+    uint8_t *dest = (c.stored & STORED) ? f->buf : f->cbuf;
+    ssize_t n = _read_full(f->fd, dest, len);
+    if (n < 0) {
+        return n;
+    }
+    if ((size_t)n != len) {
+        return -EILSEQ;
+    }
+    if (!(c.stored & STORED)) {
+        res = _decompress(f, len, c.raw);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    f->chunk = idx;
+    f->chunk_off = c.off;
+    f->chunk_stored = c.stored;
+    f->len = c.raw;
+    return 1;
+}
+
+int hsfile_open(hsfile_t *f, const char *name, int flags, mode_t mode)
+{
+    int acc = flags & O_ACCMODE;
+    int res;
+
+    if (((acc != O_RDONLY) && (acc != O_WRONLY)) || (flags & O_APPEND)) {
+        return -EINVAL;
+    }
+    if (acc == O_WRONLY) {
+        flags |= O_TRUNC;
+    }
+
+    int fd = vfs_open(name, flags, mode);
+    if (fd < 0) {
+        return fd;
+    }
+
+    if (acc == O_WRONLY) {
+        res = _write_full(fd, _file_hdr, sizeof(_file_hdr));
+    }
+    else {
+        uint8_t hdr[FILE_HDR_SIZE];
+        ssize_t n = _read_full(fd, hdr, sizeof(hdr));
+        res = (n < 0) ? n : 0;
+        if ((n >= 0) && ((n != sizeof(hdr))
+                         || memcmp(hdr, _file_hdr, sizeof(hdr)))) {
+            res = -EILSEQ;
+        }
+    }
+
+    f->fd = fd;
+    f->flags = flags;
+    f->pos = 0;
+    f->chunk = NO_CHUNK;
+    f->chunk_off = FILE_HDR_SIZE;
+    f->len = 0;
+    f->end = UINT32_MAX;
+    f->index_len = 0;
+    /* no index when reading, until one is found */
+    f->index_stride = (acc == O_WRONLY) ? 1 : 0;
+    if ((res == 0) && (acc == O_RDONLY)) {
+        res = _read_index(f);
+    }
+    if (res < 0) {
+        vfs_close(fd);
+        f->fd = -1;
+        return res;
+    }
+    return 0;
+}
+
+int hsfile_close(hsfile_t *f)
+{
+    int res = 0;
+
+    if ((f->flags & O_ACCMODE) == O_WRONLY) {
+        res = _flush(f);
+        if (res == 0) {
+            res = _write_index(f);
+        }
+    }
+    int cres = vfs_close(f->fd);
+    f->fd = -1;
+    return (res < 0) ? res : cres;
+}
+
+ssize_t hsfile_read(hsfile_t *f, void *dest, size_t count)
+{
+    size_t done = 0;
+
+    if ((f->flags & O_ACCMODE) != O_RDONLY) {
+        return -EBADF;
+    }
+
+    while (done < count) {
+        uint32_t idx = f->pos / HSFILE_CHUNK_SIZE;
+        size_t off = f->pos % HSFILE_CHUNK_SIZE;
+        if (idx != f->chunk) {
+            int res = _load(f, idx);
+            if (res < 0) {
+                return (done > 0) ? (ssize_t)done : res;
+            }
+            if (res == 0) {
+                break;
+            }
+        }
+        if (off >= f->len) {
+            break;
+        }
+        size_t n = f->len - off;
+        if (n > count - done) {
+            n = count - done;
+        }
+        memcpy((uint8_t *)dest + done, &f->buf[off], n);
+        done += n;
+        f->pos += n;
+    }
+    return done;
+}
+
+ssize_t hsfile_write(hsfile_t *f, const void *src, size_t count)
+{
+    size_t done = 0;
+
+    if ((f->flags & O_ACCMODE) != O_WRONLY) {
+        return -EBADF;
+    }
+    if (count > UINT32_MAX - f->pos) {
+        return -EFBIG;
+    }
+
+    while (done < count) {
+        /* a full chunk is written once more data follows, or on close */
+        if (f->len == HSFILE_CHUNK_SIZE) {
+            int res = _flush(f);
+            if (res < 0) {
+                return (done > 0) ? (ssize_t)done : res;
+            }
+        }
+        size_t n = HSFILE_CHUNK_SIZE - f->len;
+        if (n > count - done) {
+            n = count - done;
+        }
+        memcpy(&f->buf[f->len], (const uint8_t *)src + done, n);
+        f->len += n;
+        f->pos += n;
+        done += n;
+    }
+    return done;
+}
+
+off_t hsfile_size(hsfile_t *f)
+{
+    _chunk_t c;
+
+    if ((f->flags & O_ACCMODE) == O_WRONLY) {
+        return f->pos;
+    }
+    if (f->index_stride) {
+        return f->size;
+    }
+    int res = _locate(f, NO_CHUNK, &c);
+    if (res == -ENOENT) {
+        return 0;
+    }
+    if (res < 0) {
+        return res;
+    }
+    return (off_t)c.idx * HSFILE_CHUNK_SIZE + c.raw;
+}
+
+off_t hsfile_lseek(hsfile_t *f, off_t off, int whence)
+{
+    switch (whence) {
+        case SEEK_SET:
+            break;
+        case SEEK_CUR:
+            off += f->pos;
+            break;
+        case SEEK_END: {
+            off_t size = hsfile_size(f);
+            if (size < 0) {
+                return size;
+            }
+            off += size;
+            break;
+        }
+        default:
+            return -EINVAL;
+    }
+    if ((off < 0) || ((uint64_t)off > UINT32_MAX)) {
+        return -EINVAL;
+    }
+    if (((f->flags & O_ACCMODE) == O_WRONLY) && ((uint32_t)off != f->pos)) {
+        return -EINVAL;
+    }
+    f->pos = off;
+    return off;
+}
+
+static int _vfs_close(vfs_file_t *filp)
+{
+    return hsfile_close(filp->private_data.ptr);
+}
+
+static int _vfs_fstat(vfs_file_t *filp, struct stat *buf)
+{
+    hsfile_t *f = filp->private_data.ptr;
+
+    int res = vfs_fstat(f->fd, buf);
+    if (res < 0) {
+        return res;
+    }
+    off_t size = hsfile_size(f);
+    if (size < 0) {
+        return size;
+    }
+    buf->st_size = size;
+    return 0;
+}
+
+static off_t _vfs_lseek(vfs_file_t *filp, off_t off, int whence)
+{
+    off = hsfile_lseek(filp->private_data.ptr, off, whence);
+    if (off >= 0) {
+        filp->pos = off;
+    }
+    return off;
+}
+
+static ssize_t _vfs_read(vfs_file_t *filp, void *dest, size_t nbytes)
+{
+    hsfile_t *f = filp->private_data.ptr;
+
+    ssize_t res = hsfile_read(f, dest, nbytes);
+    filp->pos = f->pos;
+    return res;
+}
+
+static ssize_t _vfs_write(vfs_file_t *filp, const void *src, size_t nbytes)
+{
+    hsfile_t *f = filp->private_data.ptr;
+
+    ssize_t res = hsfile_write(f, src, nbytes);
+    filp->pos = f->pos;
+    return res;
+}
+
+const vfs_file_ops_t hsfile_vfs_file_ops = {
+    .close = _vfs_close,
+    .fstat = _vfs_fstat,
+    .lseek = _vfs_lseek,
+    .read = _vfs_read,
+    .write = _vfs_write,
+};
+
+int hsfile_vfs_open(hsfile_t *f, const char *name, int flags, mode_t mode)
+{
+    int res = hsfile_open(f, name, flags, mode);
+    if (res < 0) {
+        return res;
+    }
+    int fd = vfs_bind(VFS_ANY_FD, f->flags, &hsfile_vfs_file_ops, f);
+    if (fd < 0) {
+        hsfile_close(f);
+    }
+    return fd;
+}
@@ -15,6 +15,15 @@
  * RIOT VFS layer. The implementation uses an array of @c constfs_file_t objects
  * as its storage back-end.
  *
+ * Files are looked up by a linear search, unless the array comes with an
+ * index of the hashes of the paths, as generated by the mkconstfs tools in
+ * dist/tools/mkconstfs. Then a lookup is a binary search over the hashes and
+ * usually a single string comparison.
+ *
+ * The contents of a file can be used in place with vfs_mmap(), e.g. to send
+ * them without copying them to a buffer first. vfs_preadv() does not change
+ * the file position, so several threads can read from the same open file.
+ *
  * @{
  * @file
  * @brief   ConstFS public API
@@ -48,6 +57,12 @@ typedef struct {
 typedef struct {
     const size_t nfiles; /**< Number of files */
     const constfs_file_t *files; /**< Files array */
+    /**
+     * @brief djb2 hash of the path of each file, or NULL
+     *
+     * If set, @c files must be sorted by these hashes in ascending order.
+     */
+    const uint32_t *hashes;
 } constfs_t;
 
 /**
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_hsfile Compressed files
+ * @ingroup     sys
+ * @brief       Streaming access to heatshrink compressed files on VFS
+ *
+ * A compressed file is a regular file on any file system mounted to VFS.
+ * Data written to it is compressed with @ref pkg_heatshrink on the fly and
+ * decompressed again when reading, so neither side needs to hold the whole
+ * file in RAM: a @ref hsfile_t contains two buffers of
+ * @ref HSFILE_CHUNK_SIZE bytes, an index of @ref HSFILE_INDEX_SIZE entries
+ * and the state of the codec, independent of the size of the file.
+ *
+ * The data is split into chunks of @ref HSFILE_CHUNK_SIZE bytes that are
+ * compressed independently. Each chunk is preceded by a header holding its
+ * uncompressed and its stored length, a chunk that does not shrink is
+ * stored as is. On close, the offsets of evenly spaced chunks and the
+ * uncompressed size are appended to the file as index. To read from an
+ * arbitrary position, only the headers between the closest indexed chunk
+ * before it and the position are read and a single chunk is decompressed.
+ * Reading forward from the current chunk does not read any header twice.
+ * A file without a valid index, e.g. because writing it failed, can still
+ * be read, but the headers are then read from the first chunk on.
+ *
+ * A file is either opened for reading or for writing. Files are always
+ * written from the start, appending to and modifying a compressed file is
+ * not supported.
+ *
+ * A compressed file can be used with the functions of this module, or with
+ * the functions of VFS, and the POSIX functions on top of them, after
+ * opening it with hsfile_vfs_open(). Existing users of file descriptors
+ * then read and write the uncompressed data.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for compressed files
+ */
+
+#ifndef HSFILE_H
+#define HSFILE_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "heatshrink_decoder.h"
+#include "heatshrink_encoder.h"
+#include "vfs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief   Number of uncompressed bytes per chunk, at most 32767
+ *
+ * Larger chunks compress better, smaller chunks need less RAM and make
+ * random reads cheaper.
+ */
+#ifndef HSFILE_CHUNK_SIZE
+#define HSFILE_CHUNK_SIZE   (512U)
+#endif
+
+/**
+ * @brief   Maximum number of chunks in the index of a file, at least 2
+ *
+ * If a file has more chunks, only every second, fourth, ... chunk is
+ * indexed, so at most `2 * chunks / HSFILE_INDEX_SIZE` headers are read to
+ * find a chunk.
+ */
+#ifndef HSFILE_INDEX_SIZE
+#define HSFILE_INDEX_SIZE   (32U)
+#endif
+
+/**
+ * @brief   Compressed file descriptor
+ *
+ * All fields are internal.
+ */
+typedef struct {
+    int fd;                     /**< VFS file descriptor of the file */
+    int flags;                  /**< flags the file was opened with */
+    uint32_t pos;               /**< position in the uncompressed data */
+    uint32_t chunk;             /**< index of the chunk in @p buf */
+    uint32_t chunk_off;         /**< offset of the header of @p chunk, or
+                                     of the buffered chunk when writing */
+    uint16_t chunk_stored;      /**< stored length of @p chunk */
+    uint16_t len;               /**< number of bytes in @p buf */
+    uint32_t end;               /**< offset of the index when reading */
+    uint32_t size;              /**< uncompressed size from the index */
+    uint32_t index_stride;      /**< chunks per entry of @p index, 0 if the
+                                     file has no index */
+    uint32_t index_len;         /**< number of entries in @p index */
+    uint32_t index[HSFILE_INDEX_SIZE];  /**< offsets of the headers of
+                                             every @p index_stride chunk */
+    union {
+        heatshrink_encoder enc; /**< encoder state when writing */
+        heatshrink_decoder dec; /**< decoder state when reading */
+    } codec;                    /**< codec state */
+    uint8_t buf[HSFILE_CHUNK_SIZE];     /**< uncompressed chunk */
+    uint8_t cbuf[HSFILE_CHUNK_SIZE];    /**< compressed chunk */
+} hsfile_t;
+
+/**
+ * @brief   Opens a compressed file
+ *
+ * @param[out] f        File descriptor to initialize
+ * @param[in]  name     Path of the file
+ * @param[in]  flags    O_RDONLY to read the file, or O_WRONLY to create
+ *                      or truncate it, optionally with O_CREAT, O_TRUNC
+ *                      and O_EXCL
+ * @param[in]  mode     Mode of a newly created file
+ *
+ * @return  0 on success
+ * @return  -EINVAL if @p flags are not supported
+ * @return  -EILSEQ if the file is not a compressed file or was written
+ *          with a different configuration of heatshrink
+ * @return  < 0 on errors of vfs_open() or vfs_read()
+ */
+int hsfile_open(hsfile_t *f, const char *name, int flags, mode_t mode);
+
+/**
+ * @brief   Closes a compressed file
+ *
+ * When writing, the last chunk is compressed and written, followed by the
+ * index.
+ *
+ * @param[in,out] f     Open file
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of vfs_write() or vfs_close()
+ */
+int hsfile_close(hsfile_t *f);
+
+/**
+ * @brief   Reads uncompressed data
+ *
+ * @param[in,out] f     File opened for reading
+ * @param[out]    dest  Destination buffer
+ * @param[in]     count Number of bytes to read
+ *
+ * @return  number of bytes read, 0 at the end of the file
+ * @return  -EBADF if @p f is not open for reading
+ * @return  -EILSEQ if the file is corrupt
+ * @return  < 0 on errors of vfs_read() or vfs_lseek()
+ */
+ssize_t hsfile_read(hsfile_t *f, void *dest, size_t count);
+
+/**
+ * @brief   Appends uncompressed data
+ *
+ * The data is buffered until a chunk is full. If writing a chunk fails, it
+ * stays buffered and is written again by the next call or by
+ * hsfile_close().
+ *
+ * @param[in,out] f     File opened for writing
+ * @param[in]     src   Data
+ * @param[in]     count Number of bytes to write
+ *
+ * @return  number of bytes written
+ * @return  -EBADF if @p f is not open for writing
+ * @return  -EFBIG if the file would grow beyond 4 GiB of uncompressed data
+ * @return  < 0 on errors of vfs_write()
+ */
+ssize_t hsfile_write(hsfile_t *f, const void *src, size_t count);
+
+/**
+ * @brief   Moves the read position in the uncompressed data
+ *
+ * Files opened for writing can not be seeked, but the current position can
+ * be queried with `hsfile_lseek(f, 0, SEEK_CUR)`.
+ *
+ * @param[in,out] f     Open file
+ * @param[in]     off   Offset relative to @p whence
+ * @param[in]     whence    SEEK_SET, SEEK_CUR or SEEK_END
+ *
+ * @return  new position
+ * @return  -EINVAL if the position would be negative or @p whence is
+ *          invalid, or if @p f is open for writing and the position would
+ *          change
+ * @return  < 0 on errors of hsfile_size()
+ */
+off_t hsfile_lseek(hsfile_t *f, off_t off, int whence);
+
+/**
+ * @brief   Gets the uncompressed size of a file
+ *
+ * When reading a file without index, this walks the chunk headers after the
+ * current chunk.
+ *
+ * @param[in,out] f     Open file
+ *
+ * @return  uncompressed size
+ * @return  -EILSEQ if the file is corrupt
+ * @return  < 0 on errors of vfs_read() or vfs_lseek()
+ */
+off_t hsfile_size(hsfile_t *f);
+
+/**
+ * @brief   VFS file operations of compressed files
+ *
+ * The private data of the file is the @ref hsfile_t of the open file.
+ */
+extern const vfs_file_ops_t hsfile_vfs_file_ops;
+
+/**
+ * @brief   Opens a compressed file as VFS file descriptor
+ *
+ * vfs_read(), vfs_write(), vfs_lseek() and vfs_close() on the descriptor
+ * behave like the functions of this module. vfs_fstat() returns the status
+ * of the underlying file with the uncompressed size. An open compressed file
+ * uses two of the @ref VFS_MAX_OPEN_FILES descriptors.
+ *
+ * @param[out] f        Storage for the file, must stay valid until the
+ *                      descriptor is closed
+ * @param[in]  name     Path of the file
+ * @param[in]  flags    Flags as for hsfile_open()
+ * @param[in]  mode     Mode of a newly created file
+ *
+ * @return  file descriptor on success
+ * @return  -ENFILE if no descriptor is available
+ * @return  < 0 on errors of hsfile_open()
+ */
+int hsfile_vfs_open(hsfile_t *f, const char *name, int flags, mode_t mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSFILE_H */
+/** @} */
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_mtd_kv Key-value store on MTD
+ * @ingroup     sys
+ * @brief       Flash-backed key-value store with an index in RAM
+ *
+ * The store is made for configuration data and credentials, i.e. a limited
+ * number of small values that are read often and updated rarely. It uses a
+ * range of sectors of an MTD as a ring of append-only sectors.
+ *
+ * - Each put or delete appends an entry to the newest sector, old entries
+ *   are left in place. An entry carries a CRC, so an update that was
+ *   interrupted by a power loss is ignored and the previous value is kept.
+ *   After an entry failed to be written, the next one starts a new sector.
+ * - A hash table in RAM maps each key to its newest entry. It is rebuilt on
+ *   mtd_kv_init() by reading all entries once. A lookup only reads entries
+ *   from the MTD whose key has the same hash, usually exactly one.
+ * - The sector after the newest one is kept erased. When the newest sector
+ *   is full, the store moves on to that sector and, if this uses up the
+ *   last erased sector, the entries that are still valid in the oldest
+ *   sector are copied over before it is erased. So all sectors wear
+ *   evenly. If copying is interrupted, it starts over in the erased newest
+ *   sector on the next mtd_kv_init(), put or delete.
+ *
+ * The values of all keys together can use at most `sector_count - 2`
+ * sectors, the number of keys is limited by @ref MTD_KV_INDEX_SIZE.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for the MTD key-value store
+ */
+
+#ifndef MTD_KV_H
+#define MTD_KV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief   Number of slots of the index, must be a power of 2
+ *
+ * At most three quarters of the slots are used, so that a lookup only
+ * needs to check a few slots.
+ */
+#ifndef MTD_KV_INDEX_SIZE
+#define MTD_KV_INDEX_SIZE   (32U)
+#endif
+
+/**
+ * @brief   Maximum length of a key
+ */
+#ifndef MTD_KV_KEY_MAX
+#define MTD_KV_KEY_MAX      (32U)
+#endif
+
+/**
+ * @brief   Slot of the index
+ */
+typedef struct {
+    uint32_t addr;              /**< offset of the entry, 0 if unused */
+    uint16_t hash;              /**< hash of the key */
+} mtd_kv_slot_t;
+
+/**
+ * @brief   Key-value store descriptor
+ *
+ * Only @p mtd, @p sector and @p sector_count need to be set before calling
+ * mtd_kv_init(), the remaining fields are internal.
+ */
+typedef struct {
+    mtd_dev_t *mtd;             /**< device the store is on */
+    uint32_t sector;            /**< first sector of the store */
+    uint32_t sector_count;      /**< number of sectors, at least 3 */
+    uint32_t head;              /**< sector written to, relative to
+                                     @p sector */
+    uint32_t head_seq;          /**< sequence number of the head sector */
+    uint32_t tail;              /**< oldest sector, relative to @p sector */
+    uint32_t pos;               /**< offset of the next entry in the head
+                                     sector */
+    uint32_t used;              /**< bytes used by the newest entries */
+    uint16_t keys;              /**< number of keys */
+    mutex_t lock;               /**< protects the store */
+    mtd_kv_slot_t index[MTD_KV_INDEX_SIZE]; /**< index of the keys */
+} mtd_kv_t;
+
+/**
+ * @brief   Initializes the MTD and builds the index of the store on it
+ *
+ * If no store is found, the sectors are formatted.
+ *
+ * @param[in,out] kv    Store descriptor
+ *
+ * @return  0 on success
+ * @return  -EINVAL if the geometry does not fit the store
+ * @return  -ENOMEM if the store holds more keys than the index
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_kv_init(mtd_kv_t *kv);
+
+/**
+ * @brief   Erases all keys
+ *
+ * @param[in,out] kv    Initialized store
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_kv_format(mtd_kv_t *kv);
+
+/**
+ * @brief   Reads the value of a key
+ *
+ * @param[in]  kv       Initialized store
+ * @param[in]  key      Key
+ * @param[out] value    Buffer for the value
+ * @param[in]  len      Size of @p value
+ *
+ * @return  length of the value
+ * @return  -ENOENT if the key is not set
+ * @return  -EOVERFLOW if @p value is too small
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_kv_get(mtd_kv_t *kv, const char *key, void *value, size_t len);
+
+/**
+ * @brief   Sets the value of a key
+ *
+ * The value is replaced atomically: after a power loss, mtd_kv_get() either
+ * returns the new value or the previous one.
+ *
+ * @param[in,out] kv    Initialized store
+ * @param[in]     key   Key of at most @ref MTD_KV_KEY_MAX characters
+ * @param[in]     value Value
+ * @param[in]     len   Length of @p value, may be 0
+ *
+ * @return  0 on success
+ * @return  -EINVAL if @p key is empty or too long, or @p len does not fit
+ *          into a sector
+ * @return  -ENOMEM if the index is full
+ * @return  -ENOSPC if the store is full
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_kv_put(mtd_kv_t *kv, const char *key, const void *value, size_t len);
+
+/**
+ * @brief   Removes a key
+ *
+ * @param[in,out] kv    Initialized store
+ * @param[in]     key   Key
+ *
+ * @return  0 on success
+ * @return  -ENOENT if the key is not set
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_kv_delete(mtd_kv_t *kv, const char *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_KV_H */
+/** @} */
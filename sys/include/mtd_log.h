@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_mtd_log Log-structured record store on MTD
+ * @ingroup     sys
+ * @brief       Circular log of small records, stored directly on an MTD
+ *
+ * The log is made for data that is appended at a high rate and read back in
+ * order, e.g. sensor samples. It uses a range of sectors of an MTD as a ring.
+ * When the ring is full, the oldest sector is dropped, so all sectors wear
+ * evenly.
+ *
+ * - Records are collected in a page buffer and each page is written once, as
+ *   a whole. mtd_log_flush() writes a partially filled page, and the rest of
+ *   that page stays unused. After a page failed to be written, its records
+ *   are lost and the next page starts a new sector.
+ * - Each record carries a CRC. A record with a wrong CRC, e.g. from a write
+ *   that was interrupted by a power loss, is skipped together with the rest
+ *   of its page.
+ * - Each sector starts with a header that holds a sequence number. On
+ *   mtd_log_init() only these headers and a few pages of the newest sector
+ *   are read to find the end of the log.
+ * - The sector after the one written to is kept erased. Starting a new
+ *   sector only needs a page write, and an erase that was interrupted by a
+ *   power loss is simply repeated.
+ *
+ * A record must fit into a page together with the headers, i.e. it can be
+ * at most the page size minus @ref MTD_LOG_RECORD_OVERHEAD bytes long.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for the MTD record log
+ */
+
+#ifndef MTD_LOG_H
+#define MTD_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief   Size of the page buffer
+ *
+ * Must be at least the page size of the device.
+ */
+#ifndef MTD_LOG_PAGE_SIZE
+#define MTD_LOG_PAGE_SIZE       (256U)
+#endif
+
+/**
+ * @brief   Bytes of a page that can not be used for the data of a record
+ */
+#define MTD_LOG_RECORD_OVERHEAD (12U)
+
+/**
+ * @brief   Log descriptor
+ *
+ * Only @p mtd, @p sector and @p sector_count need to be set before calling
+ * mtd_log_init(), the remaining fields are internal.
+ */
+typedef struct {
+    mtd_dev_t *mtd;             /**< device the log is stored on */
+    uint32_t sector;            /**< first sector of the log */
+    uint32_t sector_count;      /**< number of sectors, at least 2 */
+    uint32_t head;              /**< sector written to, relative to @p sector */
+    uint32_t head_seq;          /**< sequence number of the head sector */
+    uint32_t tail_seq;          /**< sequence number of the oldest sector */
+    uint32_t page;              /**< offset of the buffered page in the head
+                                     sector */
+    uint16_t buf_len;           /**< bytes used in @p buf */
+    mutex_t lock;               /**< protects the log */
+    uint8_t buf[MTD_LOG_PAGE_SIZE]; /**< page buffer */
+} mtd_log_t;
+
+/**
+ * @brief   Read position in a log
+ */
+typedef struct {
+    uint32_t seq;               /**< sequence number of the sector */
+    uint32_t offset;            /**< offset of the next record in the sector */
+} mtd_log_cursor_t;
+
+/**
+ * @brief   Initializes the MTD and opens the log stored on it
+ *
+ * If no log is found, the sectors are formatted, unless they are all
+ * erased, which is an empty log.
+ *
+ * @param[in,out] log   Log descriptor
+ *
+ * @return  0 on success
+ * @return  -EINVAL if the geometry does not fit the log
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_log_init(mtd_log_t *log);
+
+/**
+ * @brief   Erases all records
+ *
+ * @param[in,out] log   Initialized log
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_log_format(mtd_log_t *log);
+
+/**
+ * @brief   Appends a record
+ *
+ * The record is buffered until its page is full or mtd_log_flush() is
+ * called.
+ *
+ * @param[in,out] log   Initialized log
+ * @param[in]     data  Data of the record
+ * @param[in]     len   Length of the record, must not be 0
+ *
+ * @return  0 on success
+ * @return  -EINVAL if @p len is 0 or too large for a page
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_log_append(mtd_log_t *log, const void *data, size_t len);
+
+/**
+ * @brief   Writes the buffered records
+ *
+ * The remainder of the current page is not used afterwards, so flushing
+ * after each record costs a page per record.
+ *
+ * @param[in,out] log   Initialized log
+ *
+ * @return  0 on success
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_log_flush(mtd_log_t *log);
+
+/**
+ * @brief   Places a cursor at the oldest record
+ *
+ * @param[in]  log  Initialized log
+ * @param[out] cur  Cursor
+ */
+void mtd_log_cursor_init(mtd_log_t *log, mtd_log_cursor_t *cur);
+
+/**
+ * @brief   Reads the record at a cursor and moves the cursor to the next one
+ *
+ * Records that are still buffered are read as well.
+ *
+ * @param[in]     log   Initialized log
+ * @param[in,out] cur   Cursor
+ * @param[out]    dest  Buffer for the record
+ * @param[in]     len   Size of @p dest
+ *
+ * @return  length of the record
+ * @return  0 at the end of the log
+ * @return  -EOVERFLOW if @p dest is too small, the cursor is not moved
+ * @return  -ESTALE if records at the cursor were dropped, the cursor is
+ *          moved to the oldest record
+ * @return  < 0 on errors of the MTD
+ */
+int mtd_log_read(mtd_log_t *log, mtd_log_cursor_t *cur, void *dest,
+                 size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_LOG_H */
+/** @} */
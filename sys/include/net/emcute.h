@@ -89,6 +89,7 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "kernel_types.h"
 #include "net/sock/udp.h"
 
 #ifdef __cplusplus
@@ -218,6 +219,31 @@ typedef struct emcute_sub {
     void *arg;                  /**< optional custom argument */
 } emcute_sub_t;
 
+/**
+ * @brief   Context of a request in flight
+ *
+ * Requests answered by an acknowledgement carrying their message ID
+ * (REGISTER, PUBLISH with QoS 1, SUBSCRIBE, and UNSUBSCRIBE) do not block each
+ * other: any number of them can be in flight at the same time, each one is
+ * retransmitted on its own. The context is allocated by the caller and
+ * **must** stay valid until emcute_req_wait() returned for it. Its fields are
+ * private to emCute.
+ */
+typedef struct emcute_req {
+    struct emcute_req *next;    /**< next request in flight */
+    emcute_topic_t *topic;      /**< topic to store the ID of a REGACK in */
+    const void *data;           /**< data following the header */
+    size_t len;                 /**< length of emcute_req_t::data in bytes */
+    uint32_t deadline;          /**< time of the next retransmission [in us] */
+    volatile int result;        /**< result, once the request completed */
+    kernel_pid_t pid;           /**< thread that started the request */
+    uint16_t id;                /**< message ID */
+    uint8_t hdr[9];             /**< message header */
+    uint8_t hdr_len;            /**< length of emcute_req_t::hdr in bytes */
+    uint8_t ack;                /**< type of the expected acknowledgement */
+    uint8_t retries;            /**< retransmissions left */
+} emcute_req_t;
+
 /**
  * @brief   Connect to a given MQTT-SN gateway (CONNECT)
  *
@@ -283,6 +309,60 @@ int emcute_reg(emcute_topic_t *topic);
 int emcute_pub(emcute_topic_t *topic, const void *buf, size_t len,
                unsigned flags);
 
+/**
+ * @brief   Start registering a topic without waiting for the gateway's reply
+ *
+ * Call emcute_req_wait() to get the result.
+ *
+ * @param[out] req          context of the request
+ * @param[in,out] topic     topic to register, topic.name **must not** be NULL,
+ *                          topic.id is set once the request completed
+ *                          successfully
+ *
+ * @return  EMCUTE_OK if the request is in flight
+ * @return  EMCUTE_NOGW if not connected to a gateway
+ * @return  EMCUTE_OVERFLOW if length of topic name exceeds
+ *          @ref EMCUTE_TOPIC_MAXLEN
+ */
+int emcute_reg_start(emcute_req_t *req, emcute_topic_t *topic);
+
+/**
+ * @brief   Start publishing data without waiting for the gateway's reply
+ *
+ * Neither @p topic nor @p buf are copied, both **must** stay valid and
+ * unchanged until emcute_req_wait() returned for @p req. With QoS 0 the
+ * request completes right away.
+ *
+ * @param[out] req      context of the request
+ * @param[in] topic     topic to send data to, topic **must** be registered
+ *                      (topic.id **must** populated).
+ * @param[in] buf       data to publish
+ * @param[in] len       length of @p data in bytes
+ * @param[in] flags     flags used for publication, allowed are QoS and retain
+ *
+ * @return  EMCUTE_OK if the request is in flight
+ * @return  EMCUTE_NOGW if not connected to a gateway
+ * @return  EMCUTE_OVERFLOW if length of data exceeds @ref EMCUTE_BUFSIZE
+ * @return  EMCUTE_NOTSUP on unsupported flag values
+ */
+int emcute_pub_start(emcute_req_t *req, emcute_topic_t *topic,
+                     const void *buf, size_t len, unsigned flags);
+
+/**
+ * @brief   Wait for a request to complete
+ *
+ * While waiting, all requests in flight started by the calling thread are
+ * retransmitted when due, so requests must only be waited for by the thread
+ * that started them. Every started request **must** be waited for.
+ *
+ * @param[in] req       context of a request started by the calling thread
+ *
+ * @return  EMCUTE_OK on success
+ * @return  EMCUTE_REJECT if the request was rejected by the gateway
+ * @return  EMCUTE_TIMEOUT if the gateway did not reply
+ */
+int emcute_req_wait(emcute_req_t *req);
+
 /**
  * @brief   Subscribe to the given topic
  *
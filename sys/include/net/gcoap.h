@@ -129,12 +129,21 @@
  *    _content_type_ attributes.
  * -# Read the payload, if any.
  *
+ * The handler may send a new request, e.g. to follow up on the response.
+ *
+ * ### Block-wise transfers ###
+ *
+ * The `gcoap_block` module fetches or uploads representations too large for
+ * a single message in blocks, with several blocks in flight. See
+ * @ref net_gcoap_block.
+ *
  * ## Observe Server Operation
  *
  * A CoAP client may register for Observe notifications for any resource that
  * an application has registered with gcoap. An application does not need to
- * take any action to support Observe client registration. However, gcoap
- * limits registration for a given resource to a _single_ observer.
+ * take any action to support Observe client registration. Several clients may
+ * observe the same resource, up to GCOAP_OBS_CLIENTS_MAX clients and
+ * GCOAP_OBS_REGISTRATIONS_MAX registrations in total.
  *
  * An Observe notification is considered a response to the original client
  * registration request. So, the Observe server only needs to create and send
@@ -158,7 +167,28 @@
  *    in the coap_pkt_t, for up to _payload_len_ bytes.
  *
  * Finally, call gcoap_obs_send() for the resource, with the sum of the
- * metadata length and payload length for the representation.
+ * metadata length and payload length for the representation. gcoap sends the
+ * notification to each observer of the resource, with the token of its
+ * registration.
+ *
+ * ### Scheduling notifications ###
+ *
+ * Alternatively, call gcoap_obs_notify() whenever the resource changes. The
+ * gcoap thread then calls the handler of the resource to generate the
+ * notification, as if an observer had sent a GET request, and sends the
+ * result to all observers. Changes are coalesced: at most one notification
+ * per GCOAP_OBS_NOTIFY_INTERVAL is sent for a resource, with its state at
+ * the time the notification is sent. The handler must use gcoap_resp_init()
+ * to initialize the response, which adds the Observe option.
+ *
+ * ### Confirmable notifications ###
+ *
+ * If GCOAP_OBS_CON_EVERY is not zero, every n-th notification to an observer
+ * is confirmable, as is a notification built as confirmable with
+ * coap_hdr_set_type(). gcoap tracks one confirmable notification per
+ * observer: it is retransmitted with the current state of the resource until
+ * it is acknowledged, and the observer is removed if it is never
+ * acknowledged. A newer notification for the same resource replaces it.
  *
  * ### Other considerations ###
  *
@@ -173,8 +203,8 @@
  * indicated by the presence of the Observe option in the response.
  *
  * To cancel registration, the server expects to receive a GET request with
- * the Observe option value set to 1. The server does not support cancellation
- * via a reset (RST) response to a non-confirmable notification.
+ * the Observe option value set to 1, or a reset (RST) response to a
+ * notification. A RST removes all registrations of the client.
  *
  * ## Implementation Notes ##
  *
@@ -380,6 +410,25 @@ extern "C" {
 #define GCOAP_OBS_REGISTRATIONS_MAX     (2)
 #endif
 
+/**
+ * @ingroup net_gcoap_conf
+ * @brief   Minimum time between two notifications for a resource scheduled
+ *          with gcoap_obs_notify() [in usec]
+ */
+#ifndef GCOAP_OBS_NOTIFY_INTERVAL
+#define GCOAP_OBS_NOTIFY_INTERVAL   (1U * US_PER_SEC)
+#endif
+
+/**
+ * @ingroup net_gcoap_conf
+ * @brief   Send every n-th notification to an observer as confirmable
+ *
+ * Set to 0 to send confirmable notifications only when built as such.
+ */
+#ifndef GCOAP_OBS_CON_EVERY
+#define GCOAP_OBS_CON_EVERY     (0U)
+#endif
+
 /**
  * @name    States for the memo used to track Observe registrations
  * @{
@@ -464,6 +513,9 @@ typedef struct gcoap_listener {
  *          originating request
  *
  * If request timed out, the packet header is for the request.
+ *
+ * The memo of the request is released before the handler is called, so the
+ * handler may send a new request.
  */
 typedef void (*gcoap_resp_handler_t)(unsigned req_state, coap_pkt_t* pdu,
                                      sock_udp_ep_t *remote);
@@ -672,9 +724,9 @@ int gcoap_obs_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 
 /**
  * @brief   Sends a buffer containing a CoAP Observe notification to the
- *          observer registered for a resource
+ *          observers registered for a resource
  *
- * Assumes a single observer for a resource.
+ * The token and message ID in @p buf are replaced for each observer.
  *
  * @param[in] buf Buffer containing the PDU
  * @param[in] len Length of the buffer
@@ -686,6 +738,23 @@ int gcoap_obs_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 size_t gcoap_obs_send(const uint8_t *buf, size_t len,
                       const coap_resource_t *resource);
 
+/**
+ * @brief   Schedules a notification about a change of a resource to its
+ *          observers
+ *
+ * Returns immediately. The notification is generated by the handler of
+ * @p resource on the gcoap thread, at most once per
+ * GCOAP_OBS_NOTIFY_INTERVAL. Several calls in between result in a single
+ * notification with the latest state.
+ *
+ * @param[in] resource  The resource that changed.
+ *
+ * @return  0, if a notification was scheduled.
+ * @return  -ENOENT, if @p resource has no observers.
+ * @return  -ENOMEM, if too many resources have notifications scheduled.
+ */
+int gcoap_obs_notify(const coap_resource_t *resource);
+
 /**
  * @brief   Provides important operational statistics
  *
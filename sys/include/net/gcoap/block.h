@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gcoap_block Gcoap block-wise transfers
+ * @ingroup     net_gcoap
+ * @brief       Client-side engine for block-wise transfers (RFC 7959)
+ *
+ * Fetches (Block2) or uploads (Block1) a representation in blocks. Up to
+ * gcoap_block_t::window block requests are in flight at once, so a transfer
+ * takes about `blocks / window` round trips instead of one per block. The
+ * data is passed block by block to a callback, so neither side of the
+ * transfer has to hold the whole representation.
+ *
+ * Usage:
+ *
+ * -# Call gcoap_block_init() with the remote endpoint, the resource path and
+ *    the callbacks.
+ * -# Optionally reduce the block size in gcoap_block_t::szx or change the
+ *    window in gcoap_block_t::window.
+ * -# Start the transfer with gcoap_block_get() or gcoap_block_put().
+ * -# gcoap_block_t::data_cb is called for each block, and
+ *    gcoap_block_t::done_cb once the transfer is finished.
+ *
+ * Both callbacks are called in the context of the gcoap thread.
+ *
+ * ### Downloads ###
+ *
+ * The size of the representation is not known until a block without the
+ * `more` flag arrives, so up to `window - 1` requests past its end may be
+ * sent. Blocks are passed to the callback in the order they arrive, together
+ * with their offset, so the callback needs to be able to write out of order
+ * if the network reorders responses. If the server picks a smaller block
+ * size in its first response, the transfer continues with that size.
+ *
+ * ### Uploads ###
+ *
+ * The callback fills each block before it is sent. It is called again for a
+ * block that has to be retransmitted. The last block is only sent after all
+ * other blocks were acknowledged, so the final response of the server covers
+ * the complete representation.
+ *
+ * ### Resources ###
+ *
+ * Each block request takes one of the @ref GCOAP_REQ_WAITING_MAX request
+ * memos of gcoap while it is in flight, so the window is effectively bounded
+ * by the memos that are not used otherwise. Block requests are
+ * non-confirmable; lost requests or responses are retransmitted by this
+ * module after @ref GCOAP_NON_TIMEOUT.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Gcoap block-wise transfer definitions
+ */
+#ifndef NET_GCOAP_BLOCK_H
+#define NET_GCOAP_BLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net/gcoap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup net_gcoap_block_conf   Gcoap block-wise transfer compile configurations
+ * @ingroup  net_gcoap_conf
+ * @{
+ */
+/**
+ * @brief   Maximum number of block requests in flight per transfer
+ */
+#ifndef GCOAP_BLOCK_WINDOW_MAX
+#define GCOAP_BLOCK_WINDOW_MAX      (4U)
+#endif
+
+/**
+ * @brief   Default block size exponent (block size is `2^(szx + 4)`)
+ *
+ * Block and headers must fit into @ref GCOAP_PDU_BUF_SIZE.
+ */
+#ifndef GCOAP_BLOCK_SZX
+#define GCOAP_BLOCK_SZX             (NANOCOAP_BLOCK_SIZE_EXP_MAX - 4)
+#endif
+
+/**
+ * @brief   Number of retransmissions of a block request before the transfer
+ *          fails
+ */
+#ifndef GCOAP_BLOCK_RETRIES
+#define GCOAP_BLOCK_RETRIES         (COAP_MAX_RETRANSMIT)
+#endif
+/** @} */
+
+#if (GCOAP_TOKENLEN == 0) && !defined(DOXYGEN)
+#error "gcoap_block: GCOAP_TOKENLEN must not be 0"
+#endif
+
+/**
+ * @brief   Forward declaration of the transfer state
+ */
+typedef struct gcoap_block gcoap_block_t;
+
+/**
+ * @brief   Callback for the data of a transfer
+ *
+ * Must not start or cancel transfers.
+ *
+ * @param[in] xfer      The transfer.
+ * @param[in] offset    Offset of the block within the representation.
+ * @param[in,out] buf   Data of the block: the data received for a download,
+ *                      to be filled for an upload.
+ * @param[in] len       Length of @p buf.
+ * @param[in] more      true, if blocks follow after this one.
+ *
+ * @return  0, to continue the transfer.
+ * @return  < 0, to abort the transfer with that value.
+ */
+typedef int (*gcoap_block_data_cb_t)(gcoap_block_t *xfer, size_t offset,
+                                     uint8_t *buf, size_t len, bool more);
+
+/**
+ * @brief   Callback for the end of a transfer
+ *
+ * @param[in] xfer      The transfer.
+ * @param[in] res       Length of the representation, on success.
+ *                      -ETIMEDOUT, if a block was not answered.
+ *                      -EBADMSG, if the server answered with an error
+ *                      (see gcoap_block_t::resp_code) or a malformed block.
+ *                      -ECANCELED, if the transfer was canceled.
+ *                      The return value of gcoap_block_t::data_cb, if it
+ *                      aborted the transfer.
+ */
+typedef void (*gcoap_block_done_cb_t)(gcoap_block_t *xfer, int res);
+
+/**
+ * @brief   Block request in flight
+ */
+typedef struct {
+    uint32_t blknum;                    /**< block number */
+    uint8_t token[GCOAP_TOKENLEN];      /**< token of the request */
+    uint8_t retries;                    /**< retransmissions so far */
+    bool used;                          /**< slot is in use */
+} gcoap_block_slot_t;
+
+/**
+ * @brief   State of a transfer
+ *
+ * Fields not documented as settable are private.
+ */
+struct gcoap_block {
+    gcoap_block_t *next;                /**< next active transfer */
+    sock_udp_ep_t remote;               /**< remote endpoint */
+    const char *path;                   /**< resource path */
+    gcoap_block_data_cb_t data_cb;      /**< callback for the data */
+    gcoap_block_done_cb_t done_cb;      /**< callback for the end */
+    void *arg;                          /**< application context, settable */
+    size_t len;                         /**< length of the representation */
+    uint32_t next_blk;                  /**< next block to request */
+    uint32_t last_blk;                  /**< last block, UINT32_MAX if unknown */
+    uint16_t format;                    /**< Content-Format of an upload */
+    uint8_t code;                       /**< request method */
+    uint8_t resp_code;                  /**< code of the last response */
+    uint8_t szx;                        /**< block size exponent, settable
+                                         *   before start */
+    uint8_t window;                     /**< blocks in flight, settable
+                                         *   before start */
+    bool started;                       /**< a block was transferred */
+    gcoap_block_slot_t slots[GCOAP_BLOCK_WINDOW_MAX]; /**< requests in flight */
+};
+
+/**
+ * @brief   Initializes a transfer
+ *
+ * @pre `(xfer != NULL) && (remote != NULL) && (path != NULL)`
+ * @pre @p path must start with `/` and must stay valid during the transfer
+ *
+ * @param[out] xfer     The transfer.
+ * @param[in] remote    Server of the resource.
+ * @param[in] path      Path of the resource.
+ * @param[in] data_cb   Callback for the data.
+ * @param[in] done_cb   Callback for the end of the transfer. May be NULL.
+ * @param[in] arg       Application context, stored in gcoap_block_t::arg.
+ */
+void gcoap_block_init(gcoap_block_t *xfer, const sock_udp_ep_t *remote,
+                      const char *path, gcoap_block_data_cb_t data_cb,
+                      gcoap_block_done_cb_t done_cb, void *arg);
+
+/**
+ * @brief   Starts to fetch a resource (GET with Block2)
+ *
+ * @pre gcoap_init() was called.
+ *
+ * @param[in,out] xfer  An initialized transfer.
+ *
+ * @return  0, when the transfer was started.
+ * @return  -EINVAL, if the block size or window of @p xfer is invalid.
+ * @return  -EBUSY, if @p xfer is active.
+ * @return  -ENOBUFS, if a block does not fit into @ref GCOAP_PDU_BUF_SIZE.
+ * @return  -ENOMEM, if no request could be sent.
+ */
+int gcoap_block_get(gcoap_block_t *xfer);
+
+/**
+ * @brief   Starts to upload a representation (PUT or POST with Block1)
+ *
+ * @pre gcoap_init() was called.
+ *
+ * @param[in,out] xfer  An initialized transfer.
+ * @param[in] code      COAP_METHOD_PUT or COAP_METHOD_POST.
+ * @param[in] len       Length of the representation.
+ * @param[in] format    Content-Format of the representation, or
+ *                      COAP_FORMAT_NONE.
+ *
+ * @return  0, when the transfer was started.
+ * @return  -EINVAL, if @p code, the block size or the window of @p xfer is
+ *          invalid.
+ * @return  -EBUSY, if @p xfer is active.
+ * @return  -ENOBUFS, if a block does not fit into @ref GCOAP_PDU_BUF_SIZE.
+ * @return  -ENOMEM, if no request could be sent.
+ * @return  the return value of gcoap_block_t::data_cb, if it aborted the
+ *          transfer.
+ */
+int gcoap_block_put(gcoap_block_t *xfer, unsigned code, size_t len,
+                    unsigned format);
+
+/**
+ * @brief   Cancels an active transfer
+ *
+ * gcoap_block_t::done_cb is called with -ECANCELED. Responses to requests
+ * still in flight are ignored.
+ *
+ * @param[in,out] xfer  The transfer.
+ */
+void gcoap_block_cancel(gcoap_block_t *xfer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GCOAP_BLOCK_H */
+/** @} */
@@ -76,6 +76,10 @@ extern "C" {
 #define GNRC_IPV6_NIB_CONF_DNS          (1)
 #endif
 
+#ifdef MODULE_GNRC_IPV6_NIB_ROUTE_CACHE
+#define GNRC_IPV6_NIB_CONF_ROUTE_CACHE  (1)
+#endif
+
 /**
  * @name    Compile flags
  * @brief   Compile flags to (de-)activate certain features for NIB
@@ -188,6 +192,18 @@ extern "C" {
 #define GNRC_IPV6_NIB_CONF_DNS          (0)
 #endif
 
+/**
+ * @brief   (de-)activate route cache
+ *
+ * The route cache remembers the result of
+ * @ref gnrc_ipv6_nib_get_next_hop_l2addr() for recently used destinations,
+ * so packets of steady flows skip the forwarding table and neighbor cache
+ * look-up. Any change to the NIB invalidates the whole cache.
+ */
+#ifndef GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+#define GNRC_IPV6_NIB_CONF_ROUTE_CACHE  (0)
+#endif
+
 /**
  * @brief   Multihop prefix and 6LoWPAN context distribution
  *
@@ -256,6 +272,31 @@ extern "C" {
 #define GNRC_IPV6_NIB_NUMOF                 (4)
 #endif
 
+/**
+ * @brief   Number of buckets in the hash index over the entries of the NIB
+ *
+ * Neighbors are looked up by address with this index. Must be a power of two.
+ * Defaults to the smallest power of two not smaller than
+ * @ref GNRC_IPV6_NIB_NUMOF (but at most 256).
+ */
+#ifndef GNRC_IPV6_NIB_HASH_NUMOF
+#if GNRC_IPV6_NIB_NUMOF <= 4
+#define GNRC_IPV6_NIB_HASH_NUMOF            (4)
+#elif GNRC_IPV6_NIB_NUMOF <= 8
+#define GNRC_IPV6_NIB_HASH_NUMOF            (8)
+#elif GNRC_IPV6_NIB_NUMOF <= 16
+#define GNRC_IPV6_NIB_HASH_NUMOF            (16)
+#elif GNRC_IPV6_NIB_NUMOF <= 32
+#define GNRC_IPV6_NIB_HASH_NUMOF            (32)
+#elif GNRC_IPV6_NIB_NUMOF <= 64
+#define GNRC_IPV6_NIB_HASH_NUMOF            (64)
+#elif GNRC_IPV6_NIB_NUMOF <= 128
+#define GNRC_IPV6_NIB_HASH_NUMOF            (128)
+#else
+#define GNRC_IPV6_NIB_HASH_NUMOF            (256)
+#endif
+#endif
+
 /**
  * @brief   Number of off-link entries in NIB
  *
@@ -266,6 +307,18 @@ extern "C" {
 #define GNRC_IPV6_NIB_OFFL_NUMOF            (8)
 #endif
 
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE || defined(DOXYGEN)
+/**
+ * @brief   Number of entries in the route cache
+ *
+ * @attention   This number is equal to the maximum number of destinations the
+ *              NIB can remember the next hop for
+ */
+#ifndef GNRC_IPV6_NIB_ROUTE_CACHE_NUMOF
+#define GNRC_IPV6_NIB_ROUTE_CACHE_NUMOF     (4)
+#endif
+#endif
+
 #if GNRC_IPV6_NIB_CONF_MULTIHOP_P6C || defined(DOXYGEN)
 /**
  * @brief   Number of authoritative border router entries in NIB
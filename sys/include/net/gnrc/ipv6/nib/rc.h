@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_ipv6_nib_rc    Route cache
+ * @ingroup     net_gnrc_ipv6_nib
+ * @brief       Cache of resolved next hops for recently used destinations
+ *
+ * The route cache remembers the result of
+ * @ref gnrc_ipv6_nib_get_next_hop_l2addr() per destination. Entries are only
+ * created for next hops that are known to be reachable, so neighbor
+ * unreachability detection is not bypassed. Every change to the NIB
+ * increments the generation of the NIB, which invalidates all entries.
+ *
+ * @note    Only available with @ref GNRC_IPV6_NIB_CONF_ROUTE_CACHE (module
+ *          `gnrc_ipv6_nib_route_cache`)
+ * @{
+ *
+ * @file
+ * @brief   Route cache definitions
+ */
+#ifndef NET_GNRC_IPV6_NIB_RC_H
+#define NET_GNRC_IPV6_NIB_RC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "net/gnrc/ipv6/nib/nc.h"
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Route cache entry view on NIB
+ */
+typedef struct {
+    ipv6_addr_t dst;                /**< destination */
+    gnrc_ipv6_nib_nc_t next_hop;    /**< next hop to gnrc_ipv6_nib_rc_t::dst */
+} gnrc_ipv6_nib_rc_t;
+
+/**
+ * @brief   Route cache statistics
+ */
+typedef struct {
+    uint32_t hits;          /**< look-ups answered by the route cache */
+    uint32_t misses;        /**< look-ups that needed a full NIB look-up */
+    uint32_t generation;    /**< number of changes to the NIB */
+} gnrc_ipv6_nib_rc_stats_t;
+
+/**
+ * @brief   Iterates over all valid route cache entries in the NIB
+ *
+ * @pre `(state != NULL) && (entry != NULL)`
+ *
+ * @param[in] iface         Restrict iteration to entries on this interface.
+ *                          0 for any interface.
+ * @param[in,out] state     Iteration state of the route cache. Must point
+ *                          to a NULL pointer to start iteration.
+ * @param[out] entry        The next route cache entry.
+ *
+ * @note    The list may change during iteration.
+ *
+ * @return  true, if iteration can be continued.
+ * @return  false, if @p entry is the last route cache entry in the NIB.
+ */
+bool gnrc_ipv6_nib_rc_iter(unsigned iface, void **state,
+                           gnrc_ipv6_nib_rc_t *entry);
+
+/**
+ * @brief   Gets the route cache statistics
+ *
+ * @pre `stats != NULL`
+ *
+ * @param[out] stats    The statistics of the route cache.
+ */
+void gnrc_ipv6_nib_rc_get_stats(gnrc_ipv6_nib_rc_stats_t *stats);
+
+/**
+ * @brief   Invalidates all route cache entries
+ *
+ * For route sources outside the NIB, e.g. the
+ * @ref net_gnrc_rpl_routes "RPL downward route store", whenever they change.
+ */
+void gnrc_ipv6_nib_rc_invalidate(void);
+
+/**
+ * @brief   Prints a route cache entry
+ *
+ * @pre `entry != NULL`
+ *
+ * @param[in] entry     A route cache entry.
+ */
+void gnrc_ipv6_nib_rc_print(const gnrc_ipv6_nib_rc_t *entry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_IPV6_NIB_RC_H */
+/** @} */
@@ -53,6 +53,9 @@
 #ifdef MODULE_NETSTATS_L2
 #include "net/netstats.h"
 #endif
+#ifdef MODULE_NETSTATS_NEIGHBOR
+#include "net/netstats/neighbor.h"
+#endif
 #include "rmutex.h"
 
 #ifdef __cplusplus
@@ -74,6 +77,9 @@ typedef struct {
 #ifdef MODULE_NETSTATS_L2
     netstats_t stats;                       /**< transceiver's statistics */
 #endif
+#if defined(MODULE_NETSTATS_NEIGHBOR) || DOXYGEN
+    netstats_nb_table_t neighbors;          /**< link statistics per neighbor */
+#endif
 #if defined(MODULE_GNRC_IPV6) || DOXYGEN
     gnrc_netif_ipv6_t ipv6;                 /**< IPv6 component */
 #endif
@@ -79,6 +79,18 @@ typedef enum {
  */
 #define GNRC_NETREG_DEMUX_CTX_ALL   (0xffff0000)
 
+/**
+ * @brief   Number of lists per type the registry is split into, by demux
+ *          context
+ *
+ * Must be a power of two. With many registrations for one type, e.g. many
+ * UDP socks, a higher value shortens the look-up for a port at the cost of
+ * one pointer per type and list.
+ */
+#ifndef GNRC_NETREG_HASH_NUMOF
+#define GNRC_NETREG_HASH_NUMOF      (1)
+#endif
+
 /**
  * @name    Static entry initialization macros
  * @anchor  net_gnrc_netreg_init_static
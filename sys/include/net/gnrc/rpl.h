@@ -193,12 +193,21 @@ extern "C" {
 /**
  * @brief   Number of implemented Objective Functions
  */
+#ifdef MODULE_GNRC_RPL_MRHOF
+#define GNRC_RPL_IMPLEMENTED_OFS_NUMOF (2)
+#else
 #define GNRC_RPL_IMPLEMENTED_OFS_NUMOF (1)
+#endif
 
 /**
  * @brief   Default Objective Code Point (OF0)
+ *
+ * Set to @ref GNRC_RPL_MRHOF_OCP to use @ref net_gnrc_rpl_mrhof for DODAGs
+ * rooted at this node.
  */
+#ifndef GNRC_RPL_DEFAULT_OCP
 #define GNRC_RPL_DEFAULT_OCP (0)
+#endif
 
 /**
  * @brief   Default Instance ID
@@ -329,8 +338,30 @@ static inline bool GNRC_RPL_COUNTER_GREATER_THAN(uint8_t A, uint8_t B)
 #define GNRC_RPL_DAO_SEND_RETRIES   (4)
 #endif
 #ifndef GNRC_RPL_DAO_ACK_DELAY
+/**
+ * @brief Initial time to wait for a DAO-ACK in milli seconds
+ *
+ * Doubled with every retransmission.
+ */
 #define GNRC_RPL_DAO_ACK_DELAY      (3000UL)
 #endif
+#ifndef GNRC_RPL_DAO_ACK_DELAY_MAX
+/**
+ * @brief Maximum time to wait for a DAO-ACK in milli seconds
+ */
+#define GNRC_RPL_DAO_ACK_DELAY_MAX  (30000UL)
+#endif
+#ifndef GNRC_RPL_DAO_TARGETS_NUMOF
+/**
+ * @brief Maximum number of targets announced in a single DAO
+ *
+ * More targets are split over several DAOs that share one Transit
+ * Information option each, so that a DAO only spans few link-layer frames.
+ * Only the first 32 DAOs sent at once are retransmitted when not
+ * acknowledged.
+ */
+#define GNRC_RPL_DAO_TARGETS_NUMOF  (4U)
+#endif
 #ifndef GNRC_RPL_DAO_DELAY_LONG
 /**
  * @brief Long delay for DAOs in milli seconds
@@ -535,12 +566,26 @@ void gnrc_rpl_send_DIS(gnrc_rpl_instance_t *instance, ipv6_addr_t *destination,
 /**
  * @brief   Send a DAO of the @p dodag to the @p destination.
  *
+ * The targets are split over as many DAOs as needed with at most
+ * @ref GNRC_RPL_DAO_TARGETS_NUMOF targets each.
+ *
  * @param[in] instance          Pointer to the instance.
  * @param[in] destination       IPv6 addres of the destination.
  * @param[in] lifetime          Lifetime of the route to announce.
  */
 void gnrc_rpl_send_DAO(gnrc_rpl_instance_t *instance, ipv6_addr_t *destination, uint8_t lifetime);
 
+/**
+ * @brief   Send the DAOs of the @p instance to its preferred parent again that
+ *          were not acknowledged yet.
+ *
+ * Sends DAOs for all targets, if none are waiting for a DAO-ACK.
+ *
+ * @param[in] instance      Pointer to the RPL instance.
+ * @param[in] lifetime      Lifetime of the route to announce.
+ */
+void gnrc_rpl_resend_DAO(gnrc_rpl_instance_t *instance, uint8_t lifetime);
+
 /**
  * @brief   Send a DAO-ACK of the @p instance to the @p destination.
  *
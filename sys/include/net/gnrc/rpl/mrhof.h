@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_rpl_mrhof Minimum Rank with Hysteresis Objective Function
+ * @ingroup     net_gnrc_rpl
+ * @brief       MRHOF with the ETX metric
+ * @see <a href="https://tools.ietf.org/html/rfc6719">
+ *          RFC 6719
+ *      </a>
+ *
+ * The ETX of the link to a parent is taken from the
+ * @ref net_netstats_neighbor "neighbor statistics" of the DODAG's interface,
+ * which the interface gathers from the transmission status its device
+ * reports. The path cost through a parent is its rank plus the ETX of the link
+ * to it (encoded as in RFC 6551, i.e. ETX 1 is 128). The preferred parent is
+ * only replaced by a parent whose path cost is lower by at least
+ * @ref GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD.
+ *
+ * No DAG Metric Container is used, so the rank is the path cost but at least
+ * the rank of the preferred parent plus MinHopRankIncrease. Unlike the RFC,
+ * parents whose link exceeds @ref GNRC_RPL_MRHOF_MAX_LINK_METRIC are not
+ * excluded but only used if there are no others, so a node stays attached
+ * over a poor link.
+ *
+ * Select it with `USEMODULE += gnrc_rpl_mrhof` and
+ * `CFLAGS += -DGNRC_RPL_DEFAULT_OCP=GNRC_RPL_MRHOF_OCP` on the root.
+ * @{
+ *
+ * @file
+ * @brief       Definitions for MRHOF
+ */
+#ifndef NET_GNRC_RPL_MRHOF_H
+#define NET_GNRC_RPL_MRHOF_H
+
+#include "net/gnrc/rpl/structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Objective code point of MRHOF
+ */
+#define GNRC_RPL_MRHOF_OCP                      (0x1)
+
+/**
+ * @brief   Maximum link metric to consider a parent usable
+ */
+#ifndef GNRC_RPL_MRHOF_MAX_LINK_METRIC
+#define GNRC_RPL_MRHOF_MAX_LINK_METRIC          (512U)
+#endif
+
+/**
+ * @brief   Maximum path cost
+ */
+#ifndef GNRC_RPL_MRHOF_MAX_PATH_COST
+#define GNRC_RPL_MRHOF_MAX_PATH_COST            (32768U)
+#endif
+
+/**
+ * @brief   Path cost a new parent must undercut the preferred parent's by
+ */
+#ifndef GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD
+#define GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD  (192U)
+#endif
+
+/**
+ * @brief   Return the address to the MRHOF objective function
+ *
+ * @return  Address of the MRHOF objective function
+ */
+gnrc_rpl_of_t *gnrc_rpl_get_of_mrhof(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_RPL_MRHOF_H */
+/** @} */
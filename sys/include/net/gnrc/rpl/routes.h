@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_rpl_routes RPL downward route store
+ * @ingroup     net_gnrc_rpl
+ * @brief       Compact store for the downward routes learned from DAOs
+ *
+ * Without this module, gnrc_rpl installs one forwarding table entry in the
+ * @ref net_gnrc_ipv6_nib "NIB" per DAO target, so the number of nodes below
+ * a router is limited by @ref GNRC_IPV6_NIB_OFFL_NUMOF and every look-up
+ * compares all off-link entries. With this module the targets are kept in a
+ * separate store instead:
+ *
+ * - Each target maps to its parent, i.e. the next hop for routes learned in
+ *   storing mode, or the DAO parent advertised in the Transit Information
+ *   option for routes learned in non-storing mode.
+ * - The upper 64 bit of all addresses are kept in a small table of
+ *   prefixes, so an entry only holds the interface identifier, the index of
+ *   its prefix and the index of its parent.
+ * - Host routes are found with a hash index over the interface identifier,
+ *   routes to shorter prefixes with a separate list.
+ * - Expired entries are reused without a timer.
+ *
+ * The NIB consults the store for routes before its own forwarding table.
+ * The chain of parents of a non-storing target is the source route
+ * @ref gnrc_rpl_srh_build() puts into a source routing header.
+ * @{
+ *
+ * @file
+ * @brief       RPL downward route store definitions
+ */
+#ifndef NET_GNRC_RPL_ROUTES_H
+#define NET_GNRC_RPL_ROUTES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kernel_types.h"
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    Compile time configuration
+ * @{
+ */
+/**
+ * @brief   Number of entries in the store
+ *
+ * Each target and each parent that is not a target itself takes an entry.
+ */
+#ifndef GNRC_RPL_ROUTES_NUMOF
+#define GNRC_RPL_ROUTES_NUMOF           (32)
+#endif
+
+/**
+ * @brief   Number of buckets in the hash index over the entries
+ *
+ * Must be a power of two. Defaults to the smallest power of two not smaller
+ * than @ref GNRC_RPL_ROUTES_NUMOF (but at most 1024).
+ */
+#ifndef GNRC_RPL_ROUTES_HASH_NUMOF
+#if GNRC_RPL_ROUTES_NUMOF <= 8
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (8)
+#elif GNRC_RPL_ROUTES_NUMOF <= 16
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (16)
+#elif GNRC_RPL_ROUTES_NUMOF <= 32
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (32)
+#elif GNRC_RPL_ROUTES_NUMOF <= 64
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (64)
+#elif GNRC_RPL_ROUTES_NUMOF <= 128
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (128)
+#elif GNRC_RPL_ROUTES_NUMOF <= 256
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (256)
+#elif GNRC_RPL_ROUTES_NUMOF <= 512
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (512)
+#else
+#define GNRC_RPL_ROUTES_HASH_NUMOF      (1024)
+#endif
+#endif
+
+/**
+ * @brief   Number of distinct prefixes (upper 64 bit) of all addresses
+ *
+ * Usually the link-local prefix and the prefix of the DODAG, plus one per
+ * external prefix advertised in DAOs.
+ */
+#ifndef GNRC_RPL_ROUTES_PFX_NUMOF
+#define GNRC_RPL_ROUTES_PFX_NUMOF       (4)
+#endif
+/** @} */
+
+/**
+ * @brief   Modes of a route
+ */
+enum {
+    GNRC_RPL_ROUTES_STORING = 0,    /**< parent is the next hop */
+    GNRC_RPL_ROUTES_NON_STORING,    /**< parent is the DAO parent */
+};
+
+/**
+ * @brief   Route representation
+ */
+typedef struct {
+    ipv6_addr_t dst;        /**< destination prefix */
+    ipv6_addr_t parent;     /**< next hop or DAO parent of gnrc_rpl_route_t::dst */
+    uint32_t ltime;         /**< remaining lifetime in seconds */
+    kernel_pid_t iface;     /**< interface to gnrc_rpl_route_t::parent */
+    uint8_t dst_len;        /**< length of gnrc_rpl_route_t::dst in bits */
+    uint8_t mode;           /**< GNRC_RPL_ROUTES_STORING or
+                             *   GNRC_RPL_ROUTES_NON_STORING */
+} gnrc_rpl_route_t;
+
+/**
+ * @brief   Usage statistics of the store
+ */
+typedef struct {
+    unsigned routes;        /**< number of valid routes */
+    unsigned entries;       /**< number of entries in use (incl. parents) */
+    unsigned pfxs;          /**< number of prefixes in use */
+    size_t size;            /**< RAM used by the store in bytes */
+} gnrc_rpl_routes_stats_t;
+
+/**
+ * @brief   Removes all routes
+ */
+void gnrc_rpl_routes_init(void);
+
+/**
+ * @brief   Adds or replaces the route to a destination
+ *
+ * @pre `(dst != NULL) && (parent != NULL) && (dst_len > 0)`
+ *
+ * @param[in] dst       Destination prefix.
+ * @param[in] dst_len   Length of @p dst in bits.
+ * @param[in] parent    Next hop (@ref GNRC_RPL_ROUTES_STORING) or DAO parent
+ *                      (@ref GNRC_RPL_ROUTES_NON_STORING) of @p dst.
+ * @param[in] iface     Interface to @p parent.
+ * @param[in] mode      Mode of the route.
+ * @param[in] ltime     Lifetime of the route in seconds.
+ *
+ * @return  0, on success.
+ * @return  -ENOMEM, if the store is full.
+ * @return  -ENOSPC, if the table of prefixes is full.
+ */
+int gnrc_rpl_routes_add(const ipv6_addr_t *dst, uint8_t dst_len,
+                        const ipv6_addr_t *parent, kernel_pid_t iface,
+                        uint8_t mode, uint32_t ltime);
+
+/**
+ * @brief   Removes the route to a destination
+ *
+ * @pre `dst != NULL`
+ *
+ * @param[in] dst       Destination prefix.
+ * @param[in] dst_len   Length of @p dst in bits.
+ */
+void gnrc_rpl_routes_del(const ipv6_addr_t *dst, uint8_t dst_len);
+
+/**
+ * @brief   Gets the route with the longest prefix matching a destination
+ *
+ * @pre `(dst != NULL) && (route != NULL)`
+ *
+ * @param[in] dst       A destination address.
+ * @param[out] route    The route to @p dst.
+ *
+ * @return  0, on success.
+ * @return  -ENOENT, if there is no route to @p dst.
+ */
+int gnrc_rpl_routes_get(const ipv6_addr_t *dst, gnrc_rpl_route_t *route);
+
+/**
+ * @brief   Gets the DAO parent of a destination in non-storing mode
+ *
+ * Only considers host routes, as source routes lead to hosts.
+ *
+ * @pre `(addr != NULL) && (parent != NULL)`
+ *
+ * @param[in] addr      An address.
+ * @param[out] parent   The DAO parent of @p addr.
+ *
+ * @return  0, on success.
+ * @return  -ENOENT, if @p addr has no parent, e.g. because it is the root.
+ */
+int gnrc_rpl_routes_get_parent(const ipv6_addr_t *addr, ipv6_addr_t *parent);
+
+/**
+ * @brief   Iterates over all valid routes
+ *
+ * @pre `(state != NULL) && (route != NULL)`
+ *
+ * @param[in] iface     Restrict iteration to routes over this interface.
+ *                      KERNEL_PID_UNDEF for any interface.
+ * @param[in,out] state Iteration state. Must point to a NULL pointer to start
+ *                      iteration.
+ * @param[out] route    The next route.
+ *
+ * @return  true, if @p route was set.
+ * @return  false, if there are no more routes.
+ */
+bool gnrc_rpl_routes_iter(kernel_pid_t iface, void **state,
+                          gnrc_rpl_route_t *route);
+
+/**
+ * @brief   Gets the usage statistics of the store
+ *
+ * @pre `stats != NULL`
+ *
+ * @param[out] stats    The statistics.
+ */
+void gnrc_rpl_routes_get_stats(gnrc_rpl_routes_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_RPL_ROUTES_H */
+/** @} */
@@ -23,6 +23,8 @@
 #ifndef NET_GNRC_RPL_SRH_H
 #define NET_GNRC_RPL_SRH_H
 
+#include <stddef.h>
+
 #include "net/ipv6/hdr.h"
 #include "net/ipv6/addr.h"
 
@@ -69,6 +71,36 @@ typedef struct __attribute__((packed)) {
  */
 int gnrc_rpl_srh_process(ipv6_hdr_t *ipv6, gnrc_rpl_srh_t *rh, void **err_ptr);
 
+#if defined(MODULE_GNRC_RPL_ROUTES) || defined(DOXYGEN)
+/**
+ * @brief   Builds the RPL source routing header for a destination
+ *
+ * The path is the chain of DAO parents from @p dst up to @p root stored in
+ * the @ref net_gnrc_rpl_routes "RPL downward route store". Addresses are
+ * elided by the longest common prefix with @p first_hop, as far as
+ * RFC 6554 allows.
+ *
+ * @pre `(root != NULL) && (dst != NULL) && (first_hop != NULL)`
+ *
+ * @param[in] root          Address of the DODAG root, i.e. of this node.
+ * @param[in] dst           Final destination.
+ * @param[out] first_hop    Destination for the IPv6 header.
+ * @param[out] rh           Buffer for the routing header. gnrc_rpl_srh_t::nh
+ *                          is left 0.
+ * @param[in] max_len       Size of @p rh. It must fit the header with
+ *                          uncompressed addresses.
+ *
+ * @return  Length of the routing header in bytes, on success.
+ * @return  0, if @p dst is a child of @p root, @p first_hop is @p dst then.
+ * @return  -EHOSTUNREACH, if the path to @p dst is not complete.
+ * @return  -ELOOP, if the path to @p dst contains a loop.
+ * @return  -ENOBUFS, if @p max_len is too small.
+ */
+int gnrc_rpl_srh_build(const ipv6_addr_t *root, const ipv6_addr_t *dst,
+                       ipv6_addr_t *first_hop, gnrc_rpl_srh_t *rh,
+                       size_t max_len);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
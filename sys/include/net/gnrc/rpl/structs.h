@@ -59,6 +59,14 @@ extern "C" {
 #define GNRC_RPL_DAO_ACK_D_BIT              (1 << 7)
 /** @} */
 
+/**
+ * @brief   Lowest DAO-ACK status that rejects the DAO
+ * @see <a href="https://tools.ietf.org/html/rfc6550#section-6.5">
+ *          RFC6550, section 6.5
+ *      </a>
+ */
+#define GNRC_RPL_DAO_ACK_STATUS_REJECT      (128)
+
 /**
  * @anchor GNRC_RPL_REQ_DIO_OPTS
  * @name DIO Options for gnrc_rpl_dodag_t::dio_opts
@@ -328,6 +336,11 @@ struct gnrc_rpl_dodag {
     uint8_t dao_seq;                /**< dao sequence number */
     uint8_t dao_counter;            /**< amount of retried DAOs */
     bool dao_ack_received;          /**< flag to check for DAO-ACK */
+    bool dao_batching;              /**< DAO is scheduled and collects changes */
+    uint8_t dao_batch_seq;          /**< sequence of the first DAO sent at once */
+    uint8_t dao_batch_len;          /**< number of DAOs sent at once */
+    uint32_t dao_acks_pending;      /**< DAOs sent at once still waiting for a
+                                         DAO-ACK, as bitmap */
     uint8_t dio_opts;               /**< options in the next DIO
                                          (see @ref GNRC_RPL_REQ_DIO_OPTS "DIO Options") */
     evtimer_msg_event_t dao_event;  /**< DAO TX events (see @ref GNRC_RPL_MSG_TYPE_DODAG_DAO_TX) */
@@ -71,6 +71,19 @@ extern "C" {
 #define GNRC_SIXLOWPAN_FRAG_RBUF_SIZE       (4U)
 #endif
 
+/**
+ * @brief   Number of hash buckets to look up reassembly buffer entries
+ *
+ * Must be a power of two. Should be in the order of
+ * @ref GNRC_SIXLOWPAN_FRAG_RBUF_SIZE to keep look-ups close to constant time.
+ *
+ * @note    Only applicable with
+ *          [gnrc_sixlowpan_frag](@ref net_gnrc_sixlowpan_frag) module
+ */
+#ifndef GNRC_SIXLOWPAN_FRAG_RBUF_HASH_SIZE
+#define GNRC_SIXLOWPAN_FRAG_RBUF_HASH_SIZE  (4U)
+#endif
+
 /**
  * @brief   Timeout for reassembly buffer entries in microseconds
  *
@@ -28,6 +28,7 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include "bitfield.h"
 #include "byteorder.h"
 #include "msg.h"
 #include "net/gnrc/pkt.h"
@@ -59,23 +60,22 @@ extern "C" {
 /** @} */
 
 /**
- * @brief   Fragment intervals to identify limits of fragments and duplicates.
+ * @brief   Granularity of fragment offsets in bytes
  *
- * @note    Fragments MUST NOT overlap and overlapping fragments are to be
- *          discarded
+ * Fragment offsets are expressed in units of 8 octets, so received parts of
+ * a datagram are tracked with that granularity.
  *
  * @see <a href="https://tools.ietf.org/html/rfc4944#section-5.3">
  *          RFC 4944, section 5.3
  *      </a>
  */
-typedef struct gnrc_sixlowpan_rbuf_int {
-    /**
-     * @brief   next element in fragment interval list
-     */
-    struct gnrc_sixlowpan_rbuf_int *next;
-    uint16_t start;             /**< start byte of the fragment interval */
-    uint16_t end;               /**< end byte of the fragment interval */
-} gnrc_sixlowpan_rbuf_int_t;
+#define GNRC_SIXLOWPAN_FRAG_RBUF_UNIT       (8U)
+
+/**
+ * @brief   Number of fragment offset units a datagram can span
+ */
+#define GNRC_SIXLOWPAN_FRAG_RBUF_UNITS      ((SIXLOWPAN_FRAG_SIZE_MASK + 1U) / \
+                                             GNRC_SIXLOWPAN_FRAG_RBUF_UNIT)
 
 /**
  * @brief   Base class for both reassembly buffer and virtual reassembly buffer
@@ -91,7 +91,20 @@ typedef struct gnrc_sixlowpan_rbuf_int {
  * @see https://tools.ietf.org/html/draft-ietf-lwig-6lowpan-virtual-reassembly-01
  */
 typedef struct {
-    gnrc_sixlowpan_rbuf_int_t *ints;            /**< intervals of already received fragments */
+    /**
+     * @brief   Fragment offset units of the datagram already received
+     *
+     * @note    Fragments MUST NOT overlap and overlapping fragments are to be
+     *          discarded
+     */
+    BITFIELD(received, GNRC_SIXLOWPAN_FRAG_RBUF_UNITS);
+    /**
+     * @brief   Fragment offset units at which a received fragment starts
+     *
+     * Together with gnrc_sixlowpan_rbuf_base_t::received this allows to tell
+     * duplicates apart from partially overlapping fragments.
+     */
+    BITFIELD(starts, GNRC_SIXLOWPAN_FRAG_RBUF_UNITS);
     uint8_t src[IEEE802154_LONG_ADDRESS_LEN];   /**< source address */
     uint8_t dst[IEEE802154_LONG_ADDRESS_LEN];   /**< destination address */
     uint8_t src_len;                            /**< length of gnrc_sixlowpan_rbuf_t::src */
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_netstats_neighbor Neighbor statistics
+ * @ingroup     net_netstats
+ * @brief       Per-neighbor link statistics and ETX estimation
+ *
+ * The link layer records the destination of every unicast frame it hands to
+ * the device and reports the outcome of the transmission once the device
+ * signals it. From the number of transmissions each frame needed an
+ * exponentially weighted moving average of the expected transmission count
+ * (ETX) of the link to the neighbor is derived.
+ *
+ * The table keeps the @ref NETSTATS_NB_SIZE neighbors used most recently.
+ * @{
+ *
+ * @file
+ * @brief       Definitions for neighbor statistics
+ */
+#ifndef NET_NETSTATS_NEIGHBOR_H
+#define NET_NETSTATS_NEIGHBOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of neighbors tracked per interface
+ */
+#ifndef NETSTATS_NB_SIZE
+#define NETSTATS_NB_SIZE                (8U)
+#endif
+
+/**
+ * @brief   Maximum length of a link-layer address
+ */
+#ifndef NETSTATS_NB_L2ADDR_MAXLEN
+#define NETSTATS_NB_L2ADDR_MAXLEN       (8U)
+#endif
+
+/**
+ * @brief   Fixed point divisor of netstats_nb_t::etx
+ *
+ * This is the encoding of the ETX metric in RPL (RFC 6551, section 4.3.2).
+ */
+#define NETSTATS_NB_ETX_DIVISOR         (128U)
+
+/**
+ * @brief   ETX of a neighbor without any transmissions yet
+ */
+#ifndef NETSTATS_NB_ETX_INIT
+#define NETSTATS_NB_ETX_INIT            (2U * NETSTATS_NB_ETX_DIVISOR)
+#endif
+
+/**
+ * @brief   ETX sample for a frame that was not acknowledged at all
+ */
+#ifndef NETSTATS_NB_ETX_NOACK
+#define NETSTATS_NB_ETX_NOACK           (8U * NETSTATS_NB_ETX_DIVISOR)
+#endif
+
+/**
+ * @brief   Weight of a new ETX sample [in percent]
+ */
+#ifndef NETSTATS_NB_EWMA_ALPHA
+#define NETSTATS_NB_EWMA_ALPHA          (15U)
+#endif
+
+/**
+ * @brief   Weight of a new ETX sample while the estimate is not fresh yet
+ *          [in percent]
+ *
+ * Lets the estimate converge quickly for new neighbors.
+ */
+#ifndef NETSTATS_NB_EWMA_ALPHA_FAST
+#define NETSTATS_NB_EWMA_ALPHA_FAST     (50U)
+#endif
+
+/**
+ * @brief   Number of samples after which an estimate is fresh
+ */
+#ifndef NETSTATS_NB_FRESHNESS
+#define NETSTATS_NB_FRESHNESS           (4U)
+#endif
+
+/**
+ * @brief   Outcome of a transmission
+ */
+typedef enum {
+    NETSTATS_NB_SUCCESS,        /**< frame was acknowledged */
+    NETSTATS_NB_NOACK,          /**< frame was not acknowledged */
+    NETSTATS_NB_BUSY,           /**< frame was not sent, medium was busy */
+} netstats_nb_result_t;
+
+/**
+ * @brief   Statistics of a single neighbor
+ */
+typedef struct {
+    uint8_t l2addr[NETSTATS_NB_L2ADDR_MAXLEN];  /**< link-layer address */
+    uint8_t l2addr_len;         /**< length of l2addr, 0 if entry is unused */
+    uint8_t freshness;          /**< number of ETX samples, saturates */
+    uint16_t etx;               /**< ETX in 1/@ref NETSTATS_NB_ETX_DIVISOR */
+    uint32_t last_used;         /**< netstats_nb_table_t::clock of last use */
+    uint32_t tx_count;          /**< frames sent to the neighbor */
+    uint32_t tx_failed;         /**< frames not acknowledged */
+} netstats_nb_t;
+
+/**
+ * @brief   Neighbor statistics of an interface
+ */
+typedef struct {
+    netstats_nb_t entries[NETSTATS_NB_SIZE];    /**< the neighbors */
+    netstats_nb_t *pending;     /**< neighbor of the frame in transmission */
+    uint32_t clock;             /**< logical clock for the LRU replacement */
+} netstats_nb_table_t;
+
+/**
+ * @brief   Initializes a neighbor table
+ *
+ * @param[out] table    The table.
+ */
+void netstats_nb_init(netstats_nb_table_t *table);
+
+/**
+ * @brief   Records the destination of the frame handed to the device next
+ *
+ * @param[in,out] table     The table.
+ * @param[in] l2addr        Link-layer destination. NULL for multicast frames,
+ *                          those are not accounted for.
+ * @param[in] l2addr_len    Length of @p l2addr.
+ */
+void netstats_nb_record(netstats_nb_table_t *table, const uint8_t *l2addr,
+                        unsigned l2addr_len);
+
+/**
+ * @brief   Accounts the outcome of the transmission of the frame recorded
+ *          last with netstats_nb_record()
+ *
+ * @param[in,out] table     The table.
+ * @param[in] result        Outcome of the transmission.
+ * @param[in] retries       Number of retransmissions the frame needed.
+ *
+ * @return  The updated neighbor.
+ * @return  NULL, if no unicast frame was in transmission.
+ */
+netstats_nb_t *netstats_nb_update_tx(netstats_nb_table_t *table,
+                                     netstats_nb_result_t result,
+                                     unsigned retries);
+
+/**
+ * @brief   Gets the statistics of a neighbor
+ *
+ * @param[in] table         The table.
+ * @param[in] l2addr        Link-layer address of the neighbor.
+ * @param[in] l2addr_len    Length of @p l2addr.
+ * @param[out] nb           Copy of the neighbor's statistics.
+ *
+ * @return  true, if the neighbor is in the table.
+ */
+bool netstats_nb_get(const netstats_nb_table_t *table, const uint8_t *l2addr,
+                     unsigned l2addr_len, netstats_nb_t *nb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_NETSTATS_NEIGHBOR_H */
+/** @} */
@@ -67,6 +67,10 @@ typedef struct {
     uint32_t dao_ack_tx_ucast_bytes;    /**< unicast dao_ack sent in bytes */
     uint32_t dao_ack_tx_mcast_count;    /**< multicast dao_ack sent in packets */
     uint32_t dao_ack_tx_mcast_bytes;    /**< multicast dao_ack sent in bytes*/
+    /* DAO scheduling */
+    uint32_t dao_tx_target_count;       /**< targets announced in sent dao */
+    uint32_t dao_retx_count;            /**< dao sent again for a missing dao_ack */
+    uint32_t dao_no_ack_count;          /**< dao given up on without dao_ack */
 } netstats_rpl_t;
 
 #ifdef __cplusplus
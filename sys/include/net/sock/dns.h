@@ -12,6 +12,13 @@
  *
  * @brief       Sock DNS client
  *
+ * The following submodules extend the client:
+ *
+ * - `sock_dns_cache`: caches answers and failed look-ups for the
+ *   time-to-live given by the server (@ref SOCK_DNS_CACHE_SIZE entries)
+ * - `sock_dns_async`: provides @ref sock_dns_query_async(), which runs
+ *   look-ups in a resolver thread so several can be in flight at once
+ *
  * @{
  *
  * @file
@@ -51,6 +58,7 @@ typedef struct {
  * @{
  */
 #define DNS_TYPE_A              (1)
+#define DNS_TYPE_SOA            (6)
 #define DNS_TYPE_AAAA           (28)
 #define DNS_CLASS_IN            (1)
 
@@ -58,9 +66,75 @@ typedef struct {
 #define SOCK_DNS_RETRIES        (2)
 
 #define SOCK_DNS_MAX_NAME_LEN   (64U)       /* we're in embedded context. */
-#define SOCK_DNS_QUERYBUF_LEN   (sizeof(sock_dns_hdr_t) + 4 + SOCK_DNS_MAX_NAME_LEN)
+/* header, encoded name, type and class of a single question */
+#define SOCK_DNS_QUERYBUF_LEN   (sizeof(sock_dns_hdr_t) + 4 + \
+                                 SOCK_DNS_MAX_NAME_LEN + 2)
 /** @} */
 
+/**
+ * @brief   Timeout for a reply to a query in microseconds
+ */
+#ifndef SOCK_DNS_TIMEOUT_US
+#define SOCK_DNS_TIMEOUT_US     (1000000LU)
+#endif
+
+/**
+ * @brief   Number of entries in the DNS cache
+ *
+ * @note    Only used with module `sock_dns_cache`
+ */
+#ifndef SOCK_DNS_CACHE_SIZE
+#define SOCK_DNS_CACHE_SIZE     (8U)
+#endif
+
+/**
+ * @brief   Time in seconds a failed look-up is cached if the reply carried no
+ *          SOA record to take the negative TTL from (see RFC 2308)
+ *
+ * @note    Only used with module `sock_dns_cache`
+ */
+#ifndef SOCK_DNS_CACHE_NEG_TTL
+#define SOCK_DNS_CACHE_NEG_TTL  (60U)
+#endif
+
+/**
+ * @brief   Number of asynchronous look-ups that can be in flight at once
+ *
+ * @note    Only used with module `sock_dns_async`
+ */
+#ifndef SOCK_DNS_ASYNC_NUMOF
+#define SOCK_DNS_ASYNC_NUMOF    (4U)
+#endif
+
+/**
+ * @brief   Stack size of the resolver thread
+ *
+ * @note    Only used with module `sock_dns_async`
+ */
+#ifndef SOCK_DNS_ASYNC_STACKSIZE
+#define SOCK_DNS_ASYNC_STACKSIZE    (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief   Priority of the resolver thread
+ *
+ * @note    Only used with module `sock_dns_async`
+ */
+#ifndef SOCK_DNS_ASYNC_PRIO
+#define SOCK_DNS_ASYNC_PRIO     (THREAD_PRIORITY_MAIN - 1)
+#endif
+
+/**
+ * @brief   Callback for an asynchronous look-up
+ *
+ * @param[in] res   Length of @p addr (4 for an A record, 16 for an AAAA
+ *                  record) on success, a negative errno on error (see
+ *                  @ref sock_dns_query() for the possible values).
+ * @param[in] addr  The resolved address. Only valid during the call.
+ * @param[in] arg   Argument given to @ref sock_dns_query_async().
+ */
+typedef void (*sock_dns_cb_t)(int res, const void *addr, void *arg);
+
 /**
  * @brief Get IP address for DNS name
  *
@@ -68,11 +142,15 @@ typedef struct {
  * the DNS server specified in the global variable @ref sock_dns_server.
  *
  * By supplying AF_INET, AF_INET6 or AF_UNSPEC in @p family requesting of A
- * records (IPv4), AAAA records (IPv6) or both can be selected.
+ * records (IPv4), AAAA records (IPv6) or both can be selected. With AF_UNSPEC
+ * both queries are sent at once, each with its own random transaction ID.
  *
  * This function will return the first DNS record it receives. IF both A and
  * AAAA are requested, AAAA will be preferred.
  *
+ * With module `sock_dns_cache` answers and failed look-ups are cached for the
+ * time-to-live given by the server.
+ *
  * @note @p addr_out needs to provide space for any possible result!
  *       (4byte when family==AF_INET, 16byte otherwise)
  *
@@ -80,11 +158,52 @@ typedef struct {
  * @param[out]  addr_out        buffer to write result into
  * @param[in]   family          Either AF_INET, AF_INET6 or AF_UNSPEC
  *
- * @return      0 on success
- * @return      !=0 otherwise
+ * @return      the length of the address in @p addr_out on success
+ * @return      -ECONNREFUSED, if no DNS server is configured
+ * @return      -ENOSPC, if @p domain_name is too long
+ * @return      -ENOENT, if @p domain_name has no record of the requested type
+ * @return      -EBADMSG, if the server sent a malformed or erroneous reply
+ * @return      -ETIMEDOUT, if the server did not reply
+ * @return      other negative errno, if sending the query failed
  */
 int sock_dns_query(const char *domain_name, void *addr_out, int family);
 
+/**
+ * @brief   Get IP address for DNS name without blocking
+ *
+ * Works like @ref sock_dns_query(), but returns as soon as the queries are
+ * sent. The result is reported to @p cb, which is called exactly once for
+ * every accepted look-up. Up to @ref SOCK_DNS_ASYNC_NUMOF look-ups can be in
+ * flight at the same time.
+ *
+ * @note    Only available with module `sock_dns_async`
+ * @note    @p cb is called in the context of the resolver thread, or in the
+ *          context of the caller before this function returns if the answer
+ *          is cached.
+ *
+ * @param[in]   domain_name     DNS name to resolve into address
+ * @param[in]   family          Either AF_INET, AF_INET6 or AF_UNSPEC
+ * @param[in]   cb              Callback for the result. Must not be NULL.
+ * @param[in]   arg             Argument for @p cb
+ *
+ * @return      0, if the look-up was accepted
+ * @return      -ECONNREFUSED, if no DNS server is configured
+ * @return      -ENOSPC, if @p domain_name is too long
+ * @return      -ENOMEM, if @ref SOCK_DNS_ASYNC_NUMOF look-ups are in flight
+ * @return      other negative errno, if sending the queries failed
+ */
+int sock_dns_query_async(const char *domain_name, int family,
+                         sock_dns_cb_t cb, void *arg);
+
+/**
+ * @brief   Removes all entries from the DNS cache
+ *
+ * Call this e.g. after changing @ref sock_dns_server.
+ *
+ * @note    Only available with module `sock_dns_cache`
+ */
+void sock_dns_cache_flush(void);
+
 /**
  * @brief global DNS server endpoint
  */
@@ -273,6 +273,7 @@
 #include <stdlib.h>
 #include <sys/types.h>
 
+#include "iolist.h"
 #include "net/sock.h"
 
 #ifdef __cplusplus
@@ -450,6 +451,36 @@ ssize_t sock_ip_recv(sock_ip_t *sock, void *data, size_t max_len,
 ssize_t sock_ip_send(sock_ip_t *sock, const void *data, size_t len,
                      uint8_t proto, const sock_ip_ep_t *remote);
 
+/**
+ * @brief   Sends a message, gathered from several buffers, over IPv4/IPv6 to
+ *          remote end point
+ *
+ * The payload is the concatenation of all entries of @p snips. It is copied
+ * exactly once, directly into the network stack's packet buffer.
+ *
+ * @pre `((sock != NULL || remote != NULL))`
+ * @pre `(if (snips->iol_len != 0): (snips->iol_base != NULL))` for all
+ *      entries of @p snips
+ *
+ * @param[in] sock      A raw IPv4/IPv6 sock object. May be NULL.
+ *                      A sensible local end point should be selected by the
+ *                      implementation in that case.
+ * @param[in] snips     List of payload fragments. May be `NULL` for an empty
+ *                      payload.
+ * @param[in] proto     Protocol to use in the packet sent, in case
+ *                      `sock == NULL`. If `sock != NULL` this parameter will be
+ *                      ignored.
+ * @param[in] remote    Remote end point for the sent data.
+ *                      May be `NULL`, if @p sock has a remote end point.
+ *                      sock_ip_ep_t::family may be AF_UNSPEC, if local
+ *                      end point of @p sock provides this information.
+ *
+ * @return  The number of bytes sent on success.
+ * @return  The same errors as @ref sock_ip_send().
+ */
+ssize_t sock_ip_sendv(sock_ip_t *sock, const iolist_t *snips, uint8_t proto,
+                      const sock_ip_ep_t *remote);
+
 #include "sock_types.h"
 
 #ifdef __cplusplus
@@ -273,6 +273,7 @@
 #include <stdlib.h>
 #include <sys/types.h>
 
+#include "iolist.h"
 #include "net/sock.h"
 
 #ifdef __cplusplus
@@ -402,6 +403,99 @@ int sock_udp_get_remote(sock_udp_t *sock, sock_udp_ep_t *ep);
 ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
                       uint32_t timeout, sock_udp_ep_t *remote);
 
+/**
+ * @brief   Provides stack-internal buffer space containing a UDP message from
+ *          a remote end point
+ *
+ * Unlike @ref sock_udp_recv() the received data is not copied, but @p data
+ * is pointed to the buffer of the stack. Call this function again with the
+ * same @p buf_ctx to release the buffer (it then returns 0):
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * void *data, *ctx = NULL;
+ * ssize_t res;
+ *
+ * while ((res = sock_udp_recv_buf(&sock, &data, &ctx, SOCK_NO_TIMEOUT,
+ *                                 NULL)) > 0) {
+ *     handle_data(data, res);
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @pre `(sock != NULL) && (data != NULL) && (buf_ctx != NULL)`
+ *
+ * @param[in] sock      A UDP sock object.
+ * @param[out] data     Pointer to the stack-internal buffer space containing
+ *                      the received data.
+ * @param[in,out] buf_ctx   Stack-internal buffer context. If it points to a
+ *                      `NULL` pointer, a new message is received. Otherwise
+ *                      the buffer of the message received before is released
+ *                      and the pointer it points to is set to `NULL`.
+ * @param[in] timeout   Timeout for receive in microseconds.
+ *                      If 0 and no data is available, the function returns
+ *                      immediately.
+ *                      May be @ref SOCK_NO_TIMEOUT for no timeout (wait until
+ *                      data is available).
+ * @param[out] remote   Remote end point of the received data.
+ *                      May be `NULL`, if it is not required by the application.
+ *
+ * @warning The buffer space at @p data is only valid until the buffer is
+ *          released.
+ *
+ * @return  The number of bytes received on success.
+ * @return  0, if the buffer of @p buf_ctx was released.
+ * @return  -EADDRNOTAVAIL, if local of @p sock is not given.
+ * @return  -EAGAIN, if @p timeout is `0` and no data is available.
+ * @return  -EINVAL, if @p remote is invalid or @p sock is not properly
+ *          initialized (or closed while sock_udp_recv_buf() blocks).
+ * @return  -ENOMEM, if no memory was available to receive @p data.
+ * @return  -EPROTO, if source address of received packet did not equal
+ *          the remote of @p sock.
+ * @return  -ETIMEDOUT, if @p timeout expired.
+ */
+ssize_t sock_udp_recv_buf(sock_udp_t *sock, void **data, void **buf_ctx,
+                          uint32_t timeout, sock_udp_ep_t *remote);
+
+/**
+ * @brief   A UDP message received with @ref sock_udp_recv_batch()
+ */
+typedef struct {
+    void *data;             /**< stack-internal buffer containing the message */
+    size_t len;             /**< length of sock_udp_dgram_t::data */
+    void *buf_ctx;          /**< stack-internal buffer context */
+    sock_udp_ep_t remote;   /**< remote end point of the message */
+} sock_udp_dgram_t;
+
+/**
+ * @brief   Receives multiple UDP messages with one call
+ *
+ * Waits for the first message like @ref sock_udp_recv_buf() and then takes
+ * all further messages that are already waiting at @p sock without
+ * blocking, up to @p numof. Messages that are rejected with -EPROTO are
+ * dropped.
+ *
+ * The buffer of each received message must be released with
+ * @ref sock_udp_recv_buf() (using sock_udp_dgram_t::buf_ctx).
+ *
+ * @pre `(sock != NULL) && (dgrams != NULL) && (numof > 0)`
+ *
+ * @param[in] sock      A UDP sock object.
+ * @param[out] dgrams   Array for the received messages.
+ * @param[in] numof     Number of elements in @p dgrams.
+ * @param[in] timeout   Timeout for the first message in microseconds,
+ *                      including the time spent on messages that are dropped
+ *                      because they are not from the remote of @p sock.
+ *                      If 0 and no data is available, the function returns
+ *                      immediately.
+ *                      May be @ref SOCK_NO_TIMEOUT for no timeout (wait until
+ *                      data is available).
+ *
+ * @return  The number of messages received on success.
+ * @return  The errors of @ref sock_udp_recv_buf(), if not even one message
+ *          was received.
+ */
+int sock_udp_recv_batch(sock_udp_t *sock, sock_udp_dgram_t *dgrams,
+                        unsigned numof, uint32_t timeout);
+
 /**
  * @brief   Sends a UDP message to remote end point
  *
@@ -438,6 +532,35 @@ ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
 ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
                       const sock_udp_ep_t *remote);
 
+/**
+ * @brief   Sends a UDP message, gathered from several buffers, to remote end
+ *          point
+ *
+ * The payload is the concatenation of all entries of @p snips. It is copied
+ * exactly once, directly into the network stack's packet buffer, so the
+ * caller does not need to assemble it in a staging buffer first.
+ *
+ * @pre `((sock != NULL || remote != NULL))`
+ * @pre `(if (snips->iol_len != 0): (snips->iol_base != NULL))` for all
+ *      entries of @p snips
+ *
+ * @param[in] sock      A UDP sock object. May be `NULL`.
+ *                      A sensible local end point should be selected by the
+ *                      implementation in that case.
+ * @param[in] snips     List of payload fragments. May be `NULL` for an empty
+ *                      payload.
+ * @param[in] remote    Remote end point for the sent data.
+ *                      May be `NULL`, if @p sock has a remote end point.
+ *                      sock_udp_ep_t::family may be AF_UNSPEC, if local
+ *                      end point of @p sock provides this information.
+ *                      sock_udp_ep_t::port may not be 0.
+ *
+ * @return  The number of bytes sent on success.
+ * @return  The same errors as @ref sock_udp_send().
+ */
+ssize_t sock_udp_sendv(sock_udp_t *sock, const iolist_t *snips,
+                       const sock_udp_ep_t *remote);
+
 #include "sock_types.h"
 
 #ifdef __cplusplus
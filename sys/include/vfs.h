@@ -30,8 +30,11 @@
  * POSIX file functions (open, close, read, write, fstat, lseek etc.)
  *
  * The VFS layer keeps track of mounted file systems and open files, the
- * `vfs_open` function searches the array of mounted file systems and dispatches
+ * `vfs_open` function searches the tree of mounted file systems and dispatches
  * the call to the file system instance with the longest matching mount point prefix.
+ * Mount points are arranged by prefix, so the search only visits the mounts
+ * along the path of the file name and their siblings. It does not take a lock,
+ * opening files on different mounts does not serialize.
  * Subsequent calls to `vfs_read`, `vfs_write`, etc will do a look up in the
  * table of open files and dispatch the call to the correct file system driver
  * for handling.
@@ -67,6 +70,7 @@ using std::atomic_int;
 #include <sys/stat.h> /* for struct stat */
 #include <sys/types.h> /* for off_t etc. */
 #include <sys/statvfs.h> /* for struct statvfs */
+#include <sys/uio.h> /* for struct iovec */
 
 #include "kernel_types.h"
 #include "clist.h"
@@ -194,6 +198,9 @@ typedef struct {
  */
 struct vfs_mount_struct {
     clist_node_t list_entry;     /**< List entry for the _vfs_mount_list list */
+    vfs_mount_t *parent;         /**< Closest mount that contains this mount point (set by vfs_mount) */
+    vfs_mount_t *child;          /**< First mount below this mount point (set by vfs_mount) */
+    vfs_mount_t *sibling;        /**< Next mount with the same parent (set by vfs_mount) */
     const vfs_file_system_t *fs; /**< The file system driver for the mount point */
     const char *mount_point;     /**< Mount point, e.g. "/mnt/cdrom" */
     size_t mount_point_len;      /**< Length of mount_point string (set by vfs_mount) */
@@ -370,6 +377,54 @@ struct vfs_file_ops {
      * @return <0 on error
      */
     ssize_t (*write) (vfs_file_t *filp, const void *src, size_t nbytes);
+
+    /**
+     * @brief Read bytes from a position in an open file into several buffers
+     *
+     * The buffers are filled in order. The file position is not changed.
+     * If the driver does not implement this, the VFS layer emulates it with
+     * @c lseek and @c read.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[in]  iov      buffers to fill
+     * @param[in]  iovcnt   number of buffers in @p iov
+     * @param[in]  off      position in the file to read from
+     *
+     * @return number of bytes read on success
+     * @return <0 on error
+     */
+    ssize_t (*preadv) (vfs_file_t *filp, const struct iovec *iov, int iovcnt, off_t off);
+
+    /**
+     * @brief Write bytes from several buffers to a position in an open file
+     *
+     * The buffers are written in order. The file position is not changed.
+     * If the driver does not implement this, the VFS layer emulates it with
+     * @c lseek and @c write.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[in]  iov      buffers to write
+     * @param[in]  iovcnt   number of buffers in @p iov
+     * @param[in]  off      position in the file to write to
+     *
+     * @return number of bytes written on success
+     * @return <0 on error
+     */
+    ssize_t (*pwritev) (vfs_file_t *filp, const struct iovec *iov, int iovcnt, off_t off);
+
+    /**
+     * @brief Get the address of the contents of an open file
+     *
+     * Only file systems that keep each file contiguously in memory, e.g. in
+     * memory mapped flash, can implement this.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[out] data     address of the first byte of the file
+     *
+     * @return size of the file on success
+     * @return <0 on error
+     */
+    ssize_t (*mmap) (vfs_file_t *filp, const void **data);
 };
 
 /**
@@ -669,6 +724,83 @@ ssize_t vfs_read(int fd, void *dest, size_t count);
  */
 ssize_t vfs_write(int fd, const void *src, size_t count);
 
+/**
+ * @brief Read bytes from an open file into several buffers
+ *
+ * The buffers are filled in order, reading stops at the end of the file.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iov      buffers to fill
+ * @param[in]  iovcnt   number of buffers in @p iov
+ *
+ * @return number of bytes read on success
+ * @return <0 on error
+ */
+ssize_t vfs_readv(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Write bytes from several buffers to an open file
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iov      buffers to write
+ * @param[in]  iovcnt   number of buffers in @p iov
+ *
+ * @return number of bytes written on success
+ * @return <0 on error
+ */
+ssize_t vfs_writev(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Read bytes from a position in an open file into several buffers
+ *
+ * The file position is not changed. For file systems that do not implement
+ * vfs_file_ops::preadv, the read is done by seeking there and back, which is
+ * not atomic with regard to other users of the same fd.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iov      buffers to fill
+ * @param[in]  iovcnt   number of buffers in @p iov
+ * @param[in]  off      position in the file to read from
+ *
+ * @return number of bytes read on success
+ * @return <0 on error
+ */
+ssize_t vfs_preadv(int fd, const struct iovec *iov, int iovcnt, off_t off);
+
+/**
+ * @brief Write bytes from several buffers to a position in an open file
+ *
+ * The file position is not changed. For file systems that do not implement
+ * vfs_file_ops::pwritev, the write is done by seeking there and back, which
+ * is not atomic with regard to other users of the same fd.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iov      buffers to write
+ * @param[in]  iovcnt   number of buffers in @p iov
+ * @param[in]  off      position in the file to write to
+ *
+ * @return number of bytes written on success
+ * @return <0 on error
+ */
+ssize_t vfs_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off);
+
+/**
+ * @brief Get the address of the contents of an open file
+ *
+ * Unlike mmap(), this does not create a mapping, it only works if the file
+ * system keeps the file contiguously in memory, e.g. in memory mapped flash.
+ * The contents can then be used without copying them. @p data stays valid
+ * until the file system is unmounted, the contents must not be written to.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[out] data     address of the first byte of the file
+ *
+ * @return size of the file on success
+ * @return -ENOTSUP if the file system does not support this
+ * @return <0 on other errors
+ */
+ssize_t vfs_mmap(int fd, const void **data);
+
 /**
  * @brief Open a directory for reading with readdir
  *
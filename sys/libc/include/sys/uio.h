@@ -35,6 +35,26 @@ struct iovec {
     size_t iov_len;     /**< Length of data.    */
 };
 
+/**
+ * @brief   Read from a file into several buffers
+ */
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief   Write to a file from several buffers
+ */
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief   Read from a position in a file into several buffers
+ */
+ssize_t preadv(int fd, const struct iovec *iov, int iovcnt, off_t off);
+
+/**
+ * @brief   Write to a position in a file from several buffers
+ */
+ssize_t pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,708 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_mtd_kv
+ * @{
+ *
+ * @file
+ * @brief       Key-value store on MTD
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "checksum/crc16_ccitt.h"
+#include "hashes.h"
+#include "mtd_kv.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define SECTOR_MAGIC    (0x4b56U)
+
+#define TYPE_VALUE      (0x01U)
+#define TYPE_DELETED    (0x02U)
+
+/* chunk size for reading values and copying entries */
+#define CHUNK_SIZE      (32U)
+
+#define MAX_KEYS        ((MTD_KV_INDEX_SIZE * 3) / 4)
+
+#if (MTD_KV_INDEX_SIZE & (MTD_KV_INDEX_SIZE - 1))
+#error "MTD_KV_INDEX_SIZE must be a power of 2"
+#endif
+
+/* start of each sector */
+typedef struct {
+    uint16_t magic;
+    uint16_t crc;               /* of seq */
+    uint32_t seq;
+} _sector_hdr_t;
+
+/* start of each entry, followed by the key and the value */
+typedef struct {
+    uint8_t key_len;
+    uint8_t type;
+    uint16_t val_len;
+    uint16_t hdr_crc;           /* of the fields above */
+    uint16_t crc;               /* of the key and the value */
+} _entry_hdr_t;
+
+/* entries are aligned to their header, so that a header never crosses a
+ * page */
+#define ALIGN           (sizeof(_entry_hdr_t))
+
+static uint32_t _sector_size(const mtd_kv_t *kv)
+{
+    return kv->mtd->pages_per_sector * kv->mtd->page_size;
+}
+
+/* Device address of an offset in the store */
+static uint32_t _addr(const mtd_kv_t *kv, uint32_t rel)
+{
+    return kv->sector * _sector_size(kv) + rel;
+}
+
+static uint32_t _entry_size(const _entry_hdr_t *hdr)
+{
+    uint32_t size = sizeof(*hdr) + hdr->key_len + hdr->val_len;
+    return (size + ALIGN - 1) & ~(ALIGN - 1);
+}
+
+static uint32_t _capacity(const mtd_kv_t *kv)
+{
+    return (kv->sector_count - 2) * (_sector_size(kv) - sizeof(_sector_hdr_t));
+}
+
+static uint16_t _hash(const char *key, size_t len)
+{
+    uint32_t hash = djb2_hash((const uint8_t *)key, len);
+    return hash ^ (hash >> 16);
+}
+
+static uint16_t _hdr_crc(const _entry_hdr_t *hdr)
+{
+    return crc16_ccitt_calc((const uint8_t *)hdr,
+                            offsetof(_entry_hdr_t, hdr_crc));
+}
+
+static int _read(mtd_kv_t *kv, uint32_t rel, void *dest, size_t len)
+{
+    int res = mtd_read(kv->mtd, dest, _addr(kv, rel), len);
+    return (res < 0) ? res : 0;
+}
+
+/* Writes without crossing pages */
+static int _write(mtd_kv_t *kv, uint32_t rel, const void *data, size_t len)
+{
+    const uint8_t *src = data;
+    uint32_t addr = _addr(kv, rel);
+
+    while (len) {
+        size_t chunk = kv->mtd->page_size - (addr % kv->mtd->page_size);
+        if (chunk > len) {
+            chunk = len;
+        }
+        int res = mtd_write(kv->mtd, src, addr, chunk);
+        if (res < 0) {
+            return res;
+        }
+        src += chunk;
+        addr += chunk;
+        len -= chunk;
+    }
+    return 0;
+}
+
+static int _read_sector_hdr(mtd_kv_t *kv, uint32_t idx, uint32_t *seq)
+{
+    _sector_hdr_t hdr;
+    int res = _read(kv, idx * _sector_size(kv), &hdr, sizeof(hdr));
+    if (res < 0) {
+        return res;
+    }
+    if ((hdr.magic != SECTOR_MAGIC)
+        || (hdr.crc != crc16_ccitt_calc((uint8_t *)&hdr.seq, sizeof(hdr.seq)))) {
+        return -ENOENT;
+    }
+    *seq = hdr.seq;
+    return 0;
+}
+
+static int _write_sector_hdr(mtd_kv_t *kv)
+{
+    _sector_hdr_t hdr = {
+        .magic = SECTOR_MAGIC,
+        .crc = crc16_ccitt_calc((uint8_t *)&kv->head_seq,
+                                sizeof(kv->head_seq)),
+        .seq = kv->head_seq,
+    };
+    kv->pos = sizeof(hdr);
+    return _write(kv, kv->head * _sector_size(kv), &hdr, sizeof(hdr));
+}
+
+static bool _is_erased(const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != 0xff) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Finds the slot of a key, or the free slot it would be put into */
+static int _find(mtd_kv_t *kv, const char *key, size_t key_len, uint16_t hash,
+                 unsigned *slot, _entry_hdr_t *hdr)
+{
+    for (unsigned i = hash; ; i++) {
+        mtd_kv_slot_t *s = &kv->index[i & (MTD_KV_INDEX_SIZE - 1)];
+        if (s->addr == 0) {
+            *slot = i & (MTD_KV_INDEX_SIZE - 1);
+            return 0;
+        }
+        if (s->hash != hash) {
+            continue;
+        }
+
+        char stored[MTD_KV_KEY_MAX];
+        int res = _read(kv, s->addr, hdr, sizeof(*hdr));
+        if ((res == 0) && (hdr->key_len == key_len)) {
+            res = _read(kv, s->addr + sizeof(*hdr), stored, key_len);
+            if ((res == 0) && (memcmp(stored, key, key_len) == 0)) {
+                *slot = i & (MTD_KV_INDEX_SIZE - 1);
+                return 0;
+            }
+        }
+        if (res < 0) {
+            return res;
+        }
+    }
+}
+
+/* Removes a slot, moving the following ones of the probe sequence up */
+static void _remove(mtd_kv_t *kv, unsigned slot)
+{
+    const unsigned mask = MTD_KV_INDEX_SIZE - 1;
+    unsigned i = slot;
+
+    for (unsigned j = (i + 1) & mask; kv->index[j].addr; j = (j + 1) & mask) {
+        unsigned home = kv->index[j].hash & mask;
+        /* the slot can move to i if its home is not in (i, j] */
+        if (((j > i) && ((home <= i) || (home > j)))
+            || ((j < i) && (home <= i) && (home > j))) {
+            kv->index[i] = kv->index[j];
+            i = j;
+        }
+    }
+    kv->index[i].addr = 0;
+}
+
+/* Updates the index with the entry at rel */
+static int _apply(mtd_kv_t *kv, uint32_t rel, const _entry_hdr_t *hdr,
+                  const char *key)
+{
+    uint16_t hash = _hash(key, hdr->key_len);
+    _entry_hdr_t old;
+    unsigned slot;
+
+    int res = _find(kv, key, hdr->key_len, hash, &slot, &old);
+    if (res < 0) {
+        return res;
+    }
+    if (kv->index[slot].addr) {
+        kv->used -= _entry_size(&old);
+        if (hdr->type == TYPE_DELETED) {
+            _remove(kv, slot);
+            kv->keys--;
+            return 0;
+        }
+    }
+    else {
+        if (hdr->type == TYPE_DELETED) {
+            return 0;
+        }
+        if (kv->keys == MAX_KEYS) {
+            return -ENOMEM;
+        }
+        kv->keys++;
+    }
+    kv->index[slot].addr = rel;
+    kv->index[slot].hash = hash;
+    kv->used += _entry_size(hdr);
+    return 0;
+}
+
+/* Reads the key of an entry and checks its CRC */
+static int _check_entry(mtd_kv_t *kv, uint32_t rel, const _entry_hdr_t *hdr,
+                        char *key)
+{
+    uint8_t buf[CHUNK_SIZE];
+
+    rel += sizeof(*hdr);
+    int res = _read(kv, rel, key, hdr->key_len);
+    if (res < 0) {
+        return res;
+    }
+    uint16_t crc = crc16_ccitt_calc((uint8_t *)key, hdr->key_len);
+    rel += hdr->key_len;
+    for (size_t left = hdr->val_len; left; ) {
+        size_t chunk = (left < sizeof(buf)) ? left : sizeof(buf);
+        res = _read(kv, rel, buf, chunk);
+        if (res < 0) {
+            return res;
+        }
+        crc = crc16_ccitt_update(crc, buf, chunk);
+        rel += chunk;
+        left -= chunk;
+    }
+    return (crc == hdr->crc) ? 0 : -EILSEQ;
+}
+
+/* Adds the entries of a sector to the index */
+static int _scan(mtd_kv_t *kv, uint32_t idx)
+{
+    static const _entry_hdr_t skipped = { 0 };
+    uint32_t size = _sector_size(kv);
+    uint32_t pos = sizeof(_sector_hdr_t);
+
+    while ((pos + sizeof(_entry_hdr_t)) <= size) {
+        uint32_t rel = idx * size + pos;
+        char key[MTD_KV_KEY_MAX];
+        _entry_hdr_t hdr;
+
+        int res = _read(kv, rel, &hdr, sizeof(hdr));
+        if (res < 0) {
+            return res;
+        }
+        if (_is_erased((uint8_t *)&hdr, sizeof(hdr))) {
+            break;
+        }
+        if ((hdr.hdr_crc != _hdr_crc(&hdr)) || (hdr.key_len == 0)
+            || (hdr.key_len > MTD_KV_KEY_MAX)
+            || ((pos + _entry_size(&hdr)) > size)) {
+            /* The writing of this header was interrupted and nothing was
+             * written behind it. It is cleared, so that the head can be
+             * written to behind it. */
+            if ((idx == kv->head) && memcmp(&hdr, &skipped, sizeof(hdr))) {
+                DEBUG("mtd_kv: clear header at 0x%" PRIx32 "\n", rel);
+                res = _write(kv, rel, &skipped, sizeof(skipped));
+                if (res < 0) {
+                    return res;
+                }
+            }
+            pos += sizeof(hdr);
+            continue;
+        }
+
+        res = _check_entry(kv, rel, &hdr, key);
+        if (res == 0) {
+            res = _apply(kv, rel, &hdr, key);
+        }
+        else if (res == -EILSEQ) {
+            DEBUG("mtd_kv: bad entry at 0x%" PRIx32 "\n", rel);
+            res = 0;
+        }
+        if (res < 0) {
+            return res;
+        }
+        pos += _entry_size(&hdr);
+    }
+    if (idx == kv->head) {
+        kv->pos = pos;
+    }
+    return 0;
+}
+
+/* Copies the entries in the index that are in the tail sector to the head
+ * and erases the tail */
+static int _gc(mtd_kv_t *kv)
+{
+    uint32_t size = _sector_size(kv);
+    uint32_t start = kv->tail * size;
+    uint8_t buf[CHUNK_SIZE];
+    int res;
+
+    DEBUG("mtd_kv: collect sector %" PRIu32 "\n", kv->sector + kv->tail);
+    for (unsigned i = 0; i < MTD_KV_INDEX_SIZE; i++) {
+        mtd_kv_slot_t *s = &kv->index[i];
+        if ((s->addr == 0) || (s->addr < start)
+            || (s->addr >= (start + size))) {
+            continue;
+        }
+
+        _entry_hdr_t hdr;
+        res = _read(kv, s->addr, &hdr, sizeof(hdr));
+        if (res < 0) {
+            return res;
+        }
+        uint32_t len = _entry_size(&hdr);
+        if ((kv->pos + len) > size) {
+            /* the live entries of a sector fit into the empty head */
+            return -ENOSPC;
+        }
+        uint32_t dst = kv->head * size + kv->pos;
+        for (uint32_t off = 0; off < len; off += sizeof(buf)) {
+            size_t chunk = ((len - off) < sizeof(buf)) ? (len - off)
+                                                       : sizeof(buf);
+            res = _read(kv, s->addr + off, buf, chunk);
+            if (res == 0) {
+                res = _write(kv, dst + off, buf, chunk);
+            }
+            if (res < 0) {
+                return res;
+            }
+        }
+        s->addr = dst;
+        kv->pos += len;
+    }
+
+    /* drop the sector first, so that it is not read if erasing it is
+     * interrupted */
+    static const _sector_hdr_t dropped = { 0 };
+    res = _write(kv, start, &dropped, sizeof(dropped));
+    if (res == 0) {
+        res = mtd_erase(kv->mtd, _addr(kv, start), size);
+    }
+    if (res < 0) {
+        return res;
+    }
+    kv->tail = (kv->tail + 1) % kv->sector_count;
+    return 0;
+}
+
+/* Builds the index from the sectors from the tail to the head */
+static int _load(mtd_kv_t *kv)
+{
+    memset(kv->index, 0, sizeof(kv->index));
+    kv->keys = 0;
+    kv->used = 0;
+
+    /* newer entries replace older ones */
+    for (uint32_t idx = kv->tail; ; idx = (idx + 1) % kv->sector_count) {
+        int res = _scan(kv, idx);
+        if (res < 0) {
+            return res;
+        }
+        if (idx == kv->head) {
+            break;
+        }
+    }
+    DEBUG("mtd_kv: %u keys, %" PRIu32 " bytes\n", kv->keys, kv->used);
+    return 0;
+}
+
+/* Collects the tail again after an interrupted or failed collection. The
+ * head only holds copies of entries of the tail then, which are dropped:
+ * copying them behind the partial copy of an entry could exceed the head. */
+static int _resume_gc(mtd_kv_t *kv)
+{
+    uint32_t size = _sector_size(kv);
+
+    DEBUG("mtd_kv: resume collecting sector %" PRIu32 "\n",
+          kv->sector + kv->tail);
+    int res = mtd_erase(kv->mtd, _addr(kv, kv->head * size), size);
+    if (res == 0) {
+        res = _write_sector_hdr(kv);
+    }
+    if (res == 0) {
+        res = _load(kv);
+    }
+    if (res < 0) {
+        return res;
+    }
+    return _gc(kv);
+}
+
+/* The sector after the head is the tail only while it is collected */
+static bool _gc_pending(const mtd_kv_t *kv)
+{
+    return ((kv->head + 1) % kv->sector_count) == kv->tail;
+}
+
+static int _next_sector(mtd_kv_t *kv)
+{
+    kv->head = (kv->head + 1) % kv->sector_count;
+    kv->head_seq++;
+    int res = _write_sector_hdr(kv);
+    if (res < 0) {
+        return res;
+    }
+
+    /* the sector after the head must be kept erased */
+    if (_gc_pending(kv)) {
+        return _gc(kv);
+    }
+    return 0;
+}
+
+/* Appends an entry to the head, returns its offset in rel */
+static int _append(mtd_kv_t *kv, uint8_t type, const char *key,
+                   size_t key_len, const void *value, size_t len,
+                   uint32_t *rel)
+{
+    _entry_hdr_t hdr = {
+        .key_len = key_len,
+        .type = type,
+        .val_len = len,
+    };
+    hdr.hdr_crc = _hdr_crc(&hdr);
+    hdr.crc = crc16_ccitt_calc((const uint8_t *)key, key_len);
+    hdr.crc = crc16_ccitt_update(hdr.crc, value, len);
+
+    uint32_t size = _entry_size(&hdr);
+    for (uint32_t i = 0; (kv->pos + size) > _sector_size(kv); i++) {
+        if (i == kv->sector_count) {
+            return -ENOSPC;
+        }
+        int res = _next_sector(kv);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    /* the header is written first, so that an interrupted write either
+     * leaves a broken header or a broken CRC */
+    *rel = kv->head * _sector_size(kv) + kv->pos;
+    kv->pos += size;
+    int res = _write(kv, *rel, &hdr, sizeof(hdr));
+    if (res == 0) {
+        res = _write(kv, *rel + sizeof(hdr), key, key_len);
+    }
+    if (res == 0) {
+        res = _write(kv, *rel + sizeof(hdr) + key_len, value, len);
+    }
+    if (res < 0) {
+        /* Its header might be erased, which ends the sector when scanning
+         * it, so the next entry goes to the next sector. */
+        kv->pos = _sector_size(kv);
+    }
+    return res;
+}
+
+static int _format(mtd_kv_t *kv)
+{
+    memset(kv->index, 0, sizeof(kv->index));
+    kv->keys = 0;
+    kv->used = 0;
+    kv->head = 0;
+    kv->head_seq = 1;
+    kv->tail = 0;
+
+    int res = mtd_erase(kv->mtd, _addr(kv, 0),
+                        kv->sector_count * _sector_size(kv));
+    if (res < 0) {
+        return res;
+    }
+    return _write_sector_hdr(kv);
+}
+
+int mtd_kv_format(mtd_kv_t *kv)
+{
+    mutex_lock(&kv->lock);
+    int res = _format(kv);
+    mutex_unlock(&kv->lock);
+
+    return res;
+}
+
+/* Erases a sector unless it is erased already */
+static int _erase_ahead(mtd_kv_t *kv)
+{
+    uint32_t size = _sector_size(kv);
+    uint32_t start = ((kv->head + 1) % kv->sector_count) * size;
+    uint8_t buf[CHUNK_SIZE];
+
+    for (uint32_t off = 0; off < size; off += sizeof(buf)) {
+        int res = _read(kv, start + off, buf, sizeof(buf));
+        if (res < 0) {
+            return res;
+        }
+        if (!_is_erased(buf, sizeof(buf))) {
+            DEBUG("mtd_kv: erase 0x%" PRIx32 "\n", start);
+            return mtd_erase(kv->mtd, _addr(kv, start), size);
+        }
+    }
+    return 0;
+}
+
+int mtd_kv_init(mtd_kv_t *kv)
+{
+    int res = mtd_init(kv->mtd);
+    if (res < 0) {
+        return res;
+    }
+    if ((kv->mtd->page_size % ALIGN) || (kv->sector_count < 3)
+        || (_sector_size(kv) % CHUNK_SIZE)
+        || ((kv->sector + kv->sector_count) > kv->mtd->sector_count)) {
+        return -EINVAL;
+    }
+    mutex_init(&kv->lock);
+
+    /* the head is the sector with the newest header */
+    bool found = false;
+    for (uint32_t i = 0; i < kv->sector_count; i++) {
+        uint32_t seq;
+        res = _read_sector_hdr(kv, i, &seq);
+        if (res == -ENOENT) {
+            continue;
+        }
+        if (res < 0) {
+            return res;
+        }
+        if (!found || (seq > kv->head_seq)) {
+            kv->head = i;
+            kv->head_seq = seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        DEBUG("mtd_kv: no store found\n");
+        return _format(kv);
+    }
+
+    /* the store continues backwards as long as the sequence numbers do */
+    kv->tail = kv->head;
+    for (uint32_t back = 1; back < kv->sector_count; back++) {
+        uint32_t seq;
+        uint32_t idx = (kv->head + kv->sector_count - back) % kv->sector_count;
+        if ((_read_sector_hdr(kv, idx, &seq) < 0)
+            || (seq != (kv->head_seq - back))) {
+            break;
+        }
+        kv->tail = idx;
+    }
+
+    /* collecting the tail might have been interrupted */
+    if (_gc_pending(kv)) {
+        return _resume_gc(kv);
+    }
+    res = _load(kv);
+    if (res < 0) {
+        return res;
+    }
+
+    /* the erase of the next sector might have been interrupted */
+    return _erase_ahead(kv);
+}
+
+int mtd_kv_get(mtd_kv_t *kv, const char *key, void *value, size_t len)
+{
+    size_t key_len = strlen(key);
+    if ((key_len == 0) || (key_len > MTD_KV_KEY_MAX)) {
+        return -ENOENT;
+    }
+
+    _entry_hdr_t hdr;
+    unsigned slot;
+    mutex_lock(&kv->lock);
+    int res = _find(kv, key, key_len, _hash(key, key_len), &slot, &hdr);
+    if (res == 0) {
+        if (kv->index[slot].addr == 0) {
+            res = -ENOENT;
+        }
+        else if (hdr.val_len > len) {
+            res = -EOVERFLOW;
+        }
+        else {
+            res = _read(kv, kv->index[slot].addr + sizeof(hdr) + key_len,
+                        value, hdr.val_len);
+            if (res == 0) {
+                res = hdr.val_len;
+            }
+        }
+    }
+    mutex_unlock(&kv->lock);
+
+    return res;
+}
+
+int mtd_kv_put(mtd_kv_t *kv, const char *key, const void *value, size_t len)
+{
+    size_t key_len = strlen(key);
+    _entry_hdr_t hdr = { .key_len = key_len, .val_len = len };
+    uint32_t size = _entry_size(&hdr);
+
+    if ((key_len == 0) || (key_len > MTD_KV_KEY_MAX) || (len > UINT16_MAX)
+        || (size > (_sector_size(kv) - sizeof(_sector_hdr_t)))) {
+        return -EINVAL;
+    }
+
+    uint16_t hash = _hash(key, key_len);
+    unsigned slot;
+    mutex_lock(&kv->lock);
+    int res = _gc_pending(kv) ? _resume_gc(kv) : 0;
+    if (res == 0) {
+        res = _find(kv, key, key_len, hash, &slot, &hdr);
+    }
+    if (res < 0) {
+        goto out;
+    }
+
+    uint32_t old_size = kv->index[slot].addr ? _entry_size(&hdr) : 0;
+    if ((old_size == 0) && (kv->keys == MAX_KEYS)) {
+        res = -ENOMEM;
+        goto out;
+    }
+    if ((kv->used - old_size + size) > _capacity(kv)) {
+        res = -ENOSPC;
+        goto out;
+    }
+
+    uint32_t rel;
+    res = _append(kv, TYPE_VALUE, key, key_len, value, len, &rel);
+    if (res == 0) {
+        if (old_size == 0) {
+            kv->keys++;
+        }
+        kv->index[slot].addr = rel;
+        kv->index[slot].hash = hash;
+        kv->used += size - old_size;
+    }
+
+out:
+    mutex_unlock(&kv->lock);
+    return res;
+}
+
+int mtd_kv_delete(mtd_kv_t *kv, const char *key)
+{
+    size_t key_len = strlen(key);
+    if ((key_len == 0) || (key_len > MTD_KV_KEY_MAX)) {
+        return -ENOENT;
+    }
+
+    _entry_hdr_t hdr;
+    unsigned slot;
+    mutex_lock(&kv->lock);
+    int res = _gc_pending(kv) ? _resume_gc(kv) : 0;
+    if (res == 0) {
+        res = _find(kv, key, key_len, _hash(key, key_len), &slot, &hdr);
+    }
+    if ((res == 0) && (kv->index[slot].addr == 0)) {
+        res = -ENOENT;
+    }
+    if (res == 0) {
+        uint32_t rel;
+        res = _append(kv, TYPE_DELETED, key, key_len, NULL, 0, &rel);
+    }
+    if (res == 0) {
+        _remove(kv, slot);
+        kv->keys--;
+        kv->used -= _entry_size(&hdr);
+    }
+    mutex_unlock(&kv->lock);
+
+    return res;
+}
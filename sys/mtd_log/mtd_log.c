@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_mtd_log
+ * @{
+ *
+ * @file
+ * @brief       Log-structured record store on MTD
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "checksum/crc16_ccitt.h"
+#include "mtd_log.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#define SECTOR_MAGIC    (0x4c4dU)
+#define ERASED          (0xffffU)
+
+/* start of each sector */
+typedef struct {
+    uint16_t magic;
+    uint16_t crc;               /* of seq */
+    uint32_t seq;
+} _sector_hdr_t;
+
+/* start of each record */
+typedef struct {
+    uint16_t len;               /* ERASED at the end of a page */
+    uint16_t crc;               /* of len and the data */
+} _record_hdr_t;
+
+static uint32_t _sector_size(const mtd_log_t *log)
+{
+    return log->mtd->pages_per_sector * log->mtd->page_size;
+}
+
+static uint32_t _sector_addr(const mtd_log_t *log, uint32_t idx)
+{
+    return (log->sector + idx) * _sector_size(log);
+}
+
+/* Sector that holds seq, which must not be newer than the head */
+static uint32_t _index(const mtd_log_t *log, uint32_t seq)
+{
+    uint32_t back = (log->head_seq - seq) % log->sector_count;
+    return (log->head + log->sector_count - back) % log->sector_count;
+}
+
+static uint16_t _record_crc(uint16_t len, const void *data)
+{
+    uint16_t crc = crc16_ccitt_calc((const uint8_t *)&len, sizeof(len));
+    return crc16_ccitt_update(crc, data, len);
+}
+
+static int _read_sector_hdr(mtd_log_t *log, uint32_t idx, uint32_t *seq)
+{
+    _sector_hdr_t hdr;
+    int res = mtd_read(log->mtd, &hdr, _sector_addr(log, idx), sizeof(hdr));
+    if (res < 0) {
+        return res;
+    }
+    if ((hdr.magic != SECTOR_MAGIC)
+        || (hdr.crc != crc16_ccitt_calc((uint8_t *)&hdr.seq, sizeof(hdr.seq)))) {
+        return -ENOENT;
+    }
+    *seq = hdr.seq;
+    return 0;
+}
+
+/* Puts the header of the head sector into the page buffer */
+static void _start_sector(mtd_log_t *log)
+{
+    _sector_hdr_t hdr = {
+        .magic = SECTOR_MAGIC,
+        .crc = crc16_ccitt_calc((uint8_t *)&log->head_seq,
+                                sizeof(log->head_seq)),
+        .seq = log->head_seq,
+    };
+    memcpy(log->buf, &hdr, sizeof(hdr));
+    log->page = 0;
+    log->buf_len = sizeof(hdr);
+}
+
+/* Checks whether a sector is erased, using the page buffer */
+static int _erased(mtd_log_t *log, uint32_t idx)
+{
+    uint32_t addr = _sector_addr(log, idx);
+
+    for (uint32_t off = 0; off < _sector_size(log);
+         off += log->mtd->page_size) {
+        int res = mtd_read(log->mtd, log->buf, addr + off,
+                           log->mtd->page_size);
+        if (res < 0) {
+            return res;
+        }
+        for (unsigned i = 0; i < log->mtd->page_size; i++) {
+            if (log->buf[i] != 0xff) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Erases a sector unless it is erased already */
+static int _erase_ahead(mtd_log_t *log, uint32_t idx, bool check)
+{
+    if (check) {
+        /* the page buffer is empty when this is called */
+        int res = _erased(log, idx);
+        if (res != 0) {
+            return (res < 0) ? res : 0;
+        }
+    }
+    DEBUG("mtd_log: erase sector %" PRIu32 "\n", log->sector + idx);
+    return mtd_erase(log->mtd, _sector_addr(log, idx), _sector_size(log));
+}
+
+/* Starts an empty log in the first sector */
+static void _reset(mtd_log_t *log)
+{
+    log->head = 0;
+    log->head_seq = 1;
+    log->tail_seq = 1;
+    _start_sector(log);
+}
+
+static int _next_sector(mtd_log_t *log)
+{
+    log->head = (log->head + 1) % log->sector_count;
+    log->head_seq++;
+    _start_sector(log);
+
+    /* the sector after the head is kept erased, drop it from the log */
+    if ((log->head_seq + 2) > (log->tail_seq + log->sector_count)) {
+        log->tail_seq = log->head_seq + 2 - log->sector_count;
+    }
+    return _erase_ahead(log, (log->head + 1) % log->sector_count, false);
+}
+
+static int _write_page(mtd_log_t *log)
+{
+    unsigned start = (log->page == 0) ? sizeof(_sector_hdr_t) : 0;
+    if (log->buf_len <= start) {
+        /* no records */
+        return 0;
+    }
+
+    int res = mtd_write(log->mtd, log->buf,
+                        _sector_addr(log, log->head) + log->page, log->buf_len);
+    /* a page is only written once, even if writing failed */
+    log->buf_len = 0;
+    if (res < 0) {
+        /* The page might be erased, so mtd_log_init() would take it for the
+         * end of the sector. The next page goes to the next sector. */
+        log->page = _sector_size(log);
+        return res;
+    }
+    log->page += log->mtd->page_size;
+    return 0;
+}
+
+int mtd_log_format(mtd_log_t *log)
+{
+    mutex_lock(&log->lock);
+    int res = mtd_erase(log->mtd, _sector_addr(log, 0),
+                        log->sector_count * _sector_size(log));
+    _reset(log);
+    mutex_unlock(&log->lock);
+
+    return (res < 0) ? res : 0;
+}
+
+int mtd_log_init(mtd_log_t *log)
+{
+    int res = mtd_init(log->mtd);
+    if (res < 0) {
+        return res;
+    }
+    if ((log->mtd->page_size > MTD_LOG_PAGE_SIZE)
+        || (log->mtd->page_size <= MTD_LOG_RECORD_OVERHEAD)
+        || (log->sector_count < 2)
+        || ((log->sector + log->sector_count) > log->mtd->sector_count)) {
+        return -EINVAL;
+    }
+    mutex_init(&log->lock);
+
+    /* the head is the sector with the newest header */
+    bool found = false;
+    for (uint32_t i = 0; i < log->sector_count; i++) {
+        uint32_t seq;
+        res = _read_sector_hdr(log, i, &seq);
+        if (res == -ENOENT) {
+            continue;
+        }
+        if (res < 0) {
+            return res;
+        }
+        if (!found || (seq > log->head_seq)) {
+            log->head = i;
+            log->head_seq = seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        /* sector headers are written with the first record, so an empty
+         * log is all erased */
+        res = 1;
+        for (uint32_t i = 0; (res > 0) && (i < log->sector_count); i++) {
+            res = _erased(log, i);
+        }
+        if (res < 0) {
+            return res;
+        }
+        if (res == 0) {
+            DEBUG("mtd_log: no log found\n");
+            return mtd_log_format(log);
+        }
+        _reset(log);
+        return 0;
+    }
+
+    /* the log continues backwards as long as the sequence numbers do */
+    log->tail_seq = log->head_seq;
+    for (uint32_t back = 1; back < (log->sector_count - 1); back++) {
+        uint32_t seq;
+        uint32_t idx = (log->head + log->sector_count - back)
+                       % log->sector_count;
+        if ((_read_sector_hdr(log, idx, &seq) < 0)
+            || (seq != (log->head_seq - back))) {
+            break;
+        }
+        log->tail_seq = seq;
+    }
+
+    /* pages are written in order, find the first unwritten one */
+    uint32_t addr = _sector_addr(log, log->head);
+    uint32_t lo = 1;
+    uint32_t hi = log->mtd->pages_per_sector;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint16_t len;
+        res = mtd_read(log->mtd, &len, addr + mid * log->mtd->page_size,
+                       sizeof(len));
+        if (res < 0) {
+            return res;
+        }
+        if (len == ERASED) {
+            hi = mid;
+        }
+        else {
+            lo = mid + 1;
+        }
+    }
+    log->page = lo * log->mtd->page_size;
+    log->buf_len = 0;
+    DEBUG("mtd_log: sectors %" PRIu32 "..%" PRIu32 ", head %" PRIu32
+          " at 0x%" PRIx32 "\n", log->tail_seq, log->head_seq, log->head,
+          log->page);
+
+    /* the erase of the next sector might have been interrupted */
+    return _erase_ahead(log, (log->head + 1) % log->sector_count, true);
+}
+
+int mtd_log_append(mtd_log_t *log, const void *data, size_t len)
+{
+    uint32_t page_size = log->mtd->page_size;
+    if ((len == 0) || (len > (page_size - MTD_LOG_RECORD_OVERHEAD))) {
+        return -EINVAL;
+    }
+
+    int res = 0;
+    mutex_lock(&log->lock);
+    if ((log->buf_len + sizeof(_record_hdr_t) + len) > page_size) {
+        res = _write_page(log);
+    }
+    if (log->page >= _sector_size(log)) {
+        int err = _next_sector(log);
+        if (res == 0) {
+            res = err;
+        }
+    }
+
+    _record_hdr_t hdr = { .len = len, .crc = _record_crc(len, data) };
+    memcpy(&log->buf[log->buf_len], &hdr, sizeof(hdr));
+    memcpy(&log->buf[log->buf_len + sizeof(hdr)], data, len);
+    log->buf_len += sizeof(hdr) + len;
+    mutex_unlock(&log->lock);
+
+    return res;
+}
+
+int mtd_log_flush(mtd_log_t *log)
+{
+    mutex_lock(&log->lock);
+    int res = _write_page(log);
+    mutex_unlock(&log->lock);
+
+    return res;
+}
+
+void mtd_log_cursor_init(mtd_log_t *log, mtd_log_cursor_t *cur)
+{
+    mutex_lock(&log->lock);
+    cur->seq = log->tail_seq;
+    cur->offset = sizeof(_sector_hdr_t);
+    mutex_unlock(&log->lock);
+}
+
+/* Reads from the page buffer or the device */
+static int _read_at(mtd_log_t *log, uint32_t seq, uint32_t offset, void *dest,
+                    size_t len)
+{
+    if ((seq == log->head_seq) && (offset >= log->page)) {
+        memcpy(dest, &log->buf[offset - log->page], len);
+        return 0;
+    }
+    int res = mtd_read(log->mtd, dest,
+                       _sector_addr(log, _index(log, seq)) + offset, len);
+    return (res < 0) ? res : 0;
+}
+
+static int _read(mtd_log_t *log, mtd_log_cursor_t *cur, void *dest,
+                 size_t len)
+{
+    uint32_t page_size = log->mtd->page_size;
+
+    if (cur->seq < log->tail_seq) {
+        cur->seq = log->tail_seq;
+        cur->offset = sizeof(_sector_hdr_t);
+        return -ESTALE;
+    }
+
+    while (1) {
+        if ((cur->seq > log->head_seq) || ((cur->seq == log->head_seq)
+                && (cur->offset >= (log->page + log->buf_len)))) {
+            return 0;
+        }
+        if (cur->offset >= _sector_size(log)) {
+            cur->seq++;
+            cur->offset = sizeof(_sector_hdr_t);
+            continue;
+        }
+
+        uint32_t in_page = cur->offset % page_size;
+        if ((in_page + sizeof(_record_hdr_t)) <= page_size) {
+            _record_hdr_t hdr;
+            int res = _read_at(log, cur->seq, cur->offset, &hdr, sizeof(hdr));
+            if (res < 0) {
+                return res;
+            }
+            if ((hdr.len != ERASED)
+                && (hdr.len <= (page_size - in_page - sizeof(hdr)))) {
+                if (hdr.len > len) {
+                    return -EOVERFLOW;
+                }
+                res = _read_at(log, cur->seq, cur->offset + sizeof(hdr),
+                               dest, hdr.len);
+                if (res < 0) {
+                    return res;
+                }
+                if (hdr.crc == _record_crc(hdr.len, dest)) {
+                    cur->offset += sizeof(hdr) + hdr.len;
+                    return hdr.len;
+                }
+                DEBUG("mtd_log: bad record at %" PRIu32 ":0x%" PRIx32 "\n",
+                      cur->seq, cur->offset);
+            }
+        }
+        /* end of the page, or the rest of it is damaged */
+        cur->offset += page_size - in_page;
+    }
+}
+
+int mtd_log_read(mtd_log_t *log, mtd_log_cursor_t *cur, void *dest,
+                 size_t len)
+{
+    mutex_lock(&log->lock);
+    int res = _read(log, cur, dest, len);
+    mutex_unlock(&log->lock);
+
+    return res;
+}
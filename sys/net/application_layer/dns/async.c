@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup net_sock_dns
+ * @{
+ * @file
+ * @brief   Asynchronous sock DNS client
+ *
+ * All look-ups share one sock. The queries of a new look-up are sent by the
+ * caller, the resolver thread receives the replies, retransmits unanswered
+ * queries and reports the results. The resolver thread never waits longer
+ * than until the earliest retransmission of all look-ups in flight and the
+ * first retransmission of a new look-up is never due earlier than that, so
+ * only an idle resolver needs to be woken up.
+ * @}
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include "msg.h"
+#include "mutex.h"
+#include "net/sock/dns.h"
+#include "net/sock/udp.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#include "dns_internal.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#define MSG_QUEUE_SIZE  (2U)
+
+typedef struct {
+    sock_dns_lookup_t lookup;
+    sock_dns_cb_t cb;                       /* NULL if request is unused */
+    void *arg;
+    uint32_t deadline;                      /* of the current try */
+    uint8_t tries;                          /* retransmissions left */
+    char name[SOCK_DNS_MAX_NAME_LEN + 1];
+} _req_t;
+
+static _req_t _reqs[SOCK_DNS_ASYNC_NUMOF];
+static mutex_t _mutex = MUTEX_INIT;
+static sock_udp_t _sock;
+static kernel_pid_t _pid = KERNEL_PID_UNDEF;
+static char _stack[SOCK_DNS_ASYNC_STACKSIZE];
+static msg_t _msg_queue[MSG_QUEUE_SIZE];
+
+static bool _from_server(const sock_udp_ep_t *remote)
+{
+    return (remote->family == sock_dns_server.family) &&
+           (remote->port == sock_dns_server.port) &&
+           (memcmp(&remote->addr, &sock_dns_server.addr,
+                   (remote->family == AF_INET6) ? 16 : 4) == 0);
+}
+
+/* expects _mutex to be locked */
+static bool _next_timeout(uint32_t *timeout)
+{
+    uint32_t now = xtimer_now_usec();
+    bool active = false;
+    int32_t min = INT32_MAX;
+
+    for (unsigned i = 0; i < SOCK_DNS_ASYNC_NUMOF; i++) {
+        if (_reqs[i].cb != NULL) {
+            int32_t left = (int32_t)(_reqs[i].deadline - now);
+
+            active = true;
+            if (left < min) {
+                min = left;
+            }
+        }
+    }
+    *timeout = (min > 0) ? (uint32_t)min : 0;
+    return active;
+}
+
+static void _handle_reply(const uint8_t *buf, size_t len)
+{
+    mutex_lock(&_mutex);
+    for (unsigned i = 0; i < SOCK_DNS_ASYNC_NUMOF; i++) {
+        _req_t *req = &_reqs[i];
+
+        if (req->cb != NULL) {
+            sock_dns_lookup_handle(&req->lookup, req->name, buf, len);
+        }
+    }
+    mutex_unlock(&_mutex);
+}
+
+static void _handle_timeouts(void)
+{
+    uint32_t now = xtimer_now_usec();
+
+    mutex_lock(&_mutex);
+    for (unsigned i = 0; i < SOCK_DNS_ASYNC_NUMOF; i++) {
+        _req_t *req = &_reqs[i];
+
+        if ((req->cb == NULL) || ((int32_t)(req->deadline - now) > 0)) {
+            continue;
+        }
+        if (req->tries == 0) {
+            /* give up on the unanswered queries */
+            req->lookup.pending = 0;
+            continue;
+        }
+        DEBUG("sock_dns: retransmitting queries for %s\n", req->name);
+        req->tries--;
+        req->deadline = now + SOCK_DNS_TIMEOUT_US;
+        sock_dns_lookup_send(&req->lookup, &_sock, req->name);
+    }
+    mutex_unlock(&_mutex);
+}
+
+static void _report(void)
+{
+    while (1) {
+        sock_dns_cb_t cb = NULL;
+        void *arg = NULL;
+        uint8_t addr[16];
+        int res = 0;
+
+        mutex_lock(&_mutex);
+        for (unsigned i = 0; i < SOCK_DNS_ASYNC_NUMOF; i++) {
+            _req_t *req = &_reqs[i];
+
+            if ((req->cb != NULL) && sock_dns_lookup_done(&req->lookup)) {
+                cb = req->cb;
+                arg = req->arg;
+                res = req->lookup.res;
+                memcpy(addr, req->lookup.addr, sizeof(addr));
+                req->cb = NULL;
+                break;
+            }
+        }
+        mutex_unlock(&_mutex);
+        if (cb == NULL) {
+            return;
+        }
+        /* call without holding the mutex so cb can start new look-ups */
+        cb(res, addr, arg);
+    }
+}
+
+static void *_resolver(void *arg)
+{
+    (void)arg;
+    msg_init_queue(_msg_queue, MSG_QUEUE_SIZE);
+    while (1) {
+        sock_udp_ep_t remote;
+        void *data, *ctx = NULL;
+        uint32_t timeout;
+        ssize_t res;
+        bool active;
+
+        mutex_lock(&_mutex);
+        active = _next_timeout(&timeout);
+        mutex_unlock(&_mutex);
+        if (!active) {
+            msg_t msg;
+
+            /* idle: wait for a new look-up */
+            msg_receive(&msg);
+            continue;
+        }
+        res = sock_udp_recv_buf(&_sock, &data, &ctx, timeout, &remote);
+        if (res >= 0) {
+            if ((res > 0) && _from_server(&remote)) {
+                _handle_reply(data, res);
+            }
+            sock_udp_recv_buf(&_sock, &data, &ctx, 0, NULL);
+        }
+        _handle_timeouts();
+        _report();
+    }
+    return NULL;
+}
+
+/* expects _mutex to be locked */
+static int _init(void)
+{
+    sock_udp_ep_t local = { .family = sock_dns_server.family };
+    int res;
+
+    if (_pid != KERNEL_PID_UNDEF) {
+        return 0;
+    }
+    /* no remote, so sock_dns_server may change between look-ups */
+    if ((res = sock_udp_create(&_sock, &local, NULL, 0)) < 0) {
+        return res;
+    }
+    _pid = thread_create(_stack, sizeof(_stack), SOCK_DNS_ASYNC_PRIO,
+                         THREAD_CREATE_STACKTEST, _resolver, NULL, "dns");
+    return 0;
+}
+
+int sock_dns_query_async(const char *domain_name, int family,
+                         sock_dns_cb_t cb, void *arg)
+{
+    sock_dns_lookup_t lookup;
+    _req_t *req = NULL;
+    int res;
+
+    assert(cb != NULL);
+    if (sock_dns_server.port == 0) {
+        return -ECONNREFUSED;
+    }
+    if (strlen(domain_name) > SOCK_DNS_MAX_NAME_LEN) {
+        return -ENOSPC;
+    }
+    if ((res = sock_dns_lookup_init(&lookup, domain_name, family)) != 0) {
+        /* answered from cache */
+        cb(res, lookup.addr, arg);
+        return 0;
+    }
+    mutex_lock(&_mutex);
+    if ((res = _init()) < 0) {
+        goto out;
+    }
+    for (unsigned i = 0; i < SOCK_DNS_ASYNC_NUMOF; i++) {
+        if (_reqs[i].cb == NULL) {
+            req = &_reqs[i];
+            break;
+        }
+    }
+    if (req == NULL) {
+        res = -ENOMEM;
+        goto out;
+    }
+    if ((res = sock_dns_lookup_send(&lookup, &_sock, domain_name)) < 0) {
+        goto out;
+    }
+    memcpy(&req->lookup, &lookup, sizeof(lookup));
+    strcpy(req->name, domain_name);
+    req->arg = arg;
+    req->tries = SOCK_DNS_RETRIES - 1;
+    req->deadline = xtimer_now_usec() + SOCK_DNS_TIMEOUT_US;
+    req->cb = cb;
+    if (_pid != thread_getpid()) {
+        msg_t msg = { .type = 0 };
+
+        /* wake up resolver if idle, it is busy otherwise if queue is full */
+        msg_try_send(&msg, _pid);
+    }
+out:
+    mutex_unlock(&_mutex);
+    return res;
+}
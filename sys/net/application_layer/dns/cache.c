@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup net_sock_dns
+ * @{
+ * @file
+ * @brief   sock DNS client cache
+ * @}
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "mutex.h"
+#include "net/sock/dns.h"
+#include "timex.h"
+#include "xtimer.h"
+
+#include "dns_internal.h"
+
+typedef struct {
+    uint32_t expires;                       /* in seconds */
+    uint16_t type;                          /* 0 if entry is unused */
+    uint8_t addr_len;                       /* 0 for a failed look-up */
+    uint8_t addr[16];
+    char name[SOCK_DNS_MAX_NAME_LEN + 1];
+} _cache_entry_t;
+
+static _cache_entry_t _cache[SOCK_DNS_CACHE_SIZE];
+static mutex_t _cache_mutex = MUTEX_INIT;
+
+static inline uint32_t _now(void)
+{
+    return (uint32_t)(xtimer_now_usec64() / US_PER_SEC);
+}
+
+static inline int32_t _lifetime(const _cache_entry_t *entry, uint32_t now)
+{
+    return (int32_t)(entry->expires - now);
+}
+
+int sock_dns_cache_get(const char *domain_name, uint16_t type, void *addr_out)
+{
+    uint32_t now = _now();
+    int res = 0;
+
+    mutex_lock(&_cache_mutex);
+    for (unsigned i = 0; i < SOCK_DNS_CACHE_SIZE; i++) {
+        _cache_entry_t *entry = &_cache[i];
+
+        if ((entry->type != type) || (strcmp(entry->name, domain_name) != 0)) {
+            continue;
+        }
+        if (_lifetime(entry, now) <= 0) {
+            entry->type = 0;
+        }
+        else if (entry->addr_len > 0) {
+            memcpy(addr_out, entry->addr, entry->addr_len);
+            res = entry->addr_len;
+        }
+        else {
+            res = -ENOENT;
+        }
+        break;
+    }
+    mutex_unlock(&_cache_mutex);
+    return res;
+}
+
+void sock_dns_cache_add(const char *domain_name, uint16_t type,
+                        const void *addr, unsigned addr_len, uint32_t ttl)
+{
+    _cache_entry_t *entry = NULL;
+    uint32_t now = _now();
+
+    if ((ttl == 0) || (addr_len > sizeof(entry->addr)) ||
+        (strlen(domain_name) > SOCK_DNS_MAX_NAME_LEN)) {
+        /* TTL 0 means the answer must not be cached (RFC 1035) */
+        return;
+    }
+    mutex_lock(&_cache_mutex);
+    for (unsigned i = 0; i < SOCK_DNS_CACHE_SIZE; i++) {
+        _cache_entry_t *tmp = &_cache[i];
+
+        if ((tmp->type == type) && (strcmp(tmp->name, domain_name) == 0)) {
+            entry = tmp;
+            break;
+        }
+        /* otherwise replace an unused entry or the one expiring first */
+        if ((entry == NULL) || ((entry->type != 0) &&
+            ((tmp->type == 0) || (_lifetime(tmp, now) < _lifetime(entry, now))))) {
+            entry = tmp;
+        }
+    }
+    entry->expires = now + ttl;
+    entry->type = type;
+    entry->addr_len = addr_len;
+    if (addr_len > 0) {
+        memcpy(entry->addr, addr, addr_len);
+    }
+    strcpy(entry->name, domain_name);
+    mutex_unlock(&_cache_mutex);
+}
+
+void sock_dns_cache_flush(void)
+{
+    mutex_lock(&_cache_mutex);
+    memset(_cache, 0, sizeof(_cache));
+    mutex_unlock(&_cache_mutex);
+}
@@ -22,14 +22,29 @@
 #include "net/dns.h"
 #include "net/sock/udp.h"
 #include "net/sock/dns.h"
+#include "random.h"
+#include "xtimer.h"
 
 #ifdef RIOT_VERSION
 #include "byteorder.h"
 #endif
 
+#include "dns_internal.h"
+
 /* min domain name length is 1, so minimum record length is 7 */
 #define DNS_MIN_REPLY_LEN   (unsigned)(sizeof(sock_dns_hdr_t ) + 7)
 
+#define DNS_FLAG_QR         (0x8000U)   /* message is a reply */
+#define DNS_RCODE_MASK      (0x000fU)
+#define DNS_RCODE_NOERROR   (0U)
+#define DNS_RCODE_NXDOMAIN  (3U)
+/* two root names and five 32-bit values */
+#define DNS_SOA_MIN_LEN     (2U + (5U * 4U))
+
+/* query types and their address families, by query index */
+static const uint16_t _types[] = { DNS_TYPE_AAAA, DNS_TYPE_A };
+static const int _families[] = { AF_INET6, AF_INET };
+
 /* global DNS server UDP endpoint */
 sock_udp_ep_t sock_dns_server;
 
@@ -68,46 +83,71 @@ static unsigned _put_short(uint8_t *out, uint16_t val)
     return 2;
 }
 
-static unsigned _get_short(uint8_t *buf)
+static unsigned _get_short(const uint8_t *buf)
 {
     uint16_t _tmp;
     memcpy(&_tmp, buf, 2);
     return _tmp;
 }
 
-static ssize_t _skip_hostname(const uint8_t *buf, size_t len, uint8_t *bufpos)
+static uint32_t _get_ttl(const uint8_t *buf)
+{
+    uint32_t _tmp;
+    memcpy(&_tmp, buf, 4);
+    _tmp = ntohl(_tmp);
+    /* TTLs with the most significant bit set are treated as 0 (RFC 2181) */
+    return (_tmp & 0x80000000UL) ? 0 : _tmp;
+}
+
+static ssize_t _skip_hostname(const uint8_t *buf, size_t len,
+                              const uint8_t *bufpos)
 {
     const uint8_t *buflim = buf + len;
     unsigned res = 0;
 
-    if (bufpos >= buflim) {
-        /* out-of-bound */
-        return -EBADMSG;
-    }
-    /* handle DNS Message Compression */
-    if (*bufpos >= 192) {
-        if ((bufpos + 2) >= buflim) {
-            return -EBADMSG;
-        }
-        return 2;
-    }
-
-    while (bufpos[res]) {
-        res += bufpos[res] + 1;
-        if ((&bufpos[res]) >= buflim) {
+    while (1) {
+        if ((bufpos + res) >= buflim) {
             /* out-of-bound */
             return -EBADMSG;
         }
+        /* handle DNS Message Compression, a pointer ends a name */
+        if (bufpos[res] >= 192) {
+            if ((bufpos + res + 2) > buflim) {
+                return -EBADMSG;
+            }
+            return res + 2;
+        }
+        if (bufpos[res] == 0) {
+            return res + 1;
+        }
+        res += bufpos[res] + 1;
     }
-    return res + 1;
 }
 
-static int _parse_dns_reply(uint8_t *buf, size_t len, void* addr_out, int family)
+static int _parse_dns_reply(const uint8_t *buf, size_t len, void *addr_out,
+                            uint16_t type, uint32_t *ttl)
 {
     const uint8_t *buflim = buf + len;
-    sock_dns_hdr_t *hdr = (sock_dns_hdr_t*) buf;
-    uint8_t *bufpos = buf + sizeof(*hdr);
-
+    const sock_dns_hdr_t *hdr = (const sock_dns_hdr_t *)buf;
+    const uint8_t *bufpos = buf + sizeof(*hdr);
+    unsigned flags = ntohs(hdr->flags);
+    unsigned ancount = ntohs(hdr->ancount);
+    unsigned rrcount = ancount + ntohs(hdr->nscount);
+
+    *ttl = SOCK_DNS_CACHE_NEG_TTL;
+    if (!(flags & DNS_FLAG_QR)) {
+        return -EBADMSG;
+    }
+    switch (flags & DNS_RCODE_MASK) {
+        case DNS_RCODE_NOERROR:
+            break;
+        case DNS_RCODE_NXDOMAIN:
+            /* only look for the SOA record in the authority section */
+            ancount = 0;
+            break;
+        default:
+            return -EBADMSG;
+    }
     /* skip all queries that are part of the reply */
     for (unsigned n = 0; n < ntohs(hdr->qdcount); n++) {
         ssize_t tmp = _skip_hostname(buf, len, bufpos);
@@ -119,59 +159,161 @@ static int _parse_dns_reply(uint8_t *buf, size_t len, void* addr_out, int family
         bufpos += (RR_TYPE_LENGTH + RR_CLASS_LENGTH);
     }
 
-    for (unsigned n = 0; n < ntohs(hdr->ancount); n++) {
+    for (unsigned n = 0; n < rrcount; n++) {
         ssize_t tmp = _skip_hostname(buf, len, bufpos);
         if (tmp < 0) {
             return tmp;
         }
         bufpos += tmp;
-        if ((bufpos + RR_TYPE_LENGTH + RR_CLASS_LENGTH + RR_TTL_LENGTH) >= buflim) {
+        if ((bufpos + RR_TYPE_LENGTH + RR_CLASS_LENGTH + RR_TTL_LENGTH +
+             RR_RDLENGTH_LENGTH) > buflim) {
             return -EBADMSG;
         }
         uint16_t _type = ntohs(_get_short(bufpos));
         bufpos += RR_TYPE_LENGTH;
         uint16_t class = ntohs(_get_short(bufpos));
         bufpos += RR_CLASS_LENGTH;
-        bufpos += RR_TTL_LENGTH; /* skip ttl */
-
-        unsigned addrlen = ntohs(_get_short(bufpos));
-        /* skip unwanted answers */
-        if ((class != DNS_CLASS_IN) ||
-                ((_type == DNS_TYPE_A) && (family == AF_INET6)) ||
-                ((_type == DNS_TYPE_AAAA) && (family == AF_INET)) ||
-                ! ((_type == DNS_TYPE_A) || ((_type == DNS_TYPE_AAAA))
-                    )) {
-            if (addrlen > len) {
-                /* buffer wraps around memory space */
+        uint32_t rr_ttl = _get_ttl(bufpos);
+        bufpos += RR_TTL_LENGTH;
+        unsigned rdlength = ntohs(_get_short(bufpos));
+        bufpos += RR_RDLENGTH_LENGTH;
+
+        if (rdlength > (size_t)(buflim - bufpos)) {
+            return -EBADMSG;
+        }
+        if ((class == DNS_CLASS_IN) && (n < ancount) && (_type == type)) {
+            if (rdlength != ((type == DNS_TYPE_A) ? INADDRSZ : IN6ADDRSZ)) {
                 return -EBADMSG;
             }
-            bufpos += addrlen;
-            /* other out-of-bound is checked in `_skip_hostname()` at start of
-             * loop */
+            memcpy(addr_out, bufpos, rdlength);
+            *ttl = rr_ttl;
+            return rdlength;
+        }
+        if ((class == DNS_CLASS_IN) && (n >= ancount) &&
+            (_type == DNS_TYPE_SOA) && (rdlength >= DNS_SOA_MIN_LEN)) {
+            /* negative TTL is the minimum of the SOA's TTL and MINIMUM field,
+             * which is the last field of the SOA record (RFC 2308) */
+            uint32_t minimum = _get_ttl(bufpos + rdlength - RR_TTL_LENGTH);
+
+            *ttl = (minimum < rr_ttl) ? minimum : rr_ttl;
+        }
+        /* skip unwanted records */
+        bufpos += rdlength;
+    }
+
+    return -ENOENT;
+}
+
+static size_t _build_query(uint8_t *buf, const char *domain_name, uint16_t id,
+                           uint16_t type)
+{
+    sock_dns_hdr_t *hdr = (sock_dns_hdr_t*) buf;
+    uint8_t *bufpos = buf + sizeof(*hdr);
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->id = id;   /* random, so byte order does not matter */
+    hdr->flags = htons(0x0120);
+    hdr->qdcount = htons(1);
+    bufpos += _enc_domain_name(bufpos, domain_name);
+    bufpos += _put_short(bufpos, htons(type));
+    bufpos += _put_short(bufpos, htons(DNS_CLASS_IN));
+    return bufpos - buf;
+}
+
+static void _lookup_result(sock_dns_lookup_t *lookup, int res,
+                           const uint8_t *addr)
+{
+    if (res > 0) {
+        /* AAAA records are preferred over A records */
+        if ((lookup->res <= 0) || (res == IN6ADDRSZ)) {
+            memcpy(lookup->addr, addr, res);
+            lookup->res = res;
+        }
+    }
+    else if (lookup->res == -ETIMEDOUT) {
+        lookup->res = res;
+    }
+}
+
+int sock_dns_lookup_init(sock_dns_lookup_t *lookup, const char *domain_name,
+                         int family)
+{
+    memset(lookup, 0, sizeof(*lookup));
+    lookup->res = -ETIMEDOUT;
+    for (unsigned q = 0; q < SOCK_DNS_Q_NUMOF; q++) {
+        uint8_t addr[IN6ADDRSZ];
+        int res;
+
+        if ((family != AF_UNSPEC) && (family != _families[q])) {
             continue;
         }
-        if (((addrlen != INADDRSZ) && (family == AF_INET)) ||
-            ((addrlen != IN6ADDRSZ) && (family == AF_INET6)) ||
-            ((addrlen != IN6ADDRSZ) && (addrlen != INADDRSZ) &&
-             (family == AF_UNSPEC))) {
-            return -EBADMSG;
+        res = sock_dns_cache_get(domain_name, _types[q], addr);
+        if (res == 0) {
+            do {
+                lookup->id[q] = (uint16_t)random_uint32();
+            } while ((q > 0) && (lookup->id[q] == lookup->id[0]));
+            lookup->pending |= (1U << q);
         }
-        bufpos += RR_RDLENGTH_LENGTH;
-        if ((bufpos + addrlen) >= buflim) {
-            return -EBADMSG;
+        else {
+            _lookup_result(lookup, res, addr);
         }
+    }
+    return (sock_dns_lookup_done(lookup)) ? lookup->res : 0;
+}
+
+int sock_dns_lookup_send(const sock_dns_lookup_t *lookup, sock_udp_t *sock,
+                         const char *domain_name)
+{
+    uint8_t buf[SOCK_DNS_QUERYBUF_LEN];
 
-        memcpy(addr_out, bufpos, addrlen);
-        return addrlen;
+    for (unsigned q = 0; q < SOCK_DNS_Q_NUMOF; q++) {
+        if (lookup->pending & (1U << q)) {
+            size_t len = _build_query(buf, domain_name, lookup->id[q],
+                                      _types[q]);
+            ssize_t res = sock_udp_send(sock, buf, len, &sock_dns_server);
+
+            if (res < 0) {
+                return res;
+            }
+        }
     }
+    return 0;
+}
+
+bool sock_dns_lookup_handle(sock_dns_lookup_t *lookup, const char *domain_name,
+                            const uint8_t *buf, size_t len)
+{
+    const sock_dns_hdr_t *hdr = (const sock_dns_hdr_t *)buf;
 
-    return -1;
+    if (len < sizeof(sock_dns_hdr_t)) {
+        return sock_dns_lookup_done(lookup);
+    }
+    for (unsigned q = 0; q < SOCK_DNS_Q_NUMOF; q++) {
+        if ((lookup->pending & (1U << q)) && (hdr->id == lookup->id[q])) {
+            uint8_t addr[IN6ADDRSZ];
+            uint32_t ttl;
+            int res = -EBADMSG;
+
+            if (len >= DNS_MIN_REPLY_LEN) {
+                res = _parse_dns_reply(buf, len, addr, _types[q], &ttl);
+            }
+            if (res != -EBADMSG) {
+                sock_dns_cache_add(domain_name, _types[q], addr,
+                                   (res > 0) ? (unsigned)res : 0, ttl);
+            }
+            lookup->pending &= ~(1U << q);
+            _lookup_result(lookup, res, addr);
+            break;
+        }
+    }
+    return sock_dns_lookup_done(lookup);
 }
 
 int sock_dns_query(const char *domain_name, void *addr_out, int family)
 {
-    uint8_t buf[SOCK_DNS_QUERYBUF_LEN];
-    uint8_t reply_buf[512];
+    sock_dns_lookup_t lookup;
+    sock_udp_t sock_dns;
+    int res, send_res = 0;
 
     if (sock_dns_server.port == 0) {
         return -ECONNREFUSED;
@@ -181,60 +323,54 @@ int sock_dns_query(const char *domain_name, void *addr_out, int family)
         return -ENOSPC;
     }
 
-    sock_dns_hdr_t *hdr = (sock_dns_hdr_t*) buf;
-    memset(hdr, 0, sizeof(*hdr));
-    hdr->id = 0; /* random? */
-    hdr->flags = htons(0x0120);
-    hdr->qdcount = htons(1 + (family == AF_UNSPEC));
-
-    uint8_t *bufpos = buf + sizeof(*hdr);
-
-    unsigned _name_ptr;
-    if ((family == AF_INET6) || (family == AF_UNSPEC)) {
-        _name_ptr = (bufpos - buf);
-        bufpos += _enc_domain_name(bufpos, domain_name);
-        bufpos += _put_short(bufpos, htons(DNS_TYPE_AAAA));
-        bufpos += _put_short(bufpos, htons(DNS_CLASS_IN));
-    }
-
-    if ((family == AF_INET) || (family == AF_UNSPEC)) {
-        if (family == AF_UNSPEC) {
-            bufpos += _put_short(bufpos, htons((0xc000) | (_name_ptr)));
-        }
-        else {
-            bufpos += _enc_domain_name(bufpos, domain_name);
-        }
-        bufpos += _put_short(bufpos, htons(DNS_TYPE_A));
-        bufpos += _put_short(bufpos, htons(DNS_CLASS_IN));
+    if ((res = sock_dns_lookup_init(&lookup, domain_name, family)) != 0) {
+        /* answered from cache */
+        goto out;
     }
 
-    sock_udp_t sock_dns;
-
-    ssize_t res = sock_udp_create(&sock_dns, NULL, &sock_dns_server, 0);
+    res = sock_udp_create(&sock_dns, NULL, &sock_dns_server, 0);
     if (res) {
-        goto out;
+        return res;
     }
 
-    for (int i = 0; i < SOCK_DNS_RETRIES; i++) {
-        res = sock_udp_send(&sock_dns, buf, (bufpos-buf), NULL);
-        if (res <= 0) {
+    for (int i = 0; (i < SOCK_DNS_RETRIES) && !sock_dns_lookup_done(&lookup);
+         i++) {
+        /* all unanswered queries are in flight at the same time */
+        send_res = sock_dns_lookup_send(&lookup, &sock_dns, domain_name);
+        if (send_res < 0) {
             continue;
         }
-        res = sock_udp_recv(&sock_dns, reply_buf, sizeof(reply_buf), 1000000LU, NULL);
-        if (res > 0) {
-            if (res > (int)DNS_MIN_REPLY_LEN) {
-                if ((res = _parse_dns_reply(reply_buf, res, addr_out,
-                                            family)) > 0) {
-                    goto out;
-                }
+        uint32_t deadline = xtimer_now_usec() + SOCK_DNS_TIMEOUT_US;
+
+        while (!sock_dns_lookup_done(&lookup)) {
+            int32_t left = (int32_t)(deadline - xtimer_now_usec());
+            void *data, *ctx = NULL;
+
+            if (left <= 0) {
+                break;
             }
-            else {
-                res = -EBADMSG;
+            /* parse the reply directly in the network stack's buffer */
+            res = sock_udp_recv_buf(&sock_dns, &data, &ctx, left, NULL);
+            if (res < 0) {
+                if (res == -EPROTO) {
+                    /* not from the DNS server */
+                    continue;
+                }
+                break;
             }
+            sock_dns_lookup_handle(&lookup, domain_name, data, res);
+            sock_udp_recv_buf(&sock_dns, &data, &ctx, 0, NULL);
         }
     }
+    sock_udp_close(&sock_dns);
+    res = lookup.res;
+    if ((res == -ETIMEDOUT) && (send_res < 0)) {
+        res = send_res;
+    }
 
 out:
-    sock_udp_close(&sock_dns);
+    if (res > 0) {
+        memcpy(addr_out, lookup.addr, res);
+    }
     return res;
 }
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup net_sock_dns
+ * @internal
+ * @{
+ *
+ * @file
+ * @brief   Definitions shared by the sock DNS client modules
+ */
+#ifndef DNS_INTERNAL_H
+#define DNS_INTERNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "net/sock/dns.h"
+#include "net/sock/udp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    Indexes of the queries of a look-up
+ * @{
+ */
+#define SOCK_DNS_Q_AAAA     (0U)    /**< AAAA query */
+#define SOCK_DNS_Q_A        (1U)    /**< A query */
+#define SOCK_DNS_Q_NUMOF    (2U)    /**< number of queries per look-up */
+/** @} */
+
+/**
+ * @brief   State of a look-up of a single domain name
+ */
+typedef struct {
+    uint8_t addr[16];                   /**< best address so far */
+    int res;                            /**< result for sock_dns_lookup_t::addr */
+    uint16_t id[SOCK_DNS_Q_NUMOF];      /**< transaction IDs of the queries */
+    uint8_t pending;                    /**< bitmap of unanswered queries */
+} sock_dns_lookup_t;
+
+/**
+ * @brief   Starts a look-up
+ *
+ * @param[out] lookup       The look-up.
+ * @param[in] domain_name   Name to look up.
+ * @param[in] family        Either AF_INET, AF_INET6 or AF_UNSPEC.
+ *
+ * @return  0, if queries need to be sent.
+ * @return  sock_dns_lookup_t::res, if the look-up was answered from cache.
+ */
+int sock_dns_lookup_init(sock_dns_lookup_t *lookup, const char *domain_name,
+                         int family);
+
+/**
+ * @brief   Sends all unanswered queries of a look-up
+ *
+ * @param[in] lookup        The look-up.
+ * @param[in] sock          Sock to send the queries with.
+ * @param[in] domain_name   Name to look up.
+ *
+ * @return  0 on success.
+ * @return  negative errno, if sending failed.
+ */
+int sock_dns_lookup_send(const sock_dns_lookup_t *lookup, sock_udp_t *sock,
+                         const char *domain_name);
+
+/**
+ * @brief   Applies a reply to a look-up
+ *
+ * @param[in,out] lookup    The look-up.
+ * @param[in] domain_name   Name to look up.
+ * @param[in] buf           The reply.
+ * @param[in] len           Length of @p buf.
+ *
+ * @return  true, if the look-up is complete.
+ */
+bool sock_dns_lookup_handle(sock_dns_lookup_t *lookup, const char *domain_name,
+                            const uint8_t *buf, size_t len);
+
+/**
+ * @brief   Checks if a look-up is complete
+ */
+static inline bool sock_dns_lookup_done(const sock_dns_lookup_t *lookup)
+{
+    /* AAAA is preferred, so an AAAA record makes the A query obsolete */
+    return (lookup->pending == 0) ||
+           ((lookup->res > 0) && (lookup->res == 16));
+}
+
+#if defined(MODULE_SOCK_DNS_CACHE) || defined(DOXYGEN)
+/**
+ * @brief   Gets a look-up result from the cache
+ *
+ * @param[in] domain_name   Name to look up.
+ * @param[in] type          DNS_TYPE_A or DNS_TYPE_AAAA.
+ * @param[out] addr_out     The cached address.
+ *
+ * @return  length of @p addr_out on hit.
+ * @return  -ENOENT on a cached failed look-up.
+ * @return  0 on a miss.
+ */
+int sock_dns_cache_get(const char *domain_name, uint16_t type, void *addr_out);
+
+/**
+ * @brief   Adds a look-up result to the cache
+ *
+ * @param[in] domain_name   Name that was looked up.
+ * @param[in] type          DNS_TYPE_A or DNS_TYPE_AAAA.
+ * @param[in] addr          The address. May be NULL if @p addr_len is 0.
+ * @param[in] addr_len      Length of @p addr. 0 for a failed look-up.
+ * @param[in] ttl           Time-to-live in seconds.
+ */
+void sock_dns_cache_add(const char *domain_name, uint16_t type,
+                        const void *addr, unsigned addr_len, uint32_t ttl);
+#else
+static inline int sock_dns_cache_get(const char *domain_name, uint16_t type,
+                                     void *addr_out)
+{
+    (void)domain_name;
+    (void)type;
+    (void)addr_out;
+    return 0;
+}
+
+static inline void sock_dns_cache_add(const char *domain_name, uint16_t type,
+                                      const void *addr, unsigned addr_len,
+                                      uint32_t ttl)
+{
+    (void)domain_name;
+    (void)type;
+    (void)addr;
+    (void)addr_len;
+    (void)ttl;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DNS_INTERNAL_H */
+/** @} */
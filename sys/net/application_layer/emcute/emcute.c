@@ -20,9 +20,11 @@
 
 #include <string.h>
 
+#include "iolist.h"
 #include "log.h"
 #include "mutex.h"
 #include "sched.h"
+#include "thread.h"
 #include "xtimer.h"
 #include "byteorder.h"
 #include "thread_flags.h"
@@ -43,6 +45,8 @@
 #define TFLAGS_TIMEOUT      (0x0002)
 #define TFLAGS_ANY          (TFLAGS_RESP | TFLAGS_TIMEOUT)
 
+#define REQ_PENDING         (1)
+
 
 static const char *cli_id;
 static sock_udp_t sock;
@@ -55,10 +59,12 @@ static emcute_sub_t *subs = NULL;
 
 static mutex_t txlock;
 
+static emcute_req_t *reqs = NULL;
+static mutex_t reqlock = MUTEX_INIT;
+
 static xtimer_t timer;
 static uint16_t id_next = 0x1234;
 static volatile uint8_t waiton = 0xff;
-static volatile uint16_t waitonid = 0;
 static volatile int result;
 
 static size_t set_len(uint8_t *buf, size_t len)
@@ -69,7 +75,7 @@ static size_t set_len(uint8_t *buf, size_t len)
     }
     else {
         buf[0] = 0x01;
-        byteorder_htobebufs(&tbuf[1], (uint16_t)(len + 3));
+        byteorder_htobebufs(&buf[1], (uint16_t)(len + 3));
         return 3;
     }
 }
@@ -131,19 +137,78 @@ static void on_disconnect(void)
     }
 }
 
-static void on_ack(uint8_t type, int id_pos, int ret_pos, int res_pos)
+static void req_send(emcute_req_t *req)
 {
-    if ((waiton == type) &&
-        (!id_pos || (waitonid == byteorder_bebuftohs(&rbuf[id_pos])))) {
-        if (!ret_pos || (rbuf[ret_pos] == ACCEPT)) {
-            if (res_pos == 0) {
-                result = EMCUTE_OK;
-            } else {
-                result = (int)byteorder_bebuftohs(&rbuf[res_pos]);
+    iolist_t data = { NULL, (void *)req->data, req->len };
+    iolist_t hdr = { (req->len > 0) ? &data : NULL, req->hdr, req->hdr_len };
+
+    sock_udp_sendv(&sock, &hdr, &gateway);
+}
+
+static int req_start(emcute_req_t *req, uint8_t ack)
+{
+    req->ack = ack;
+    req->pid = thread_getpid();
+    req->retries = EMCUTE_N_RETRY;
+    req->result = REQ_PENDING;
+
+    mutex_lock(&reqlock);
+    /* the message ID always closes the header */
+    req->id = id_next++;
+    byteorder_htobebufs(&req->hdr[req->hdr_len - 2], req->id);
+    req->deadline = xtimer_now_usec() + (EMCUTE_T_RETRY * US_PER_SEC);
+    req->next = reqs;
+    reqs = req;
+    mutex_unlock(&reqlock);
+
+    req_send(req);
+    return EMCUTE_OK;
+}
+
+static void on_req_ack(uint8_t type, uint16_t id, int res)
+{
+    mutex_lock(&reqlock);
+    for (emcute_req_t **prev = &reqs; *prev; prev = &(*prev)->next) {
+        emcute_req_t *req = *prev;
+
+        if ((req->ack == type) && (req->id == id)) {
+            thread_t *thread = (thread_t *)thread_get(req->pid);
+
+            *prev = req->next;
+            if (res > 0) {
+                req->topic->id = (uint16_t)res;
+                res = EMCUTE_OK;
             }
+            /* req may be gone as soon as the waiting thread sees its result */
+            req->result = res;
+            thread_flags_set(thread, TFLAGS_RESP);
+            break;
+        }
+    }
+    mutex_unlock(&reqlock);
+}
+
+static void on_ack(uint8_t type, int id_pos, int ret_pos, int res_pos)
+{
+    if ((waiton != type) && !id_pos) {
+        return;
+    }
+    int res;
+
+    if (!ret_pos || (rbuf[ret_pos] == ACCEPT)) {
+        if (res_pos == 0) {
+            res = EMCUTE_OK;
         } else {
-            result = EMCUTE_REJECT;
+            res = (int)byteorder_bebuftohs(&rbuf[res_pos]);
         }
+    } else {
+        res = EMCUTE_REJECT;
+    }
+    if (id_pos) {
+        on_req_ack(type, byteorder_bebuftohs(&rbuf[id_pos]), res);
+    }
+    else {
+        result = res;
         thread_flags_set((thread_t *)timer.arg, TFLAGS_RESP);
     }
 }
@@ -297,9 +362,9 @@ int emcute_discon(void)
     return syncsend(DISCONNECT, 2, true);
 }
 
-int emcute_reg(emcute_topic_t *topic)
+int emcute_reg_start(emcute_req_t *req, emcute_topic_t *topic)
 {
-    assert(topic && topic->name);
+    assert(req && topic && topic->name);
 
     if (gateway.port == 0) {
         return EMCUTE_NOGW;
@@ -308,29 +373,33 @@ int emcute_reg(emcute_topic_t *topic)
         return EMCUTE_OVERFLOW;
     }
 
-    mutex_lock(&txlock);
+    req->hdr[0] = (strlen(topic->name) + 6);
+    req->hdr[1] = REGISTER;
+    byteorder_htobebufs(&req->hdr[2], 0);
+    req->hdr_len = 6;
+    req->topic = topic;
+    req->data = topic->name;
+    req->len = strlen(topic->name);
+
+    return req_start(req, REGACK);
+}
 
-    tbuf[0] = (strlen(topic->name) + 6);
-    tbuf[1] = REGISTER;
-    byteorder_htobebufs(&tbuf[2], 0);
-    byteorder_htobebufs(&tbuf[4], id_next);
-    waitonid = id_next++;
-    memcpy(&tbuf[6], topic->name, strlen(topic->name));
+int emcute_reg(emcute_topic_t *topic)
+{
+    emcute_req_t req;
 
-    int res = syncsend(REGACK, (size_t)tbuf[0], true);
-    if (res > 0) {
-        topic->id = (uint16_t)res;
-        res = EMCUTE_OK;
+    int res = emcute_reg_start(&req, topic);
+    if (res != EMCUTE_OK) {
+        return res;
     }
-    return res;
+    return emcute_req_wait(&req);
 }
 
-int emcute_pub(emcute_topic_t *topic, const void *data, size_t len,
-               unsigned flags)
+int emcute_pub_start(emcute_req_t *req, emcute_topic_t *topic,
+                     const void *data, size_t len, unsigned flags)
 {
-    int res = EMCUTE_OK;
-
-    assert((topic->id != 0) && data && (len > 0) && !(flags & ~PUB_FLAGS));
+    assert(req && (topic->id != 0) && data && (len > 0) &&
+           !(flags & ~PUB_FLAGS));
 
     if (gateway.port == 0) {
         return EMCUTE_NOGW;
@@ -342,32 +411,102 @@ int emcute_pub(emcute_topic_t *topic, const void *data, size_t len,
         return EMCUTE_NOTSUP;
     }
 
-    mutex_lock(&txlock);
-
-    size_t pos = set_len(tbuf, (len + 6));
-    len += (pos + 6);
-    tbuf[pos++] = PUBLISH;
-    tbuf[pos++] = flags;
-    byteorder_htobebufs(&tbuf[pos], topic->id);
-    pos += 2;
-    byteorder_htobebufs(&tbuf[pos], id_next);
-    waitonid = id_next++;
+    size_t pos = set_len(req->hdr, (len + 6));
+    req->hdr[pos++] = PUBLISH;
+    req->hdr[pos++] = flags;
+    byteorder_htobebufs(&req->hdr[pos], topic->id);
     pos += 2;
-    memcpy(&tbuf[pos], data, len);
+    req->hdr_len = pos + 2;
+    req->topic = topic;
+    req->data = data;
+    req->len = len;
 
     if (flags & EMCUTE_QOS_1) {
-        res = syncsend(PUBACK, len, true);
+        return req_start(req, PUBACK);
+    }
+    /* QoS 0 is not acknowledged, so the request completes right away */
+    mutex_lock(&reqlock);
+    byteorder_htobebufs(&req->hdr[pos], id_next++);
+    mutex_unlock(&reqlock);
+    req->pid = thread_getpid();
+    req->result = EMCUTE_OK;
+    req_send(req);
+    return EMCUTE_OK;
+}
+
+int emcute_pub(emcute_topic_t *topic, const void *data, size_t len,
+               unsigned flags)
+{
+    emcute_req_t req;
+
+    int res = emcute_pub_start(&req, topic, data, len, flags);
+    if (res != EMCUTE_OK) {
+        return res;
     }
-    else {
-        sock_udp_send(&sock, tbuf, len, &gateway);
-        mutex_unlock(&txlock);
+    return emcute_req_wait(&req);
+}
+
+int emcute_req_wait(emcute_req_t *req)
+{
+    xtimer_t retry = { .callback = time_evt,
+                       .arg = (void *)sched_active_thread };
+    kernel_pid_t pid = thread_getpid();
+
+    assert(req && (req->pid == pid));
+
+    while (req->result == REQ_PENDING) {
+        uint32_t now = xtimer_now_usec();
+        uint32_t next = (EMCUTE_T_RETRY * US_PER_SEC);
+
+        /* retransmit all due requests of this thread, not only req */
+        mutex_lock(&reqlock);
+        for (emcute_req_t **prev = &reqs; *prev;) {
+            emcute_req_t *r = *prev;
+            int32_t left = (int32_t)(r->deadline - now);
+
+            if ((r->pid != pid) || (left > 0)) {
+                if ((r->pid == pid) && ((uint32_t)left < next)) {
+                    next = (uint32_t)left;
+                }
+                prev = &r->next;
+                continue;
+            }
+            if (r->retries == 0) {
+                *prev = r->next;
+                r->result = EMCUTE_TIMEOUT;
+                continue;
+            }
+            DEBUG("[emcute] req_wait: retransmitting message %u\n",
+                  (unsigned)r->id);
+            r->retries--;
+            r->deadline = now + (EMCUTE_T_RETRY * US_PER_SEC);
+            if (r->ack == PUBACK) {
+                r->hdr[r->hdr_len - 5] |= EMCUTE_DUP;
+            }
+            else if (r->ack == SUBACK) {
+                r->hdr[r->hdr_len - 3] |= EMCUTE_DUP;
+            }
+            req_send(r);
+            prev = &r->next;
+        }
+        if (req->result != REQ_PENDING) {
+            mutex_unlock(&reqlock);
+            break;
+        }
+        /* a reply may arrive before we wait for it, the flag stays set then */
+        xtimer_set(&retry, next);
+        mutex_unlock(&reqlock);
+        thread_flags_wait_any(TFLAGS_ANY);
+        xtimer_remove(&retry);
     }
 
-    return res;
+    return req->result;
 }
 
 int emcute_sub(emcute_sub_t *sub, unsigned flags)
 {
+    emcute_req_t req;
+
     assert(sub && (sub->cb) && (sub->topic.name) && !(flags & ~SUB_FLAGS));
 
     if (gateway.port == 0) {
@@ -377,53 +516,55 @@ int emcute_sub(emcute_sub_t *sub, unsigned flags)
         return EMCUTE_OVERFLOW;
     }
 
-    mutex_lock(&txlock);
-
-    tbuf[0] = (strlen(sub->topic.name) + 5);
-    tbuf[1] = SUBSCRIBE;
-    tbuf[2] = flags;
-    byteorder_htobebufs(&tbuf[3], id_next);
-    waitonid = id_next++;
-    memcpy(&tbuf[5], sub->topic.name, strlen(sub->topic.name));
+    req.hdr[0] = (strlen(sub->topic.name) + 5);
+    req.hdr[1] = SUBSCRIBE;
+    req.hdr[2] = flags;
+    req.hdr_len = 5;
+    req.topic = &sub->topic;
+    req.data = sub->topic.name;
+    req.len = strlen(sub->topic.name);
 
-    int res = syncsend(SUBACK, (size_t)tbuf[0], false);
-    if (res > 0) {
-        DEBUG("[emcute] sub: success, topic id is %i\n", res);
-        sub->topic.id = res;
+    req_start(&req, SUBACK);
+    int res = emcute_req_wait(&req);
+    if (res == EMCUTE_OK) {
+        DEBUG("[emcute] sub: success, topic id is %i\n", (int)sub->topic.id);
 
+        mutex_lock(&txlock);
         /* check if subscription is already in the list, only insert if not*/
         emcute_sub_t *s;
         for (s = subs; s && (s != sub); s = s->next) {}
         if (!s) {
             sub->next = subs;
             subs = sub;
-            res = EMCUTE_OK;
         }
+        mutex_unlock(&txlock);
     }
 
-    mutex_unlock(&txlock);
     return res;
 }
 
 int emcute_unsub(emcute_sub_t *sub)
 {
+    emcute_req_t req;
+
     assert(sub && sub->topic.name);
 
     if (gateway.port == 0) {
         return EMCUTE_NOGW;
     }
 
-    mutex_lock(&txlock);
+    req.hdr[0] = (strlen(sub->topic.name) + 5);
+    req.hdr[1] = UNSUBSCRIBE;
+    req.hdr[2] = 0;
+    req.hdr_len = 5;
+    req.topic = NULL;
+    req.data = sub->topic.name;
+    req.len = strlen(sub->topic.name);
 
-    tbuf[0] = (strlen(sub->topic.name) + 5);
-    tbuf[1] = UNSUBSCRIBE;
-    tbuf[2] = 0;
-    byteorder_htobebufs(&tbuf[3], id_next);
-    waitonid = id_next++;
-    memcpy(&tbuf[5], sub->topic.name, strlen(sub->topic.name));
-
-    int res = syncsend(UNSUBACK, (size_t)tbuf[0], false);
+    req_start(&req, UNSUBACK);
+    int res = emcute_req_wait(&req);
     if (res == EMCUTE_OK) {
+        mutex_lock(&txlock);
         if (subs == sub) {
             subs = sub->next;
         }
@@ -436,9 +577,9 @@ int emcute_unsub(emcute_sub_t *sub)
                 }
             }
         }
+        mutex_unlock(&txlock);
     }
 
-    mutex_unlock(&txlock);
     return res;
 }
 
@@ -0,0 +1,433 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gcoap_block
+ * @{
+ *
+ * @file
+ * @brief       Gcoap block-wise transfer engine
+ *
+ * Each block is requested with its own token. Responses and timeouts are
+ * matched to their transfer and block by that token, as the response handler
+ * of gcoap carries no context.
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "assert.h"
+#include "mutex.h"
+#include "net/gcoap/block.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+static mutex_t _lock = MUTEX_INIT;
+static gcoap_block_t *_xfers;
+static uint8_t _buf[GCOAP_PDU_BUF_SIZE];    /* protected by _lock */
+
+static void _resp_handler(unsigned req_state, coap_pkt_t *pdu,
+                          sock_udp_ep_t *remote);
+
+static inline bool _is_upload(const gcoap_block_t *xfer)
+{
+    return (xfer->code != COAP_METHOD_GET);
+}
+
+static inline uint32_t _last_blk(size_t len, unsigned szx)
+{
+    return (len > 0) ? ((len - 1) >> (szx + 4)) : 0;
+}
+
+static unsigned _in_flight(const gcoap_block_t *xfer)
+{
+    unsigned res = 0;
+
+    for (unsigned i = 0; i < GCOAP_BLOCK_WINDOW_MAX; i++) {
+        res += xfer->slots[i].used;
+    }
+    return res;
+}
+
+static gcoap_block_slot_t *_free_slot(gcoap_block_t *xfer)
+{
+    for (unsigned i = 0; i < GCOAP_BLOCK_WINDOW_MAX; i++) {
+        if (!xfer->slots[i].used) {
+            return &xfer->slots[i];
+        }
+    }
+    return NULL;
+}
+
+static void _drop_slots(gcoap_block_t *xfer, uint32_t after)
+{
+    for (unsigned i = 0; i < GCOAP_BLOCK_WINDOW_MAX; i++) {
+        if (xfer->slots[i].blknum > after) {
+            /* a late response will not find its slot and is ignored */
+            xfer->slots[i].used = false;
+        }
+    }
+}
+
+static void _clear_slots(gcoap_block_t *xfer)
+{
+    for (unsigned i = 0; i < GCOAP_BLOCK_WINDOW_MAX; i++) {
+        xfer->slots[i].used = false;
+    }
+}
+
+static bool _unlink(gcoap_block_t *xfer)
+{
+    for (gcoap_block_t **ptr = &_xfers; *ptr != NULL; ptr = &(*ptr)->next) {
+        if (*ptr == xfer) {
+            *ptr = xfer->next;
+            _clear_slots(xfer);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _find(coap_pkt_t *pdu, gcoap_block_t **xfer_ptr,
+                  gcoap_block_slot_t **slot_ptr)
+{
+    const uint8_t *token = coap_hdr_data_ptr(pdu->hdr);
+
+    if (coap_get_token_len(pdu) != GCOAP_TOKENLEN) {
+        return false;
+    }
+    for (gcoap_block_t *xfer = _xfers; xfer != NULL; xfer = xfer->next) {
+        for (unsigned i = 0; i < GCOAP_BLOCK_WINDOW_MAX; i++) {
+            gcoap_block_slot_t *slot = &xfer->slots[i];
+
+            if (slot->used &&
+                (memcmp(slot->token, token, GCOAP_TOKENLEN) == 0)) {
+                *xfer_ptr = xfer;
+                *slot_ptr = slot;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static int _send(gcoap_block_t *xfer, gcoap_block_slot_t *slot)
+{
+    coap_pkt_t pdu;
+    ssize_t len;
+
+    if (gcoap_req_init(&pdu, _buf, sizeof(_buf), xfer->code, xfer->path) < 0) {
+        return -ENOBUFS;
+    }
+    if (_is_upload(xfer)) {
+        size_t offset = (size_t)slot->blknum << (xfer->szx + 4);
+        size_t blk_len = xfer->len - offset;
+        bool more = (slot->blknum < xfer->last_blk);
+        int res;
+
+        if (more) {
+            blk_len = coap_szx2size(xfer->szx);
+        }
+        if ((xfer->format != COAP_FORMAT_NONE) &&
+            (coap_opt_add_format(&pdu, xfer->format) < 0)) {
+            return -ENOBUFS;
+        }
+        if ((coap_opt_add_uint(&pdu, COAP_OPT_BLOCK1,
+                               (slot->blknum << 4) | (more << 3) |
+                               xfer->szx) < 0) ||
+            ((len = coap_opt_finish(&pdu, (blk_len > 0) ?
+                                    COAP_OPT_FINISH_PAYLOAD :
+                                    COAP_OPT_FINISH_NONE)) < 0) ||
+            (pdu.payload_len < blk_len)) {
+            return -ENOBUFS;
+        }
+        if ((res = xfer->data_cb(xfer, offset, pdu.payload, blk_len,
+                                 more)) < 0) {
+            return res;
+        }
+        len += blk_len;
+    }
+    else if ((coap_opt_add_uint(&pdu, COAP_OPT_BLOCK2,
+                                (slot->blknum << 4) | xfer->szx) < 0) ||
+             ((len = coap_opt_finish(&pdu, COAP_OPT_FINISH_NONE)) < 0)) {
+        return -ENOBUFS;
+    }
+    memcpy(slot->token, coap_hdr_data_ptr(pdu.hdr), GCOAP_TOKENLEN);
+    slot->used = true;
+    if (gcoap_req_send(_buf, len, &xfer->remote, _resp_handler) == 0) {
+        slot->used = false;
+        return -ENOMEM;
+    }
+    DEBUG("gcoap_block: requested block %" PRIu32 "\n", slot->blknum);
+    return 0;
+}
+
+static int _fill(gcoap_block_t *xfer)
+{
+    unsigned in_flight = _in_flight(xfer);
+
+    while ((in_flight < xfer->window) && (xfer->next_blk <= xfer->last_blk)) {
+        gcoap_block_slot_t *slot = _free_slot(xfer);
+        int res;
+
+        if (_is_upload(xfer) && (xfer->next_blk == xfer->last_blk) &&
+            (in_flight > 0)) {
+            /* the final response needs to cover all blocks */
+            break;
+        }
+        slot->blknum = xfer->next_blk;
+        slot->retries = 0;
+        if ((res = _send(xfer, slot)) < 0) {
+            if ((res == -ENOMEM) && (in_flight > 0)) {
+                /* continue once a response freed a request memo */
+                break;
+            }
+            return res;
+        }
+        xfer->next_blk++;
+        in_flight++;
+    }
+    return 0;
+}
+
+static int _handle_download(gcoap_block_t *xfer, uint32_t blknum,
+                            coap_pkt_t *pdu)
+{
+    coap_block1_t block2;
+
+    if (!coap_get_block2(pdu, &block2)) {
+        /* server does not know block-wise transfers, so the response holds
+         * the whole representation */
+        if (blknum > 0) {
+            return 0;
+        }
+        block2.blknum = 0;
+        block2.szx = xfer->szx;
+        block2.more = 0;
+    }
+    else if (pdu->payload_len > coap_szx2size(block2.szx)) {
+        return -EBADMSG;
+    }
+    else if (block2.szx != xfer->szx) {
+        if (xfer->started || (block2.szx > xfer->szx)) {
+            return -EBADMSG;
+        }
+        /* server picked a smaller block size: start over with it */
+        DEBUG("gcoap_block: block size reduced to %u\n",
+              coap_szx2size(block2.szx));
+        xfer->szx = block2.szx;
+        _clear_slots(xfer);
+        if (block2.blknum != 0) {
+            xfer->next_blk = 0;
+            return 0;
+        }
+        xfer->next_blk = 1;
+    }
+    if (block2.blknum > xfer->last_blk) {
+        /* request past the end */
+        return 0;
+    }
+    if (!block2.more) {
+        xfer->last_blk = block2.blknum;
+        _drop_slots(xfer, xfer->last_blk);
+    }
+    else if (block2.blknum == xfer->last_blk) {
+        return -EBADMSG;
+    }
+    xfer->started = true;
+    if (pdu->payload_len > 0) {
+        size_t offset = (size_t)block2.blknum << (block2.szx + 4);
+
+        if ((offset + pdu->payload_len) > xfer->len) {
+            xfer->len = offset + pdu->payload_len;
+        }
+        return xfer->data_cb(xfer, offset, pdu->payload, pdu->payload_len,
+                             block2.more);
+    }
+    return 0;
+}
+
+/* While the length of a download is unknown, blocks past its end are
+ * requested. A client error for such a block is taken as the end of the
+ * resource, if a block before it is still awaited: that one tells whether
+ * it is the last block, a later error must then be a real one. */
+static bool _past_end(gcoap_block_t *xfer, uint32_t blknum, coap_pkt_t *pdu)
+{
+    if (_is_upload(xfer) || (blknum == 0) ||
+        (coap_get_code_class(pdu) != COAP_CLASS_CLIENT_FAILURE)) {
+        return false;
+    }
+    for (unsigned i = 0; i < GCOAP_BLOCK_WINDOW_MAX; i++) {
+        if (xfer->slots[i].used && (xfer->slots[i].blknum < blknum)) {
+            DEBUG("gcoap_block: block %" PRIu32 " past the end\n", blknum);
+            if ((blknum - 1) < xfer->last_blk) {
+                xfer->last_blk = blknum - 1;
+                _drop_slots(xfer, xfer->last_blk);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static int _handle_upload(gcoap_block_t *xfer, coap_pkt_t *pdu)
+{
+    coap_block1_t block1;
+
+    if (coap_get_block1(pdu, &block1) && (block1.szx != xfer->szx)) {
+        if (xfer->started || (block1.szx > xfer->szx)) {
+            return -EBADMSG;
+        }
+        /* server asks for smaller blocks: start over with them */
+        DEBUG("gcoap_block: block size reduced to %u\n",
+              coap_szx2size(block1.szx));
+        xfer->szx = block1.szx;
+        _clear_slots(xfer);
+        xfer->next_blk = 0;
+        xfer->last_blk = _last_blk(xfer->len, xfer->szx);
+        return 0;
+    }
+    xfer->started = true;
+    return 0;
+}
+
+static void _resp_handler(unsigned req_state, coap_pkt_t *pdu,
+                          sock_udp_ep_t *remote)
+{
+    gcoap_block_done_cb_t done_cb = NULL;
+    gcoap_block_t *xfer;
+    gcoap_block_slot_t *slot;
+    int res;
+
+    (void)remote;
+    mutex_lock(&_lock);
+    if (!_find(pdu, &xfer, &slot)) {
+        /* canceled, or a request past the end of a download */
+        mutex_unlock(&_lock);
+        return;
+    }
+    slot->used = false;
+    if (req_state == GCOAP_MEMO_TIMEOUT) {
+        DEBUG("gcoap_block: block %" PRIu32 " timed out\n", slot->blknum);
+        res = (slot->retries++ < GCOAP_BLOCK_RETRIES) ? _send(xfer, slot)
+                                                      : -ETIMEDOUT;
+    }
+    else if (req_state != GCOAP_MEMO_RESP) {
+        res = -EBADMSG;
+    }
+    else if (_past_end(xfer, slot->blknum, pdu)) {
+        res = 0;
+    }
+    else {
+        xfer->resp_code = coap_get_code_raw(pdu);
+        if (coap_get_code_class(pdu) != COAP_CLASS_SUCCESS) {
+            res = -EBADMSG;
+        }
+        else if (_is_upload(xfer)) {
+            res = _handle_upload(xfer, pdu);
+        }
+        else {
+            res = _handle_download(xfer, slot->blknum, pdu);
+        }
+    }
+    if (res == 0) {
+        res = _fill(xfer);
+    }
+    if ((res < 0) ||
+        ((xfer->next_blk > xfer->last_blk) && (_in_flight(xfer) == 0))) {
+        _unlink(xfer);
+        done_cb = xfer->done_cb;
+        if (res == 0) {
+            res = (int)xfer->len;
+        }
+    }
+    mutex_unlock(&_lock);
+    if (done_cb != NULL) {
+        done_cb(xfer, res);
+    }
+}
+
+static int _start(gcoap_block_t *xfer)
+{
+    int res;
+
+    if ((xfer->szx > (NANOCOAP_BLOCK_SIZE_EXP_MAX - 4)) ||
+        (xfer->window == 0) || (xfer->window > GCOAP_BLOCK_WINDOW_MAX)) {
+        return -EINVAL;
+    }
+    mutex_lock(&_lock);
+    for (gcoap_block_t *tmp = _xfers; tmp != NULL; tmp = tmp->next) {
+        if (tmp == xfer) {
+            mutex_unlock(&_lock);
+            return -EBUSY;
+        }
+    }
+    memset(xfer->slots, 0, sizeof(xfer->slots));
+    xfer->next_blk = 0;
+    xfer->started = false;
+    xfer->next = _xfers;
+    _xfers = xfer;
+    if ((res = _fill(xfer)) < 0) {
+        _unlink(xfer);
+    }
+    mutex_unlock(&_lock);
+    return res;
+}
+
+void gcoap_block_init(gcoap_block_t *xfer, const sock_udp_ep_t *remote,
+                      const char *path, gcoap_block_data_cb_t data_cb,
+                      gcoap_block_done_cb_t done_cb, void *arg)
+{
+    assert((xfer != NULL) && (remote != NULL) && (path != NULL));
+    memset(xfer, 0, sizeof(*xfer));
+    memcpy(&xfer->remote, remote, sizeof(xfer->remote));
+    xfer->path = path;
+    xfer->data_cb = data_cb;
+    xfer->done_cb = done_cb;
+    xfer->arg = arg;
+    xfer->szx = GCOAP_BLOCK_SZX;
+    xfer->window = GCOAP_BLOCK_WINDOW_MAX;
+}
+
+int gcoap_block_get(gcoap_block_t *xfer)
+{
+    xfer->code = COAP_METHOD_GET;
+    xfer->format = COAP_FORMAT_NONE;
+    xfer->len = 0;
+    xfer->last_blk = UINT32_MAX;
+    return _start(xfer);
+}
+
+int gcoap_block_put(gcoap_block_t *xfer, unsigned code, size_t len,
+                    unsigned format)
+{
+    if ((code != COAP_METHOD_PUT) && (code != COAP_METHOD_POST)) {
+        return -EINVAL;
+    }
+    xfer->code = code;
+    xfer->format = format;
+    xfer->len = len;
+    xfer->last_blk = _last_blk(len, xfer->szx);
+    return _start(xfer);
+}
+
+void gcoap_block_cancel(gcoap_block_t *xfer)
+{
+    bool active;
+
+    mutex_lock(&_lock);
+    active = _unlink(xfer);
+    mutex_unlock(&_lock);
+    if (active && (xfer->done_cb != NULL)) {
+        xfer->done_cb(xfer, -ECANCELED);
+    }
+}
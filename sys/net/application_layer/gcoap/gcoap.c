@@ -24,6 +24,7 @@
 #include <string.h>
 
 #include "assert.h"
+#include "kernel_defines.h"
 #include "net/gcoap.h"
 #include "net/sock/util.h"
 #include "mutex.h"
@@ -54,6 +55,9 @@ static int _find_obs_memo(gcoap_observe_memo_t **memo, sock_udp_ep_t *remote,
                                                        coap_pkt_t *pdu);
 static void _find_obs_memo_resource(gcoap_observe_memo_t **memo,
                                    const coap_resource_t *resource);
+static void _obs_wake(void *arg);
+static void _obs_run(void);
+static void _obs_empty(coap_pkt_t *pdu, sock_udp_ep_t *remote);
 
 /* Internal variables */
 const coap_resource_t _default_resources[] = {
@@ -66,6 +70,28 @@ static gcoap_listener_t _default_listener = {
     NULL
 };
 
+/* Observe client, with the state of its confirmable notification */
+typedef struct {
+    sock_udp_ep_t ep;                   /* Client endpoint; unused if family
+                                           is AF_UNSPEC */
+    const coap_resource_t *con_resource;
+                                        /* Resource of the unacknowledged
+                                           confirmable notification, if any */
+    uint32_t con_deadline;              /* Time to retransmit it */
+    uint16_t con_msgid;                 /* Its message ID */
+    uint16_t msgid;                     /* Message ID of the last notification */
+    uint8_t con_retries;                /* Retransmissions so far */
+    uint8_t notify_count;               /* Notifications since the last
+                                           confirmable one */
+} gcoap_observer_t;
+
+/* Notification schedule of a resource, for gcoap_obs_notify() */
+typedef struct {
+    const coap_resource_t *resource;    /* Unused if NULL */
+    uint32_t last;                      /* Time of the last notification */
+    bool pending;                       /* Resource changed since */
+} gcoap_obs_sched_t;
+
 /* Container for the state of gcoap itself */
 typedef struct {
     mutex_t lock;                       /* Shares state attributes safely */
@@ -75,11 +101,18 @@ typedef struct {
                                            byte of an entry is zero, the entry
                                            is available */
     atomic_uint next_message_id;        /* Next message ID to use */
-    sock_udp_ep_t observers[GCOAP_OBS_CLIENTS_MAX];
+    gcoap_observer_t observers[GCOAP_OBS_CLIENTS_MAX];
                                         /* Observe clients; allows reuse for
                                            observe memos */
     gcoap_observe_memo_t observe_memos[GCOAP_OBS_REGISTRATIONS_MAX];
                                         /* Observed resource registrations */
+    gcoap_obs_sched_t obs_sched[GCOAP_OBS_REGISTRATIONS_MAX];
+                                        /* Scheduled notifications */
+    uint8_t obs_buf[GCOAP_PDU_BUF_SIZE + GCOAP_TOKENLEN_MAX];
+                                        /* Notification for one observer */
+    xtimer_t obs_timer;                 /* Wakes up the event loop for the
+                                           next scheduled notification */
+    atomic_bool obs_due;                /* Notifications may be due */
     uint8_t resend_bufs[GCOAP_RESEND_BUFS_MAX][GCOAP_PDU_BUF_SIZE];
                                         /* Buffers for PDU for request resends;
                                            if first byte of an entry is zero,
@@ -90,6 +123,14 @@ static gcoap_state_t _coap_state = {
     .listeners   = &_default_listener,
 };
 
+/* Observe client of an observe memo */
+static inline gcoap_observer_t *_observer(sock_udp_ep_t *observer)
+{
+    return container_of(observer, gcoap_observer_t, ep);
+}
+
+static void _obs_remove(gcoap_observer_t *obs);
+
 static kernel_pid_t _pid = KERNEL_PID_UNDEF;
 static char _msg_stack[GCOAP_STACK_SIZE];
 static msg_t _msg_queue[GCOAP_MSG_QUEUE_SIZE];
@@ -156,6 +197,9 @@ static void *_event_loop(void *arg)
             }
         }
 
+        if (atomic_exchange(&_coap_state.obs_due, false)) {
+            _obs_run();
+        }
         _listen(&_sock);
     }
 
@@ -196,7 +240,7 @@ static void _listen(sock_udp_t *sock)
     }
 
     if (pdu.hdr->code == COAP_CODE_EMPTY) {
-        DEBUG("gcoap: empty messages not handled yet\n");
+        _obs_empty(&pdu, &remote);
         return;
     }
 
@@ -227,18 +271,21 @@ static void _listen(sock_udp_t *sock)
         if (memo) {
             switch (coap_get_type(&pdu)) {
             case COAP_TYPE_NON:
-            case COAP_TYPE_ACK:
-                xtimer_remove(&memo->response_timer);
-                memo->state = GCOAP_MEMO_RESP;
-                if (memo->resp_handler) {
-                    memo->resp_handler(memo->state, &pdu, &remote);
-                }
+            case COAP_TYPE_ACK: {
+                gcoap_resp_handler_t resp_handler = memo->resp_handler;
 
+                xtimer_remove(&memo->response_timer);
                 if (memo->send_limit >= 0) {        /* if confirmable */
                     *memo->msg.data.pdu_buf = 0;    /* clear resend PDU buffer */
                 }
+                /* release the memo first, so the handler can send a follow-up
+                 * request, e.g. for the next block */
                 memo->state = GCOAP_MEMO_UNUSED;
+                if (resp_handler) {
+                    resp_handler(GCOAP_MEMO_RESP, &pdu, &remote);
+                }
                 break;
+            }
             case COAP_TYPE_CON:
                 DEBUG("gcoap: separate CON response not handled yet\n");
                 break;
@@ -270,7 +317,6 @@ static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
     gcoap_listener_t *listener          = NULL;
     sock_udp_ep_t *observer             = NULL;
     gcoap_observe_memo_t *memo          = NULL;
-    gcoap_observe_memo_t *resource_memo = NULL;
 
     switch (_find_resource(pdu, &resource, &listener)) {
         case GCOAP_RESOURCE_WRONG_METHOD:
@@ -278,48 +324,48 @@ static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
         case GCOAP_RESOURCE_NO_PATH:
             return gcoap_response(pdu, buf, len, COAP_CODE_PATH_NOT_FOUND);
         case GCOAP_RESOURCE_FOUND:
-            /* find observe registration for resource */
-            _find_obs_memo_resource(&resource_memo, resource);
             break;
     }
 
     if (coap_get_observe(pdu) == COAP_OBS_REGISTER) {
+        mutex_lock(&_coap_state.lock);
         /* lookup remote+token */
         int empty_slot = _find_obs_memo(&memo, remote, pdu);
+        int obs_slot = _find_observer(&observer, remote);
         /* validate re-registration request */
-        if (resource_memo != NULL) {
-            if (memo != NULL) {
-                if (memo != resource_memo) {
-                    /* reject token already used for a different resource */
-                    memo = NULL;
-                    coap_clear_observe(pdu);
-                    DEBUG("gcoap: can't change resource for token\n");
+        if ((memo != NULL) && (memo->resource != resource)) {
+            /* reject token already used for a different resource */
+            memo = NULL;
+            coap_clear_observe(pdu);
+            DEBUG("gcoap: can't change resource for token\n");
+        }
+        else if ((memo == NULL) && (observer != NULL)) {
+            /* accept new token for resource */
+            for (unsigned i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+                if ((_coap_state.observe_memos[i].observer == observer)
+                        && (_coap_state.observe_memos[i].resource == resource)) {
+                    memo = &_coap_state.observe_memos[i];
+                    break;
                 }
-                /* otherwise OK to re-register resource with the same token */
-            }
-            else if (sock_udp_ep_equal(remote, resource_memo->observer)) {
-                /* accept new token for resource */
-                memo = resource_memo;
             }
         }
         /* initialize new registration request */
         if ((memo == NULL) && coap_has_observe(pdu)) {
-            /* verify resource not already registerered (for another endpoint) */
-            if ((empty_slot >= 0) && (resource_memo == NULL)) {
-                int obs_slot = _find_observer(&observer, remote);
+            if (empty_slot >= 0) {
                 /* cache new observer */
-                if (observer == NULL) {
-                    if (obs_slot >= 0) {
-                        observer = &_coap_state.observers[obs_slot];
-                        memcpy(observer, remote, sizeof(sock_udp_ep_t));
-                    } else {
-                        DEBUG("gcoap: can't register observer\n");
-                    }
+                if ((observer == NULL) && (obs_slot >= 0)) {
+                    gcoap_observer_t *obs = &_coap_state.observers[obs_slot];
+                    memset(obs, 0, sizeof(*obs));
+                    memcpy(&obs->ep, remote, sizeof(sock_udp_ep_t));
+                    observer = &obs->ep;
                 }
                 if (observer != NULL) {
                     memo = &_coap_state.observe_memos[empty_slot];
                     memo->observer = observer;
                 }
+                else {
+                    DEBUG("gcoap: can't register observer\n");
+                }
             }
             if (memo == NULL) {
                 coap_clear_observe(pdu);
@@ -328,7 +374,6 @@ static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
         }
         /* finish registration */
         if (memo != NULL) {
-            /* resource may be assigned here if it is not already registered */
             memo->resource = resource;
             memo->token_len = coap_get_token_len(pdu);
             if (memo->token_len) {
@@ -336,22 +381,27 @@ static size_t _handle_req(coap_pkt_t *pdu, uint8_t *buf, size_t len,
             }
             DEBUG("gcoap: Registered observer for: %s\n", memo->resource->path);
         }
+        mutex_unlock(&_coap_state.lock);
 
     } else if (coap_get_observe(pdu) == COAP_OBS_DEREGISTER) {
+        mutex_lock(&_coap_state.lock);
         _find_obs_memo(&memo, remote, pdu);
         /* clear memo, and clear observer if no other memos */
         if (memo != NULL) {
+            gcoap_observer_t *obs = _observer(memo->observer);
+
             DEBUG("gcoap: Deregistering observer for: %s\n", memo->resource->path);
+            if (obs->con_resource == memo->resource) {
+                obs->con_resource = NULL;
+            }
             memo->observer = NULL;
             memo           = NULL;
             _find_obs_memo(&memo, remote, NULL);
             if (memo == NULL) {
-                _find_observer(&observer, remote);
-                if (observer != NULL) {
-                    observer->family = AF_UNSPEC;
-                }
+                _obs_remove(obs);
             }
         }
+        mutex_unlock(&_coap_state.lock);
         coap_clear_observe(pdu);
 
     } else if (coap_has_observe(pdu)) {
@@ -469,22 +519,29 @@ static void _expire_request(gcoap_request_memo_t *memo)
 {
     DEBUG("coap: received timeout message\n");
     if (memo->state == GCOAP_MEMO_WAIT) {
-        memo->state = GCOAP_MEMO_TIMEOUT;
-        /* Pass response to handler */
-        if (memo->resp_handler) {
-            coap_pkt_t req;
-            if (memo->send_limit == GCOAP_SEND_LIMIT_NON) {
-                req.hdr = (coap_hdr_t *)&memo->msg.hdr_buf[0];   /* for reference */
-            }
-            else {
-                req.hdr = (coap_hdr_t *)memo->msg.data.pdu_buf;
-            }
-            memo->resp_handler(memo->state, &req, NULL);
+        gcoap_resp_handler_t resp_handler = memo->resp_handler;
+        uint8_t hdr_buf[GCOAP_HEADER_MAXLEN];
+        uint8_t *resend_buf = NULL;
+        coap_pkt_t req;
+
+        if (memo->send_limit == GCOAP_SEND_LIMIT_NON) {
+            /* copy, as the memo may be reused by the handler */
+            memcpy(hdr_buf, &memo->msg.hdr_buf[0], sizeof(hdr_buf));
+            req.hdr = (coap_hdr_t *)hdr_buf;    /* for reference */
         }
-        if (memo->send_limit != GCOAP_SEND_LIMIT_NON) {
-            *memo->msg.data.pdu_buf = 0;    /* clear resend buffer */
+        else {
+            resend_buf = memo->msg.data.pdu_buf;
+            req.hdr = (coap_hdr_t *)resend_buf;
         }
+        /* release the memo first, so the handler can resend the request */
         memo->state = GCOAP_MEMO_UNUSED;
+        /* Pass response to handler */
+        if (resp_handler) {
+            resp_handler(GCOAP_MEMO_TIMEOUT, &req, NULL);
+        }
+        if (resend_buf != NULL) {
+            *resend_buf = 0;    /* clear resend buffer */
+        }
     }
     else {
         /* Response already handled; timeout must have fired while response */
@@ -525,11 +582,11 @@ static int _find_observer(sock_udp_ep_t **observer, sock_udp_ep_t *remote)
     *observer      = NULL;
     for (unsigned i = 0; i < GCOAP_OBS_CLIENTS_MAX; i++) {
 
-        if (_coap_state.observers[i].family == AF_UNSPEC) {
+        if (_coap_state.observers[i].ep.family == AF_UNSPEC) {
             empty_slot = i;
         }
-        else if (sock_udp_ep_equal(&_coap_state.observers[i], remote)) {
-            *observer = &_coap_state.observers[i];
+        else if (sock_udp_ep_equal(&_coap_state.observers[i].ep, remote)) {
+            *observer = &_coap_state.observers[i].ep;
             break;
         }
     }
@@ -600,6 +657,277 @@ static void _find_obs_memo_resource(gcoap_observe_memo_t **memo,
     }
 }
 
+/*
+ * Wakes up the gcoap thread to send scheduled notifications. Called from the
+ * notification timer, so also in interrupt context.
+ */
+static void _obs_wake(void *arg)
+{
+    (void)arg;
+    msg_t mbox_msg;
+
+    atomic_store(&_coap_state.obs_due, true);
+    /* interrupts sock_udp_recv() in _listen(), like gcoap_req_send() */
+    mbox_msg.type          = GCOAP_MSG_TYPE_INTR;
+    mbox_msg.content.value = 0;
+    mbox_try_put(&_sock.reg.mbox, &mbox_msg);
+}
+
+/*
+ * Removes an observer and all of its registrations.
+ *
+ * Caller must hold the lock.
+ */
+static void _obs_remove(gcoap_observer_t *obs)
+{
+    for (unsigned i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        if (_coap_state.observe_memos[i].observer == &obs->ep) {
+            _coap_state.observe_memos[i].observer = NULL;
+        }
+    }
+    obs->ep.family     = AF_UNSPEC;
+    obs->con_resource  = NULL;
+}
+
+/*
+ * Time to wait for the acknowledgement of a confirmable notification, after
+ * the given number of retransmissions [in usec].
+ */
+static uint32_t _obs_con_timeout(unsigned retries)
+{
+    uint32_t timeout  = ((uint32_t)COAP_ACK_TIMEOUT << retries) * US_PER_SEC;
+    uint32_t variance = ((uint32_t)COAP_ACK_VARIANCE << retries) * US_PER_SEC;
+
+    return random_uint32_range(timeout, timeout + variance);
+}
+
+/*
+ * Generates the current representation of a resource as a notification,
+ * without token, by calling its handler with a GET request.
+ *
+ * return length of the notification, or < 0 if not available
+ */
+static ssize_t _obs_render(const coap_resource_t *resource, uint8_t *buf,
+                           size_t len)
+{
+    coap_pkt_t pdu;
+
+    /* each path segment takes at most three bytes of option header */
+    if ((sizeof(coap_hdr_t) + 1 + (3 * strlen(resource->path))) > len) {
+        return -ENOBUFS;
+    }
+    uint8_t *pos = buf + coap_build_hdr((coap_hdr_t *)buf, COAP_TYPE_NON,
+                                        NULL, 0, COAP_METHOD_GET, 0);
+    pos += coap_put_option(pos, 0, COAP_OPT_OBSERVE, NULL, 0);
+    pos += coap_opt_put_uri_path(pos, COAP_OPT_OBSERVE, resource->path);
+
+    if (coap_parse(&pdu, buf, pos - buf) < 0) {
+        return -EBADMSG;
+    }
+    ssize_t res = resource->handler(&pdu, buf, len, resource->context);
+    if ((res <= 0) || (coap_get_code_class(&pdu) != COAP_CLASS_SUCCESS)) {
+        DEBUG("gcoap: no notification for %s\n", resource->path);
+        return -EINVAL;
+    }
+    return res;
+}
+
+/*
+ * Sends a notification to the observers of a resource, with the token of the
+ * respective registration.
+ *
+ * Caller must hold the lock.
+ *
+ * buf[in] -- Notification; the token and message ID are replaced
+ * len[in] -- Length of buf
+ * resource[in] -- Observed resource
+ * only[in] -- Send to this observer only, or NULL for all observers
+ *
+ * return Number of observers the notification was sent to
+ */
+static unsigned _obs_fanout(const uint8_t *buf, size_t len,
+                            const coap_resource_t *resource,
+                            gcoap_observer_t *only)
+{
+    const coap_hdr_t *hdr = (const coap_hdr_t *)buf;
+    unsigned type         = (hdr->ver_t_tkl & 0x30) >> 4;
+    size_t hdr_len        = sizeof(coap_hdr_t) + (hdr->ver_t_tkl & 0xf);
+    unsigned count        = 0;
+
+    if (len < hdr_len) {
+        return 0;
+    }
+    for (unsigned i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        gcoap_observe_memo_t *memo = &_coap_state.observe_memos[i];
+        if ((memo->observer == NULL) || (memo->resource != resource)) {
+            continue;
+        }
+        gcoap_observer_t *obs = _observer(memo->observer);
+        if ((only != NULL) && (obs != only)) {
+            continue;
+        }
+
+        /* a newer notification replaces an unacknowledged one, but only one
+         * confirmable notification per observer is tracked at a time */
+        bool con = (type == COAP_TYPE_CON) || (obs->con_resource == resource);
+#if GCOAP_OBS_CON_EVERY
+        con = con || ((obs->notify_count + 1U) >= GCOAP_OBS_CON_EVERY);
+#endif
+        if ((obs->con_resource != NULL) && (obs->con_resource != resource)) {
+            con = false;
+        }
+
+        uint16_t msgid = (uint16_t)atomic_fetch_add(&_coap_state.next_message_id, 1);
+        ssize_t res = coap_build_hdr((coap_hdr_t *)_coap_state.obs_buf,
+                                     con ? COAP_TYPE_CON : COAP_TYPE_NON,
+                                     &memo->token[0], memo->token_len,
+                                     hdr->code, msgid);
+        if ((res < 0) || ((res + len - hdr_len) > sizeof(_coap_state.obs_buf))) {
+            DEBUG("gcoap: notification too long\n");
+            continue;
+        }
+        memcpy(&_coap_state.obs_buf[res], buf + hdr_len, len - hdr_len);
+        res = sock_udp_send(&_sock, _coap_state.obs_buf, res + len - hdr_len,
+                            &obs->ep);
+        if (res <= 0) {
+            DEBUG("gcoap: send notification failed: %d\n", (int)res);
+            continue;
+        }
+        count++;
+
+        obs->msgid = msgid;
+        if (con) {
+            if (obs->con_resource == NULL) {
+                obs->con_resource = resource;
+                obs->con_retries  = 0;
+                obs->con_deadline = xtimer_now_usec() + _obs_con_timeout(0);
+            }
+            obs->con_msgid    = msgid;
+            obs->notify_count = 0;
+        }
+        else {
+            obs->notify_count++;
+        }
+    }
+    return count;
+}
+
+/*
+ * Sends due notifications scheduled with gcoap_obs_notify(), retransmits
+ * unacknowledged confirmable notifications, and sets the timer for the next
+ * of both. Runs on the gcoap thread.
+ */
+static void _obs_run(void)
+{
+    uint8_t buf[GCOAP_PDU_BUF_SIZE];
+    uint32_t now  = xtimer_now_usec();
+    uint32_t next = UINT32_MAX;
+
+    for (unsigned i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        gcoap_obs_sched_t *sched = &_coap_state.obs_sched[i];
+        const coap_resource_t *resource = NULL;
+
+        mutex_lock(&_coap_state.lock);
+        if ((sched->resource != NULL) && sched->pending) {
+            uint32_t elapsed = now - sched->last;
+            if (elapsed >= GCOAP_OBS_NOTIFY_INTERVAL) {
+                resource        = sched->resource;
+                sched->pending  = false;
+                sched->last     = now;
+            }
+            else if ((GCOAP_OBS_NOTIFY_INTERVAL - elapsed) < next) {
+                next = GCOAP_OBS_NOTIFY_INTERVAL - elapsed;
+            }
+        }
+        mutex_unlock(&_coap_state.lock);
+
+        if (resource != NULL) {
+            /* changes while the handler runs are sent with the next
+             * notification */
+            ssize_t len = _obs_render(resource, buf, sizeof(buf));
+            if (len > 0) {
+                mutex_lock(&_coap_state.lock);
+                _obs_fanout(buf, len, resource, NULL);
+                mutex_unlock(&_coap_state.lock);
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < GCOAP_OBS_CLIENTS_MAX; i++) {
+        gcoap_observer_t *obs = &_coap_state.observers[i];
+        const coap_resource_t *resource = NULL;
+
+        mutex_lock(&_coap_state.lock);
+        if ((obs->ep.family != AF_UNSPEC) && (obs->con_resource != NULL)) {
+            uint32_t left = obs->con_deadline - now;
+            if ((int32_t)left > 0) {
+                if (left < next) {
+                    next = left;
+                }
+            }
+            else if (obs->con_retries >= COAP_MAX_RETRANSMIT) {
+                DEBUG("gcoap: observer not responding; removed\n");
+                _obs_remove(obs);
+            }
+            else {
+                resource = obs->con_resource;
+                obs->con_retries++;
+                left = _obs_con_timeout(obs->con_retries);
+                obs->con_deadline = now + left;
+                if (left < next) {
+                    next = left;
+                }
+            }
+        }
+        mutex_unlock(&_coap_state.lock);
+
+        if (resource != NULL) {
+            /* retransmit with the current state of the resource */
+            ssize_t len = _obs_render(resource, buf, sizeof(buf));
+            if (len > 0) {
+                mutex_lock(&_coap_state.lock);
+                _obs_fanout(buf, len, resource, obs);
+                mutex_unlock(&_coap_state.lock);
+            }
+        }
+    }
+
+    if (next != UINT32_MAX) {
+        xtimer_set(&_coap_state.obs_timer, next);
+    }
+}
+
+/*
+ * Handles an empty ACK or RST in response to a notification.
+ */
+static void _obs_empty(coap_pkt_t *pdu, sock_udp_ep_t *remote)
+{
+    sock_udp_ep_t *observer = NULL;
+    unsigned type           = coap_get_type(pdu);
+    uint16_t msgid          = coap_get_id(pdu);
+
+    if ((type != COAP_TYPE_ACK) && (type != COAP_TYPE_RST)) {
+        DEBUG("gcoap: empty messages not handled yet\n");
+        return;
+    }
+
+    mutex_lock(&_coap_state.lock);
+    _find_observer(&observer, remote);
+    if (observer != NULL) {
+        gcoap_observer_t *obs = _observer(observer);
+        bool con_match = (obs->con_resource != NULL) && (msgid == obs->con_msgid);
+
+        if ((type == COAP_TYPE_RST) && (con_match || (msgid == obs->msgid))) {
+            DEBUG("gcoap: observer reset; removed\n");
+            _obs_remove(obs);
+        }
+        else if ((type == COAP_TYPE_ACK) && con_match) {
+            obs->con_resource = NULL;
+        }
+    }
+    mutex_unlock(&_coap_state.lock);
+}
+
 /*
  * gcoap interface functions
  */
@@ -617,6 +945,9 @@ kernel_pid_t gcoap_init(void)
     memset(&_coap_state.open_reqs[0], 0, sizeof(_coap_state.open_reqs));
     memset(&_coap_state.observers[0], 0, sizeof(_coap_state.observers));
     memset(&_coap_state.observe_memos[0], 0, sizeof(_coap_state.observe_memos));
+    memset(&_coap_state.obs_sched[0], 0, sizeof(_coap_state.obs_sched));
+    _coap_state.obs_timer.callback = _obs_wake;
+    atomic_init(&_coap_state.obs_due, false);
     memset(&_coap_state.resend_bufs[0], 0, sizeof(_coap_state.resend_bufs));
     /* randomize initial value */
     atomic_init(&_coap_state.next_message_id, (unsigned)random_uint32());
@@ -873,18 +1204,61 @@ int gcoap_obs_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 
 size_t gcoap_obs_send(const uint8_t *buf, size_t len,
                       const coap_resource_t *resource)
+{
+    unsigned type = (((const coap_hdr_t *)buf)->ver_t_tkl & 0x30) >> 4;
+
+    mutex_lock(&_coap_state.lock);
+    unsigned count = _obs_fanout(buf, len, resource, NULL);
+    mutex_unlock(&_coap_state.lock);
+
+    if (count == 0) {
+        return 0;
+    }
+    if ((type == COAP_TYPE_CON) || (GCOAP_OBS_CON_EVERY > 0)) {
+        /* start the retransmission timer on the gcoap thread */
+        _obs_wake(NULL);
+    }
+    return len;
+}
+
+int gcoap_obs_notify(const coap_resource_t *resource)
 {
     gcoap_observe_memo_t *memo = NULL;
+    gcoap_obs_sched_t *sched   = NULL;
+    uint32_t now               = xtimer_now_usec();
 
+    mutex_lock(&_coap_state.lock);
     _find_obs_memo_resource(&memo, resource);
-
-    if (memo) {
-        ssize_t bytes = sock_udp_send(&_sock, buf, len, memo->observer);
-        return (size_t)((bytes > 0) ? bytes : 0);
+    if (memo == NULL) {
+        mutex_unlock(&_coap_state.lock);
+        return -ENOENT;
     }
-    else {
-        return 0;
+    for (unsigned i = 0; i < GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        gcoap_obs_sched_t *entry = &_coap_state.obs_sched[i];
+        if (entry->resource == resource) {
+            sched = entry;
+            break;
+        }
+        /* an entry is free again once its interval has passed */
+        if ((sched == NULL) && ((entry->resource == NULL)
+                || (!entry->pending
+                    && ((now - entry->last) >= GCOAP_OBS_NOTIFY_INTERVAL)))) {
+            sched = entry;
+        }
     }
+    if (sched == NULL) {
+        mutex_unlock(&_coap_state.lock);
+        return -ENOMEM;
+    }
+    if (sched->resource != resource) {
+        sched->resource = resource;
+        sched->last     = now - GCOAP_OBS_NOTIFY_INTERVAL;
+    }
+    sched->pending = true;
+    mutex_unlock(&_coap_state.lock);
+
+    _obs_wake(NULL);
+    return 0;
 }
 
 uint8_t gcoap_op_state(void)
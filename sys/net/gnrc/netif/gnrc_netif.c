@@ -1266,6 +1266,39 @@ static void _test_options(gnrc_netif_t *netif)
 }
 #endif /* DEVELHELP */
 
+#ifdef MODULE_NETSTATS_NEIGHBOR
+static void _nb_record(gnrc_netif_t *netif, const gnrc_pktsnip_t *pkt)
+{
+    const gnrc_netif_hdr_t *hdr;
+
+    if ((pkt == NULL) || (pkt->type != GNRC_NETTYPE_NETIF)) {
+        netstats_nb_record(&netif->neighbors, NULL, 0);
+        return;
+    }
+    hdr = pkt->data;
+    if (hdr->flags & (GNRC_NETIF_HDR_FLAGS_BROADCAST |
+                      GNRC_NETIF_HDR_FLAGS_MULTICAST)) {
+        netstats_nb_record(&netif->neighbors, NULL, 0);
+    }
+    else {
+        netstats_nb_record(&netif->neighbors, gnrc_netif_hdr_get_dst_addr(hdr),
+                           hdr->dst_l2addr_len);
+    }
+}
+
+static void _nb_update_tx(gnrc_netif_t *netif, netstats_nb_result_t result)
+{
+    uint8_t retries = 0;
+
+    if ((result == NETSTATS_NB_SUCCESS) &&
+        (netif->dev->driver->get(netif->dev, NETOPT_TX_RETRIES_NEEDED,
+                                 &retries, sizeof(retries)) < 0)) {
+        retries = 0;    /* device does not know, assume the first try worked */
+    }
+    netstats_nb_update_tx(&netif->neighbors, result, retries);
+}
+#endif /* MODULE_NETSTATS_NEIGHBOR */
+
 static void *_gnrc_netif_thread(void *args)
 {
     gnrc_netapi_opt_t *opt;
@@ -1311,6 +1344,9 @@ static void *_gnrc_netif_thread(void *args)
     }
 #ifdef MODULE_NETSTATS_L2
     memset(&netif->stats, 0, sizeof(netstats_t));
+#endif
+#ifdef MODULE_NETSTATS_NEIGHBOR
+    netstats_nb_init(&netif->neighbors);
 #endif
     /* now let rest of GNRC use the interface */
     gnrc_netif_release(netif);
@@ -1326,6 +1362,9 @@ static void *_gnrc_netif_thread(void *args)
                 break;
             case GNRC_NETAPI_MSG_TYPE_SND:
                 DEBUG("gnrc_netif: GNRC_NETDEV_MSG_TYPE_SND received\n");
+#ifdef MODULE_NETSTATS_NEIGHBOR
+                _nb_record(netif, msg.content.ptr);
+#endif
                 res = netif->ops->send(netif, msg.content.ptr);
                 if (res < 0) {
                     DEBUG("gnrc_netif: error sending packet %p (code: %i)\n",
@@ -1416,16 +1455,34 @@ static void _event_cb(netdev_t *dev, netdev_event_t event)
                     _pass_on_packet(pkt);
                 }
                 break;
-#ifdef MODULE_NETSTATS_L2
+#if defined(MODULE_NETSTATS_L2) || defined(MODULE_NETSTATS_NEIGHBOR)
             case NETDEV_EVENT_TX_MEDIUM_BUSY:
+#ifdef MODULE_NETSTATS_L2
                 /* we are the only ones supposed to touch this variable,
                  * so no acquire necessary */
                 netif->stats.tx_failed++;
+#endif
+#ifdef MODULE_NETSTATS_NEIGHBOR
+                _nb_update_tx(netif, NETSTATS_NB_BUSY);
+#endif
+                break;
+            case NETDEV_EVENT_TX_NOACK:
+#ifdef MODULE_NETSTATS_L2
+                netif->stats.tx_failed++;
+#endif
+#ifdef MODULE_NETSTATS_NEIGHBOR
+                _nb_update_tx(netif, NETSTATS_NB_NOACK);
+#endif
                 break;
             case NETDEV_EVENT_TX_COMPLETE:
+#ifdef MODULE_NETSTATS_L2
                 /* we are the only ones supposed to touch this variable,
                  * so no acquire necessary */
                 netif->stats.tx_success++;
+#endif
+#ifdef MODULE_NETSTATS_NEIGHBOR
+                _nb_update_tx(netif, NETSTATS_NB_SUCCESS);
+#endif
                 break;
 #endif
             default:
@@ -432,6 +432,7 @@ void _set_nud_state(gnrc_netif_t *netif, _nib_onl_entry_t *nce,
 {
     nce->info &= ~GNRC_IPV6_NIB_NC_INFO_NUD_STATE_MASK;
     nce->info |= state;
+    _nib_rc_invalidate();
 
 #if GNRC_IPV6_NIB_CONF_ROUTER
     gnrc_netif_acquire(netif);
@@ -23,6 +23,9 @@
 #include "net/gnrc/ipv6/nib/nc.h"
 #include "net/gnrc/ipv6/nib.h"
 #include "net/gnrc/netif/internal.h"
+#ifdef MODULE_GNRC_RPL_ROUTES
+#include "net/gnrc/rpl/routes.h"
+#endif
 #include "random.h"
 
 #include "_nib-internal.h"
@@ -33,9 +36,12 @@
 
 /* pointers for default router selection */
 _nib_dr_entry_t *_prime_def_router = NULL;
-static clist_node_t _next_removable = { NULL };
 
 static _nib_onl_entry_t _nodes[GNRC_IPV6_NIB_NUMOF];
+/* hash index over the addresses of _nodes, chains are sorted by index */
+static _nib_onl_idx_t _onl_buckets[GNRC_IPV6_NIB_HASH_NUMOF];
+/* neighbor cache entries, least recently used first */
+static _nib_onl_idx_t _lru_head, _lru_tail;
 static _nib_offl_entry_t _dsts[GNRC_IPV6_NIB_OFFL_NUMOF];
 static _nib_dr_entry_t _def_routers[GNRC_IPV6_NIB_DEFAULT_ROUTER_NUMOF];
 
@@ -43,6 +49,13 @@ static _nib_dr_entry_t _def_routers[GNRC_IPV6_NIB_DEFAULT_ROUTER_NUMOF];
 static _nib_abr_entry_t _abrs[GNRC_IPV6_NIB_ABR_NUMOF];
 #endif  /* GNRC_IPV6_NIB_CONF_MULTIHOP_P6C */
 
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+static _nib_rc_entry_t _rcs[GNRC_IPV6_NIB_ROUTE_CACHE_NUMOF];
+static uint32_t _rc_hits, _rc_misses;
+/* starts with 1 so empty entries are never valid */
+uint32_t _nib_gen = 1;
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
+
 static char addr_str[IPV6_ADDR_MAX_STR_LEN];
 
 mutex_t _nib_mutex = MUTEX_INIT;
@@ -56,14 +69,22 @@ void _nib_init(void)
 {
 #ifdef TEST_SUITES
     _prime_def_router = NULL;
-    _next_removable.next = NULL;
     memset(_nodes, 0, sizeof(_nodes));
+    memset(_onl_buckets, 0, sizeof(_onl_buckets));
+    _lru_head = 0;
+    _lru_tail = 0;
     memset(_def_routers, 0, sizeof(_def_routers));
     memset(_dsts, 0, sizeof(_dsts));
 #if GNRC_IPV6_NIB_CONF_MULTIHOP_P6C
     memset(_abrs, 0, sizeof(_abrs));
 #endif  /* GNRC_IPV6_NIB_CONF_MULTIHOP_P6C */
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+    memset(_rcs, 0, sizeof(_rcs));
+    _rc_hits = 0;
+    _rc_misses = 0;
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
 #endif  /* TEST_SUITES */
+    _nib_rc_invalidate();
     evtimer_init_msg(&_nib_evtimer);
     /* TODO: load ABR information from persistent memory */
 }
@@ -75,6 +96,136 @@ static inline bool _addr_equals(const ipv6_addr_t *addr,
            (ipv6_addr_equal(addr, &node->ipv6));
 }
 
+static inline _nib_onl_idx_t _onl_idx(const _nib_onl_entry_t *node)
+{
+    return (_nib_onl_idx_t)(node - _nodes) + 1;
+}
+
+static inline _nib_onl_entry_t *_onl_node(_nib_onl_idx_t idx)
+{
+    return &_nodes[idx - 1];
+}
+
+static inline _nib_onl_idx_t *_onl_bucket(const ipv6_addr_t *addr)
+{
+    uint32_t hash = addr->u32[0].u32 ^ addr->u32[1].u32 ^
+                    addr->u32[2].u32 ^ addr->u32[3].u32;
+
+    /* mix the interface identifier bits into the lower bits */
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+    return &_onl_buckets[hash & (GNRC_IPV6_NIB_HASH_NUMOF - 1)];
+}
+
+static void _onl_hash_add(_nib_onl_entry_t *node)
+{
+    _nib_onl_idx_t idx = _onl_idx(node);
+    _nib_onl_idx_t *ptr = _onl_bucket(&node->ipv6);
+
+    /* keep chain sorted so look-ups find entries in the same order as a
+     * linear search over _nodes would */
+    while ((*ptr != 0) && (*ptr < idx)) {
+        ptr = &_onl_node(*ptr)->hash_next;
+    }
+    if (*ptr != idx) {
+        node->hash_next = *ptr;
+        *ptr = idx;
+    }
+}
+
+static void _onl_hash_remove(_nib_onl_entry_t *node)
+{
+    _nib_onl_idx_t idx = _onl_idx(node);
+    _nib_onl_idx_t *ptr = _onl_bucket(&node->ipv6);
+
+    while ((*ptr != 0) && (*ptr < idx)) {
+        ptr = &_onl_node(*ptr)->hash_next;
+    }
+    if (*ptr == idx) {
+        *ptr = node->hash_next;
+    }
+    node->hash_next = 0;
+}
+
+static _nib_onl_entry_t *_onl_hash_get(const ipv6_addr_t *addr,
+                                       unsigned iface)
+{
+    for (_nib_onl_idx_t i = *_onl_bucket(addr); i != 0;
+         i = _onl_node(i)->hash_next) {
+        _nib_onl_entry_t *node = _onl_node(i);
+
+        if ((_nib_onl_get_if(node) == iface) &&
+            ipv6_addr_equal(addr, &node->ipv6)) {
+            DEBUG("  %p is an exact match\n", (void *)node);
+            return node;
+        }
+    }
+    return NULL;
+}
+
+static void _onl_set_addr(_nib_onl_entry_t *node, const ipv6_addr_t *addr)
+{
+    _onl_hash_remove(node);
+    memcpy(&node->ipv6, addr, sizeof(node->ipv6));
+    _onl_hash_add(node);
+}
+
+static inline bool _lru_contains(const _nib_onl_entry_t *node)
+{
+    return (node->lru_prev != 0) || (_lru_head == _onl_idx(node));
+}
+
+static void _lru_remove(_nib_onl_entry_t *node)
+{
+    if (!_lru_contains(node)) {
+        return;
+    }
+    if (node->lru_prev == 0) {
+        _lru_head = node->lru_next;
+    }
+    else {
+        _onl_node(node->lru_prev)->lru_next = node->lru_next;
+    }
+    if (node->lru_next == 0) {
+        _lru_tail = node->lru_prev;
+    }
+    else {
+        _onl_node(node->lru_next)->lru_prev = node->lru_prev;
+    }
+    node->lru_prev = 0;
+    node->lru_next = 0;
+}
+
+static void _lru_push(_nib_onl_entry_t *node)
+{
+    _nib_onl_idx_t idx = _onl_idx(node);
+
+    if (_lru_tail == idx) {
+        return;
+    }
+    _lru_remove(node);
+    node->lru_prev = _lru_tail;
+    if (_lru_tail == 0) {
+        _lru_head = idx;
+    }
+    else {
+        _onl_node(_lru_tail)->lru_next = idx;
+    }
+    _lru_tail = idx;
+}
+
+bool _nib_onl_clear(_nib_onl_entry_t *node)
+{
+    if (node->mode == _EMPTY) {
+        _onl_hash_remove(node);
+        _lru_remove(node);
+        memset(node, 0, sizeof(_nib_onl_entry_t));
+        return true;
+    }
+    return false;
+}
+
 _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface)
 {
     _nib_onl_entry_t *node = NULL;
@@ -82,17 +233,27 @@ _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface)
     DEBUG("nib: Allocating on-link node entry (addr = %s, iface = %u)\n",
           (addr == NULL) ? "NULL" : ipv6_addr_to_str(addr_str, addr,
                                                      sizeof(addr_str)), iface);
-    for (unsigned i = 0; i < GNRC_IPV6_NIB_NUMOF; i++) {
+    if (addr != NULL) {
+        /* exact match or an entry on iface that has no address yet */
+        if ((node = _onl_hash_get(addr, iface)) == NULL) {
+            node = _onl_hash_get(&ipv6_addr_unspecified, iface);
+        }
+    }
+    for (unsigned i = 0; (node == NULL) && (i < GNRC_IPV6_NIB_NUMOF); i++) {
         _nib_onl_entry_t *tmp = &_nodes[i];
 
-        if ((_nib_onl_get_if(tmp) == iface) && _addr_equals(addr, tmp)) {
-            /* exact match */
+        if ((addr == NULL) && (_nib_onl_get_if(tmp) == iface) &&
+            (tmp->mode != _EMPTY)) {
+            /* any entry on iface will do */
             DEBUG("  %p is an exact match\n", (void *)tmp);
             node = tmp;
-            break;
         }
-        if ((node == NULL) && (tmp->mode == _EMPTY)) {
-            DEBUG("  using %p\n", (void *)node);
+    }
+    for (unsigned i = 0; (node == NULL) && (i < GNRC_IPV6_NIB_NUMOF); i++) {
+        _nib_onl_entry_t *tmp = &_nodes[i];
+
+        if (tmp->mode == _EMPTY) {
+            DEBUG("  using %p\n", (void *)tmp);
             node = tmp;
         }
     }
@@ -118,47 +279,32 @@ static inline _nib_onl_entry_t *_cache_out_onl_entry(const ipv6_addr_t *addr,
                                                      unsigned iface,
                                                      uint16_t cstate)
 {
-    /* Use clist as FIFO for caching */
-    _nib_onl_entry_t *first = (_nib_onl_entry_t *)clist_lpop(&_next_removable);
-    _nib_onl_entry_t *tmp = first, *res = NULL;
-
     DEBUG("nib: Searching for replaceable entries (addr = %s, iface = %u)\n",
           ipv6_addr_to_str(addr_str, addr, sizeof(addr_str)), iface);
-    if (tmp == NULL) {
-        return NULL;
-    }
-    do {
-        if (_is_gc(tmp)) {
+    /* replace least recently used entry that is garbage collectible */
+    for (_nib_onl_idx_t i = _lru_head; i != 0; i = _onl_node(i)->lru_next) {
+        _nib_onl_entry_t *res = _onl_node(i);
+
+        if (_is_gc(res)) {
             DEBUG("nib: Removing neighbor cache entry (addr = %s, "
                   "iface = %u) ",
-                  ipv6_addr_to_str(addr_str, &tmp->ipv6,
+                  ipv6_addr_to_str(addr_str, &res->ipv6,
                                    sizeof(addr_str)),
-                  _nib_onl_get_if(tmp));
+                  _nib_onl_get_if(res));
             DEBUG("for (addr = %s, iface = %u)\n",
                   ipv6_addr_to_str(addr_str, addr, sizeof(addr_str)),
                   iface);
             /* call _nib_nc_remove to remove timers from _evtimer */
-            _nib_nc_remove(tmp);
-            res = tmp;
+            _nib_nc_remove(res);
             _override_node(addr, iface, res);
             /* cstate masked in _nib_nc_add() already */
             res->info |= cstate;
             res->mode = _NC;
+            _lru_push(res);
+            return res;
         }
-        /* requeue if not garbage collectible at the moment or queueing
-         * newly created NCE or in case entry becomes garbage collectible
-         * again */
-        clist_rpush(&_next_removable, (clist_node_t *)tmp);
-        if (res == NULL) {
-            /* no new entry created yet, get next entry in FIFO */
-            tmp = (_nib_onl_entry_t *)clist_lpop(&_next_removable);
-        }
-    } while ((tmp != first) && (res == NULL));
-    if (res == NULL) {
-        /* we did not find any removable entry => requeue current one */
-        clist_rpush(&_next_removable, (clist_node_t *)tmp);
     }
-    return res;
+    return NULL;
 }
 
 _nib_onl_entry_t *_nib_nc_add(const ipv6_addr_t *addr, unsigned iface,
@@ -181,12 +327,8 @@ _nib_onl_entry_t *_nib_nc_add(const ipv6_addr_t *addr, unsigned iface,
         node->info |= cstate;
         node->mode |= _NC;
     }
-    if (node->next == NULL) {
-        DEBUG("nib: queueing (addr = %s, iface = %u) for potential removal\n",
-              ipv6_addr_to_str(addr_str, addr, sizeof(addr_str)), iface);
-        /* add to next removable list, if not already in it */
-        clist_rpush(&_next_removable, (clist_node_t *)node);
-    }
+    /* (re-)queue as most recently used for potential removal */
+    _lru_push(node);
     return node;
 }
 
@@ -209,8 +351,9 @@ _nib_onl_entry_t *_nib_onl_get(const ipv6_addr_t *addr, unsigned iface)
     assert(addr != NULL);
     DEBUG("nib: Getting on-link node entry (addr = %s, iface = %u)\n",
           ipv6_addr_to_str(addr_str, addr, sizeof(addr_str)), iface);
-    for (unsigned i = 0; i < GNRC_IPV6_NIB_NUMOF; i++) {
-        _nib_onl_entry_t *node = &_nodes[i];
+    for (_nib_onl_idx_t i = *_onl_bucket(addr); i != 0;
+         i = _onl_node(i)->hash_next) {
+        _nib_onl_entry_t *node = _onl_node(i);
 
         if ((node->mode != _EMPTY) &&
             /* either requested or current interface undefined or
@@ -233,6 +376,7 @@ void _nib_nc_set_reachable(_nib_onl_entry_t *node)
 
     node->info &= ~GNRC_IPV6_NIB_NC_INFO_NUD_STATE_MASK;
     node->info |= GNRC_IPV6_NIB_NC_INFO_NUD_STATE_REACHABLE;
+    _nib_rc_invalidate();
 #ifdef TEST_SUITES
     /* exit early for unittests */
     if (netif == NULL) {
@@ -278,8 +422,17 @@ void _nib_nc_remove(_nib_onl_entry_t *node)
     }
 #endif  /* GNRC_IPV6_NIB_CONF_QUEUE_PKT */
     /* remove from cache-out procedure */
-    clist_remove(&_next_removable, (clist_node_t *)node);
+    _lru_remove(node);
     _nib_onl_clear(node);
+    /* node might have been cached out while resolving another next hop */
+    _nib_rc_invalidate();
+}
+
+void _nib_nc_touch(_nib_onl_entry_t *node)
+{
+    if (_lru_contains(node)) {
+        _lru_push(node);
+    }
 }
 
 #if GNRC_IPV6_NIB_CONF_6LN || !GNRC_IPV6_NIB_CONF_ARSM
@@ -359,6 +512,7 @@ _nib_dr_entry_t *_nib_drl_add(const ipv6_addr_t *router_addr, unsigned iface)
         }
         _override_node(router_addr, iface, def_router->next_hop);
         def_router->next_hop->mode |= _DRL;
+        _nib_rc_invalidate();
     }
     return def_router;
 }
@@ -373,6 +527,7 @@ void _nib_drl_remove(_nib_dr_entry_t *nib_dr)
     if (nib_dr == _prime_def_router) {
         _prime_def_router = NULL;
     }
+    _nib_rc_invalidate();
 }
 
 _nib_dr_entry_t *_nib_drl_iter(const _nib_dr_entry_t *last)
@@ -481,7 +636,7 @@ _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
             /* exact match (or next hop address was previously unset) */
             DEBUG("  %p is an exact match\n", (void *)tmp);
             if (next_hop != NULL) {
-                memcpy(&tmp_node->ipv6, next_hop, sizeof(tmp_node->ipv6));
+                _onl_set_addr(tmp_node, next_hop);
             }
             tmp->next_hop->mode |= _DST;
             return tmp;
@@ -502,6 +657,7 @@ _nib_offl_entry_t *_nib_offl_alloc(const ipv6_addr_t *next_hop, unsigned iface,
         dst->next_hop->mode |= _DST;
         ipv6_addr_init_prefix(&dst->pfx, pfx, pfx_len);
         dst->pfx_len = pfx_len;
+        _nib_rc_invalidate();
     }
     return dst;
 }
@@ -534,6 +690,7 @@ void _nib_offl_clear(_nib_offl_entry_t *dst)
             _nib_onl_clear(dst->next_hop);
         }
         memset(dst, 0, sizeof(_nib_offl_entry_t));
+        _nib_rc_invalidate();
     }
 }
 
@@ -607,6 +764,20 @@ int _nib_get_route(const ipv6_addr_t *dst, gnrc_pktsnip_t *pkt,
     DEBUG("nib: get route %s for packet %p\n",
           ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)),
           (void *)pkt);
+#ifdef MODULE_GNRC_RPL_ROUTES
+    gnrc_rpl_route_t route;
+
+    /* RPL keeps its downward routes out of the off-link entries */
+    if ((gnrc_rpl_routes_get(dst, &route) == 0) &&
+        (route.mode == GNRC_RPL_ROUTES_STORING)) {
+        memcpy(&fte->dst, &route.dst, sizeof(route.dst));
+        memcpy(&fte->next_hop, &route.parent, sizeof(route.parent));
+        fte->dst_len = route.dst_len;
+        fte->primary = 0;
+        fte->iface = route.iface;
+        return 0;
+    }
+#endif
     _nib_offl_entry_t *offl = _nib_offl_get_match(dst);
 
     if ((offl == NULL) || (offl->mode == _PL)) {
@@ -765,6 +936,117 @@ _nib_abr_entry_t *_nib_abr_iter(const _nib_abr_entry_t *last)
 }
 #endif  /* GNRC_IPV6_NIB_CONF_MULTIHOP_P6C */
 
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+static inline bool _rc_valid(const _nib_rc_entry_t *entry)
+{
+    return (entry->gen == _nib_gen);
+}
+
+bool _nib_rc_get(const ipv6_addr_t *dst, unsigned iface,
+                 gnrc_ipv6_nib_nc_t *nce)
+{
+    assert((dst != NULL) && (nce != NULL));
+    for (unsigned i = 0; i < GNRC_IPV6_NIB_ROUTE_CACHE_NUMOF; i++) {
+        _nib_rc_entry_t *entry = &_rcs[i];
+
+        if (_rc_valid(entry) && (entry->iface == iface) &&
+            ipv6_addr_equal(&entry->dst, dst)) {
+            DEBUG("nib: %s%%%u found in route cache\n",
+                  ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)), iface);
+            entry->used = ++_rc_hits + _rc_misses;
+            memcpy(nce, &entry->nce, sizeof(entry->nce));
+            /* keep the next hop from being cached out of the neighbor cache */
+            if (entry->node != NULL) {
+                _nib_nc_touch(entry->node);
+            }
+#if GNRC_IPV6_NIB_CONF_ROUTER
+            if (entry->offl) {
+                gnrc_netif_t *netif = gnrc_netif_get_by_pid(
+                        gnrc_ipv6_nib_nc_get_iface(&entry->nce)
+                    );
+
+                /* routing protocols still see the route being used */
+                if (netif != NULL) {
+                    _call_route_info_cb(netif,
+                                        GNRC_IPV6_NIB_ROUTE_INFO_TYPE_RN,
+                                        &entry->pfx,
+                                        (void *)((intptr_t)entry->pfx_len));
+                }
+            }
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTER */
+            return true;
+        }
+    }
+    _rc_misses++;
+    return false;
+}
+
+void _nib_rc_add(const ipv6_addr_t *dst, unsigned iface,
+                 const gnrc_ipv6_nib_nc_t *nce, _nib_onl_entry_t *node,
+                 const gnrc_ipv6_nib_ft_t *route)
+{
+    _nib_rc_entry_t *entry = NULL;
+
+    assert((dst != NULL) && (nce != NULL));
+    switch (gnrc_ipv6_nib_nc_get_nud_state(nce)) {
+        case GNRC_IPV6_NIB_NC_INFO_NUD_STATE_UNMANAGED:
+        case GNRC_IPV6_NIB_NC_INFO_NUD_STATE_REACHABLE:
+            break;
+        default:
+            /* let the NIB handle neighbor unreachability detection */
+            return;
+    }
+    for (unsigned i = 0; i < GNRC_IPV6_NIB_ROUTE_CACHE_NUMOF; i++) {
+        _nib_rc_entry_t *tmp = &_rcs[i];
+
+        if (!_rc_valid(tmp)) {
+            entry = tmp;
+            break;
+        }
+        /* replace least recently used entry */
+        if ((entry == NULL) || (tmp->used < entry->used)) {
+            entry = tmp;
+        }
+    }
+    DEBUG("nib: Adding %s%%%u to route cache\n",
+          ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)), iface);
+    memcpy(&entry->dst, dst, sizeof(entry->dst));
+    memcpy(&entry->nce, nce, sizeof(entry->nce));
+    entry->node = node;
+    entry->gen = _nib_gen;
+    entry->used = _rc_hits + _rc_misses;
+    entry->iface = iface;
+    entry->offl = (route != NULL);
+#if GNRC_IPV6_NIB_CONF_ROUTER
+    if (route != NULL) {
+        memcpy(&entry->pfx, &route->dst, sizeof(entry->pfx));
+        entry->pfx_len = route->dst_len;
+    }
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTER */
+}
+
+_nib_rc_entry_t *_nib_rc_iter(const _nib_rc_entry_t *last)
+{
+    for (const _nib_rc_entry_t *entry = (last) ? (last + 1) : _rcs;
+         entry < (_rcs + GNRC_IPV6_NIB_ROUTE_CACHE_NUMOF);
+         entry++) {
+        if (_rc_valid(entry)) {
+            /* const modifier provided to assure internal consistency.
+             * Can now be discarded. */
+            return (_nib_rc_entry_t *)entry;
+        }
+    }
+    return NULL;
+}
+
+void _nib_rc_get_stats(gnrc_ipv6_nib_rc_stats_t *stats)
+{
+    stats->hits = _rc_hits;
+    stats->misses = _rc_misses;
+    stats->generation = _nib_gen;
+}
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
+
 _nib_offl_entry_t *_nib_pl_add(unsigned iface,
                                const ipv6_addr_t *pfx,
                                unsigned pfx_len,
@@ -808,9 +1090,18 @@ _nib_offl_entry_t *_nib_pl_add(unsigned iface,
 static void _override_node(const ipv6_addr_t *addr, unsigned iface,
                            _nib_onl_entry_t *node)
 {
+    /* a new entry is preferred by look-ups for its address */
+    if ((node->mode == _EMPTY) || (addr == NULL) ||
+        !ipv6_addr_equal(addr, &node->ipv6)) {
+        _nib_rc_invalidate();
+    }
     _nib_onl_clear(node);
     if (addr != NULL) {
-        memcpy(&node->ipv6, addr, sizeof(node->ipv6));
+        _onl_set_addr(node, addr);
+    }
+    else {
+        /* also make sure a cleared entry is indexed */
+        _onl_hash_add(node);
     }
     _nib_onl_set_if(node, iface);
 }
@@ -36,6 +36,7 @@
 #include "net/gnrc/ipv6/nib/ft.h"
 #include "net/gnrc/ipv6/nib/nc.h"
 #include "net/gnrc/ipv6/nib/conf.h"
+#include "net/gnrc/ipv6/nib/rc.h"
 #include "net/gnrc/pktqueue.h"
 #include "net/gnrc/sixlowpan/ctx.h"
 #include "net/ndp.h"
@@ -85,12 +86,23 @@ extern "C" {
  */
 #define _NIB_IF_MAX         (_NIB_IF_MASK >> _NIB_IF_POS)
 
+/**
+ * @brief   Index of an on-link NIB entry plus one (0 means no entry)
+ */
+#if (GNRC_IPV6_NIB_NUMOF < UINT8_MAX) || defined(DOXYGEN)
+typedef uint8_t _nib_onl_idx_t;
+#else
+typedef uint16_t _nib_onl_idx_t;
+#endif
+
 /**
  * @brief   On-link NIB entry
  * @anchor  _nib_onl_entry_t
  */
 typedef struct _nib_onl_entry {
-    struct _nib_onl_entry *next;        /**< next removable entry */
+    _nib_onl_idx_t hash_next;   /**< next entry in the same hash bucket */
+    _nib_onl_idx_t lru_prev;    /**< previous entry in eviction order */
+    _nib_onl_idx_t lru_next;    /**< next entry in eviction order */
 #if GNRC_IPV6_NIB_CONF_QUEUE_PKT || defined(DOXYGEN)
     /**
      * @brief   queue for packets currently in address resolution
@@ -312,14 +324,7 @@ _nib_onl_entry_t *_nib_onl_alloc(const ipv6_addr_t *addr, unsigned iface);
  * @return  true, if entry was cleared.
  * @return  false, if entry was not cleared.
  */
-static inline bool _nib_onl_clear(_nib_onl_entry_t *node)
-{
-    if (node->mode == _EMPTY) {
-        memset(node, 0, sizeof(_nib_onl_entry_t));
-        return true;
-    }
-    return false;
-}
+bool _nib_onl_clear(_nib_onl_entry_t *node);
 
 /**
  * @brief   Iterates over on-link entries
@@ -372,6 +377,16 @@ _nib_onl_entry_t *_nib_nc_add(const ipv6_addr_t *addr, unsigned iface,
  */
 void _nib_nc_remove(_nib_onl_entry_t *node);
 
+/**
+ * @brief   Marks a neighbor cache entry as recently used
+ *
+ * Entries that were not used for the longest time are replaced first when
+ * the neighbor cache is full.
+ *
+ * @param[in,out] node  A node.
+ */
+void _nib_nc_touch(_nib_onl_entry_t *node);
+
 /**
  * @brief   Gets external neighbor cache entry representation from on-link entry
  *
@@ -758,6 +773,123 @@ _nib_offl_entry_t *_nib_abr_iter_pfx(const _nib_abr_entry_t *abr,
 _nib_abr_entry_t *_nib_abr_iter(const _nib_abr_entry_t *last);
 #endif
 
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE || defined(DOXYGEN)
+/**
+ * @brief   Route cache entry
+ */
+typedef struct {
+    ipv6_addr_t dst;            /**< destination */
+    gnrc_ipv6_nib_nc_t nce;     /**< next hop to _nib_rc_entry_t::dst */
+    _nib_onl_entry_t *node;     /**< neighbor cache entry of the next hop,
+                                 *   may be NULL */
+    uint32_t gen;               /**< NIB generation the entry is valid in */
+    uint32_t used;              /**< time of last use in look-ups */
+#if GNRC_IPV6_NIB_CONF_ROUTER || defined(DOXYGEN)
+    /**
+     * @brief   prefix of the route the next hop was found with
+     *
+     * Used for the route notification on a cache hit.
+     */
+    ipv6_addr_t pfx;
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTER || defined(DOXYGEN) */
+    uint16_t iface;             /**< interface the look-up was restricted to */
+    uint8_t offl;               /**< next hop was found via a route */
+#if GNRC_IPV6_NIB_CONF_ROUTER || defined(DOXYGEN)
+    uint8_t pfx_len;            /**< length of _nib_rc_entry_t::pfx */
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTER || defined(DOXYGEN) */
+} _nib_rc_entry_t;
+
+/**
+ * @brief   Generation of the NIB
+ *
+ * Route cache entries are only valid as long as their
+ * _nib_rc_entry_t::gen equals this value. Use @ref _nib_rc_invalidate() to
+ * change it.
+ */
+extern uint32_t _nib_gen;
+
+/**
+ * @brief   Invalidates all route cache entries
+ *
+ * Must be called on every change to the NIB that may change the result of
+ * @ref gnrc_ipv6_nib_get_next_hop_l2addr().
+ *
+ * @note    Only available if @ref GNRC_IPV6_NIB_CONF_ROUTE_CACHE.
+ */
+static inline void _nib_rc_invalidate(void)
+{
+    _nib_gen++;
+}
+
+/**
+ * @brief   Gets the cached next hop for a destination
+ *
+ * The neighbor cache entry of the next hop is marked as used, as on a full
+ * look-up. If the next hop was found via a route, the route notification is
+ * issued to the [route info callback](@ref gnrc_netif_ipv6_t::route_info_cb)
+ * as on a full look-up. A callback that changes the NIB invalidates the cache
+ * as usual.
+ *
+ * @pre `(dst != NULL) && (nce != NULL)`
+ *
+ * @param[in] dst       A destination.
+ * @param[in] iface     The interface the look-up is restricted to. 0 for any
+ *                      interface.
+ * @param[out] nce      The next hop to @p dst.
+ *
+ * @note    Only available if @ref GNRC_IPV6_NIB_CONF_ROUTE_CACHE.
+ *
+ * @return  true, if a valid route cache entry for @p dst was found.
+ * @return  false, if the next hop must be resolved with the NIB.
+ */
+bool _nib_rc_get(const ipv6_addr_t *dst, unsigned iface,
+                 gnrc_ipv6_nib_nc_t *nce);
+
+/**
+ * @brief   Adds the resolved next hop of a destination to the route cache
+ *
+ * Next hops, of which the reachability is not confirmed, are not added, so
+ * neighbor unreachability detection still is triggered for them.
+ *
+ * @pre `(dst != NULL) && (nce != NULL)`
+ *
+ * @param[in] dst       A destination.
+ * @param[in] iface     The interface the look-up was restricted to. 0 for any
+ *                      interface.
+ * @param[in] nce       The next hop to @p dst.
+ * @param[in] node      The neighbor cache entry of @p nce. May be NULL.
+ * @param[in] route     The route the next hop was found with. NULL if
+ *                      @p dst is on-link.
+ *
+ * @note    Only available if @ref GNRC_IPV6_NIB_CONF_ROUTE_CACHE.
+ */
+void _nib_rc_add(const ipv6_addr_t *dst, unsigned iface,
+                 const gnrc_ipv6_nib_nc_t *nce, _nib_onl_entry_t *node,
+                 const gnrc_ipv6_nib_ft_t *route);
+
+/**
+ * @brief   Iterates over valid route cache entries
+ *
+ * @param[in] last  Last entry (NULL to start).
+ *
+ * @note    Only available if @ref GNRC_IPV6_NIB_CONF_ROUTE_CACHE.
+ *
+ * @return  entry after @p last.
+ */
+_nib_rc_entry_t *_nib_rc_iter(const _nib_rc_entry_t *last);
+
+/**
+ * @brief   Gets the route cache statistics
+ *
+ * @param[out] stats    The statistics of the route cache.
+ *
+ * @note    Only available if @ref GNRC_IPV6_NIB_CONF_ROUTE_CACHE.
+ */
+void _nib_rc_get_stats(gnrc_ipv6_nib_rc_stats_t *stats);
+#else   /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE || defined(DOXYGEN) */
+#define _nib_rc_invalidate()    (void)0
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE || defined(DOXYGEN) */
+
 /**
  * @brief   Gets external forwarding table entry representation from off-link
  *          entry
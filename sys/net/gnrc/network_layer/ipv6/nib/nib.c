@@ -182,6 +182,13 @@ int gnrc_ipv6_nib_get_next_hop_l2addr(const ipv6_addr_t *dst,
     gnrc_netif_acquire(netif);
     mutex_lock(&_nib_mutex);
     do {    /* XXX: hidden goto ;-) */
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+        const unsigned rc_iface = (netif == NULL) ? 0 : netif->pid;
+
+        if (_nib_rc_get(dst, rc_iface, nce)) {
+            break;
+        }
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
         _nib_onl_entry_t *node = _nib_onl_get(dst,
                                               (netif == NULL) ? 0 : netif->pid);
         /* consider neighbor cache entries first */
@@ -211,6 +218,9 @@ int gnrc_ipv6_nib_get_next_hop_l2addr(const ipv6_addr_t *dst,
                 res = -EHOSTUNREACH;
                 break;
             }
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+            _nib_rc_add(dst, rc_iface, nce, node, NULL);
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
         }
         else {
             gnrc_ipv6_nib_ft_t route;
@@ -258,6 +268,9 @@ int gnrc_ipv6_nib_get_next_hop_l2addr(const ipv6_addr_t *dst,
 #if GNRC_IPV6_NIB_CONF_DC
                 _nib_dc_add(&route.next_hop, netif->pid, dst);
 #endif  /* GNRC_IPV6_NIB_CONF_DC */
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+                _nib_rc_add(dst, rc_iface, nce, node, &route);
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
             }
             else {
                 /* _resolve_addr releases pkt if not queued (in which case
@@ -1137,6 +1150,7 @@ static bool _resolve_addr(const ipv6_addr_t *dst, gnrc_netif_t *netif,
               ipv6_addr_to_str(addr_str, &entry->ipv6, sizeof(addr_str)),
               _nib_onl_get_if(entry));
         _nib_nc_get(entry, nce);
+        _nib_nc_touch(entry);
         res = true;
     }
 #else   /* GNRC_IPV6_NIB_CONF_ARSM */
@@ -1145,6 +1159,7 @@ static bool _resolve_addr(const ipv6_addr_t *dst, gnrc_netif_t *netif,
               ipv6_addr_to_str(addr_str, &entry->ipv6, sizeof(addr_str)),
               _nib_onl_get_if(entry));
         _nib_nc_get(entry, nce);
+        _nib_nc_touch(entry);
         res = true;
     }
 #endif  /* GNRC_IPV6_NIB_CONF_ARSM */
@@ -53,6 +53,7 @@ int gnrc_ipv6_nib_ft_add(const ipv6_addr_t *dst, unsigned dst_len,
         }
         else {
             _prime_def_router = ptr;
+            _nib_rc_invalidate();
             if (ltime > 0) {
                 _evtimer_add(ptr, GNRC_IPV6_NIB_RTR_TIMEOUT,
                              &ptr->rtr_timeout, ltime * MS_PER_SEC);
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/gnrc/netif.h"
+#include "net/gnrc/ipv6/nib/rc.h"
+
+#include "_nib-internal.h"
+
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+bool gnrc_ipv6_nib_rc_iter(unsigned iface, void **state,
+                           gnrc_ipv6_nib_rc_t *entry)
+{
+    _nib_rc_entry_t *rc = *state;
+
+    mutex_lock(&_nib_mutex);
+    while ((rc = _nib_rc_iter(rc)) != NULL) {
+        if ((iface == 0) ||
+            (gnrc_ipv6_nib_nc_get_iface(&rc->nce) == iface)) {
+            memcpy(&entry->dst, &rc->dst, sizeof(entry->dst));
+            memcpy(&entry->next_hop, &rc->nce, sizeof(entry->next_hop));
+            break;
+        }
+    }
+    *state = rc;
+    mutex_unlock(&_nib_mutex);
+    return (*state != NULL);
+}
+
+void gnrc_ipv6_nib_rc_get_stats(gnrc_ipv6_nib_rc_stats_t *stats)
+{
+    mutex_lock(&_nib_mutex);
+    _nib_rc_get_stats(stats);
+    mutex_unlock(&_nib_mutex);
+}
+
+void gnrc_ipv6_nib_rc_invalidate(void)
+{
+    mutex_lock(&_nib_mutex);
+    _nib_rc_invalidate();
+    mutex_unlock(&_nib_mutex);
+}
+
+void gnrc_ipv6_nib_rc_print(const gnrc_ipv6_nib_rc_t *entry)
+{
+    char addr_str[(IPV6_ADDR_MAX_STR_LEN > GNRC_IPV6_NIB_L2ADDR_MAX_LEN) ?
+                   IPV6_ADDR_MAX_STR_LEN : GNRC_IPV6_NIB_L2ADDR_MAX_LEN];
+
+    printf("%s ", ipv6_addr_to_str(addr_str, &entry->dst, sizeof(addr_str)));
+    if (!ipv6_addr_equal(&entry->dst, &entry->next_hop.ipv6)) {
+        printf("via %s ", ipv6_addr_to_str(addr_str, &entry->next_hop.ipv6,
+                                           sizeof(addr_str)));
+    }
+    if (gnrc_ipv6_nib_nc_get_iface(&entry->next_hop) != KERNEL_PID_UNDEF) {
+        printf("dev #%u ", gnrc_ipv6_nib_nc_get_iface(&entry->next_hop));
+    }
+    printf("lladdr %s\n", gnrc_netif_addr_to_str(entry->next_hop.l2addr,
+                                                 entry->next_hop.l2addr_len,
+                                                 addr_str));
+}
+#else
+typedef int dont_be_pedantic;
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
+
+/** @} */
@@ -16,6 +16,8 @@
  * @author  Peter Kietzmann <peter.kietzmann@haw-hamburg.de>
  */
 
+#include <string.h>
+
 #include "kernel_types.h"
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/netapi.h"
@@ -367,14 +369,8 @@ uint16_t gnrc_sixlowpan_frag_next_tag(void)
 
 void gnrc_sixlowpan_frag_rbuf_base_rm(gnrc_sixlowpan_rbuf_base_t *entry)
 {
-    while (entry->ints != NULL) {
-        gnrc_sixlowpan_rbuf_int_t *next = entry->ints->next;
-
-        entry->ints->start = 0;
-        entry->ints->end = 0;
-        entry->ints->next = NULL;
-        entry->ints = next;
-    }
+    memset(entry->received, 0, sizeof(entry->received));
+    memset(entry->starts, 0, sizeof(entry->starts));
     entry->datagram_size = 0;
 }
 
@@ -14,6 +14,7 @@
 
 #include <inttypes.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "rbuf.h"
 #include "net/ipv6.h"
@@ -24,28 +25,49 @@
 #include "net/sixlowpan.h"
 #include "thread.h"
 #include "xtimer.h"
-#include "utlist.h"
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
 
-/* estimated fragment payload size to determinate RBUF_INT_SIZE, default to
- * MAC payload size - fragment header. */
-#ifndef GNRC_SIXLOWPAN_FRAG_SIZE
-/* assuming 64-bit source/destination address, source PAN ID omitted */
-#define GNRC_SIXLOWPAN_FRAG_SIZE (104 - 5)
+#define RBUF_HASH_SIZE      (GNRC_SIXLOWPAN_FRAG_RBUF_HASH_SIZE)
+#define RBUF_UNIT           (GNRC_SIXLOWPAN_FRAG_RBUF_UNIT)
+#define RBUF_UNITS          (GNRC_SIXLOWPAN_FRAG_RBUF_UNITS)
+
+#if (RBUF_HASH_SIZE & (RBUF_HASH_SIZE - 1)) != 0
+#error "GNRC_SIXLOWPAN_FRAG_RBUF_HASH_SIZE must be a power of two"
 #endif
 
-#ifndef RBUF_INT_SIZE
-/* same as ((int) ceil((double) N / D)) */
-#define DIV_CEIL(N, D) (((N) + (D) - 1) / (D))
-#define RBUF_INT_SIZE (DIV_CEIL(IPV6_MIN_MTU, GNRC_SIXLOWPAN_FRAG_SIZE) * RBUF_SIZE)
+#if RBUF_SIZE >= UINT8_MAX
+#error "GNRC_SIXLOWPAN_FRAG_RBUF_SIZE must be smaller than 255"
 #endif
 
-static gnrc_sixlowpan_rbuf_int_t rbuf_int[RBUF_INT_SIZE];
+/* references to reassembly buffer entries are stored as index + 1, so a
+ * zero-initialized reference marks the end of a list */
+#define RBUF_NIL            (0U)
+#define RBUF_REF(idx)       ((uint8_t)((idx) + 1))
+#define RBUF_IDX(ref)       ((unsigned)(ref) - 1)
+
+/**
+ * @brief   Management information for a reassembly buffer entry
+ */
+typedef struct {
+    uint8_t next;   /**< next entry in hash bucket (or free list) */
+    uint8_t older;  /**< entry that received its last fragment before */
+    uint8_t newer;  /**< entry that received its last fragment after */
+} _rbuf_link_t;
 
 static gnrc_sixlowpan_rbuf_t rbuf[RBUF_SIZE];
 
+/* hash index over (src, tag, size) of the entries in use */
+static uint8_t _buckets[RBUF_HASH_SIZE];
+static _rbuf_link_t _links[RBUF_SIZE];
+/* entries in use, ordered by arrival of their last fragment */
+static uint8_t _oldest, _newest;
+/* entries released by rbuf_rm() */
+static uint8_t _free;
+/* number of entries that were never handed out */
+static unsigned _unused = RBUF_SIZE;
+
 static char l2addr_str[3 * IEEE802154_LONG_ADDRESS_LEN];
 
 static xtimer_t _gc_timer;
@@ -54,13 +76,8 @@ static msg_t _gc_timer_msg = { .type = GNRC_SIXLOWPAN_MSG_FRAG_GC_RBUF };
 /* ------------------------------------
  * internal function definitions
  * ------------------------------------*/
-/* checks whether start and end overlaps, but not identical to, given interval i */
-static inline bool _rbuf_int_overlap_partially(gnrc_sixlowpan_rbuf_int_t *i,
-                                               uint16_t start, uint16_t end);
-/* gets a free entry from interval buffer */
-static gnrc_sixlowpan_rbuf_int_t *_rbuf_int_get_free(void);
-/* update interval buffer of entry */
-static bool _rbuf_update_ints(gnrc_sixlowpan_rbuf_base_t *entry,
+/* marks a fragment as received in the entry */
+static void _rbuf_update_ints(gnrc_sixlowpan_rbuf_base_t *entry,
                               uint16_t offset, size_t frag_size);
 /* gets an entry identified by its tupel */
 static gnrc_sixlowpan_rbuf_t *_rbuf_get(const void *src, size_t src_len,
@@ -82,27 +99,42 @@ enum {
 static int _check_fragments(gnrc_sixlowpan_rbuf_base_t *entry,
                             size_t frag_size, size_t offset)
 {
-    gnrc_sixlowpan_rbuf_int_t *ptr = entry->ints;
-
-    /* If the fragment overlaps another fragment and differs in either the size
-     * or the offset of the overlapped fragment, discards the datagram
-     * https://tools.ietf.org/html/rfc4944#section-5.3 */
-    while (ptr != NULL) {
-        if (_rbuf_int_overlap_partially(ptr, offset, offset + frag_size - 1)) {
+    const unsigned first = offset / RBUF_UNIT;
+    const unsigned last = (offset + frag_size - 1) / RBUF_UNIT;
+    bool overlaps = false, identical = bf_isset(entry->starts, first);
 
-            /* "A fresh reassembly may be commenced with the most recently
-             * received link fragment"
-             * https://tools.ietf.org/html/rfc4944#section-5.3 */
-            return RBUF_ADD_REPEAT;
+    for (unsigned i = first; i <= last; i++) {
+        if (bf_isset(entry->received, i)) {
+            overlaps = true;
         }
-        /* End was already checked in overlap check */
-        if (ptr->start == offset) {
-            DEBUG("6lo rbuf: fragment already in reassembly buffer");
-            return RBUF_ADD_DUPLICATE;
+        else {
+            identical = false;
+        }
+        if ((i > first) && bf_isset(entry->starts, i)) {
+            identical = false;
         }
-        ptr = ptr->next;
     }
-    return RBUF_ADD_SUCCESS;
+    if (!overlaps) {
+        return RBUF_ADD_SUCCESS;
+    }
+    /* an identical fragment also needs to end where this fragment ends */
+    if (identical && ((last + 1) < RBUF_UNITS) &&
+        bf_isset(entry->received, last + 1) &&
+        !bf_isset(entry->starts, last + 1)) {
+        identical = false;
+    }
+    if (identical) {
+        DEBUG("6lo rbuf: fragment already in reassembly buffer");
+        return RBUF_ADD_DUPLICATE;
+    }
+    /* If the fragment overlaps another fragment and differs in either the size
+     * or the offset of the overlapped fragment, discards the datagram
+     * https://tools.ietf.org/html/rfc4944#section-5.3
+     *
+     * "A fresh reassembly may be commenced with the most recently
+     * received link fragment"
+     * https://tools.ietf.org/html/rfc4944#section-5.3 */
+    return RBUF_ADD_REPEAT;
 }
 
 void rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
@@ -126,17 +158,6 @@ static int _rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
                 SIXLOWPAN_FRAG_1_DISP)) && (offset == 0)) ||
            ((((frag->disp_size.u8[0] & SIXLOWPAN_FRAG_DISP_MASK) ==
                 SIXLOWPAN_FRAG_N_DISP)) && (offset == (frag->offset * 8U))));
-    rbuf_gc();
-    entry = _rbuf_get(gnrc_netif_hdr_get_src_addr(netif_hdr), netif_hdr->src_l2addr_len,
-                      gnrc_netif_hdr_get_dst_addr(netif_hdr), netif_hdr->dst_l2addr_len,
-                      byteorder_ntohs(frag->disp_size) & SIXLOWPAN_FRAG_SIZE_MASK,
-                      byteorder_ntohs(frag->tag), page);
-
-    if (entry == NULL) {
-        DEBUG("6lo rbuf: reassembly buffer full.\n");
-        gnrc_pktbuf_release(pkt);
-        return RBUF_ADD_ERROR;
-    }
 
     /* dispatches in the first fragment are ignored */
     if (offset == 0) {
@@ -150,6 +171,24 @@ static int _rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
         data++; /* FRAGN header is one byte longer (offset) */
     }
 
+    if (frag_size == 0) {
+        DEBUG("6lo rfrag: empty fragment, discarding fragment\n");
+        gnrc_pktbuf_release(pkt);
+        return RBUF_ADD_ERROR;
+    }
+
+    rbuf_gc();
+    entry = _rbuf_get(gnrc_netif_hdr_get_src_addr(netif_hdr), netif_hdr->src_l2addr_len,
+                      gnrc_netif_hdr_get_dst_addr(netif_hdr), netif_hdr->dst_l2addr_len,
+                      byteorder_ntohs(frag->disp_size) & SIXLOWPAN_FRAG_SIZE_MASK,
+                      byteorder_ntohs(frag->tag), page);
+
+    if (entry == NULL) {
+        DEBUG("6lo rbuf: reassembly buffer full.\n");
+        gnrc_pktbuf_release(pkt);
+        return RBUF_ADD_ERROR;
+    }
+
     if ((offset + frag_size) > entry->super.datagram_size) {
         DEBUG("6lo rfrag: fragment too big for resulting datagram, discarding datagram\n");
         gnrc_pktbuf_release(entry->pkt);
@@ -171,114 +210,183 @@ static int _rbuf_add(gnrc_netif_hdr_t *netif_hdr, gnrc_pktsnip_t *pkt,
             break;
     }
 
-    if (_rbuf_update_ints(&entry->super, offset, frag_size)) {
-        DEBUG("6lo rbuf: add fragment data\n");
-        entry->super.current_size += (uint16_t)frag_size;
-        if (offset == 0) {
+    _rbuf_update_ints(&entry->super, offset, frag_size);
+    DEBUG("6lo rbuf: add fragment data\n");
+    entry->super.current_size += (uint16_t)frag_size;
+    if (offset == 0) {
 #ifdef MODULE_GNRC_SIXLOWPAN_IPHC
-            if (sixlowpan_iphc_is(data)) {
-                gnrc_pktsnip_t *frag_hdr = gnrc_pktbuf_mark(pkt,
-                        sizeof(sixlowpan_frag_t), GNRC_NETTYPE_SIXLOWPAN);
-                if (frag_hdr == NULL) {
-                    gnrc_pktbuf_release(entry->pkt);
-                    gnrc_pktbuf_release(pkt);
-                    rbuf_rm(entry);
-                    return RBUF_ADD_ERROR;
-                }
-                gnrc_sixlowpan_iphc_recv(pkt, entry, 0);
-                return RBUF_ADD_SUCCESS;
+        if (sixlowpan_iphc_is(data)) {
+            gnrc_pktsnip_t *frag_hdr = gnrc_pktbuf_mark(pkt,
+                    sizeof(sixlowpan_frag_t), GNRC_NETTYPE_SIXLOWPAN);
+            if (frag_hdr == NULL) {
+                gnrc_pktbuf_release(entry->pkt);
+                gnrc_pktbuf_release(pkt);
+                rbuf_rm(entry);
+                return RBUF_ADD_ERROR;
             }
-            else
+            gnrc_sixlowpan_iphc_recv(pkt, entry, 0);
+            return RBUF_ADD_SUCCESS;
+        }
+        else
 #endif
-            if (data[0] == SIXLOWPAN_UNCOMP) {
-                data++;
-            }
+        if (data[0] == SIXLOWPAN_UNCOMP) {
+            data++;
         }
-        memcpy(((uint8_t *)entry->pkt->data) + offset, data,
-               frag_size);
     }
+    memcpy(((uint8_t *)entry->pkt->data) + offset, data, frag_size);
     gnrc_sixlowpan_frag_rbuf_dispatch_when_complete(entry, netif_hdr);
     gnrc_pktbuf_release(pkt);
     return RBUF_ADD_SUCCESS;
 }
 
-static inline bool _rbuf_int_overlap_partially(gnrc_sixlowpan_rbuf_int_t *i,
-                                               uint16_t start, uint16_t end)
+static unsigned _rbuf_hash(const uint8_t *src, size_t src_len,
+                           size_t size, uint16_t tag)
+{
+    unsigned hash = tag ^ (size << 5);
+
+    for (unsigned i = 0; i < src_len; i++) {
+        hash = (hash * 33) ^ src[i];
+    }
+    return hash & (RBUF_HASH_SIZE - 1);
+}
+
+static inline unsigned _rbuf_entry_hash(const gnrc_sixlowpan_rbuf_t *entry)
 {
-    /* start and ends are both inclusive, so using <= for both */
-    return ((i->start <= end) && (start <= i->end)) && /* overlaps */
-        ((start != i->start) || (end != i->end)); /* not identical */
+    return _rbuf_hash(entry->super.src, entry->super.src_len,
+                      entry->super.datagram_size, entry->super.tag);
 }
 
-static gnrc_sixlowpan_rbuf_int_t *_rbuf_int_get_free(void)
+/* removes entry with index idx from the arrival order */
+static void _rbuf_order_rm(unsigned idx)
 {
-    for (unsigned int i = 0; i < RBUF_INT_SIZE; i++) {
-        if (rbuf_int[i].end == 0) { /* start must be smaller than end anyways*/
-            return rbuf_int + i;
+    _rbuf_link_t *link = &_links[idx];
+
+    if (link->older == RBUF_NIL) {
+        _oldest = link->newer;
+    }
+    else {
+        _links[RBUF_IDX(link->older)].newer = link->newer;
+    }
+    if (link->newer == RBUF_NIL) {
+        _newest = link->older;
+    }
+    else {
+        _links[RBUF_IDX(link->newer)].older = link->older;
+    }
+    link->older = RBUF_NIL;
+    link->newer = RBUF_NIL;
+}
+
+/* appends entry with index idx as newest entry to the arrival order */
+static void _rbuf_order_add(unsigned idx)
+{
+    _links[idx].older = _newest;
+    _links[idx].newer = RBUF_NIL;
+    if (_newest == RBUF_NIL) {
+        _oldest = RBUF_REF(idx);
+    }
+    else {
+        _links[RBUF_IDX(_newest)].newer = RBUF_REF(idx);
+    }
+    _newest = RBUF_REF(idx);
+}
+
+static void _rbuf_hash_rm(unsigned idx, unsigned bucket)
+{
+    uint8_t *ref = &_buckets[bucket];
+
+    while (*ref != RBUF_NIL) {
+        if (RBUF_IDX(*ref) == idx) {
+            *ref = _links[idx].next;
+            _links[idx].next = RBUF_NIL;
+            return;
         }
+        ref = &_links[RBUF_IDX(*ref)].next;
     }
+}
+
+static inline void _rbuf_free(unsigned idx)
+{
+    _links[idx].next = _free;
+    _free = RBUF_REF(idx);
+}
 
-    return NULL;
+static gnrc_sixlowpan_rbuf_t *_rbuf_alloc(void)
+{
+    unsigned idx;
+
+    if (_free != RBUF_NIL) {
+        idx = RBUF_IDX(_free);
+        _free = _links[idx].next;
+        _links[idx].next = RBUF_NIL;
+    }
+    else if (_unused > 0) {
+        idx = RBUF_SIZE - _unused--;
+    }
+    else {
+        return NULL;
+    }
+    return &rbuf[idx];
 }
 
 void rbuf_rm(gnrc_sixlowpan_rbuf_t *entry)
 {
+    if (!rbuf_entry_empty(entry)) {
+        unsigned idx = entry - rbuf;
+
+        _rbuf_hash_rm(idx, _rbuf_entry_hash(entry));
+        _rbuf_order_rm(idx);
+        _rbuf_free(idx);
+    }
     gnrc_sixlowpan_frag_rbuf_base_rm(&entry->super);
     entry->pkt = NULL;
 }
 
-static bool _rbuf_update_ints(gnrc_sixlowpan_rbuf_base_t *entry,
+static void _rbuf_update_ints(gnrc_sixlowpan_rbuf_base_t *entry,
                               uint16_t offset, size_t frag_size)
 {
-    gnrc_sixlowpan_rbuf_int_t *new;
-    uint16_t end = (uint16_t)(offset + frag_size - 1);
-
-    new = _rbuf_int_get_free();
-
-    if (new == NULL) {
-        DEBUG("6lo rfrag: no space left in rbuf interval buffer.\n");
-        return false;
-    }
-
-    new->start = offset;
-    new->end = end;
+    const unsigned first = offset / RBUF_UNIT;
+    const unsigned last = (offset + frag_size - 1) / RBUF_UNIT;
 
     DEBUG("6lo rfrag: add interval (%" PRIu16 ", %" PRIu16 ") to entry (%s, ",
-          new->start, new->end, gnrc_netif_addr_to_str(entry->src,
-                                                       entry->src_len,
-                                                       l2addr_str));
+          offset, (uint16_t)(offset + frag_size - 1),
+          gnrc_netif_addr_to_str(entry->src, entry->src_len, l2addr_str));
     DEBUG("%s, %u, %u)\n", gnrc_netif_addr_to_str(entry->dst,
                                                   entry->dst_len,
                                                   l2addr_str),
           entry->datagram_size, entry->tag);
 
-    LL_PREPEND(entry->ints, new);
-
-    return true;
+    bf_set(entry->starts, first);
+    for (unsigned i = first; i <= last; i++) {
+        bf_set(entry->received, i);
+    }
 }
 
 void rbuf_gc(void)
 {
     uint32_t now_usec = xtimer_now_usec();
-    unsigned int i;
 
-    for (i = 0; i < RBUF_SIZE; i++) {
-        /* since pkt occupies pktbuf, aggressivly collect garbage */
-        if ((rbuf[i].pkt != NULL) &&
-              ((now_usec - rbuf[i].super.arrival) > RBUF_TIMEOUT)) {
-            DEBUG("6lo rfrag: entry (%s, ",
-                  gnrc_netif_addr_to_str(rbuf[i].super.src,
-                                         rbuf[i].super.src_len,
-                                         l2addr_str));
-            DEBUG("%s, %u, %u) timed out\n",
-                  gnrc_netif_addr_to_str(rbuf[i].super.dst,
-                                         rbuf[i].super.dst_len,
-                                         l2addr_str),
-                  (unsigned)rbuf[i].super.datagram_size, rbuf[i].super.tag);
+    /* entries are ordered by arrival, so stop at the first one not timed out
+     * yet */
+    while (_oldest != RBUF_NIL) {
+        gnrc_sixlowpan_rbuf_t *entry = &rbuf[RBUF_IDX(_oldest)];
 
-            gnrc_pktbuf_release(rbuf[i].pkt);
-            rbuf_rm(&(rbuf[i]));
+        if ((now_usec - entry->super.arrival) <= RBUF_TIMEOUT) {
+            break;
         }
+        /* since pkt occupies pktbuf, aggressivly collect garbage */
+        DEBUG("6lo rfrag: entry (%s, ",
+              gnrc_netif_addr_to_str(entry->super.src,
+                                     entry->super.src_len,
+                                     l2addr_str));
+        DEBUG("%s, %u, %u) timed out\n",
+              gnrc_netif_addr_to_str(entry->super.dst,
+                                     entry->super.dst_len,
+                                     l2addr_str),
+              (unsigned)entry->super.datagram_size, entry->super.tag);
+
+        gnrc_pktbuf_release(entry->pkt);
+        rbuf_rm(entry);
     }
 }
 
@@ -292,56 +400,55 @@ static gnrc_sixlowpan_rbuf_t *_rbuf_get(const void *src, size_t src_len,
                                         size_t size, uint16_t tag,
                                         unsigned page)
 {
-    gnrc_sixlowpan_rbuf_t *res = NULL, *oldest = NULL;
+    gnrc_sixlowpan_rbuf_t *res;
     uint32_t now_usec = xtimer_now_usec();
-
-    for (unsigned int i = 0; i < RBUF_SIZE; i++) {
-        /* check first if entry already available */
-        if ((rbuf[i].pkt != NULL) && (rbuf[i].super.datagram_size == size) &&
-            (rbuf[i].super.tag == tag) && (rbuf[i].super.src_len == src_len) &&
-            (rbuf[i].super.dst_len == dst_len) &&
-            (memcmp(rbuf[i].super.src, src, src_len) == 0) &&
-            (memcmp(rbuf[i].super.dst, dst, dst_len) == 0)) {
-            DEBUG("6lo rfrag: entry %p (%s, ", (void *)(&rbuf[i]),
-                  gnrc_netif_addr_to_str(rbuf[i].super.src,
-                                         rbuf[i].super.src_len,
+    unsigned bucket = _rbuf_hash(src, src_len, size, tag);
+
+    /* check first if entry already available */
+    for (uint8_t ref = _buckets[bucket]; ref != RBUF_NIL;
+         ref = _links[RBUF_IDX(ref)].next) {
+        res = &rbuf[RBUF_IDX(ref)];
+
+        if ((res->super.datagram_size == size) && (res->super.tag == tag) &&
+            (res->super.src_len == src_len) &&
+            (res->super.dst_len == dst_len) &&
+            (memcmp(res->super.src, src, src_len) == 0) &&
+            (memcmp(res->super.dst, dst, dst_len) == 0)) {
+            DEBUG("6lo rfrag: entry %p (%s, ", (void *)res,
+                  gnrc_netif_addr_to_str(res->super.src,
+                                         res->super.src_len,
                                          l2addr_str));
             DEBUG("%s, %u, %u) found\n",
-                  gnrc_netif_addr_to_str(rbuf[i].super.dst,
-                                         rbuf[i].super.dst_len,
+                  gnrc_netif_addr_to_str(res->super.dst,
+                                         res->super.dst_len,
                                          l2addr_str),
-                  (unsigned)rbuf[i].super.datagram_size, rbuf[i].super.tag);
-            rbuf[i].super.arrival = now_usec;
+                  (unsigned)res->super.datagram_size, res->super.tag);
+            res->super.arrival = now_usec;
+            _rbuf_order_rm(RBUF_IDX(ref));
+            _rbuf_order_add(RBUF_IDX(ref));
             _set_rbuf_timeout();
-            return &(rbuf[i]);
-        }
-
-        /* if there is a free spot: remember it */
-        if ((res == NULL) && rbuf_entry_empty(&rbuf[i])) {
-            res = &(rbuf[i]);
-        }
-
-        /* remember oldest slot */
-        /* note that xtimer_now will overflow in ~1.2 hours */
-        if ((oldest == NULL) ||
-            (oldest->super.arrival - rbuf[i].super.arrival < UINT32_MAX / 2)) {
-            oldest = &(rbuf[i]);
+            return res;
         }
     }
 
+    res = _rbuf_alloc();
     /* entry not in buffer and no empty spot found */
     if (res == NULL) {
-        assert(oldest != NULL);
-        /* if oldest is not empty, res must not be NULL (because otherwise
-         * oldest could have been picked as res) */
+        gnrc_sixlowpan_rbuf_t *oldest;
+
+        /* if there is no empty spot, all entries are in use */
+        assert(_oldest != RBUF_NIL);
+        oldest = &rbuf[RBUF_IDX(_oldest)];
         assert(!rbuf_entry_empty(oldest));
+        /* note that xtimer_now will overflow in ~1.2 hours */
         if (GNRC_SIXLOWPAN_FRAG_RBUF_AGGRESSIVE_OVERRIDE ||
             ((now_usec - oldest->super.arrival) >
             GNRC_SIXLOWPAN_FRAG_RBUF_TIMEOUT_US)) {
             DEBUG("6lo rfrag: reassembly buffer full, remove oldest entry\n");
             gnrc_pktbuf_release(oldest->pkt);
             rbuf_rm(oldest);
-            res = oldest;
+            res = _rbuf_alloc();
+            assert(res == oldest);
         }
         else {
             return NULL;
@@ -364,6 +471,7 @@ static gnrc_sixlowpan_rbuf_t *_rbuf_get(const void *src, size_t src_len,
     res->pkt = gnrc_pktbuf_add(NULL, NULL, size, reass_type);
     if (res->pkt == NULL) {
         DEBUG("6lo rfrag: can not allocate reassembly buffer space.\n");
+        _rbuf_free(res - rbuf);
         return NULL;
     }
 
@@ -377,6 +485,9 @@ static gnrc_sixlowpan_rbuf_t *_rbuf_get(const void *src, size_t src_len,
     res->super.dst_len = dst_len;
     res->super.tag = tag;
     res->super.current_size = 0;
+    _links[res - rbuf].next = _buckets[bucket];
+    _buckets[bucket] = RBUF_REF(res - rbuf);
+    _rbuf_order_add(res - rbuf);
 
     DEBUG("6lo rfrag: entry %p (%s, ", (void *)res,
           gnrc_netif_addr_to_str(res->super.src, res->super.src_len,
@@ -395,7 +506,12 @@ static gnrc_sixlowpan_rbuf_t *_rbuf_get(const void *src, size_t src_len,
 void rbuf_reset(void)
 {
     xtimer_remove(&_gc_timer);
-    memset(rbuf_int, 0, sizeof(rbuf_int));
+    memset(_buckets, 0, sizeof(_buckets));
+    memset(_links, 0, sizeof(_links));
+    _oldest = RBUF_NIL;
+    _newest = RBUF_NIL;
+    _free = RBUF_NIL;
+    _unused = RBUF_SIZE;
     for (unsigned int i = 0; i < RBUF_SIZE; i++) {
         if ((rbuf[i].pkt != NULL) &&
             (rbuf[i].pkt->users > 0)) {
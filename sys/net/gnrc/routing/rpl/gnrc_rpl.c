@@ -27,6 +27,9 @@
 #include "gnrc_rpl_internal/globals.h"
 
 #include "net/gnrc/rpl.h"
+#ifdef MODULE_GNRC_RPL_ROUTES
+#include "net/gnrc/rpl/routes.h"
+#endif
 #ifdef MODULE_GNRC_RPL_P2P
 #include "net/gnrc/rpl/p2p.h"
 #include "net/gnrc/rpl/p2p_dodag.h"
@@ -85,6 +88,9 @@ kernel_pid_t gnrc_rpl_init(kernel_pid_t if_pid)
         gnrc_netreg_register(GNRC_NETTYPE_ICMPV6, &_me_reg);
 
         gnrc_rpl_of_manager_init();
+#ifdef MODULE_GNRC_RPL_ROUTES
+        gnrc_rpl_routes_init();
+#endif
         evtimer_init_msg(&gnrc_rpl_evtimer);
 #ifdef MODULE_GNRC_RPL_P2P
         xtimer_set_msg(&_lt_timer, _lt_time, &_lt_msg, gnrc_rpl_pid);
@@ -321,6 +327,11 @@ void _update_lifetime(void)
 
 void gnrc_rpl_delay_dao(gnrc_rpl_dodag_t *dodag)
 {
+    if (dodag->dao_batching) {
+        /* the DAO already scheduled will include the change, postponing it
+         * further would starve it while the DODAG forms */
+        return;
+    }
     evtimer_del(&gnrc_rpl_evtimer, (evtimer_event_t *)&dodag->dao_event);
     ((evtimer_event_t *)&(dodag->dao_event))->offset = random_uint32_range(
         GNRC_RPL_DAO_DELAY_DEFAULT,
@@ -329,6 +340,7 @@ void gnrc_rpl_delay_dao(gnrc_rpl_dodag_t *dodag)
     evtimer_add_msg(&gnrc_rpl_evtimer, &dodag->dao_event, gnrc_rpl_pid);
     dodag->dao_counter = 0;
     dodag->dao_ack_received = false;
+    dodag->dao_batching = true;
 }
 
 void gnrc_rpl_long_delay_dao(gnrc_rpl_dodag_t *dodag)
@@ -341,10 +353,26 @@ void gnrc_rpl_long_delay_dao(gnrc_rpl_dodag_t *dodag)
     evtimer_add_msg(&gnrc_rpl_evtimer, &dodag->dao_event, gnrc_rpl_pid);
     dodag->dao_counter = 0;
     dodag->dao_ack_received = false;
+    dodag->dao_batching = false;
+}
+
+static uint32_t _dao_ack_delay(uint8_t retries)
+{
+    uint32_t delay = GNRC_RPL_DAO_ACK_DELAY_MAX;
+
+    /* exponential backoff */
+    if ((retries < 16) &&
+        ((GNRC_RPL_DAO_ACK_DELAY << retries) < GNRC_RPL_DAO_ACK_DELAY_MAX)) {
+        delay = GNRC_RPL_DAO_ACK_DELAY << retries;
+    }
+    /* desynchronize children that lost their DAO-ACKs at once */
+    return random_uint32_range(delay, delay + GNRC_RPL_DAO_DELAY_JITTER);
 }
 
 void _dao_handle_send(gnrc_rpl_dodag_t *dodag)
 {
+    /* the scheduled DAO is due, so later changes need a new one */
+    dodag->dao_batching = false;
     if (dodag->node_status == GNRC_RPL_ROOT_NODE) {
         return;
     }
@@ -354,13 +382,21 @@ void _dao_handle_send(gnrc_rpl_dodag_t *dodag)
     }
 #endif
     if ((dodag->dao_ack_received == false) && (dodag->dao_counter < GNRC_RPL_DAO_SEND_RETRIES)) {
-        dodag->dao_counter++;
-        gnrc_rpl_send_DAO(dodag->instance, NULL, dodag->default_lifetime);
+        if (dodag->dao_counter == 0) {
+            gnrc_rpl_send_DAO(dodag->instance, NULL, dodag->default_lifetime);
+        }
+        else {
+            gnrc_rpl_resend_DAO(dodag->instance, dodag->default_lifetime);
+        }
         evtimer_del(&gnrc_rpl_evtimer, (evtimer_event_t *)&dodag->dao_event);
-        ((evtimer_event_t *)&(dodag->dao_event))->offset = GNRC_RPL_DAO_ACK_DELAY;
+        ((evtimer_event_t *)&(dodag->dao_event))->offset = _dao_ack_delay(dodag->dao_counter);
         evtimer_add_msg(&gnrc_rpl_evtimer, &dodag->dao_event, gnrc_rpl_pid);
+        dodag->dao_counter++;
     }
     else if (dodag->dao_ack_received == false) {
+#ifdef MODULE_NETSTATS_RPL
+        gnrc_rpl_netstats.dao_no_ack_count++;
+#endif
         gnrc_rpl_long_delay_dao(dodag);
     }
 }
@@ -33,6 +33,9 @@
 #endif
 
 #include "net/gnrc/rpl.h"
+#ifdef MODULE_GNRC_RPL_ROUTES
+#include "net/gnrc/rpl/routes.h"
+#endif
 #ifndef GNRC_RPL_WITHOUT_VALIDATION
 #include "gnrc_rpl_internal/validation.h"
 #endif
@@ -393,6 +396,34 @@ static inline uint32_t _sec_to_ms(uint32_t sec)
     }
 }
 
+/* Adds a route to target via src, or via the DAO parent in non-storing mode if
+ * parent is not NULL */
+static void _add_route(gnrc_rpl_dodag_t *dodag, gnrc_rpl_opt_target_t *target,
+                       ipv6_addr_t *src, ipv6_addr_t *parent, uint32_t ltime)
+{
+#ifdef MODULE_GNRC_RPL_ROUTES
+    if (ltime == 0) {
+        /* No-Path DAO */
+        gnrc_rpl_routes_del(&target->target, target->prefix_length);
+    }
+    else if (gnrc_rpl_routes_add(&target->target, target->prefix_length,
+                                 (parent) ? parent : src, dodag->iface,
+                                 (parent) ? GNRC_RPL_ROUTES_NON_STORING
+                                          : GNRC_RPL_ROUTES_STORING,
+                                 ltime) < 0) {
+        DEBUG("RPL: no space left for route to %s/%d\n",
+              ipv6_addr_to_str(addr_str, &target->target, sizeof(addr_str)),
+              target->prefix_length);
+    }
+#else
+    /* the DAO parent is usually not on-link, so the route goes via src */
+    (void)parent;
+    gnrc_ipv6_nib_ft_del(&target->target, target->prefix_length);
+    gnrc_ipv6_nib_ft_add(&target->target, target->prefix_length, src,
+                         dodag->iface, ltime);
+#endif
+}
+
 /** @todo allow target prefixes in target options to be of variable length */
 bool _parse_options(int msg_type, gnrc_rpl_instance_t *inst, gnrc_rpl_opt_t *opt, uint16_t len,
                     ipv6_addr_t *src, uint32_t *included_opts)
@@ -517,14 +548,17 @@ bool _parse_options(int msg_type, gnrc_rpl_instance_t *inst, gnrc_rpl_opt_t *opt
                     first_target = target;
                 }
 
+                if (inst->mop == GNRC_RPL_MOP_NON_STORING_MODE) {
+                    /* the parent is only known from the transit option */
+                    break;
+                }
+
                 DEBUG("RPL: adding FT entry %s/%d\n",
                       ipv6_addr_to_str(addr_str, &(target->target), (unsigned)sizeof(addr_str)),
                       target->prefix_length);
 
-                gnrc_ipv6_nib_ft_del(&(target->target), target->prefix_length);
-                gnrc_ipv6_nib_ft_add(&(target->target), target->prefix_length, src,
-                                     dodag->iface,
-                                     dodag->default_lifetime * dodag->lifetime_unit);
+                _add_route(dodag, target, src, NULL,
+                           dodag->default_lifetime * dodag->lifetime_unit);
                 break;
 
             case (GNRC_RPL_OPT_TRANSIT):
@@ -537,17 +571,22 @@ bool _parse_options(int msg_type, gnrc_rpl_instance_t *inst, gnrc_rpl_opt_t *opt
                     break;
                 }
 
+                ipv6_addr_t *parent = NULL;
+
+                if ((inst->mop == GNRC_RPL_MOP_NON_STORING_MODE) &&
+                    (transit->length >= (GNRC_RPL_OPT_TRANSIT_INFO_LEN +
+                                         sizeof(ipv6_addr_t)))) {
+                    /* the DAO parent follows the transit option */
+                    parent = (ipv6_addr_t *)(transit + 1);
+                }
+
                 do {
                     DEBUG("RPL: updating FT entry %s/%d\n",
                           ipv6_addr_to_str(addr_str, &(first_target->target), sizeof(addr_str)),
                           first_target->prefix_length);
 
-                    gnrc_ipv6_nib_ft_del(&(first_target->target),
-                                         first_target->prefix_length);
-                    gnrc_ipv6_nib_ft_add(&(first_target->target),
-                                         first_target->prefix_length, src,
-                                         dodag->iface,
-                                         transit->path_lifetime * dodag->lifetime_unit);
+                    _add_route(dodag, first_target, src, parent,
+                               transit->path_lifetime * dodag->lifetime_unit);
 
                     first_target = (gnrc_rpl_opt_target_t *) (((uint8_t *) (first_target)) +
                                    sizeof(gnrc_rpl_opt_t) + first_target->length);
@@ -854,82 +893,48 @@ gnrc_pktsnip_t *_dao_transit_build(gnrc_pktsnip_t *pkt, uint8_t lifetime, bool e
     return opt_snip;
 }
 
-void gnrc_rpl_send_DAO(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination, uint8_t lifetime)
-{
-    gnrc_rpl_dodag_t *dodag;
-
-    if (inst == NULL) {
-        DEBUG("RPL: Error - trying to send DAO without being part of a dodag.\n");
-        return;
-    }
-
-    dodag = &inst->dodag;
-
-    if (dodag->node_status == GNRC_RPL_ROOT_NODE) {
-        return;
-    }
-
-#ifdef MODULE_GNRC_RPL_P2P
-    if (dodag->instance->mop == GNRC_RPL_P2P_MOP) {
-        return;
-    }
+/* iterates the targets announced besides the own address */
+typedef struct {
+    void *state;
+#ifdef MODULE_GNRC_RPL_ROUTES
+    gnrc_rpl_route_t route;
+#else
+    gnrc_ipv6_nib_ft_t fte;
 #endif
+} _dao_iter_t;
 
-    if (destination == NULL) {
-        if (dodag->parents == NULL) {
-            DEBUG("RPL: dodag has no preferred parent\n");
-            return;
-        }
-
-        destination = &(dodag->parents->addr);
-    }
-
-    gnrc_pktsnip_t *pkt = NULL, *tmp = NULL;
-    gnrc_rpl_dao_t *dao;
-
-    /* find my address */
-    ipv6_addr_t *me = NULL;
-    gnrc_netif_t *netif = gnrc_netif_get_by_prefix(&dodag->dodag_id);
-    int idx;
-
-    if (netif == NULL) {
-        DEBUG("RPL: no address configured\n");
-        return;
-    }
-    idx = gnrc_netif_ipv6_addr_match(netif, &dodag->dodag_id);
-    me = &netif->ipv6.addrs[idx];
-
-    /* add external and RPL FT entries */
+static bool _dao_targets_iter(gnrc_rpl_dodag_t *dodag, _dao_iter_t *it,
+                              ipv6_addr_t **dst, uint8_t *dst_len)
+{
     /* TODO: nib: dropped support for external transit options for now */
-    void *ft_state = NULL;
-    gnrc_ipv6_nib_ft_t fte;
-    while(gnrc_ipv6_nib_ft_iter(NULL, dodag->iface, &ft_state, &fte)) {
-        DEBUG("RPL: Send DAO - building transit option\n");
-
-        if ((pkt = _dao_transit_build(pkt, lifetime, false)) == NULL) {
-            DEBUG("RPL: Send DAO - no space left in packet buffer\n");
-            return;
-        }
-        if (ipv6_addr_is_global(&fte.dst) &&
-            !ipv6_addr_is_unspecified(&fte.next_hop)) {
-            DEBUG("RPL: Send DAO - building target %s/%d\n",
-                  ipv6_addr_to_str(addr_str, &fte.dst, sizeof(addr_str)), fte.dst_len);
-
-            if ((pkt = _dao_target_build(pkt, &fte.dst, fte.dst_len)) == NULL) {
-                DEBUG("RPL: Send DAO - no space left in packet buffer\n");
-                return;
-            }
+#ifdef MODULE_GNRC_RPL_ROUTES
+    while (gnrc_rpl_routes_iter(dodag->iface, &it->state, &it->route)) {
+        if ((it->route.mode == GNRC_RPL_ROUTES_STORING) &&
+            ipv6_addr_is_global(&it->route.dst)) {
+            *dst = &it->route.dst;
+            *dst_len = it->route.dst_len;
+            return true;
         }
     }
-
-    /* add own address */
-    DEBUG("RPL: Send DAO - building target %s/128\n",
-          ipv6_addr_to_str(addr_str, me, sizeof(addr_str)));
-    if ((pkt = _dao_target_build(pkt, me, IPV6_ADDR_BIT_LEN)) == NULL) {
-        DEBUG("RPL: Send DAO - no space left in packet buffer\n");
-        return;
+#else
+    while (gnrc_ipv6_nib_ft_iter(NULL, dodag->iface, &it->state, &it->fte)) {
+        if (ipv6_addr_is_global(&it->fte.dst) &&
+            !ipv6_addr_is_unspecified(&it->fte.next_hop)) {
+            *dst = &it->fte.dst;
+            *dst_len = it->fte.dst_len;
+            return true;
+        }
     }
+#endif
+    return false;
+}
 
+static bool _dao_send(gnrc_rpl_instance_t *inst, gnrc_pktsnip_t *pkt,
+                      ipv6_addr_t *destination, uint8_t seq)
+{
+    gnrc_rpl_dodag_t *dodag = &inst->dodag;
+    gnrc_pktsnip_t *tmp;
+    gnrc_rpl_dao_t *dao;
     bool local_instance = (inst->id & GNRC_RPL_INSTANCE_ID_MSB) ? true : false;
 
     if (local_instance) {
@@ -937,7 +942,7 @@ void gnrc_rpl_send_DAO(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination, uint
                                    GNRC_NETTYPE_UNDEF)) == NULL) {
             DEBUG("RPL: Send DAO - no space left in packet buffer\n");
             gnrc_pktbuf_release(pkt);
-            return;
+            return false;
         }
         pkt = tmp;
     }
@@ -945,7 +950,7 @@ void gnrc_rpl_send_DAO(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination, uint
     if ((tmp = gnrc_pktbuf_add(pkt, NULL, sizeof(gnrc_rpl_dao_t), GNRC_NETTYPE_UNDEF)) == NULL) {
         DEBUG("RPL: Send DAO - no space left in packet buffer\n");
         gnrc_pktbuf_release(pkt);
-        return;
+        return false;
     }
     pkt = tmp;
     dao = pkt->data;
@@ -960,14 +965,14 @@ void gnrc_rpl_send_DAO(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination, uint
 
     /* set the K flag to indicate that ACKs are required */
     dao->k_d_flags |= GNRC_RPL_DAO_K_BIT;
-    dao->dao_sequence = dodag->dao_seq;
+    dao->dao_sequence = seq;
     dao->reserved = 0;
 
     if ((tmp = gnrc_icmpv6_build(pkt, ICMPV6_RPL_CTRL, GNRC_RPL_ICMPV6_CODE_DAO,
                                  sizeof(icmpv6_hdr_t))) == NULL) {
         DEBUG("RPL: Send DAO - no space left in packet buffer\n");
         gnrc_pktbuf_release(pkt);
-        return;
+        return false;
     }
     pkt = tmp;
 
@@ -977,8 +982,136 @@ void gnrc_rpl_send_DAO(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination, uint
 #endif
 
     gnrc_rpl_send(pkt, dodag->iface, NULL, destination, &dodag->dodag_id);
+    return true;
+}
+
+/* Sends the targets in DAOs of GNRC_RPL_DAO_TARGETS_NUMOF targets each, each
+ * followed by one transit option. DAO i of the batch has sequence
+ * dao_batch_seq + i, so a DAO sent again keeps its sequence. Only DAOs with
+ * their bit set in pending are sent, all DAOs if retx is false. */
+static void _dao_batch_send(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination,
+                            uint8_t lifetime, bool retx)
+{
+    gnrc_rpl_dodag_t *dodag = &inst->dodag;
+    gnrc_netif_t *netif = gnrc_netif_get_by_prefix(&dodag->dodag_id);
+    gnrc_pktsnip_t *pkt = NULL;
+    _dao_iter_t it = { .state = NULL };
+    ipv6_addr_t *dst;
+    uint32_t pending = dodag->dao_acks_pending;
+    uint8_t seq = dodag->dao_batch_seq, dst_len = IPV6_ADDR_BIT_LEN;
+    unsigned targets = 0, daos = 0;
+    bool more = true;
+    int idx;
+
+    if (netif == NULL) {
+        DEBUG("RPL: no address configured\n");
+        return;
+    }
+    if (!retx) {
+        dodag->dao_acks_pending = 0;
+    }
+    /* own address first */
+    idx = gnrc_netif_ipv6_addr_match(netif, &dodag->dodag_id);
+    dst = &netif->ipv6.addrs[idx];
+    while (more) {
+        bool tracked = (daos < (sizeof(pending) * 8));
+
+        if (!retx || (tracked && (pending & (1UL << daos)))) {
+            if ((pkt == NULL) &&
+                ((pkt = _dao_transit_build(NULL, lifetime, false)) == NULL)) {
+                return;
+            }
+            DEBUG("RPL: Send DAO - building target %s/%d\n",
+                  ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)), dst_len);
+            if ((pkt = _dao_target_build(pkt, dst, dst_len)) == NULL) {
+                return;
+            }
+#ifdef MODULE_NETSTATS_RPL
+            gnrc_rpl_netstats.dao_tx_target_count++;
+#endif
+        }
+        targets++;
+        more = _dao_targets_iter(dodag, &it, &dst, &dst_len);
+        if (!more || ((targets % GNRC_RPL_DAO_TARGETS_NUMOF) == 0)) {
+            if (pkt != NULL) {
+                if (!_dao_send(inst, pkt, destination, seq)) {
+                    return;
+                }
+                pkt = NULL;
+                if (!retx && tracked) {
+                    dodag->dao_acks_pending |= (1UL << daos);
+                }
+#ifdef MODULE_NETSTATS_RPL
+                if (retx) {
+                    gnrc_rpl_netstats.dao_retx_count++;
+                }
+#endif
+            }
+            daos++;
+            seq = GNRC_RPL_COUNTER_INCREMENT(seq);
+        }
+    }
+    if (!retx) {
+        dodag->dao_batch_len = (daos < (sizeof(pending) * 8)) ?
+                               daos : (sizeof(pending) * 8);
+        dodag->dao_seq = seq;
+    }
+}
+
+static bool _dao_sendable(gnrc_rpl_instance_t *inst)
+{
+    if (inst == NULL) {
+        DEBUG("RPL: Error - trying to send DAO without being part of a dodag.\n");
+        return false;
+    }
 
-    GNRC_RPL_COUNTER_INCREMENT(dodag->dao_seq);
+    if (inst->dodag.node_status == GNRC_RPL_ROOT_NODE) {
+        return false;
+    }
+
+#ifdef MODULE_GNRC_RPL_P2P
+    if (inst->mop == GNRC_RPL_P2P_MOP) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+void gnrc_rpl_send_DAO(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination, uint8_t lifetime)
+{
+    if (!_dao_sendable(inst)) {
+        return;
+    }
+
+    if (destination == NULL) {
+        if (inst->dodag.parents == NULL) {
+            DEBUG("RPL: dodag has no preferred parent\n");
+            return;
+        }
+
+        destination = &(inst->dodag.parents->addr);
+    }
+
+    inst->dodag.dao_batch_seq = inst->dodag.dao_seq;
+    _dao_batch_send(inst, destination, lifetime, false);
+}
+
+void gnrc_rpl_resend_DAO(gnrc_rpl_instance_t *inst, uint8_t lifetime)
+{
+    if (!_dao_sendable(inst)) {
+        return;
+    }
+
+    if (inst->dodag.parents == NULL) {
+        DEBUG("RPL: dodag has no preferred parent\n");
+        return;
+    }
+
+    if (inst->dodag.dao_acks_pending == 0) {
+        gnrc_rpl_send_DAO(inst, NULL, lifetime);
+        return;
+    }
+    _dao_batch_send(inst, &inst->dodag.parents->addr, lifetime, true);
 }
 
 void gnrc_rpl_send_DAO_ACK(gnrc_rpl_instance_t *inst, ipv6_addr_t *destination, uint8_t seq)
@@ -1134,14 +1267,33 @@ void gnrc_rpl_recv_DAO_ACK(gnrc_rpl_dao_ack_t *dao_ack, kernel_pid_t iface, ipv6
         }
     }
 
-    if ((dao_ack->status != 0) && (dao_ack->dao_sequence != dodag->dao_seq)) {
-        DEBUG("RPL: DAO-ACK sequence (%d) does not match expected sequence (%d)\n",
-                dao_ack->dao_sequence, dodag->dao_seq);
+    uint8_t seq = dodag->dao_batch_seq;
+    unsigned i;
+
+    for (i = 0; i < dodag->dao_batch_len; i++) {
+        if (dao_ack->dao_sequence == seq) {
+            break;
+        }
+        seq = GNRC_RPL_COUNTER_INCREMENT(seq);
+    }
+    if (i == dodag->dao_batch_len) {
+        DEBUG("RPL: DAO-ACK sequence (%d) does not match any DAO sent\n",
+              dao_ack->dao_sequence);
+        return;
+    }
+    if (dao_ack->status >= GNRC_RPL_DAO_ACK_STATUS_REJECT) {
+        DEBUG("RPL: DAO (%d) rejected with status %d\n",
+              dao_ack->dao_sequence, dao_ack->status);
+        /* keep it pending, so it is retransmitted and finally counted as
+         * not acknowledged */
         return;
     }
 
-    dodag->dao_ack_received = true;
-    gnrc_rpl_long_delay_dao(dodag);
+    dodag->dao_acks_pending &= ~(1UL << i);
+    if (dodag->dao_acks_pending == 0) {
+        dodag->dao_ack_received = true;
+        gnrc_rpl_long_delay_dao(dodag);
+    }
 }
 
 /**
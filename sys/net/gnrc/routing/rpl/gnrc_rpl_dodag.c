@@ -155,6 +155,9 @@ bool gnrc_rpl_dodag_init(gnrc_rpl_instance_t *instance, ipv6_addr_t *dodag_id, k
     dodag->dtsn = 0;
     dodag->dao_ack_received = false;
     dodag->dao_counter = 0;
+    dodag->dao_batching = false;
+    dodag->dao_batch_len = 0;
+    dodag->dao_acks_pending = 0;
     dodag->instance = instance;
     dodag->iface = iface;
     dodag->dao_event.msg.content.ptr = instance;
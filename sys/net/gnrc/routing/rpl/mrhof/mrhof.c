@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gnrc_rpl_mrhof
+ * @{
+ * @file
+ * @brief       Minimum Rank with Hysteresis Objective Function with ETX
+ * @}
+ */
+
+#include <string.h>
+
+#include "net/eui64.h"
+#include "net/gnrc/ipv6/nib/nc.h"
+#include "net/gnrc/netif.h"
+#include "net/gnrc/netif/internal.h"
+#include "net/gnrc/rpl.h"
+#include "net/gnrc/rpl/mrhof.h"
+#include "net/netstats/neighbor.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+static uint16_t calc_rank(gnrc_rpl_dodag_t *, uint16_t);
+static int parent_cmp(gnrc_rpl_parent_t *, gnrc_rpl_parent_t *);
+static gnrc_rpl_dodag_t *which_dodag(gnrc_rpl_dodag_t *, gnrc_rpl_dodag_t *);
+static void reset(gnrc_rpl_dodag_t *);
+
+static gnrc_rpl_of_t gnrc_rpl_mrhof = {
+    .ocp          = GNRC_RPL_MRHOF_OCP,
+    .calc_rank    = calc_rank,
+    .parent_cmp   = parent_cmp,
+    .which_dodag  = which_dodag,
+    .reset        = reset,
+    .parent_state_callback = NULL,
+    .init         = reset,
+    .process_dio  = NULL
+};
+
+/* the parent list is unordered while it is sorted, so the preferred parent
+ * of each instance is remembered for the hysteresis */
+static ipv6_addr_t _preferred[GNRC_RPL_INSTANCES_NUMOF];
+
+gnrc_rpl_of_t *gnrc_rpl_get_of_mrhof(void)
+{
+    return &gnrc_rpl_mrhof;
+}
+
+static inline ipv6_addr_t *_preferred_of(gnrc_rpl_dodag_t *dodag)
+{
+    return &_preferred[dodag->instance - gnrc_rpl_instances];
+}
+
+static int _l2addr(gnrc_netif_t *netif, const ipv6_addr_t *addr,
+                   uint8_t *l2addr)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    void *state = NULL;
+
+    while (gnrc_ipv6_nib_nc_iter(netif->pid, &state, &nce)) {
+        if (ipv6_addr_equal(&nce.ipv6, addr) && (nce.l2addr_len > 0)) {
+            memcpy(l2addr, nce.l2addr, nce.l2addr_len);
+            return nce.l2addr_len;
+        }
+    }
+    /* 6LNs resolve link-local addresses from their IID */
+    return gnrc_netif_ipv6_iid_to_addr(netif, (const eui64_t *)&addr->u64[1],
+                                       l2addr);
+}
+
+static uint16_t _link_metric(gnrc_rpl_parent_t *parent)
+{
+    gnrc_netif_t *netif = gnrc_netif_get_by_pid(parent->dodag->iface);
+    uint8_t l2addr[GNRC_IPV6_NIB_L2ADDR_MAX_LEN];
+    netstats_nb_t nb;
+    int l2addr_len;
+
+    if ((netif != NULL) &&
+        ((l2addr_len = _l2addr(netif, &parent->addr, l2addr)) > 0) &&
+        netstats_nb_get(&netif->neighbors, l2addr, l2addr_len, &nb)) {
+        return nb.etx;
+    }
+    /* no transmissions to the parent yet */
+    return NETSTATS_NB_ETX_INIT;
+}
+
+static uint32_t _path_cost(gnrc_rpl_parent_t *parent)
+{
+    uint16_t link = _link_metric(parent);
+    uint32_t cost = (uint32_t)parent->rank + link;
+
+    if (link > GNRC_RPL_MRHOF_MAX_LINK_METRIC) {
+        /* only use as a last resort */
+        cost += GNRC_RPL_MRHOF_MAX_PATH_COST;
+    }
+    return cost;
+}
+
+void reset(gnrc_rpl_dodag_t *dodag)
+{
+    memset(_preferred_of(dodag), 0, sizeof(ipv6_addr_t));
+}
+
+uint16_t calc_rank(gnrc_rpl_dodag_t *dodag, uint16_t base_rank)
+{
+    uint32_t rank;
+
+    if (base_rank == 0) {
+        gnrc_rpl_parent_t *parent = dodag->parents;
+        uint32_t cost;
+
+        if ((parent == NULL) || (parent->rank == GNRC_RPL_INFINITE_RANK)) {
+            return GNRC_RPL_INFINITE_RANK;
+        }
+        /* called right after the parent list was sorted */
+        memcpy(_preferred_of(dodag), &parent->addr, sizeof(ipv6_addr_t));
+        cost = _path_cost(parent);
+        rank = parent->rank + dodag->instance->min_hop_rank_inc;
+        if ((cost > rank) && (cost < GNRC_RPL_MRHOF_MAX_PATH_COST)) {
+            rank = cost;
+        }
+        DEBUG("RPL: MRHOF path cost %u, rank %u\n", (unsigned)cost,
+              (unsigned)rank);
+    }
+    else {
+        rank = (uint32_t)base_rank + ((dodag->parents != NULL) ?
+                                      dodag->instance->min_hop_rank_inc :
+                                      GNRC_RPL_DEFAULT_MIN_HOP_RANK_INCREASE);
+    }
+
+    return (rank < GNRC_RPL_INFINITE_RANK) ? rank : GNRC_RPL_INFINITE_RANK;
+}
+
+int parent_cmp(gnrc_rpl_parent_t *parent1, gnrc_rpl_parent_t *parent2)
+{
+    const ipv6_addr_t *preferred = _preferred_of(parent1->dodag);
+    uint32_t cost1 = _path_cost(parent1);
+    uint32_t cost2 = _path_cost(parent2);
+
+    /* hysteresis: keep the preferred parent unless the other one is
+     * considerably better */
+    if (ipv6_addr_equal(&parent1->addr, preferred)) {
+        cost2 += GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD;
+    }
+    else if (ipv6_addr_equal(&parent2->addr, preferred)) {
+        cost1 += GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD;
+    }
+    if (cost1 < cost2) {
+        return -1;
+    }
+    else if (cost1 > cost2) {
+        return 1;
+    }
+    return 0;
+}
+
+/* Not used yet */
+gnrc_rpl_dodag_t *which_dodag(gnrc_rpl_dodag_t *d1, gnrc_rpl_dodag_t *d2)
+{
+    (void) d2;
+    return d1;
+}
@@ -0,0 +1,458 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_gnrc_rpl_routes
+ * @{
+ * @file
+ * @brief       RPL downward route store
+ *
+ * Entries are linked by 1-based indices, 0 marks the end of a list. Unused
+ * entries form a free list. An entry that is no valid route (expired or
+ * removed) may still be the parent of other entries, so it is only reused
+ * after a garbage collection found it unreferenced.
+ * @}
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include "bitfield.h"
+#include "mutex.h"
+#include "net/eui64.h"
+#include "net/gnrc/ipv6/nib/conf.h"
+#include "net/gnrc/ipv6/nib/rc.h"
+#include "net/gnrc/rpl/routes.h"
+#include "timex.h"
+#include "xtimer.h"
+
+#define ENABLE_DEBUG    (0)
+#include "debug.h"
+
+#if GNRC_RPL_ROUTES_NUMOF < 255
+typedef uint8_t _idx_t;
+#else
+typedef uint16_t _idx_t;
+#endif
+
+#define PFX_LEN         (sizeof(eui64_t))
+
+typedef struct {
+    eui64_t iid;            /* lower 64 bit of destination */
+    uint32_t expires;       /* in seconds, 0 if no valid route */
+    _idx_t next;            /* next entry in bucket, prefix or free list */
+    _idx_t parent;          /* 0 if none */
+    kernel_pid_t iface;
+    uint8_t pfx;            /* 1-based index in _pfxs, 0 if entry is unused */
+    uint8_t len;            /* prefix length of destination */
+    uint8_t mode;
+} _entry_t;
+
+typedef struct {
+    uint8_t pfx[PFX_LEN];   /* upper 64 bit of destination */
+    _idx_t refs;            /* entries using the prefix */
+} _pfx_t;
+
+static _entry_t _entries[GNRC_RPL_ROUTES_NUMOF];
+static _idx_t _buckets[GNRC_RPL_ROUTES_HASH_NUMOF];
+static _pfx_t _pfxs[GNRC_RPL_ROUTES_PFX_NUMOF];
+static _idx_t _pfx_routes;  /* routes with destinations shorter than 128 bit */
+static _idx_t _free;
+static unsigned _free_numof;
+static mutex_t _mutex = MUTEX_INIT;
+
+static inline uint32_t _now(void)
+{
+    return (uint32_t)(xtimer_now_usec64() / US_PER_SEC);
+}
+
+static inline _idx_t _idx(const _entry_t *entry)
+{
+    return (_idx_t)(entry - _entries) + 1;
+}
+
+static inline _entry_t *_entry(_idx_t idx)
+{
+    return &_entries[idx - 1];
+}
+
+static inline bool _valid(const _entry_t *entry, uint32_t now)
+{
+    return (entry->expires != 0) && ((int32_t)(entry->expires - now) > 0);
+}
+
+static inline _idx_t *_bucket(uint8_t pfx, const eui64_t *iid)
+{
+    uint64_t tmp = iid->uint64.u64;
+    uint32_t hash = (uint32_t)(tmp ^ (tmp >> 32)) ^ pfx;
+
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+    return &_buckets[hash & (GNRC_RPL_ROUTES_HASH_NUMOF - 1)];
+}
+
+static inline _idx_t *_list(const _entry_t *entry)
+{
+    return (entry->len == IPV6_ADDR_BIT_LEN) ? _bucket(entry->pfx, &entry->iid)
+                                             : &_pfx_routes;
+}
+
+static void _get_addr(const _entry_t *entry, ipv6_addr_t *addr)
+{
+    memcpy(&addr->u8[0], _pfxs[entry->pfx - 1].pfx, PFX_LEN);
+    memcpy(&addr->u8[PFX_LEN], &entry->iid, sizeof(entry->iid));
+}
+
+/* masks addr to len bits */
+static void _mask(ipv6_addr_t *out, const ipv6_addr_t *addr, uint8_t len)
+{
+    ipv6_addr_set_unspecified(out);
+    ipv6_addr_init_prefix(out, addr, len);
+}
+
+/* returns 1-based index of prefix of addr, allocates an unused one other
+ * than exclude if alloc is set, 0 if none */
+static uint8_t _pfx_get(const ipv6_addr_t *addr, bool alloc, uint8_t exclude)
+{
+    uint8_t unused = 0;
+
+    for (unsigned i = 0; i < GNRC_RPL_ROUTES_PFX_NUMOF; i++) {
+        if (_pfxs[i].refs == 0) {
+            if ((unused == 0) && ((i + 1) != exclude)) {
+                unused = i + 1;
+            }
+        }
+        else if (memcmp(_pfxs[i].pfx, addr, PFX_LEN) == 0) {
+            return i + 1;
+        }
+    }
+    if (alloc && (unused != 0)) {
+        memcpy(_pfxs[unused - 1].pfx, addr, PFX_LEN);
+    }
+    return (alloc) ? unused : 0;
+}
+
+/* addr must be masked to len */
+static _entry_t *_find(uint8_t pfx, const ipv6_addr_t *addr, uint8_t len)
+{
+    const eui64_t *iid = (const eui64_t *)&addr->u8[PFX_LEN];
+    _idx_t i = (len == IPV6_ADDR_BIT_LEN) ? *_bucket(pfx, iid) : _pfx_routes;
+
+    for (; i != 0; i = _entry(i)->next) {
+        _entry_t *entry = _entry(i);
+
+        if ((entry->pfx == pfx) && (entry->len == len) &&
+            (memcmp(&entry->iid, iid, sizeof(*iid)) == 0)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static _entry_t *_create(uint8_t pfx, const ipv6_addr_t *addr, uint8_t len)
+{
+    _entry_t *entry;
+    _idx_t *list;
+
+    assert(_free != 0);
+    entry = _entry(_free);
+    _free = entry->next;
+    _free_numof--;
+    memset(entry, 0, sizeof(*entry));
+    memcpy(&entry->iid, &addr->u8[PFX_LEN], sizeof(entry->iid));
+    entry->pfx = pfx;
+    entry->len = len;
+    _pfxs[pfx - 1].refs++;
+    list = _list(entry);
+    entry->next = *list;
+    *list = _idx(entry);
+    return entry;
+}
+
+static void _remove(_entry_t *entry)
+{
+    _idx_t idx = _idx(entry);
+    _idx_t *ptr = _list(entry);
+
+    while (*ptr != idx) {
+        assert(*ptr != 0);
+        ptr = &_entry(*ptr)->next;
+    }
+    *ptr = entry->next;
+    _pfxs[entry->pfx - 1].refs--;
+    entry->pfx = 0;
+    entry->next = _free;
+    _free = idx;
+    _free_numof++;
+}
+
+/* frees all entries that are neither valid routes nor (indirect) parents of
+ * one */
+static void _gc(uint32_t now)
+{
+    BITFIELD(used, GNRC_RPL_ROUTES_NUMOF);
+
+    memset(used, 0, sizeof(used));
+    for (unsigned i = 0; i < GNRC_RPL_ROUTES_NUMOF; i++) {
+        _entry_t *entry = &_entries[i];
+
+        if ((entry->pfx == 0) || !_valid(entry, now)) {
+            continue;
+        }
+        bf_set(used, i);
+        for (_idx_t p = entry->parent; (p != 0) && !bf_isset(used, p - 1);
+             p = _entry(p)->parent) {
+            bf_set(used, p - 1);
+        }
+    }
+    for (unsigned i = 0; i < GNRC_RPL_ROUTES_NUMOF; i++) {
+        _entry_t *entry = &_entries[i];
+
+        if (entry->pfx == 0) {
+            continue;
+        }
+        if (!bf_isset(used, i)) {
+            DEBUG("rpl_routes: freeing entry %u\n", i);
+            _remove(entry);
+        }
+        else if (!_valid(entry, now)) {
+            entry->expires = 0;
+        }
+    }
+}
+
+static inline void _invalidate_route_cache(uint8_t mode)
+{
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+    if (mode == GNRC_RPL_ROUTES_STORING) {
+        gnrc_ipv6_nib_rc_invalidate();
+    }
+#else
+    (void)mode;
+#endif
+}
+
+static void _get(const _entry_t *entry, uint32_t now, gnrc_rpl_route_t *route)
+{
+    _get_addr(entry, &route->dst);
+    _get_addr(_entry(entry->parent), &route->parent);
+    route->ltime = entry->expires - now;
+    route->iface = entry->iface;
+    route->dst_len = entry->len;
+    route->mode = entry->mode;
+}
+
+void gnrc_rpl_routes_init(void)
+{
+    mutex_lock(&_mutex);
+    memset(_entries, 0, sizeof(_entries));
+    memset(_buckets, 0, sizeof(_buckets));
+    memset(_pfxs, 0, sizeof(_pfxs));
+    _pfx_routes = 0;
+    _free = 0;
+    for (unsigned i = GNRC_RPL_ROUTES_NUMOF; i > 0; i--) {
+        _entries[i - 1].next = _free;
+        _free = i;
+    }
+    _free_numof = GNRC_RPL_ROUTES_NUMOF;
+    mutex_unlock(&_mutex);
+}
+
+int gnrc_rpl_routes_add(const ipv6_addr_t *dst, uint8_t dst_len,
+                        const ipv6_addr_t *parent, kernel_pid_t iface,
+                        uint8_t mode, uint32_t ltime)
+{
+    ipv6_addr_t target;
+    _entry_t *entry, *p;
+    uint8_t dst_pfx, parent_pfx = 0;
+    uint32_t now = _now();
+    unsigned need;
+
+    assert((dst != NULL) && (parent != NULL) && (dst_len > 0));
+    if (dst_len > IPV6_ADDR_BIT_LEN) {
+        dst_len = IPV6_ADDR_BIT_LEN;
+    }
+    _mask(&target, dst, dst_len);
+    if ((dst_len == IPV6_ADDR_BIT_LEN) && ipv6_addr_equal(&target, parent)) {
+        return -EINVAL;
+    }
+    mutex_lock(&_mutex);
+    if ((dst_pfx = _pfx_get(&target, true, 0)) != 0) {
+        /* a prefix allocated just now is not found by _pfx_get() yet */
+        parent_pfx = (memcmp(_pfxs[dst_pfx - 1].pfx, parent, PFX_LEN) == 0)
+                   ? dst_pfx : _pfx_get(parent, true, dst_pfx);
+    }
+    if ((dst_pfx == 0) || (parent_pfx == 0)) {
+        mutex_unlock(&_mutex);
+        return -ENOSPC;
+    }
+    entry = _find(dst_pfx, &target, dst_len);
+    p = _find(parent_pfx, parent, IPV6_ADDR_BIT_LEN);
+    need = (entry == NULL) + (p == NULL);
+    if (_free_numof < need) {
+        _gc(now);
+        /* prefixes are still referenced, but the entries may be gone */
+        entry = _find(dst_pfx, &target, dst_len);
+        p = _find(parent_pfx, parent, IPV6_ADDR_BIT_LEN);
+        need = (entry == NULL) + (p == NULL);
+    }
+    if (_free_numof < need) {
+        mutex_unlock(&_mutex);
+        return -ENOMEM;
+    }
+    if (entry == NULL) {
+        entry = _create(dst_pfx, &target, dst_len);
+    }
+    if (p == NULL) {
+        p = _create(parent_pfx, parent, IPV6_ADDR_BIT_LEN);
+    }
+    entry->parent = _idx(p);
+    entry->iface = iface;
+    entry->mode = mode;
+    entry->expires = now + ltime;
+    if (entry->expires == 0) {
+        entry->expires = 1;
+    }
+    mutex_unlock(&_mutex);
+    _invalidate_route_cache(mode);
+    return 0;
+}
+
+void gnrc_rpl_routes_del(const ipv6_addr_t *dst, uint8_t dst_len)
+{
+    ipv6_addr_t target;
+    _entry_t *entry = NULL;
+    uint8_t mode = GNRC_RPL_ROUTES_NON_STORING;
+    uint8_t pfx;
+
+    assert(dst != NULL);
+    if (dst_len > IPV6_ADDR_BIT_LEN) {
+        dst_len = IPV6_ADDR_BIT_LEN;
+    }
+    _mask(&target, dst, dst_len);
+    mutex_lock(&_mutex);
+    if ((pfx = _pfx_get(&target, false, 0)) != 0) {
+        entry = _find(pfx, &target, dst_len);
+    }
+    if (entry != NULL) {
+        /* may still be a parent, so leave freeing it to the next _gc() */
+        entry->expires = 0;
+        mode = entry->mode;
+    }
+    mutex_unlock(&_mutex);
+    _invalidate_route_cache(mode);
+}
+
+int gnrc_rpl_routes_get(const ipv6_addr_t *dst, gnrc_rpl_route_t *route)
+{
+    _entry_t *best = NULL;
+    uint32_t now = _now();
+    uint8_t pfx;
+
+    assert((dst != NULL) && (route != NULL));
+    mutex_lock(&_mutex);
+    if ((pfx = _pfx_get(dst, false, 0)) != 0) {
+        best = _find(pfx, dst, IPV6_ADDR_BIT_LEN);
+        if ((best != NULL) && !_valid(best, now)) {
+            best = NULL;
+        }
+    }
+    if (best == NULL) {
+        for (_idx_t i = _pfx_routes; i != 0; i = _entry(i)->next) {
+            _entry_t *entry = _entry(i);
+            ipv6_addr_t addr;
+
+            if (!_valid(entry, now) ||
+                ((best != NULL) && (entry->len <= best->len))) {
+                continue;
+            }
+            _get_addr(entry, &addr);
+            if (ipv6_addr_match_prefix(&addr, dst) >= entry->len) {
+                best = entry;
+            }
+        }
+    }
+    if (best != NULL) {
+        _get(best, now, route);
+    }
+    mutex_unlock(&_mutex);
+    return (best != NULL) ? 0 : -ENOENT;
+}
+
+int gnrc_rpl_routes_get_parent(const ipv6_addr_t *addr, ipv6_addr_t *parent)
+{
+    _entry_t *entry = NULL;
+    uint8_t pfx;
+
+    assert((addr != NULL) && (parent != NULL));
+    mutex_lock(&_mutex);
+    if ((pfx = _pfx_get(addr, false, 0)) != 0) {
+        entry = _find(pfx, addr, IPV6_ADDR_BIT_LEN);
+    }
+    /* expired routes stay usable as long as they are part of a path */
+    if ((entry != NULL) && (entry->parent != 0) &&
+        (entry->mode == GNRC_RPL_ROUTES_NON_STORING)) {
+        _get_addr(_entry(entry->parent), parent);
+    }
+    else {
+        entry = NULL;
+    }
+    mutex_unlock(&_mutex);
+    return (entry != NULL) ? 0 : -ENOENT;
+}
+
+bool gnrc_rpl_routes_iter(kernel_pid_t iface, void **state,
+                          gnrc_rpl_route_t *route)
+{
+    _entry_t *entry;
+    uint32_t now = _now();
+
+    assert((state != NULL) && (route != NULL));
+    entry = *state;
+    mutex_lock(&_mutex);
+    for (entry = (entry == NULL) ? _entries : (entry + 1);
+         entry < (_entries + GNRC_RPL_ROUTES_NUMOF); entry++) {
+        if ((entry->pfx != 0) && _valid(entry, now) &&
+            ((iface == KERNEL_PID_UNDEF) || (entry->iface == iface))) {
+            _get(entry, now, route);
+            break;
+        }
+    }
+    if (entry == (_entries + GNRC_RPL_ROUTES_NUMOF)) {
+        entry = NULL;
+    }
+    mutex_unlock(&_mutex);
+    *state = entry;
+    return (entry != NULL);
+}
+
+void gnrc_rpl_routes_get_stats(gnrc_rpl_routes_stats_t *stats)
+{
+    uint32_t now = _now();
+
+    assert(stats != NULL);
+    memset(stats, 0, sizeof(*stats));
+    mutex_lock(&_mutex);
+    for (unsigned i = 0; i < GNRC_RPL_ROUTES_NUMOF; i++) {
+        if (_entries[i].pfx != 0) {
+            stats->entries++;
+            if (_valid(&_entries[i], now)) {
+                stats->routes++;
+            }
+        }
+    }
+    for (unsigned i = 0; i < GNRC_RPL_ROUTES_PFX_NUMOF; i++) {
+        if (_pfxs[i].refs > 0) {
+            stats->pfxs++;
+        }
+    }
+    mutex_unlock(&_mutex);
+    stats->size = sizeof(_entries) + sizeof(_buckets) + sizeof(_pfxs);
+}
@@ -15,10 +15,15 @@
  * @author Martine Lenders <m.lenders@fu-berlin.de>
  */
 
+#include <errno.h>
 #include <string.h>
 #include "net/gnrc/netif/internal.h"
 #include "net/gnrc/ipv6/ext/rh.h"
 #include "net/gnrc/rpl/srh.h"
+#ifdef MODULE_GNRC_RPL_ROUTES
+#include "net/gnrc/rpl/routes.h"
+#include "net/ipv6/ext/rh.h"
+#endif
 
 #define ENABLE_DEBUG    (0)
 #include "debug.h"
@@ -124,4 +129,96 @@ int gnrc_rpl_srh_process(ipv6_hdr_t *ipv6, gnrc_rpl_srh_t *rh, void **err_ptr)
     return GNRC_IPV6_EXT_RH_FORWARDED;
 }
 
+#ifdef MODULE_GNRC_RPL_ROUTES
+/* number of leading octets a and b have in common, at most 15 */
+static inline uint8_t _common_octets(const ipv6_addr_t *a,
+                                     const ipv6_addr_t *b)
+{
+    uint8_t octets = ipv6_addr_match_prefix(a, b) / 8;
+
+    return (octets < sizeof(ipv6_addr_t)) ? octets : sizeof(ipv6_addr_t) - 1;
+}
+
+int gnrc_rpl_srh_build(const ipv6_addr_t *root, const ipv6_addr_t *dst,
+                       ipv6_addr_t *first_hop, gnrc_rpl_srh_t *rh,
+                       size_t max_len)
+{
+    ipv6_addr_t *vec = (ipv6_addr_t *)(rh + 1);
+    uint8_t *out = (uint8_t *)(rh + 1);
+    unsigned num_addr = 0;
+    uint8_t compri = sizeof(ipv6_addr_t) - 1, compre;
+    size_t len;
+    unsigned pad;
+
+    assert((root != NULL) && (dst != NULL) && (first_hop != NULL));
+    /* collect path from dst upwards, uncompressed */
+    memcpy(first_hop, dst, sizeof(*first_hop));
+    while (1) {
+        ipv6_addr_t parent;
+
+        if (gnrc_rpl_routes_get_parent(first_hop, &parent) < 0) {
+            DEBUG("RPL SRH: no parent for %s\n",
+                  ipv6_addr_to_str(addr_str, first_hop, sizeof(addr_str)));
+            return -EHOSTUNREACH;
+        }
+        if (ipv6_addr_equal(&parent, root)) {
+            break;
+        }
+        if (num_addr >= GNRC_RPL_ROUTES_NUMOF) {
+            return -ELOOP;
+        }
+        if ((sizeof(*rh) + ((num_addr + 1) * sizeof(ipv6_addr_t))) > max_len) {
+            return -ENOBUFS;
+        }
+        memcpy(&vec[num_addr++], first_hop, sizeof(ipv6_addr_t));
+        memcpy(first_hop, &parent, sizeof(parent));
+    }
+    if (num_addr == 0) {
+        return 0;
+    }
+    /* reverse to order of traversal, dst becomes last */
+    for (unsigned i = 0; i < (num_addr / 2); i++) {
+        ipv6_addr_t tmp;
+
+        memcpy(&tmp, &vec[i], sizeof(tmp));
+        memcpy(&vec[i], &vec[num_addr - 1 - i], sizeof(tmp));
+        memcpy(&vec[num_addr - 1 - i], &tmp, sizeof(tmp));
+    }
+    for (unsigned i = 0; i < (num_addr - 1); i++) {
+        uint8_t common = _common_octets(&vec[i], first_hop);
+
+        if (common < compri) {
+            compri = common;
+        }
+    }
+    compre = _common_octets(&vec[num_addr - 1], first_hop);
+    /* the last address is restored from the second to last one */
+    if ((num_addr > 1) && (compre > compri)) {
+        compre = compri;
+    }
+    /* compress in place, output never overtakes input */
+    for (unsigned i = 0; i < num_addr; i++) {
+        uint8_t elided = (i < (num_addr - 1)) ? compri : compre;
+
+        memmove(out, &vec[i].u8[elided], sizeof(ipv6_addr_t) - elided);
+        out += sizeof(ipv6_addr_t) - elided;
+    }
+    len = out - (uint8_t *)rh;
+    pad = (8 - (len & 0x7)) & 0x7;
+    memset(out, 0, pad);
+    len += pad;
+    rh->nh = 0;
+    rh->len = (len / 8) - 1;
+    rh->type = IPV6_EXT_RH_TYPE_RPL_SRH;
+    rh->seg_left = num_addr;
+    rh->compr = (compri << 4) | compre;
+    rh->pad_resv = pad << 4;
+    rh->resv = 0;
+    DEBUG("RPL SRH: %u addresses to %s, first hop ", num_addr,
+          ipv6_addr_to_str(addr_str, dst, sizeof(addr_str)));
+    DEBUG("%s\n", ipv6_addr_to_str(addr_str, first_hop, sizeof(addr_str)));
+    return len;
+}
+#endif
+
 /** @} */
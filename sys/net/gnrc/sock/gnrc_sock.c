@@ -13,6 +13,7 @@
  * @author  Martine Lenders <mlenders@inf.fu-berlin.de>
  */
 
+#include <assert.h>
 #include <errno.h>
 
 #include "net/af.h"
@@ -60,26 +61,27 @@ ssize_t gnrc_sock_recv(gnrc_sock_reg_t *reg, gnrc_pktsnip_t **pkt_out,
     if (reg->mbox.cib.mask != (SOCK_MBOX_SIZE - 1)) {
         return -EINVAL;
     }
+    /* only set up a timeout if we actually need to wait */
+    if (!mbox_try_get(&reg->mbox, &msg)) {
+        if (timeout == 0) {
+            return -EAGAIN;
+        }
 #ifdef MODULE_XTIMER
-    xtimer_t timeout_timer;
+        xtimer_t timeout_timer;
 
-    if ((timeout != SOCK_NO_TIMEOUT) && (timeout != 0)) {
-        timeout_timer.callback = _callback_put;
-        timeout_timer.arg = reg;
-        xtimer_set(&timeout_timer, timeout);
-    }
+        if (timeout != SOCK_NO_TIMEOUT) {
+            timeout_timer.callback = _callback_put;
+            timeout_timer.arg = reg;
+            xtimer_set(&timeout_timer, timeout);
+        }
 #endif
-    if (timeout != 0) {
         mbox_get(&reg->mbox, &msg);
-    }
-    else {
-        if (!mbox_try_get(&reg->mbox, &msg)) {
-            return -EAGAIN;
-        }
-    }
 #ifdef MODULE_XTIMER
-    xtimer_remove(&timeout_timer);
+        if (timeout != SOCK_NO_TIMEOUT) {
+            xtimer_remove(&timeout_timer);
+        }
 #endif
+    }
     switch (msg.type) {
         case GNRC_NETAPI_MSG_TYPE_RCV:
             pkt = msg.content.ptr;
@@ -113,6 +115,25 @@ ssize_t gnrc_sock_recv(gnrc_sock_reg_t *reg, gnrc_pktsnip_t **pkt_out,
     return 0;
 }
 
+gnrc_pktsnip_t *gnrc_sock_pktbuf_gather(const iolist_t *snips)
+{
+    gnrc_pktsnip_t *payload;
+    uint8_t *ptr;
+
+    payload = gnrc_pktbuf_add(NULL, NULL, iolist_size(snips),
+                              GNRC_NETTYPE_UNDEF);
+    if (payload == NULL) {
+        return NULL;
+    }
+    ptr = payload->data;
+    for (const iolist_t *snip = snips; snip != NULL; snip = snip->iol_next) {
+        assert((snip->iol_len == 0) || (snip->iol_base != NULL));
+        memcpy(ptr, snip->iol_base, snip->iol_len);
+        ptr += snip->iol_len;
+    }
+    return payload;
+}
+
 ssize_t gnrc_sock_send(gnrc_pktsnip_t *payload, sock_ip_ep_t *local,
                        const sock_ip_ep_t *remote, uint8_t nh)
 {
@@ -25,6 +25,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include "iolist.h"
 #include "mbox.h"
 #include "net/af.h"
 #include "net/gnrc.h"
@@ -66,6 +67,18 @@ extern "C" {
  */
 #define GNRC_SOCK_DYN_PORTRANGE_OFF (17U)
 
+#if defined(MODULE_GNRC_SOCK_CHECK_REUSE) || defined(DOXYGEN)
+/**
+ * @brief   Number of counters of bound UDP socks, by hash of their port
+ *
+ * Must be a power of two. A port whose counter is zero is free without
+ * looking at any sock.
+ */
+#ifndef GNRC_SOCK_PORT_HASH_NUMOF
+#define GNRC_SOCK_PORT_HASH_NUMOF   (64U)
+#endif
+#endif
+
 /**
  * @brief   Internal helper functions for GNRC
  * @internal
@@ -135,6 +148,14 @@ ssize_t gnrc_sock_recv(gnrc_sock_reg_t *reg, gnrc_pktsnip_t **pkt, uint32_t time
  */
 ssize_t gnrc_sock_send(gnrc_pktsnip_t *payload, sock_ip_ep_t *local,
                        const sock_ip_ep_t *remote, uint8_t nh);
+
+/**
+ * @brief   Allocate a payload snip and gather an iolist into it
+ * @internal
+ *
+ * @return  The payload snip on success, NULL if packet buffer is full.
+ */
+gnrc_pktsnip_t *gnrc_sock_pktbuf_gather(const iolist_t *snips);
 /**
  * @}
  */
@@ -45,9 +45,6 @@ extern "C" {
  * @internal
  */
 typedef struct gnrc_sock_reg {
-#ifdef MODULE_GNRC_SOCK_CHECK_REUSE
-    struct gnrc_sock_reg *next;         /**< list-like for internal storage */
-#endif
     gnrc_netreg_entry_t entry;          /**< @ref net_gnrc_netreg entry for mbox */
     mbox_t mbox;                        /**< @ref core_mbox target for the sock */
     msg_t mbox_queue[SOCK_MBOX_SIZE];   /**< queue for gnrc_sock_reg_t::mbox */
@@ -19,19 +19,78 @@
 #include <string.h>
 
 #include "byteorder.h"
+#include "kernel_defines.h"
 #include "net/af.h"
 #include "net/protnum.h"
 #include "net/gnrc/ipv6.h"
 #include "net/gnrc/udp.h"
 #include "net/sock/udp.h"
 #include "net/udp.h"
+#include "xtimer.h"
 
 #include "gnrc_sock_internal.h"
 
 #ifdef MODULE_GNRC_SOCK_CHECK_REUSE
-static sock_udp_t *_udp_socks = NULL;
+#if (GNRC_SOCK_PORT_HASH_NUMOF & (GNRC_SOCK_PORT_HASH_NUMOF - 1)) != 0
+#error "GNRC_SOCK_PORT_HASH_NUMOF must be a power of two"
 #endif
 
+/* number of bound socks by hash of their port, saturating */
+static uint8_t _port_socks[GNRC_SOCK_PORT_HASH_NUMOF];
+
+static inline uint8_t *_port_socks_of(uint16_t port)
+{
+    return &_port_socks[(port ^ (port >> 8)) & (GNRC_SOCK_PORT_HASH_NUMOF - 1)];
+}
+
+/* the netreg entries of a port also belong to other registrants */
+static sock_udp_t *_sock_of(gnrc_netreg_entry_t *entry)
+{
+    gnrc_sock_reg_t *reg = container_of(entry, gnrc_sock_reg_t, entry);
+
+    if ((entry->type != GNRC_NETREG_TYPE_MBOX) ||
+        (entry->target.mbox != &reg->mbox)) {
+        return NULL;
+    }
+    return (sock_udp_t *)reg;
+}
+
+/**
+ * @brief   Finds the bound sock with a local end-point of a port the
+ *          predicate is true for
+ */
+static sock_udp_t *_port_sock_find(uint16_t port,
+                                   bool (*pred)(const sock_udp_t *,
+                                                const void *),
+                                   const void *arg)
+{
+    if (*_port_socks_of(port) == 0) {
+        return NULL;
+    }
+    for (gnrc_netreg_entry_t *entry = gnrc_netreg_lookup(GNRC_NETTYPE_UDP,
+                                                          port);
+         entry != NULL; entry = gnrc_netreg_getnext(entry)) {
+        sock_udp_t *ptr = _sock_of(entry);
+
+        if ((ptr != NULL) && pred(ptr, arg)) {
+            return ptr;
+        }
+    }
+    return NULL;
+}
+
+static bool _any_addr(const sock_udp_t *sock, const void *arg)
+{
+    (void)arg;
+    return gnrc_ep_addr_any((const sock_ip_ep_t *)&sock->local);
+}
+
+static bool _same_ep(const sock_udp_t *sock, const void *arg)
+{
+    return (memcmp(&sock->local, arg, sizeof(sock_udp_ep_t)) == 0);
+}
+#endif /* MODULE_GNRC_SOCK_CHECK_REUSE */
+
 static uint16_t _dyn_port_next = 0;
 
 /**
@@ -40,27 +99,23 @@ static uint16_t _dyn_port_next = 0;
 static bool _dyn_port_used(uint16_t port)
 {
 #ifdef MODULE_GNRC_SOCK_CHECK_REUSE
-    for (sock_udp_t *ptr = _udp_socks; ptr != NULL;
-         ptr = (sock_udp_t *)ptr->reg.next) {
-        bool spec_addr = false;
-        for (unsigned i = 0; i < sizeof(ptr->local.addr); i++) {
-            const uint8_t *const p = (uint8_t *)&ptr->local.addr;
-            if (p[i] != 0) {
-                spec_addr = true;
-            }
-        }
-        if (spec_addr) {
-            continue;
-        }
-        if (ptr->local.port == port) {
-            /* port already in use by another sock */
-            return true;
-        }
-    }
+    return (_port_sock_find(port, _any_addr, NULL) != NULL);
 #else
     (void) port;
-#endif /* MODULE_GNRC_SOCK_CHECK_REUSE */
     return false;
+#endif /* MODULE_GNRC_SOCK_CHECK_REUSE */
+}
+
+static void _sock_register(sock_udp_t *sock)
+{
+    gnrc_sock_create(&sock->reg, GNRC_NETTYPE_UDP, sock->local.port);
+#ifdef MODULE_GNRC_SOCK_CHECK_REUSE
+    uint8_t *socks = _port_socks_of(sock->local.port);
+
+    if (*socks < UINT8_MAX) {
+        (*socks)++;
+    }
+#endif /* MODULE_GNRC_SOCK_CHECK_REUSE */
 }
 
 /**
@@ -95,7 +150,19 @@ int sock_udp_create(sock_udp_t *sock, const sock_udp_ep_t *local,
         (local->netif != remote->netif)) {
         return -EINVAL;
     }
+    /* not registered unless bound */
+    sock->reg.entry.target.mbox = NULL;
+    sock->flags = flags;
     memset(&sock->local, 0, sizeof(sock_udp_ep_t));
+    memset(&sock->remote, 0, sizeof(sock_udp_ep_t));
+    if (remote != NULL) {
+        if (gnrc_af_not_supported(remote->family)) {
+            return -EAFNOSUPPORT;
+        }
+        if (gnrc_ep_addr_any((const sock_ip_ep_t *)remote)) {
+            return -EINVAL;
+        }
+    }
     if (local != NULL) {
         uint16_t port = local->port;
 
@@ -109,37 +176,22 @@ int sock_udp_create(sock_udp_t *sock, const sock_udp_ep_t *local,
             }
         }
 #ifdef MODULE_GNRC_SOCK_CHECK_REUSE
-        else if (!(flags & SOCK_FLAGS_REUSE_EP)) {
-            for (sock_udp_t *ptr = _udp_socks; ptr != NULL;
-                 ptr = (sock_udp_t *)ptr->reg.next) {
-                if (memcmp(&ptr->local, local, sizeof(sock_udp_ep_t)) == 0) {
-                    return -EADDRINUSE;
-                }
-            }
+        else if (!(flags & SOCK_FLAGS_REUSE_EP) &&
+                 (_port_sock_find(port, _same_ep, local) != NULL)) {
+            return -EADDRINUSE;
         }
-        /* prepend to current socks */
-        sock->reg.next = (gnrc_sock_reg_t *)_udp_socks;
-        _udp_socks = sock;
 #endif
         memcpy(&sock->local, local, sizeof(sock_udp_ep_t));
         sock->local.port = port;
     }
-    memset(&sock->remote, 0, sizeof(sock_udp_ep_t));
     if (remote != NULL) {
-        if (gnrc_af_not_supported(remote->family)) {
-            return -EAFNOSUPPORT;
-        }
-        if (gnrc_ep_addr_any((const sock_ip_ep_t *)remote)) {
-            return -EINVAL;
-        }
         gnrc_ep_set((sock_ip_ep_t *)&sock->remote,
                     (sock_ip_ep_t *)remote, sizeof(sock_udp_ep_t));
     }
     if (local != NULL) {
         /* listen only with local given */
-        gnrc_sock_create(&sock->reg, GNRC_NETTYPE_UDP, sock->local.port);
+        _sock_register(sock);
     }
-    sock->flags = flags;
     return 0;
 }
 
@@ -148,11 +200,16 @@ void sock_udp_close(sock_udp_t *sock)
     assert(sock != NULL);
     gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &sock->reg.entry);
 #ifdef MODULE_GNRC_SOCK_CHECK_REUSE
-    if (_udp_socks != NULL) {
-        gnrc_sock_reg_t *head = (gnrc_sock_reg_t *)_udp_socks;
-        LL_DELETE(head, (gnrc_sock_reg_t *)sock);
+    if (sock->reg.entry.target.mbox == &sock->reg.mbox) {
+        uint8_t *socks = _port_socks_of(sock->local.port);
+
+        /* a saturated counter stays, the port is then just checked */
+        if ((*socks > 0) && (*socks < UINT8_MAX)) {
+            (*socks)--;
+        }
     }
 #endif
+    sock->reg.entry.target.mbox = NULL;
 }
 
 int sock_udp_get_local(sock_udp_t *sock, sock_udp_ep_t *local)
@@ -175,15 +232,14 @@ int sock_udp_get_remote(sock_udp_t *sock, sock_udp_ep_t *remote)
     return 0;
 }
 
-ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
-                      uint32_t timeout, sock_udp_ep_t *remote)
+static ssize_t _udp_recv(sock_udp_t *sock, gnrc_pktsnip_t **pkt_out,
+                         uint32_t timeout, sock_udp_ep_t *remote)
 {
     gnrc_pktsnip_t *pkt, *udp;
     udp_hdr_t *hdr;
     sock_ip_ep_t tmp;
     int res;
 
-    assert((sock != NULL) && (data != NULL) && (max_len > 0));
     if (sock->local.family == AF_UNSPEC) {
         return -EADDRNOTAVAIL;
     }
@@ -192,10 +248,6 @@ ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
     if (res < 0) {
         return res;
     }
-    if (pkt->size > max_len) {
-        gnrc_pktbuf_release(pkt);
-        return -ENOBUFS;
-    }
     udp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_UDP);
     assert(udp);
     hdr = udp->data;
@@ -214,14 +266,117 @@ ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
         gnrc_pktbuf_release(pkt);
         return -EPROTO;
     }
+    *pkt_out = pkt;
+    return (ssize_t)pkt->size;
+}
+
+ssize_t sock_udp_recv(sock_udp_t *sock, void *data, size_t max_len,
+                      uint32_t timeout, sock_udp_ep_t *remote)
+{
+    gnrc_pktsnip_t *pkt;
+    ssize_t res;
+
+    assert((sock != NULL) && (data != NULL) && (max_len > 0));
+    res = _udp_recv(sock, &pkt, timeout, remote);
+    if (res < 0) {
+        return res;
+    }
+    if ((size_t)res > max_len) {
+        gnrc_pktbuf_release(pkt);
+        return -ENOBUFS;
+    }
     memcpy(data, pkt->data, pkt->size);
-    res = (int)pkt->size;
     gnrc_pktbuf_release(pkt);
     return res;
 }
 
+ssize_t sock_udp_recv_buf(sock_udp_t *sock, void **data, void **buf_ctx,
+                          uint32_t timeout, sock_udp_ep_t *remote)
+{
+    gnrc_pktsnip_t *pkt;
+    ssize_t res;
+
+    assert((sock != NULL) && (data != NULL) && (buf_ctx != NULL));
+    if (*buf_ctx != NULL) {
+        *data = NULL;
+        gnrc_pktbuf_release(*buf_ctx);
+        *buf_ctx = NULL;
+        return 0;
+    }
+    res = _udp_recv(sock, &pkt, timeout, remote);
+    if (res < 0) {
+        return res;
+    }
+    /* payload snip is the first snip of a received packet */
+    *data = pkt->data;
+    *buf_ctx = pkt;
+    return res;
+}
+
+/* Time left of timeout, which started at start */
+static uint32_t _remaining(uint32_t timeout, uint32_t start)
+{
+#ifdef MODULE_XTIMER
+    if ((timeout != 0) && (timeout != SOCK_NO_TIMEOUT)) {
+        uint32_t spent = xtimer_now_usec() - start;
+
+        return (spent < timeout) ? (timeout - spent) : 0;
+    }
+#else
+    (void)start;
+#endif
+    return timeout;
+}
+
+int sock_udp_recv_batch(sock_udp_t *sock, sock_udp_dgram_t *dgrams,
+                        unsigned numof, uint32_t timeout)
+{
+    unsigned got = 0;
+    uint32_t start = 0;
+
+    assert((sock != NULL) && (dgrams != NULL) && (numof > 0));
+#ifdef MODULE_XTIMER
+    start = xtimer_now_usec();
+#endif
+    while (got < numof) {
+        sock_udp_dgram_t *dgram = &dgrams[got];
+        gnrc_pktsnip_t *pkt;
+        /* only wait for the first message, just drain the mailbox after.
+         * Dropped messages do not restart the timeout. */
+        ssize_t res = _udp_recv(sock, &pkt,
+                                (got == 0) ? _remaining(timeout, start) : 0,
+                                &dgram->remote);
+
+        if ((res == -EAGAIN) && (got == 0) && (timeout != 0)) {
+            /* timeout ran out while dropping messages */
+            res = -ETIMEDOUT;
+        }
+        if (res == -EPROTO) {
+            /* message was from wrong remote and is already dropped */
+            continue;
+        }
+        if (res < 0) {
+            return (got == 0) ? res : (int)got;
+        }
+        dgram->data = pkt->data;
+        dgram->len = (size_t)res;
+        dgram->buf_ctx = pkt;
+        got++;
+    }
+    return (int)got;
+}
+
 ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
                       const sock_udp_ep_t *remote)
+{
+    const iolist_t snip = { NULL, (void *)data, len };
+
+    assert((len == 0) || (data != NULL)); /* (len != 0) => (data != NULL) */
+    return sock_udp_sendv(sock, &snip, remote);
+}
+
+ssize_t sock_udp_sendv(sock_udp_t *sock, const iolist_t *snips,
+                       const sock_udp_ep_t *remote)
 {
     int res;
     gnrc_pktsnip_t *payload, *pkt;
@@ -231,7 +386,6 @@ ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
     sock_ip_ep_t *rem;
 
     assert((sock != NULL) || (remote != NULL));
-    assert((len == 0) || (data != NULL)); /* (len != 0) => (data != NULL) */
 
     if (remote != NULL) {
         if (remote->port == 0) {
@@ -274,12 +428,7 @@ ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
             else {
                 sock->local.family = remote->family;
             }
-            gnrc_sock_create(&sock->reg, GNRC_NETTYPE_UDP, src_port);
-#ifdef MODULE_GNRC_SOCK_CHECK_REUSE
-            /* prepend to current socks */
-            sock->reg.next = (gnrc_sock_reg_t *)_udp_socks;
-            _udp_socks = sock;
-#endif /* MODULE_GNRC_SOCK_CHECK_REUSE */
+            _sock_register(sock);
         }
     }
     else {
@@ -304,7 +453,7 @@ ssize_t sock_udp_send(sock_udp_t *sock, const void *data, size_t len,
         return -EINVAL;
     }
     /* generate payload and header snips */
-    payload = gnrc_pktbuf_add(NULL, (void *)data, len, GNRC_NETTYPE_UNDEF);
+    payload = gnrc_sock_pktbuf_gather(snips);
     if (payload == NULL) {
         return -ENOMEM;
     }
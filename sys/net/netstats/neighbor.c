@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @}
+ */
+
+#include <string.h>
+
+#include "net/netstats/neighbor.h"
+
+static netstats_nb_t *_find(const netstats_nb_table_t *table,
+                            const uint8_t *l2addr, unsigned l2addr_len)
+{
+    for (unsigned i = 0; i < NETSTATS_NB_SIZE; i++) {
+        const netstats_nb_t *nb = &table->entries[i];
+
+        if ((nb->l2addr_len == l2addr_len) &&
+            (memcmp(nb->l2addr, l2addr, l2addr_len) == 0)) {
+            return (netstats_nb_t *)nb;
+        }
+    }
+    return NULL;
+}
+
+void netstats_nb_init(netstats_nb_table_t *table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+void netstats_nb_record(netstats_nb_table_t *table, const uint8_t *l2addr,
+                        unsigned l2addr_len)
+{
+    netstats_nb_t *nb;
+
+    table->pending = NULL;
+    if ((l2addr == NULL) || (l2addr_len == 0) ||
+        (l2addr_len > NETSTATS_NB_L2ADDR_MAXLEN)) {
+        return;
+    }
+    if ((nb = _find(table, l2addr, l2addr_len)) == NULL) {
+        /* replace the least recently used neighbor */
+        nb = &table->entries[0];
+        for (unsigned i = 1; i < NETSTATS_NB_SIZE; i++) {
+            netstats_nb_t *tmp = &table->entries[i];
+
+            if ((nb->l2addr_len != 0) && ((tmp->l2addr_len == 0) ||
+                ((table->clock - tmp->last_used) >
+                 (table->clock - nb->last_used)))) {
+                nb = tmp;
+            }
+        }
+        memset(nb, 0, sizeof(*nb));
+        memcpy(nb->l2addr, l2addr, l2addr_len);
+        nb->l2addr_len = l2addr_len;
+        nb->etx = NETSTATS_NB_ETX_INIT;
+    }
+    nb->last_used = table->clock++;
+    table->pending = nb;
+}
+
+netstats_nb_t *netstats_nb_update_tx(netstats_nb_table_t *table,
+                                     netstats_nb_result_t result,
+                                     unsigned retries)
+{
+    netstats_nb_t *nb = table->pending;
+    uint32_t sample, alpha;
+
+    table->pending = NULL;
+    if ((nb == NULL) || (result == NETSTATS_NB_BUSY)) {
+        /* nothing was sent, so there is nothing to learn about the link */
+        return nb;
+    }
+    nb->tx_count++;
+    if (result == NETSTATS_NB_NOACK) {
+        nb->tx_failed++;
+        sample = NETSTATS_NB_ETX_NOACK;
+    }
+    else {
+        sample = (retries + 1) * NETSTATS_NB_ETX_DIVISOR;
+        if (sample > NETSTATS_NB_ETX_NOACK) {
+            sample = NETSTATS_NB_ETX_NOACK;
+        }
+    }
+    if (nb->freshness < NETSTATS_NB_FRESHNESS) {
+        alpha = NETSTATS_NB_EWMA_ALPHA_FAST;
+        nb->freshness++;
+    }
+    else {
+        alpha = NETSTATS_NB_EWMA_ALPHA;
+    }
+    nb->etx = ((nb->etx * (100U - alpha)) + (sample * alpha) + 50U) / 100U;
+    return nb;
+}
+
+bool netstats_nb_get(const netstats_nb_table_t *table, const uint8_t *l2addr,
+                     unsigned l2addr_len, netstats_nb_t *nb)
+{
+    const netstats_nb_t *tmp = _find(table, l2addr, l2addr_len);
+
+    if ((tmp == NULL) || (l2addr_len == 0)) {
+        return false;
+    }
+    memcpy(nb, tmp, sizeof(*nb));
+    return true;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup posix
+ *
+ * @{
+ * @file
+ * @brief   Vectored and positional I/O wrappers for vfs
+ * @}
+ */
+
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "vfs.h"
+
+static ssize_t _res(ssize_t res)
+{
+    if (res < 0) {
+        /* vfs returns negative error codes */
+        errno = -res;
+        return -1;
+    }
+    return res;
+}
+
+ssize_t readv(int fd, const struct iovec *iov, int iovcnt)
+{
+    return _res(vfs_readv(fd, iov, iovcnt));
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    return _res(vfs_writev(fd, iov, iovcnt));
+}
+
+ssize_t preadv(int fd, const struct iovec *iov, int iovcnt, off_t off)
+{
+    return _res(vfs_preadv(fd, iov, iovcnt, off));
+}
+
+ssize_t pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off)
+{
+    return _res(vfs_pwritev(fd, iov, iovcnt, off));
+}
+
+ssize_t pread(int fd, void *dest, size_t count, off_t off)
+{
+    struct iovec iov = { .iov_base = dest, .iov_len = count };
+
+    return _res(vfs_preadv(fd, &iov, 1, off));
+}
+
+ssize_t pwrite(int fd, const void *src, size_t count, off_t off)
+{
+    struct iovec iov = { .iov_base = (void *)src, .iov_len = count };
+
+    return _res(vfs_pwritev(fd, &iov, 1, off));
+}
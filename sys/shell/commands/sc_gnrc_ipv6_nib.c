@@ -13,6 +13,7 @@
  * @author  Martine Lenders <m.lenders@fu-berlin.de>
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 
 #include "net/gnrc/ipv6/nib.h"
@@ -23,6 +24,9 @@ static void _usage(char **argv);
 static int _nib_neigh(int argc, char **argv);
 static int _nib_prefix(int argc, char **argv);
 static int _nib_route(int argc, char **argv);
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+static int _nib_cache(int argc, char **argv);
+#endif
 
 int _gnrc_ipv6_nib(int argc, char **argv)
 {
@@ -41,6 +45,11 @@ int _gnrc_ipv6_nib(int argc, char **argv)
     else if (strcmp(argv[1], "route") == 0) {
         res = _nib_route(argc, argv);
     }
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+    else if (strcmp(argv[1], "cache") == 0) {
+        res = _nib_cache(argc, argv);
+    }
+#endif
     else {
         _usage(argv);
     }
@@ -49,7 +58,11 @@ int _gnrc_ipv6_nib(int argc, char **argv)
 
 static void _usage(char **argv)
 {
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+    printf("usage: %s {neigh|prefix|route|cache|help} ...\n", argv[0]);
+#else
     printf("usage: %s {neigh|prefix|route|help} ...\n", argv[0]);
+#endif
 }
 
 static void _usage_nib_neigh(char **argv)
@@ -78,6 +91,14 @@ static void _usage_nib_route(char **argv)
     printf("       %s %s show [iface]\n", argv[0], argv[1]);
 }
 
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+static void _usage_nib_cache(char **argv)
+{
+    printf("usage: %s %s [show|help]\n", argv[0], argv[1]);
+    printf("       %s %s show [iface]\n", argv[0], argv[1]);
+}
+#endif
+
 static inline gnrc_netif_t *_get_iface(unsigned iface)
 {
      /* To prevent integer overflow we can't use pid_is_valid() since it
@@ -282,4 +303,38 @@ static int _nib_route(int argc, char **argv)
     return 0;
 }
 
+#if GNRC_IPV6_NIB_CONF_ROUTE_CACHE
+static int _nib_cache(int argc, char **argv)
+{
+    if ((argc == 2) || (strcmp(argv[2], "show") == 0)) {
+        gnrc_ipv6_nib_rc_t entry;
+        gnrc_ipv6_nib_rc_stats_t stats;
+        void *state = NULL;
+        unsigned iface = 0U;
+
+        if (argc > 3) {
+            iface = atoi(argv[3]);
+        }
+        while (gnrc_ipv6_nib_rc_iter(iface, &state, &entry)) {
+            gnrc_ipv6_nib_rc_print(&entry);
+        }
+        gnrc_ipv6_nib_rc_get_stats(&stats);
+        printf("hits: %" PRIu32 ", misses: %" PRIu32 ", hit rate: %u%%, "
+               "generation: %" PRIu32 "\n", stats.hits, stats.misses,
+               (stats.hits + stats.misses) ?
+               (unsigned)(((uint64_t)stats.hits * 100U) /
+                          (stats.hits + stats.misses)) : 0U,
+               stats.generation);
+    }
+    else if ((argc > 2) && (strcmp(argv[2], "help") == 0)) {
+        _usage_nib_cache(argv);
+    }
+    else {
+        _usage_nib_cache(argv);
+        return 1;
+    }
+    return 0;
+}
+#endif  /* GNRC_IPV6_NIB_CONF_ROUTE_CACHE */
+
 /** @} */
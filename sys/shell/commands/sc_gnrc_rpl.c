@@ -229,6 +229,10 @@ int _stats(void)
     printf("DAO-ACK   #bytes: %10" PRIu32 " / %-10" PRIu32 "  %10" PRIu32 " / %-10" PRIu32 "\n",
            gnrc_rpl_netstats.dao_ack_rx_ucast_bytes, gnrc_rpl_netstats.dao_ack_tx_ucast_bytes,
            gnrc_rpl_netstats.dao_ack_rx_mcast_bytes, gnrc_rpl_netstats.dao_ack_tx_mcast_bytes);
+    printf("DAO TX  #targets: %10" PRIu32 "  #retries: %10" PRIu32
+           "  #unacked: %10" PRIu32 "\n",
+           gnrc_rpl_netstats.dao_tx_target_count, gnrc_rpl_netstats.dao_retx_count,
+           gnrc_rpl_netstats.dao_no_ack_count);
     return 0;
 }
 #endif
@@ -15,6 +15,8 @@
  */
 
 #include <errno.h> /* for error codes */
+#include <stdbool.h>
+#include <stdint.h> /* for SIZE_MAX */
 #include <string.h> /* for strncmp */
 #include <stddef.h> /* for NULL */
 #include <sys/types.h> /* for off_t etc */
@@ -24,6 +26,8 @@
 #include <unistd.h> /* for STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO */
 
 #include "vfs.h"
+#include "bitfield.h"
+#include "irq.h"
 #include "mutex.h"
 #include "thread.h"
 #include "kernel_types.h"
@@ -59,6 +63,32 @@ static vfs_file_t _vfs_open_files[VFS_MAX_OPEN_FILES];
  */
 static clist_node_t _vfs_mounts_list;
 
+/**
+ * @internal
+ * @brief First top level mount of the mount tree
+ *
+ * The children of a mount are the mounts whose mount point is below its own,
+ * siblings are never below each other. A mount point mounted twice is nested
+ * under its older mount, so the newest mount wins as before.
+ *
+ * Lookups walk the tree without locking, modifications are done with
+ * interrupts disabled and increment _vfs_mount_seq, so lookups that raced
+ * with a modification can retry.
+ */
+static vfs_mount_t *_vfs_mount_tree;
+
+/**
+ * @internal
+ * @brief Number of modifications of the mount tree
+ */
+static atomic_uint _vfs_mount_seq;
+
+/**
+ * @internal
+ * @brief Bitmap of the used entries in the _vfs_open_files array
+ */
+static BITFIELD(_vfs_fd_used, VFS_MAX_OPEN_FILES);
+
 /**
  * @internal
  * @brief Find an unused entry in the _vfs_open_files array and mark it as used
@@ -130,7 +160,6 @@ static inline int _find_mount(vfs_mount_t **mountpp, const char *name, const cha
 static inline int _fd_is_valid(int fd);
 
 static mutex_t _mount_mutex = MUTEX_INIT;
-static mutex_t _open_mutex = MUTEX_INIT;
 
 int vfs_close(int fd)
 {
@@ -214,14 +243,8 @@ int vfs_fstatvfs(int fd, struct statvfs *buf)
     return filp->mp->fs->fs_op->fstatvfs(filp->mp, filp, buf);
 }
 
-off_t vfs_lseek(int fd, off_t off, int whence)
+static off_t _lseek(vfs_file_t *filp, off_t off, int whence)
 {
-    DEBUG("vfs_lseek: %d, %ld, %d\n", fd, (long)off, whence);
-    int res = _fd_is_valid(fd);
-    if (res < 0) {
-        return res;
-    }
-    vfs_file_t *filp = &_vfs_open_files[fd];
     if (filp->f_op->lseek == NULL) {
         /* driver does not implement lseek() */
         /* default seek functionality is naive */
@@ -249,6 +272,16 @@ off_t vfs_lseek(int fd, off_t off, int whence)
     return filp->f_op->lseek(filp, off, whence);
 }
 
+off_t vfs_lseek(int fd, off_t off, int whence)
+{
+    DEBUG("vfs_lseek: %d, %ld, %d\n", fd, (long)off, whence);
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    return _lseek(&_vfs_open_files[fd], off, whence);
+}
+
 int vfs_open(const char *name, int flags, mode_t mode)
 {
     DEBUG("vfs_open: \"%s\", 0x%x, 0%03lo\n", name, flags, (long unsigned int)mode);
@@ -264,9 +297,7 @@ int vfs_open(const char *name, int flags, mode_t mode)
         DEBUG("vfs_open: no matching mount\n");
         return res;
     }
-    mutex_lock(&_open_mutex);
     int fd = _init_fd(VFS_ANY_FD, mountp->fs->f_op, mountp, flags, NULL);
-    mutex_unlock(&_open_mutex);
     if (fd < 0) {
         DEBUG("vfs_open: _init_fd: ERR %d!\n", fd);
         /* remember to decrement the open_files count */
@@ -333,6 +364,172 @@ ssize_t vfs_write(int fd, const void *src, size_t count)
     return filp->f_op->write(filp, src, count);
 }
 
+/* Checks a vectored read or write, returns the file or NULL and the error */
+static vfs_file_t *_check_rw(int fd, const struct iovec *iov, int iovcnt,
+                             bool is_write, int *err)
+{
+    *err = _fd_is_valid(fd);
+    if (*err < 0) {
+        return NULL;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    int mode = filp->flags & O_ACCMODE;
+    if ((mode != O_RDWR) && (mode != (is_write ? O_WRONLY : O_RDONLY))) {
+        /* File not open for reading or writing, respectively */
+        *err = -EBADF;
+        return NULL;
+    }
+    if ((is_write && (filp->f_op->write == NULL))
+        || (!is_write && (filp->f_op->read == NULL))) {
+        /* driver does not implement read() or write() */
+        *err = -EINVAL;
+        return NULL;
+    }
+    if ((iovcnt < 0) || ((iovcnt > 0) && (iov == NULL))) {
+        *err = -EINVAL;
+        return NULL;
+    }
+    /* the total length must fit the return value */
+    size_t len = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if ((iov[i].iov_base == NULL) && (iov[i].iov_len > 0)) {
+            *err = -EFAULT;
+            return NULL;
+        }
+        if (iov[i].iov_len > ((SIZE_MAX >> 1) - len)) {
+            *err = -EINVAL;
+            return NULL;
+        }
+        len += iov[i].iov_len;
+    }
+    return filp;
+}
+
+/* Reads or writes the buffers in order at the current position */
+static ssize_t _rw(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                   bool is_write)
+{
+    ssize_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len == 0) {
+            continue;
+        }
+        ssize_t res = is_write
+                    ? filp->f_op->write(filp, iov[i].iov_base, iov[i].iov_len)
+                    : filp->f_op->read(filp, iov[i].iov_base, iov[i].iov_len);
+        if (res < 0) {
+            /* report the data that was transferred already */
+            return (total > 0) ? total : res;
+        }
+        total += res;
+        if ((size_t)res < iov[i].iov_len) {
+            /* end of file or device full */
+            break;
+        }
+    }
+    return total;
+}
+
+/* Positional read or write for drivers that do not implement it */
+static ssize_t _prw(vfs_file_t *filp, const struct iovec *iov, int iovcnt,
+                    off_t off, bool is_write)
+{
+    off_t pos = _lseek(filp, 0, SEEK_CUR);
+    if (pos < 0) {
+        return pos;
+    }
+    off_t res = _lseek(filp, off, SEEK_SET);
+    if (res < 0) {
+        return res;
+    }
+    ssize_t total = _rw(filp, iov, iovcnt, is_write);
+    res = _lseek(filp, pos, SEEK_SET);
+    if ((res < 0) && (total <= 0)) {
+        return res;
+    }
+    return total;
+}
+
+ssize_t vfs_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+    DEBUG("vfs_readv: %d, %p, %d\n", fd, (void *)iov, iovcnt);
+    int res;
+    vfs_file_t *filp = _check_rw(fd, iov, iovcnt, false, &res);
+    if (filp == NULL) {
+        return res;
+    }
+    return _rw(filp, iov, iovcnt, false);
+}
+
+ssize_t vfs_writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    DEBUG_NOT_STDOUT(fd, "vfs_writev: %d, %p, %d\n", fd, (void *)iov, iovcnt);
+    int res;
+    vfs_file_t *filp = _check_rw(fd, iov, iovcnt, true, &res);
+    if (filp == NULL) {
+        return res;
+    }
+    return _rw(filp, iov, iovcnt, true);
+}
+
+ssize_t vfs_preadv(int fd, const struct iovec *iov, int iovcnt, off_t off)
+{
+    DEBUG("vfs_preadv: %d, %p, %d, %ld\n", fd, (void *)iov, iovcnt, (long)off);
+    int res;
+    vfs_file_t *filp = _check_rw(fd, iov, iovcnt, false, &res);
+    if (filp == NULL) {
+        return res;
+    }
+    if (off < 0) {
+        return -EINVAL;
+    }
+    if (filp->f_op->preadv == NULL) {
+        /* driver does not implement preadv() */
+        return _prw(filp, iov, iovcnt, off, false);
+    }
+    return filp->f_op->preadv(filp, iov, iovcnt, off);
+}
+
+ssize_t vfs_pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off)
+{
+    DEBUG("vfs_pwritev: %d, %p, %d, %ld\n", fd, (void *)iov, iovcnt, (long)off);
+    int res;
+    vfs_file_t *filp = _check_rw(fd, iov, iovcnt, true, &res);
+    if (filp == NULL) {
+        return res;
+    }
+    if (off < 0) {
+        return -EINVAL;
+    }
+    if (filp->f_op->pwritev == NULL) {
+        /* driver does not implement pwritev() */
+        return _prw(filp, iov, iovcnt, off, true);
+    }
+    return filp->f_op->pwritev(filp, iov, iovcnt, off);
+}
+
+ssize_t vfs_mmap(int fd, const void **data)
+{
+    DEBUG("vfs_mmap: %d, %p\n", fd, (void *)data);
+    if (data == NULL) {
+        return -EFAULT;
+    }
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    if ((filp->flags & O_ACCMODE) == O_WRONLY) {
+        /* File not open for reading */
+        return -EBADF;
+    }
+    if (filp->f_op->mmap == NULL) {
+        /* driver does not implement mmap() */
+        return -ENOTSUP;
+    }
+    return filp->f_op->mmap(filp, data);
+}
+
 int vfs_opendir(vfs_DIR *dirp, const char *dirname)
 {
     DEBUG("vfs_opendir: %p, \"%s\"\n", (void *)dirp, dirname);
@@ -408,6 +605,82 @@ int vfs_closedir(vfs_DIR *dirp)
     return res;
 }
 
+/* mount point of mountp is a prefix of the path name */
+static inline bool _is_prefix(const vfs_mount_t *mountp, const char *name)
+{
+    size_t len = mountp->mount_point_len;
+    if (strncmp(name, mountp->mount_point, len) != 0) {
+        return false;
+    }
+    /* special check for mount_point == "/" */
+    return (len == 1) || (name[len] == '/') || (name[len] == '\0');
+}
+
+/* Inserts a mount into the mount tree, called with _mount_mutex locked */
+static void _tree_insert(vfs_mount_t *mountp)
+{
+    vfs_mount_t *parent = NULL;
+    vfs_mount_t **level = &_vfs_mount_tree;
+    vfs_mount_t *it = *level;
+    while (it != NULL) {
+        if (_is_prefix(it, mountp->mount_point)) {
+            parent = it;
+            level = &it->child;
+            it = *level;
+        }
+        else {
+            it = it->sibling;
+        }
+    }
+    mountp->parent = parent;
+    mountp->child = NULL;
+
+    unsigned state = irq_disable();
+    /* mounts below the new mount point become its children */
+    vfs_mount_t **pos = level;
+    while (*pos != NULL) {
+        it = *pos;
+        if (_is_prefix(mountp, it->mount_point)) {
+            *pos = it->sibling;
+            it->parent = mountp;
+            it->sibling = mountp->child;
+            mountp->child = it;
+        }
+        else {
+            pos = &it->sibling;
+        }
+    }
+    mountp->sibling = *level;
+    *level = mountp;
+    atomic_fetch_add(&_vfs_mount_seq, 1);
+    irq_restore(state);
+}
+
+/* Removes a mount from the mount tree, called with interrupts disabled */
+static void _tree_remove(vfs_mount_t *mountp)
+{
+    vfs_mount_t **pos = (mountp->parent != NULL) ? &mountp->parent->child
+                                                 : &_vfs_mount_tree;
+    while (*pos != mountp) {
+        pos = &(*pos)->sibling;
+    }
+    *pos = mountp->sibling;
+    /* the children move up to the parent, the pointers of mountp stay valid
+     * for lookups that are still walking through it */
+    for (vfs_mount_t *it = mountp->child; it != NULL; it = it->sibling) {
+        it->parent = mountp->parent;
+    }
+    if (mountp->child != NULL) {
+        vfs_mount_t *last = mountp->child;
+        while (last->sibling != NULL) {
+            last = last->sibling;
+        }
+        last->sibling = *pos;
+        *pos = mountp->child;
+    }
+    atomic_fetch_add(&_vfs_mount_seq, 1);
+}
+
 /**
  * @brief Check if the given mount point is mounted
  *
@@ -481,6 +754,7 @@ int vfs_mount(vfs_mount_t *mountp)
             }
         }
     }
+    _tree_insert(mountp);
     /* insert last in list */
     clist_rpush(&_vfs_mounts_list, &mountp->list_entry);
     mutex_unlock(&_mount_mutex);
@@ -506,16 +780,23 @@ int vfs_umount(vfs_mount_t *mountp)
         return -EINVAL;
     }
     DEBUG("vfs_umount: -> \"%s\" open=%d\n", mountp->mount_point, atomic_load(&mountp->open_files));
+    /* _find_mount increments open_files before it checks _vfs_mount_seq, so
+     * either we see its file here or it sees the removal and looks again */
+    unsigned state = irq_disable();
     if (atomic_load(&mountp->open_files) > 0) {
+        irq_restore(state);
         mutex_unlock(&_mount_mutex);
         return -EBUSY;
     }
+    _tree_remove(mountp);
+    irq_restore(state);
     if (mountp->fs->fs_op != NULL) {
         if (mountp->fs->fs_op->umount != NULL) {
             int res = mountp->fs->fs_op->umount(mountp);
             if (res < 0) {
                 /* umount failed */
                 DEBUG("vfs_umount: ERR %d!\n", res);
+                _tree_insert(mountp);
                 mutex_unlock(&_mount_mutex);
                 return res;
             }
@@ -766,9 +1047,7 @@ int vfs_bind(int fd, int flags, const vfs_file_ops_t *f_op, void *private_data)
     if (f_op == NULL) {
         return -EINVAL;
     }
-    mutex_lock(&_open_mutex);
     fd = _init_fd(fd, f_op, NULL, flags, private_data);
-    mutex_unlock(&_open_mutex);
     if (fd < 0) {
         DEBUG("vfs_bind: _init_fd: ERR %d!\n", fd);
         return fd;
@@ -866,28 +1145,36 @@ const vfs_mount_t *vfs_iterate_mounts(const vfs_mount_t *cur)
 
 static inline int _allocate_fd(int fd)
 {
+    unsigned state = irq_disable();
     if (fd < 0) {
-        for (fd = 0; fd < VFS_MAX_OPEN_FILES; ++fd) {
-            if ((fd == STDIN_FILENO) || (fd == STDOUT_FILENO) || (fd == STDERR_FILENO)) {
-                /* Do not auto-allocate the stdio file descriptor numbers to
-                 * avoid conflicts between normal file system users and stdio
-                 * drivers such as stdio_uart, stdio_rtt which need to be able
-                 * to bind to these specific file descriptor numbers. */
+        /* Do not auto-allocate the stdio file descriptor numbers to avoid
+         * conflicts between normal file system users and stdio drivers such
+         * as stdio_uart, stdio_rtt which need to be able to bind to these
+         * specific file descriptor numbers. */
+        for (fd = STDERR_FILENO + 1; fd < VFS_MAX_OPEN_FILES; ++fd) {
+            if (((fd % 8) == 0) && (_vfs_fd_used[fd / 8] == 0xff)) {
+                /* skip full bytes of the bitmap */
+                fd += 7;
                 continue;
             }
-            if (_vfs_open_files[fd].pid == KERNEL_PID_UNDEF) {
+            if (!bf_isset(_vfs_fd_used, fd)) {
                 break;
             }
         }
     }
     if (fd >= VFS_MAX_OPEN_FILES) {
         /* The _vfs_open_files array is full */
+        irq_restore(state);
         return -ENFILE;
     }
-    else if (_vfs_open_files[fd].pid != KERNEL_PID_UNDEF) {
+    else if (bf_isset(_vfs_fd_used, fd)) {
         /* The desired fd is already in use */
+        irq_restore(state);
         return -EEXIST;
     }
+    bf_set(_vfs_fd_used, fd);
+    irq_restore(state);
+
     kernel_pid_t pid = thread_getpid();
     if (pid == KERNEL_PID_UNDEF) {
         /* This happens when calling vfs_bind during boot, before threads have
@@ -904,7 +1191,10 @@ static inline void _free_fd(int fd)
     if (_vfs_open_files[fd].mp != NULL) {
         atomic_fetch_sub(&_vfs_open_files[fd].mp->open_files, 1);
     }
+    unsigned state = irq_disable();
     _vfs_open_files[fd].pid = KERNEL_PID_UNDEF;
+    bf_unset(_vfs_fd_used, fd);
+    irq_restore(state);
 }
 
 static inline int _init_fd(int fd, const vfs_file_ops_t *f_op, vfs_mount_t *mountp, int flags, void *private_data)
@@ -924,53 +1214,39 @@ static inline int _init_fd(int fd, const vfs_file_ops_t *f_op, vfs_mount_t *moun
 
 static inline int _find_mount(vfs_mount_t **mountpp, const char *name, const char **rel_path)
 {
-    size_t longest_match = 0;
-    size_t name_len = strlen(name);
-    mutex_lock(&_mount_mutex);
-
-    clist_node_t *node = _vfs_mounts_list.next;
-    if (node == NULL) {
-        /* list empty */
-        mutex_unlock(&_mount_mutex);
-        return -ENOENT;
-    }
-    vfs_mount_t *mountp = NULL;
-    do {
-        node = node->next;
-        vfs_mount_t *it = container_of(node, vfs_mount_t, list_entry);
-        size_t len = it->mount_point_len;
-        if (len < longest_match) {
-            /* Already found a longer prefix */
-            continue;
+    vfs_mount_t *mountp;
+    while (1) {
+        unsigned seq = atomic_load(&_vfs_mount_seq);
+        /* descend into the mounts whose mount point is a prefix of name, the
+         * last one found has the longest prefix */
+        mountp = NULL;
+        vfs_mount_t *it = _vfs_mount_tree;
+        while (it != NULL) {
+            if (_is_prefix(it, name)) {
+                mountp = it;
+                it = it->child;
+            }
+            else {
+                it = it->sibling;
+            }
         }
-        if (len > name_len) {
-            /* path name is shorter than the mount point name */
-            continue;
+        if (mountp == NULL) {
+            /* not found */
+            return -ENOENT;
         }
-        if ((len > 1) && (name[len] != '/') && (name[len] != '\0')) {
-            /* name does not have a directory separator where mount point name ends */
-            continue;
-        }
-        if (strncmp(name, it->mount_point, len) == 0) {
-            /* mount_point is a prefix of name */
-            /* special check for mount_point == "/" */
-            if (len > 1) {
-                longest_match = len;
-            }
-            mountp = it;
+        /* Increment open files counter for this mount */
+        atomic_fetch_add(&mountp->open_files, 1);
+        if (atomic_load(&_vfs_mount_seq) == seq) {
+            break;
         }
-    } while (node != _vfs_mounts_list.next);
-    if (mountp == NULL) {
-        /* not found */
-        mutex_unlock(&_mount_mutex);
-        return -ENOENT;
+        /* the mount tree changed during the lookup, the mount might be
+         * unmounted already */
+        atomic_fetch_sub(&mountp->open_files, 1);
     }
-    /* Increment open files counter for this mount */
-    atomic_fetch_add(&mountp->open_files, 1);
-    mutex_unlock(&_mount_mutex);
     *mountpp = mountp;
     if (rel_path != NULL) {
-        *rel_path = name + longest_match;
+        /* special check for mount_point == "/" */
+        *rel_path = name + ((mountp->mount_point_len > 1) ? mountp->mount_point_len : 0);
     }
     return 0;
 }
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measure QoS 1 publishes acknowledged per second with and
+ *              without pipelining
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "byteorder.h"
+#include "net/emcute.h"
+#include "net/ipv6/addr.h"
+#include "net/mqttsn.h"
+#include "net/sock/udp.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#ifndef BROKER_DELAY
+#define BROKER_DELAY        (10000U)    /**< delay of each reply [in us] */
+#endif
+
+#ifndef PUB_NUMOF
+#define PUB_NUMOF           (100U)
+#endif
+
+#ifndef WINDOW
+#define WINDOW              (8U)        /**< QoS 1 publishes in flight */
+#endif
+
+#define TOPIC_NUMOF         (4U)
+#define EMCUTE_PORT         (1883U)
+#define BROKER_PORT         (1885U)
+#define ACKS_NUMOF          (16U)
+
+typedef struct {
+    uint32_t deadline;
+    uint8_t msg[7];
+} _ack_t;
+
+static char _emcute_stack[THREAD_STACKSIZE_DEFAULT];
+static char _broker_stack[THREAD_STACKSIZE_DEFAULT];
+
+static sock_udp_t _broker_sock;
+static sock_udp_ep_t _client;
+static _ack_t _acks[ACKS_NUMOF];
+static unsigned _acks_first, _acks_len;
+static uint16_t _topic_id_next = 1;
+
+static emcute_topic_t _topics[TOPIC_NUMOF] = {
+    { .name = "bench/0" }, { .name = "bench/1" },
+    { .name = "bench/2" }, { .name = "bench/3" },
+};
+static emcute_req_t _reqs[WINDOW];
+static const char _payload[] = "0123456789abcdef";
+
+static void *_emcute(void *arg)
+{
+    (void)arg;
+    emcute_run(EMCUTE_PORT, "bench");
+    return NULL;    /* should never be reached */
+}
+
+static void _reply_later(uint8_t type, const uint8_t *ids, size_t ids_len)
+{
+    _ack_t *ack;
+
+    if (_acks_len == ACKS_NUMOF) {
+        return;     /* emCute will retransmit */
+    }
+    ack = &_acks[(_acks_first + _acks_len++) % ACKS_NUMOF];
+    ack->deadline = xtimer_now_usec() + BROKER_DELAY;
+    ack->msg[0] = ids_len + 3;
+    ack->msg[1] = type;
+    memcpy(&ack->msg[2], ids, ids_len);
+    ack->msg[ids_len + 2] = MQTTSN_ACCEPTED;
+}
+
+static void _handle(const uint8_t *buf, size_t len)
+{
+    uint8_t ids[4];
+
+    if ((buf[0] == 0x01) || (buf[0] != len)) {
+        return;     /* the stand-in only knows short messages */
+    }
+    switch (buf[1]) {
+        case MQTTSN_CONNECT:
+            _reply_later(MQTTSN_CONNACK, NULL, 0);
+            break;
+        case MQTTSN_REGISTER:
+            byteorder_htobebufs(&ids[0], _topic_id_next++);
+            memcpy(&ids[2], &buf[4], 2);
+            _reply_later(MQTTSN_REGACK, ids, sizeof(ids));
+            break;
+        case MQTTSN_PUBLISH:
+            if (buf[2] & EMCUTE_QOS_1) {
+                _reply_later(MQTTSN_PUBACK, &buf[3], sizeof(ids));
+            }
+            break;
+        case MQTTSN_DISCONNECT:
+            sock_udp_send(&_broker_sock, buf, 2, &_client);
+            break;
+        default:
+            break;
+    }
+}
+
+static void *_broker(void *arg)
+{
+    sock_udp_ep_t local = { .family = AF_INET6, .port = BROKER_PORT };
+    uint8_t buf[64];
+
+    (void)arg;
+    sock_udp_create(&_broker_sock, &local, NULL, 0);
+    while (1) {
+        uint32_t timeout = SOCK_NO_TIMEOUT;
+        ssize_t res;
+
+        if (_acks_len > 0) {
+            _ack_t *ack = &_acks[_acks_first];
+            int32_t left = (int32_t)(ack->deadline - xtimer_now_usec());
+
+            if (left <= 0) {
+                sock_udp_send(&_broker_sock, ack->msg, ack->msg[0], &_client);
+                _acks_first = (_acks_first + 1) % ACKS_NUMOF;
+                _acks_len--;
+                continue;
+            }
+            timeout = (uint32_t)left;
+        }
+        res = sock_udp_recv(&_broker_sock, buf, sizeof(buf), timeout, &_client);
+        if (res >= 2) {
+            _handle(buf, res);
+        }
+    }
+    return NULL;
+}
+
+static int _register(void)
+{
+    for (unsigned i = 0; i < TOPIC_NUMOF; i++) {
+        if (emcute_reg_start(&_reqs[i], &_topics[i]) != EMCUTE_OK) {
+            return -1;
+        }
+    }
+    for (unsigned i = 0; i < TOPIC_NUMOF; i++) {
+        if ((emcute_req_wait(&_reqs[i]) != EMCUTE_OK) ||
+            (_topics[i].id == 0)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static uint32_t _rate(uint32_t start)
+{
+    uint32_t duration = xtimer_now_usec() - start;
+
+    return (uint32_t)(((uint64_t)PUB_NUMOF * US_PER_SEC) / duration);
+}
+
+static int _pub_sequential(uint32_t *rate)
+{
+    uint32_t start = xtimer_now_usec();
+
+    for (unsigned i = 0; i < PUB_NUMOF; i++) {
+        if (emcute_pub(&_topics[i % TOPIC_NUMOF], _payload, sizeof(_payload),
+                       EMCUTE_QOS_1) != EMCUTE_OK) {
+            return -1;
+        }
+    }
+    *rate = _rate(start);
+    return 0;
+}
+
+static int _pub_pipelined(uint32_t *rate)
+{
+    uint32_t start = xtimer_now_usec();
+    int res = 0;
+
+    for (unsigned i = 0; i < (PUB_NUMOF + WINDOW); i++) {
+        emcute_req_t *req = &_reqs[i % WINDOW];
+
+        /* the slot is free once the oldest request in flight completed */
+        if ((i >= WINDOW) && (emcute_req_wait(req) != EMCUTE_OK)) {
+            res = -1;
+        }
+        if ((i < PUB_NUMOF) &&
+            (emcute_pub_start(req, &_topics[i % TOPIC_NUMOF], _payload,
+                              sizeof(_payload), EMCUTE_QOS_1) != EMCUTE_OK)) {
+            return -1;
+        }
+    }
+    *rate = _rate(start);
+    return res;
+}
+
+int main(void)
+{
+    sock_udp_ep_t gw = { .family = AF_INET6, .port = BROKER_PORT };
+    uint32_t sequential, pipelined;
+
+    ipv6_addr_set_loopback((ipv6_addr_t *)&gw.addr.ipv6);
+    thread_create(_broker_stack, sizeof(_broker_stack),
+                  THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+                  _broker, NULL, "broker");
+    thread_create(_emcute_stack, sizeof(_emcute_stack),
+                  THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+                  _emcute, NULL, "emcute");
+
+    if (emcute_con(&gw, true, NULL, NULL, 0, 0) != EMCUTE_OK) {
+        puts("error: unable to connect to broker stand-in");
+        return 1;
+    }
+    if (_register() < 0) {
+        puts("error: unable to register topics");
+        return 1;
+    }
+    if (_pub_sequential(&sequential) < 0) {
+        puts("error: sequential publish failed");
+        return 1;
+    }
+    printf("{ \"sequential\" : %" PRIu32 " }\n", sequential);
+    if (_pub_pipelined(&pipelined) < 0) {
+        puts("error: pipelined publish failed");
+        return 1;
+    }
+    printf("{ \"pipelined\" : %" PRIu32 " }\n", pipelined);
+    emcute_discon();
+
+    puts((pipelined > sequential) ? "SUCCESS" : "FAILURE");
+    return 0;
+}
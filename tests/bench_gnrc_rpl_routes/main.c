@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compare RAM and look-up time of downward RPL routes in the
+ *              NIB's forwarding table and in the gnrc_rpl_routes store
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "byteorder.h"
+#include "net/gnrc/ipv6/nib/ft.h"
+#include "net/gnrc/rpl/routes.h"
+#include "net/gnrc/rpl/srh.h"
+#include "xtimer.h"
+
+#include "_nib-internal.h"
+
+#ifndef NODES
+#define NODES               (64U)
+#endif
+
+#ifndef ROUNDS
+#define ROUNDS              (100U)
+#endif
+
+#define IFACE               (7U)
+#define LTIME               (300U)
+#define SRH_BUF_SIZE        (sizeof(gnrc_rpl_srh_t) + (16 * sizeof(ipv6_addr_t)))
+
+static uint8_t _srh_buf[SRH_BUF_SIZE];
+
+/* node 0 is the root, node i the child of node (i - 1) / 2 */
+static void _addr(ipv6_addr_t *addr, unsigned node)
+{
+    ipv6_addr_from_str(addr, "2001:db8::");
+    addr->u16[7] = byteorder_htons(node + 1);
+}
+
+/* storing mode: the next hop is the link-local address of the child of the
+ * root the node is below of */
+static void _next_hop(ipv6_addr_t *addr, unsigned node)
+{
+    while (node > 2) {
+        node = (node - 1) / 2;
+    }
+    ipv6_addr_from_str(addr, "fe80::");
+    addr->u16[7] = byteorder_htons(node);
+}
+
+static unsigned _depth(unsigned node)
+{
+    unsigned depth = 0;
+
+    while (node > 0) {
+        node = (node - 1) / 2;
+        depth++;
+    }
+    return depth;
+}
+
+static uint32_t _per_op_ns(uint32_t start)
+{
+    uint32_t duration = xtimer_now_usec() - start;
+
+    return (uint32_t)(((uint64_t)duration * NS_PER_US) / (ROUNDS * NODES));
+}
+
+static int _bench_nib(size_t *bytes, uint32_t *lookup_ns)
+{
+    gnrc_ipv6_nib_ft_t fte;
+    ipv6_addr_t dst, next_hop;
+    uint32_t start;
+
+    for (unsigned i = 1; i <= NODES; i++) {
+        _addr(&dst, i);
+        _next_hop(&next_hop, i);
+        if (gnrc_ipv6_nib_ft_add(&dst, IPV6_ADDR_BIT_LEN, &next_hop, IFACE,
+                                 0) < 0) {
+            return -1;
+        }
+    }
+    start = xtimer_now_usec();
+    for (unsigned r = 0; r < ROUNDS; r++) {
+        for (unsigned i = 1; i <= NODES; i++) {
+            _addr(&dst, i);
+            if (gnrc_ipv6_nib_ft_get(&dst, NULL, &fte) < 0) {
+                return -1;
+            }
+        }
+    }
+    *lookup_ns = _per_op_ns(start);
+    /* the forwarding table plus the entries of the two next hops */
+    *bytes = (GNRC_IPV6_NIB_OFFL_NUMOF * sizeof(_nib_offl_entry_t)) +
+             (2 * sizeof(_nib_onl_entry_t));
+    for (unsigned i = 1; i <= NODES; i++) {
+        _addr(&dst, i);
+        gnrc_ipv6_nib_ft_del(&dst, IPV6_ADDR_BIT_LEN);
+    }
+    return 0;
+}
+
+static int _bench_routes(size_t *bytes, uint32_t *lookup_ns)
+{
+    gnrc_rpl_routes_stats_t stats;
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst, next_hop;
+    uint32_t start;
+
+    gnrc_rpl_routes_init();
+    for (unsigned i = 1; i <= NODES; i++) {
+        _addr(&dst, i);
+        _next_hop(&next_hop, i);
+        if (gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN, &next_hop, IFACE,
+                                GNRC_RPL_ROUTES_STORING, LTIME) < 0) {
+            return -1;
+        }
+    }
+    start = xtimer_now_usec();
+    for (unsigned r = 0; r < ROUNDS; r++) {
+        for (unsigned i = 1; i <= NODES; i++) {
+            _addr(&dst, i);
+            if (gnrc_rpl_routes_get(&dst, &route) < 0) {
+                return -1;
+            }
+        }
+    }
+    *lookup_ns = _per_op_ns(start);
+    gnrc_rpl_routes_get_stats(&stats);
+    *bytes = stats.size;
+    return 0;
+}
+
+static int _bench_srh(unsigned *depth, uint32_t *build_ns)
+{
+    ipv6_addr_t root, dst, parent, first_hop;
+    uint32_t start;
+
+    gnrc_rpl_routes_init();
+    _addr(&root, 0);
+    for (unsigned i = 1; i <= NODES; i++) {
+        _addr(&dst, i);
+        _addr(&parent, (i - 1) / 2);
+        if (gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN, &parent, IFACE,
+                                GNRC_RPL_ROUTES_NON_STORING, LTIME) < 0) {
+            return -1;
+        }
+    }
+    start = xtimer_now_usec();
+    for (unsigned r = 0; r < ROUNDS; r++) {
+        for (unsigned i = 1; i <= NODES; i++) {
+            _addr(&dst, i);
+            if (gnrc_rpl_srh_build(&root, &dst, &first_hop,
+                                   (gnrc_rpl_srh_t *)_srh_buf,
+                                   sizeof(_srh_buf)) < 0) {
+                return -1;
+            }
+        }
+    }
+    *build_ns = _per_op_ns(start);
+    *depth = _depth(NODES);
+    return 0;
+}
+
+int main(void)
+{
+    size_t nib_bytes, routes_bytes;
+    uint32_t nib_ns, routes_ns, srh_ns;
+    unsigned depth;
+
+    /* the NIB consults the store first, so measure it while the store is
+     * empty */
+    gnrc_rpl_routes_init();
+    if (_bench_nib(&nib_bytes, &nib_ns) < 0) {
+        puts("error: unable to fill forwarding table");
+        return 1;
+    }
+    printf("{ \"nib\" : { \"bytes\" : %u, \"lookup_ns\" : %" PRIu32 " } }\n",
+           (unsigned)nib_bytes, nib_ns);
+    if (_bench_routes(&routes_bytes, &routes_ns) < 0) {
+        puts("error: unable to fill route store");
+        return 1;
+    }
+    printf("{ \"routes\" : { \"bytes\" : %u, \"lookup_ns\" : %" PRIu32 " } }\n",
+           (unsigned)routes_bytes, routes_ns);
+    if (_bench_srh(&depth, &srh_ns) < 0) {
+        puts("error: unable to build source routing header");
+        return 1;
+    }
+    printf("{ \"srh\" : { \"depth\" : %u, \"build_ns\" : %" PRIu32 " } }\n",
+           depth, srh_ns);
+
+    puts(((routes_bytes < nib_bytes) && (routes_ns < nib_ns)) ?
+         "SUCCESS" : "FAILURE");
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Size and access time of compressed files compared to plain
+ *              files on littlefs
+ *
+ * @}
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "fs/littlefs_fs.h"
+#include "hsfile.h"
+#include "vfs.h"
+#include "xtimer.h"
+
+#ifndef MTD_0
+#error "the board does not provide MTD_0"
+#endif
+#ifndef TEST_HSFILE_SECTORS
+#error "TEST_HSFILE_SECTORS not defined"
+#endif
+#ifndef TEST_HSFILE_SIZE
+#error "TEST_HSFILE_SIZE not defined"
+#endif
+#ifndef TEST_HSFILE_READS
+#error "TEST_HSFILE_READS not defined"
+#endif
+
+#define FILE_NAME   "/bench/data"
+#define LINE_SIZE   (32U)
+#define BLOCK_SIZE  (64U)
+#define READ_SIZE   (16U)
+
+static littlefs_desc_t _lfs = {
+    .base_addr = 0,
+    .config = { .block_count = TEST_HSFILE_SECTORS },
+};
+
+static vfs_mount_t _mount = {
+    .fs = &littlefs_file_system,
+    .mount_point = "/bench",
+    .private_data = &_lfs,
+};
+
+static hsfile_t _hsfile;
+static uint8_t _block[BLOCK_SIZE];
+static uint8_t _buf[BLOCK_SIZE];
+static uint32_t _seed;
+
+/* Log lines of a sensor, i.e. typical compressible data */
+static void _fill(uint8_t *buf, uint32_t off, size_t len)
+{
+    char line[LINE_SIZE + 1];
+    uint32_t num = UINT32_MAX;
+
+    for (size_t i = 0; i < len; i++, off++) {
+        if (off / LINE_SIZE != num) {
+            num = off / LINE_SIZE;
+            snprintf(line, sizeof(line), "id=%06u temp=21.%u hum=45.%u ok\n",
+                     (unsigned)(num % 1000000), (unsigned)(num % 10),
+                     (unsigned)((num / 10) % 10));
+        }
+        buf[i] = line[off % LINE_SIZE];
+    }
+}
+
+static uint32_t _rand(void)
+{
+    _seed = _seed * 1103515245 + 12345;
+    return _seed >> 8;
+}
+
+static void _print(const char *op, const char *file, uint32_t start)
+{
+    printf("{ \"%s\" : { \"file\" : \"%s\", \"us\" : %" PRIu32 " } }\n",
+           op, file, xtimer_now_usec() - start);
+}
+
+/* both files are used through VFS file descriptors */
+static int _open(bool compressed, int flags)
+{
+    if (compressed) {
+        return hsfile_vfs_open(&_hsfile, FILE_NAME, flags, 0);
+    }
+    return vfs_open(FILE_NAME, flags, 0);
+}
+
+static int _bench_write(const char *name, bool compressed)
+{
+    int fd = _open(compressed, O_CREAT | O_WRONLY | O_TRUNC);
+    if (fd < 0) {
+        printf("error: open failed: %d\n", fd);
+        return fd;
+    }
+
+    int res = 0;
+    uint32_t start = xtimer_now_usec();
+    for (uint32_t off = 0; off < TEST_HSFILE_SIZE; off += BLOCK_SIZE) {
+        size_t len = TEST_HSFILE_SIZE - off;
+        if (len > BLOCK_SIZE) {
+            len = BLOCK_SIZE;
+        }
+        _fill(_block, off, len);
+        res = vfs_write(fd, _block, len);
+        if (res != (int)len) {
+            printf("error: write failed: %d\n", res);
+            res = -1;
+            break;
+        }
+    }
+    int cres = vfs_close(fd);
+    if ((res < 0) || (cres < 0)) {
+        printf("error: close failed: %d\n", cres);
+        return -1;
+    }
+    _print("write", name, start);
+
+    struct stat st;
+    res = vfs_stat(FILE_NAME, &st);
+    if (res < 0) {
+        printf("error: stat failed: %d\n", res);
+        return res;
+    }
+    printf("{ \"size\" : { \"file\" : \"%s\", \"bytes\" : %u, "
+           "\"stored\" : %u } }\n", name, (unsigned)TEST_HSFILE_SIZE,
+           (unsigned)st.st_size);
+    return 0;
+}
+
+static int _bench_read(const char *name, bool compressed)
+{
+    int fd = _open(compressed, O_RDONLY);
+    if (fd < 0) {
+        printf("error: open failed: %d\n", fd);
+        return fd;
+    }
+
+    int res = 0;
+    uint32_t off = 0;
+    uint32_t start = xtimer_now_usec();
+    while ((res = vfs_read(fd, _buf, sizeof(_buf))) > 0) {
+        _fill(_block, off, res);
+        if (memcmp(_buf, _block, res)) {
+            puts("error: data mismatch");
+            res = -1;
+            break;
+        }
+        off += res;
+    }
+    if ((res == 0) && (off != TEST_HSFILE_SIZE)) {
+        puts("error: file too short");
+        res = -1;
+    }
+    if (res == 0) {
+        _print("read", name, start);
+    }
+
+    _seed = 1;
+    start = xtimer_now_usec();
+    for (unsigned i = 0; (res == 0) && (i < TEST_HSFILE_READS); i++) {
+        off = _rand() % (TEST_HSFILE_SIZE - READ_SIZE);
+        if ((vfs_lseek(fd, off, SEEK_SET) != (off_t)off)
+            || (vfs_read(fd, _buf, READ_SIZE) != (ssize_t)READ_SIZE)) {
+            puts("error: random read failed");
+            res = -1;
+            break;
+        }
+        _fill(_block, off, READ_SIZE);
+        if (memcmp(_buf, _block, READ_SIZE)) {
+            puts("error: data mismatch");
+            res = -1;
+        }
+    }
+    if (res == 0) {
+        _print("seek", name, start);
+    }
+
+    vfs_close(fd);
+    return res;
+}
+
+static int _bench(const char *name, bool compressed)
+{
+    int res = vfs_format(&_mount);
+    if (res == 0) {
+        res = vfs_mount(&_mount);
+    }
+    if (res < 0) {
+        printf("error: format failed: %d\n", res);
+        return res;
+    }
+
+    res = _bench_write(name, compressed);
+    if (res == 0) {
+        res = _bench_read(name, compressed);
+    }
+    vfs_umount(&_mount);
+    return res;
+}
+
+int main(void)
+{
+    _lfs.dev = MTD_0;
+
+    printf("%u bytes in chunks of %u bytes, %u random reads of %u bytes\n",
+           (unsigned)TEST_HSFILE_SIZE, (unsigned)HSFILE_CHUNK_SIZE,
+           (unsigned)TEST_HSFILE_READS, READ_SIZE);
+
+    int res  = _bench("plain", false);
+    res |= _bench("hsfile", true);
+
+    puts((res == 0) ? "SUCCESS" : "FAILURE");
+    return 0;
+}
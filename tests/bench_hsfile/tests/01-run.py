@@ -0,0 +1,26 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2019 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    for name in ("plain", "hsfile"):
+        child.expect(r"{ \"write\" : { \"file\" : \"%s\", \"us\" : \d+ } }"
+                     % name)
+        child.expect(r"{ \"size\" : { \"file\" : \"%s\", \"bytes\" : \d+, "
+                     r"\"stored\" : \d+ } }" % name)
+        for op in ("read", "seek"):
+            child.expect(r"{ \"%s\" : { \"file\" : \"%s\", \"us\" : \d+ } }"
+                         % (op, name))
+    child.expect_exact("SUCCESS")
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Latency of the MTD key-value store compared to littlefs files
+ *
+ * @}
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "board.h"
+#include "fs/littlefs_fs.h"
+#include "mtd_kv.h"
+#include "vfs.h"
+#include "xtimer.h"
+
+#ifndef MTD_0
+#error "the board does not provide MTD_0"
+#endif
+#ifndef TEST_MTD_KV_SECTORS
+#error "TEST_MTD_KV_SECTORS not defined"
+#endif
+#ifndef TEST_MTD_KV_KEYS
+#error "TEST_MTD_KV_KEYS not defined"
+#endif
+#ifndef TEST_MTD_KV_ROUNDS
+#error "TEST_MTD_KV_ROUNDS not defined"
+#endif
+
+#define VALUE_SIZE  (16U)
+#define OPS         (TEST_MTD_KV_KEYS * TEST_MTD_KV_ROUNDS)
+
+static mtd_kv_t _kv = {
+    .sector = 0,
+    .sector_count = TEST_MTD_KV_SECTORS,
+};
+
+static littlefs_desc_t _lfs = {
+    .base_addr = 0,
+    .config = { .block_count = TEST_MTD_KV_SECTORS },
+};
+
+static vfs_mount_t _mount = {
+    .fs = &littlefs_file_system,
+    .mount_point = "/bench",
+    .private_data = &_lfs,
+};
+
+static uint8_t _value[VALUE_SIZE];
+static uint8_t _buf[VALUE_SIZE];
+
+static void _fill(unsigned key, unsigned round)
+{
+    for (unsigned i = 0; i < VALUE_SIZE; i++) {
+        _value[i] = (uint8_t)(key * 31 + round + i);
+    }
+}
+
+static void _print(const char *op, const char *store, unsigned ops,
+                   uint32_t start)
+{
+    printf("{ \"%s\" : { \"store\" : \"%s\", \"ops\" : %u, \"us\" : %" PRIu32
+           " } }\n", op, store, ops, xtimer_now_usec() - start);
+}
+
+static int _check(void)
+{
+    _fill(TEST_MTD_KV_KEYS - 1, TEST_MTD_KV_ROUNDS - 1);
+    if (memcmp(_buf, _value, sizeof(_buf))) {
+        puts("error: data mismatch");
+        return -1;
+    }
+    return 0;
+}
+
+static int _bench_kv(void)
+{
+    char key[8];
+    int res = mtd_kv_format(&_kv);
+    if (res < 0) {
+        printf("error: format failed: %d\n", res);
+        return res;
+    }
+
+    uint32_t start = xtimer_now_usec();
+    for (unsigned round = 0; round < TEST_MTD_KV_ROUNDS; round++) {
+        for (unsigned i = 0; i < TEST_MTD_KV_KEYS; i++) {
+            snprintf(key, sizeof(key), "key%02u", i);
+            _fill(i, round);
+            res = mtd_kv_put(&_kv, key, _value, sizeof(_value));
+            if (res < 0) {
+                printf("error: put failed: %d\n", res);
+                return res;
+            }
+        }
+    }
+    _print("put", "mtd_kv", OPS, start);
+
+    start = xtimer_now_usec();
+    for (unsigned round = 0; round < TEST_MTD_KV_ROUNDS; round++) {
+        for (unsigned i = 0; i < TEST_MTD_KV_KEYS; i++) {
+            snprintf(key, sizeof(key), "key%02u", i);
+            res = mtd_kv_get(&_kv, key, _buf, sizeof(_buf));
+            if (res != (int)sizeof(_buf)) {
+                printf("error: get failed: %d\n", res);
+                return -1;
+            }
+        }
+    }
+    _print("get", "mtd_kv", OPS, start);
+
+    start = xtimer_now_usec();
+    res = mtd_kv_init(&_kv);
+    if (res < 0) {
+        printf("error: init failed: %d\n", res);
+        return res;
+    }
+    _print("open", "mtd_kv", 1, start);
+
+    return _check();
+}
+
+static int _bench_littlefs(void)
+{
+    char path[16];
+    int fd;
+    int res = vfs_format(&_mount);
+    if (res == 0) {
+        res = vfs_mount(&_mount);
+    }
+    if (res < 0) {
+        printf("error: format failed: %d\n", res);
+        return res;
+    }
+
+    uint32_t start = xtimer_now_usec();
+    for (unsigned round = 0; round < TEST_MTD_KV_ROUNDS; round++) {
+        for (unsigned i = 0; i < TEST_MTD_KV_KEYS; i++) {
+            snprintf(path, sizeof(path), "/bench/key%02u", i);
+            _fill(i, round);
+            fd = vfs_open(path, O_CREAT | O_WRONLY | O_TRUNC, 0);
+            if (fd < 0) {
+                printf("error: open failed: %d\n", fd);
+                res = fd;
+                goto out;
+            }
+            res = vfs_write(fd, _value, sizeof(_value));
+            if (res < 0) {
+                printf("error: write failed: %d\n", res);
+                vfs_close(fd);
+                goto out;
+            }
+            res = vfs_close(fd);
+            if (res < 0) {
+                printf("error: close failed: %d\n", res);
+                goto out;
+            }
+        }
+    }
+    _print("put", "littlefs", OPS, start);
+
+    start = xtimer_now_usec();
+    for (unsigned round = 0; round < TEST_MTD_KV_ROUNDS; round++) {
+        for (unsigned i = 0; i < TEST_MTD_KV_KEYS; i++) {
+            snprintf(path, sizeof(path), "/bench/key%02u", i);
+            fd = vfs_open(path, O_RDONLY, 0);
+            if (fd < 0) {
+                printf("error: open failed: %d\n", fd);
+                res = fd;
+                goto out;
+            }
+            res = vfs_read(fd, _buf, sizeof(_buf));
+            vfs_close(fd);
+            if (res != (int)sizeof(_buf)) {
+                printf("error: read failed: %d\n", res);
+                res = -1;
+                goto out;
+            }
+        }
+    }
+    _print("get", "littlefs", OPS, start);
+
+    vfs_umount(&_mount);
+    start = xtimer_now_usec();
+    res = vfs_mount(&_mount);
+    if (res < 0) {
+        printf("error: mount failed: %d\n", res);
+        return res;
+    }
+    _print("open", "littlefs", 1, start);
+    res = _check();
+
+out:
+    vfs_umount(&_mount);
+    return (res < 0) ? res : 0;
+}
+
+int main(void)
+{
+    _kv.mtd = MTD_0;
+    _lfs.dev = MTD_0;
+
+    int res = mtd_kv_init(&_kv);
+    if (res < 0) {
+        printf("error: init failed: %d\n", res);
+        return 1;
+    }
+    printf("%u sectors of %" PRIu32 " bytes, page size %" PRIu32 "\n",
+           (unsigned)TEST_MTD_KV_SECTORS,
+           _kv.mtd->pages_per_sector * _kv.mtd->page_size,
+           _kv.mtd->page_size);
+
+    res  = _bench_kv();
+    res |= _bench_littlefs();
+
+    puts((res == 0) ? "SUCCESS" : "FAILURE");
+    return 0;
+}
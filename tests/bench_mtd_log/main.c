@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Append rate of the MTD record log compared to littlefs
+ *
+ * @}
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "fs/littlefs_fs.h"
+#include "mtd_log.h"
+#include "vfs.h"
+#include "xtimer.h"
+
+#ifndef MTD_0
+#error "the board does not provide MTD_0"
+#endif
+#ifndef TEST_MTD_LOG_SECTORS
+#error "TEST_MTD_LOG_SECTORS not defined"
+#endif
+#ifndef TEST_MTD_LOG_RECORDS
+#error "TEST_MTD_LOG_RECORDS not defined"
+#endif
+#ifndef TEST_MTD_LOG_RECORD_SIZE
+#error "TEST_MTD_LOG_RECORD_SIZE not defined"
+#endif
+
+#define FILE_NAME   "/bench/log"
+
+static mtd_log_t _log = {
+    .sector = 0,
+    .sector_count = TEST_MTD_LOG_SECTORS,
+};
+
+static littlefs_desc_t _lfs = {
+    .base_addr = 0,
+    .config = { .block_count = TEST_MTD_LOG_SECTORS },
+};
+
+static vfs_mount_t _mount = {
+    .fs = &littlefs_file_system,
+    .mount_point = "/bench",
+    .private_data = &_lfs,
+};
+
+static uint8_t _record[TEST_MTD_LOG_RECORD_SIZE];
+static uint8_t _buf[TEST_MTD_LOG_RECORD_SIZE];
+
+static void _fill(uint8_t *buf, uint32_t num)
+{
+    for (unsigned i = 0; i < TEST_MTD_LOG_RECORD_SIZE; i++) {
+        buf[i] = (uint8_t)(num + i);
+    }
+}
+
+static void _print(const char *store, const char *mode, uint32_t start)
+{
+    uint32_t us = xtimer_now_usec() - start;
+    uint32_t per_s = (uint64_t)TEST_MTD_LOG_RECORDS * US_PER_SEC
+                     / ((us > 0) ? us : 1);
+
+    printf("{ \"append\" : { \"store\" : \"%s\", \"mode\" : \"%s\", "
+           "\"records\" : %u, \"us\" : %" PRIu32 ", \"per_s\" : %" PRIu32
+           " } }\n", store, mode, (unsigned)TEST_MTD_LOG_RECORDS, us, per_s);
+}
+
+static int _check_last(void)
+{
+    _fill(_record, TEST_MTD_LOG_RECORDS - 1);
+    if (memcmp(_buf, _record, sizeof(_buf))) {
+        puts("error: data mismatch");
+        return -1;
+    }
+    return 0;
+}
+
+static int _bench_log(const char *mode, bool durable)
+{
+    int res = mtd_log_format(&_log);
+    if (res < 0) {
+        printf("error: format failed: %d\n", res);
+        return res;
+    }
+
+    uint32_t start = xtimer_now_usec();
+    for (uint32_t i = 0; i < TEST_MTD_LOG_RECORDS; i++) {
+        _fill(_record, i);
+        res = mtd_log_append(&_log, _record, sizeof(_record));
+        if ((res == 0) && durable) {
+            res = mtd_log_flush(&_log);
+        }
+        if (res < 0) {
+            printf("error: append failed: %d\n", res);
+            return res;
+        }
+    }
+    res = mtd_log_flush(&_log);
+    if (res < 0) {
+        printf("error: flush failed: %d\n", res);
+        return res;
+    }
+    _print("mtd_log", mode, start);
+
+    /* old records might have been dropped, the newest one must be there */
+    mtd_log_cursor_t cur;
+    mtd_log_cursor_init(&_log, &cur);
+    while ((res = mtd_log_read(&_log, &cur, _buf, sizeof(_buf))) > 0) {}
+    if (res < 0) {
+        printf("error: read failed: %d\n", res);
+        return res;
+    }
+    return _check_last();
+}
+
+static int _bench_littlefs(const char *mode, bool durable)
+{
+    int res = vfs_format(&_mount);
+    if (res == 0) {
+        res = vfs_mount(&_mount);
+    }
+    if (res < 0) {
+        printf("error: format failed: %d\n", res);
+        return res;
+    }
+
+    int fd = -1;
+    uint32_t start = xtimer_now_usec();
+    for (uint32_t i = 0; i < TEST_MTD_LOG_RECORDS; i++) {
+        if (fd < 0) {
+            fd = vfs_open(FILE_NAME, O_CREAT | O_WRONLY | O_APPEND, 0);
+            if (fd < 0) {
+                printf("error: open failed: %d\n", fd);
+                res = fd;
+                break;
+            }
+        }
+        _fill(_record, i);
+        res = vfs_write(fd, _record, sizeof(_record));
+        if (res < 0) {
+            printf("error: write failed: %d\n", res);
+            break;
+        }
+        if (durable || (i == (TEST_MTD_LOG_RECORDS - 1))) {
+            res = vfs_close(fd);
+            fd = -1;
+            if (res < 0) {
+                printf("error: close failed: %d\n", res);
+                break;
+            }
+        }
+    }
+    if (fd >= 0) {
+        vfs_close(fd);
+    }
+    if (res >= 0) {
+        _print("littlefs", mode, start);
+
+        fd = vfs_open(FILE_NAME, O_RDONLY, 0);
+        if ((fd < 0)
+            || (vfs_lseek(fd, -(off_t)sizeof(_buf), SEEK_END) < 0)
+            || (vfs_read(fd, _buf, sizeof(_buf)) != (ssize_t)sizeof(_buf))) {
+            puts("error: read failed");
+            res = -1;
+        }
+        else {
+            res = _check_last();
+        }
+        if (fd >= 0) {
+            vfs_close(fd);
+        }
+    }
+    vfs_umount(&_mount);
+    return res;
+}
+
+int main(void)
+{
+    _log.mtd = MTD_0;
+    _lfs.dev = MTD_0;
+
+    int res = mtd_log_init(&_log);
+    if (res < 0) {
+        printf("error: init failed: %d\n", res);
+        return 1;
+    }
+    printf("%u sectors of %" PRIu32 " bytes, page size %" PRIu32 "\n",
+           (unsigned)TEST_MTD_LOG_SECTORS,
+           _log.mtd->pages_per_sector * _log.mtd->page_size,
+           _log.mtd->page_size);
+
+    res  = _bench_log("buffered", false);
+    res |= _bench_log("durable", true);
+    res |= _bench_littlefs("buffered", false);
+    res |= _bench_littlefs("durable", true);
+
+    puts((res == 0) ? "SUCCESS" : "FAILURE");
+    return 0;
+}
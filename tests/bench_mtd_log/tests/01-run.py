@@ -0,0 +1,23 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2019 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    for store in ("mtd_log", "littlefs"):
+        for mode in ("buffered", "durable"):
+            child.expect(r"{ \"append\" : { \"store\" : \"%s\", "
+                         r"\"mode\" : \"%s\", \"records\" : \d+, "
+                         r"\"us\" : \d+, \"per_s\" : \d+ } }" % (store, mode))
+    child.expect_exact("SUCCESS")
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
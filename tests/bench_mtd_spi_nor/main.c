@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Throughput benchmark for serial NOR flash
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mtd_spi_nor.h"
+#include "xtimer.h"
+
+#ifndef TEST_MTD_SPI_NOR_DEV
+#error "TEST_MTD_SPI_NOR_DEV not defined"
+#endif
+#ifndef TEST_MTD_SPI_NOR_CS
+#error "TEST_MTD_SPI_NOR_CS not defined"
+#endif
+#ifndef TEST_MTD_SPI_NOR_SIZE
+#error "TEST_MTD_SPI_NOR_SIZE not defined"
+#endif
+#ifndef TEST_MTD_SPI_NOR_MODE
+#define TEST_MTD_SPI_NOR_MODE   (SPI_MODE_0)
+#endif
+#ifndef TEST_MTD_SPI_NOR_CLK
+#define TEST_MTD_SPI_NOR_CLK    (SPI_CLK_10MHZ)
+#endif
+
+#define BUF_SIZE                (1024U)
+
+/* configuration for flashes without SFDP */
+static mtd_spi_nor_t _dev = {
+    .base = {
+        .driver = &mtd_spi_nor_driver,
+        .page_size = 256,
+        .pages_per_sector = 16,
+        .sector_count = TEST_MTD_SPI_NOR_SIZE / 4096,
+    },
+    .opcode = &mtd_spi_nor_opcode_default,
+    .spi = TEST_MTD_SPI_NOR_DEV,
+    .cs = TEST_MTD_SPI_NOR_CS,
+    .addr_width = 3,
+    .mode = TEST_MTD_SPI_NOR_MODE,
+    .clk = TEST_MTD_SPI_NOR_CLK,
+    .flag = SPI_NOR_F_SECT_4K,
+};
+
+static mtd_dev_t *mtd = &_dev.base;
+static uint8_t _buf[BUF_SIZE];
+
+static void _print(const char *op, const char *mode, uint32_t start)
+{
+    printf("{ \"%s\" : { \"mode\" : \"%s\", \"bytes\" : %u, \"us\" : %" PRIu32
+           " } }\n", op, mode, (unsigned)TEST_MTD_SPI_NOR_SIZE,
+           xtimer_now_usec() - start);
+}
+
+static int _erase(const char *mode, uint16_t flag)
+{
+    uint16_t detected = _dev.flag;
+    uint32_t start = xtimer_now_usec();
+
+    _dev.flag = flag;
+    int res = mtd_erase(mtd, 0, TEST_MTD_SPI_NOR_SIZE);
+    _dev.flag = detected;
+    if (res < 0) {
+        printf("error: erase failed: %d\n", res);
+        return res;
+    }
+    _print("erase", mode, start);
+    return 0;
+}
+
+static int _write(const char *mode, uint32_t chunk)
+{
+    uint32_t start = xtimer_now_usec();
+
+    for (uint32_t addr = 0; addr < TEST_MTD_SPI_NOR_SIZE; addr += chunk) {
+        for (unsigned i = 0; i < chunk; i++) {
+            _buf[i] = (uint8_t)(addr + i);
+        }
+        int res = mtd_write(mtd, _buf, addr, chunk);
+        if (res < 0) {
+            printf("error: write failed: %d\n", res);
+            return res;
+        }
+    }
+    _print("write", mode, start);
+    return 0;
+}
+
+static int _read(const char *mode, uint16_t flag)
+{
+    uint16_t detected = _dev.flag;
+    uint32_t start = xtimer_now_usec();
+    int res = 0;
+
+    _dev.flag = (detected & ~SPI_NOR_F_FAST_READ) | flag;
+    for (uint32_t addr = 0; addr < TEST_MTD_SPI_NOR_SIZE; addr += BUF_SIZE) {
+        res = mtd_read(mtd, _buf, addr, BUF_SIZE);
+        if (res < 0) {
+            printf("error: read failed: %d\n", res);
+            break;
+        }
+    }
+    _dev.flag = detected;
+    if (res < 0) {
+        return res;
+    }
+    _print("read", mode, start);
+
+    /* the last block is from the multi-page write */
+    for (unsigned i = 0; i < BUF_SIZE; i++) {
+        if (_buf[i] != (uint8_t)(TEST_MTD_SPI_NOR_SIZE - BUF_SIZE + i)) {
+            puts("error: data mismatch");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int res = mtd_init(mtd);
+
+    if (res < 0) {
+        printf("error: init failed: %d\n", res);
+        return 1;
+    }
+    printf("JEDEC ID 0x%02x 0x%02x 0x%02x, %" PRIu32 " sectors of %" PRIu32
+           " bytes, page size %" PRIu32 ", dual: %d, quad: %d\n",
+           _dev.jedec_id.manuf, _dev.jedec_id.device[0],
+           _dev.jedec_id.device[1], mtd->sector_count,
+           mtd->pages_per_sector * mtd->page_size, mtd->page_size,
+           !!(_dev.flag & SPI_NOR_F_READ_DUAL),
+           !!(_dev.flag & SPI_NOR_F_READ_QUAD));
+
+    if ((TEST_MTD_SPI_NOR_SIZE % BUF_SIZE) || (BUF_SIZE % mtd->page_size)) {
+        puts("error: invalid test size");
+        return 1;
+    }
+
+    res  = _erase("4k", _dev.flag & ~(SPI_NOR_F_SECT_32K | SPI_NOR_F_SECT_64K));
+    res |= _write("page", mtd->page_size);
+    res |= _erase("block", _dev.flag);
+    res |= _write("multi", BUF_SIZE);
+    res |= _read("read", 0);
+    res |= _read("fast", SPI_NOR_F_FAST_READ);
+
+    puts((res == 0) ? "SUCCESS" : "FAILURE");
+    return 0;
+}
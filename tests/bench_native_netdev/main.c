@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measure frames received per second by native's socket_zep
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "msg.h"
+#include "net/ieee802154.h"
+#include "sched.h"
+#include "socket_zep.h"
+#include "socket_zep_params.h"
+#include "xtimer.h"
+
+#ifndef BENCH_IDLE_TIMEOUT
+#define BENCH_IDLE_TIMEOUT  (500U * US_PER_MS)
+#endif
+
+#define MSG_QUEUE_SIZE      (8)
+#define MSG_TYPE_ISR        (0x3456)
+
+static uint8_t _recvbuf[IEEE802154_FRAME_LEN_MAX];
+static msg_t _msg_queue[MSG_QUEUE_SIZE];
+static socket_zep_t _dev;
+static kernel_pid_t _main_pid;
+static uint32_t _frames, _bytes, _first, _last;
+
+static void _event_cb(netdev_t *dev, netdev_event_t event)
+{
+    if (event == NETDEV_EVENT_ISR) {
+        msg_t msg = { .type = MSG_TYPE_ISR };
+
+        msg_try_send(&msg, _main_pid);
+    }
+    else if (event == NETDEV_EVENT_RX_COMPLETE) {
+        int res = dev->driver->recv(dev, _recvbuf, sizeof(_recvbuf), NULL);
+
+        if (res > 0) {
+            _last = xtimer_now_usec();
+            if (_frames++ == 0) {
+                _first = _last;
+            }
+            _bytes += res;
+        }
+    }
+}
+
+int main(void)
+{
+    netdev_t *netdev = (netdev_t *)&_dev;
+    uint32_t duration;
+
+    /* no auto-init, so xtimer needs to be initialized manually */
+    xtimer_init();
+    msg_init_queue(_msg_queue, MSG_QUEUE_SIZE);
+    _main_pid = sched_active_pid;
+    socket_zep_setup(&_dev, &socket_zep_params[0]);
+    netdev->event_callback = _event_cb;
+    if (netdev->driver->init(netdev) < 0) {
+        puts("Unable to initialize socket_zep");
+        return 1;
+    }
+#ifdef MODULE_NATIVE_POLLER
+    puts("Receiving with native_poller");
+#else
+    puts("Receiving with SIGIO");
+#endif
+    puts("Waiting for frames");
+    while (1) {
+        msg_t msg;
+
+        if (xtimer_msg_receive_timeout(&msg, BENCH_IDLE_TIMEOUT) < 0) {
+            if (_frames > 0) {
+                break;
+            }
+            continue;
+        }
+        if (msg.type == MSG_TYPE_ISR) {
+            netdev->driver->isr(netdev);
+        }
+    }
+    duration = _last - _first;
+    printf("{ \"frames\" : %" PRIu32 ", \"bytes\" : %" PRIu32
+           ", \"duration_us\" : %" PRIu32 ", \"fps\" : %" PRIu32 " }\n",
+           _frames, _bytes, duration,
+           (duration > 0) ? (uint32_t)(((uint64_t)_frames * US_PER_SEC) /
+                                       duration) : 0);
+#ifdef MODULE_NATIVE_POLLER
+    printf("batches: %" PRIu32 ", truncated: %" PRIu32 "\n",
+           _dev.poller.batches, _dev.poller.truncated);
+#endif
+    return 0;
+}
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2019 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import os
+import socket
+import struct
+import sys
+from testrunner import run
+
+
+BENCH_FRAMES = int(os.environ.get("BENCH_FRAMES", 10000))
+ZEP_V2_TYPE_DATA = 1
+IEEE802154_DEFAULT_CHANNEL = 26
+zep_params = {
+        "local_addr": "::",
+        "local_port": 12345,
+        "remote_addr": "::1",
+        "remote_port": 17754,
+    }
+s = None
+
+
+def zep_frame(seq):
+    # data frame, PAN ID compression, short addresses, broadcast destination
+    mac = struct.pack("<HBHHH", 0x8841, seq & 0xff, 0x0023, 0xffff, 0x0001)
+    mac += b"\x54" * 100
+    mac += b"\x00\x00"  # FCS is not checked
+    hdr = struct.pack("!2sBBBHBB8sI10sB", b"EX", 2, ZEP_V2_TYPE_DATA,
+                      IEEE802154_DEFAULT_CHANNEL, 0, 1, 0xff, bytes(8), seq,
+                      bytes(10), len(mac))
+    return hdr + mac
+
+
+def testfunc(child):
+    child.expect(r"Receiving with (native_poller|SIGIO)")
+    child.expect_exact("Waiting for frames")
+    frames = [zep_frame(i) for i in range(BENCH_FRAMES)]
+    for frame in frames:
+        s.sendto(frame, ("::1", zep_params['local_port']))
+    child.expect(r"{ \"frames\" : \d+, \"bytes\" : \d+, "
+                 r"\"duration_us\" : \d+, \"fps\" : \d+ }")
+
+
+if __name__ == "__main__":
+    os.environ['TERMFLAGS'] = "-z [%s]:%d,[%s]:%d" % (
+            zep_params['local_addr'], zep_params['local_port'],
+            zep_params['remote_addr'], zep_params['remote_port'])
+    s = socket.socket(family=socket.AF_INET6, type=socket.SOCK_DGRAM)
+    s.bind(("::", zep_params['remote_port']))
+    res = run(testfunc, timeout=30, echo=True, traceback=True)
+    s.close()
+    sys.exit(res)
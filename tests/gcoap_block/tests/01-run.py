@@ -0,0 +1,23 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2019 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    for method in ("get", "put"):
+        for window in (1, 4):
+            child.expect(r"{ \"%s\" : { \"window\" : %d, \"len\" : 4096, "
+                         r"\"us\" : \d+ } }" % (method, window))
+    child.expect(r"{ \"get_short\" : { \"window\" : 4, \"len\" : 160 } }")
+    child.expect_exact("SUCCESS")
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
@@ -0,0 +1,367 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test scheduling of gcoap Observe notifications over the
+ *              loopback interface
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "net/gcoap.h"
+#include "xtimer.h"
+
+#define OBSERVERS_NUMOF     (2U)
+#define OBSERVER_PORT       (GCOAP_PORT + 1)
+#define NOTIFY_NUMOF        (3U)
+/* longest time until a scheduled notification is sent */
+#define RECV_TIMEOUT        (GCOAP_OBS_NOTIFY_INTERVAL + (100U * US_PER_MS))
+
+/* Observe client on its own port, driven by the test */
+typedef struct {
+    sock_udp_t sock;
+    uint8_t token;
+    uint8_t notifications;      /* since the last confirmable one */
+    uint16_t msgid;             /* of the last notification */
+    bool ack;                   /* acknowledge confirmable notifications */
+} observer_t;
+
+static ssize_t _value_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              void *ctx);
+
+static const coap_resource_t _resources[] = {
+    { "/value", COAP_GET, _value_handler, NULL },
+};
+
+static gcoap_listener_t _listener = {
+    &_resources[0],
+    sizeof(_resources) / sizeof(_resources[0]),
+    NULL
+};
+
+static observer_t _observers[OBSERVERS_NUMOF];
+static sock_udp_ep_t _server = { .family = AF_INET6, .port = GCOAP_PORT };
+static uint8_t _buf[GCOAP_PDU_BUF_SIZE];
+static uint8_t _value;
+static unsigned _renders;
+
+static ssize_t _value_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                              void *ctx)
+{
+    ssize_t res;
+
+    (void)ctx;
+    _renders++;
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+    res = coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
+    if ((res < 0) || (pdu->payload_len < 1)) {
+        return -1;
+    }
+    pdu->payload[0] = _value;
+    return res + 1;
+}
+
+/* Longest time until the given retransmission of a confirmable
+ * notification */
+static uint32_t _con_timeout(unsigned retries)
+{
+    return ((uint32_t)(COAP_ACK_TIMEOUT + COAP_ACK_VARIANCE) << retries)
+           * US_PER_SEC + (100U * US_PER_MS);
+}
+
+static int _send_empty(observer_t *obs, unsigned type, uint16_t msgid)
+{
+    ssize_t res = coap_build_hdr((coap_hdr_t *)_buf, type, NULL, 0,
+                                 COAP_CODE_EMPTY, msgid);
+
+    res = sock_udp_send(&obs->sock, _buf, res, &_server);
+    return (res < 0) ? (int)res : 0;
+}
+
+static int _register(observer_t *obs, uint8_t token)
+{
+    coap_pkt_t pdu;
+    ssize_t res;
+
+    res = coap_build_hdr((coap_hdr_t *)_buf, COAP_TYPE_NON, &token, 1,
+                         COAP_METHOD_GET, token);
+    res += coap_put_option(&_buf[res], 0, COAP_OPT_OBSERVE, NULL, 0);
+    res += coap_opt_put_uri_path(&_buf[res], COAP_OPT_OBSERVE,
+                                 _resources[0].path);
+    res = sock_udp_send(&obs->sock, _buf, res, &_server);
+    if (res < 0) {
+        return res;
+    }
+    res = sock_udp_recv(&obs->sock, _buf, sizeof(_buf), RECV_TIMEOUT, NULL);
+    if (res < 0) {
+        return res;
+    }
+    if ((coap_parse(&pdu, _buf, res) < 0)
+        || (coap_get_code_raw(&pdu) != COAP_CODE_CONTENT)
+        || !coap_has_observe(&pdu)) {
+        return -EBADMSG;
+    }
+    obs->token = token;
+    obs->notifications = 0;
+    return 0;
+}
+
+/* Receives a notification with the current value, and returns its type */
+static int _expect(observer_t *obs, uint32_t timeout)
+{
+    coap_pkt_t pdu;
+    ssize_t res = sock_udp_recv(&obs->sock, _buf, sizeof(_buf), timeout,
+                                NULL);
+
+    if (res < 0) {
+        printf("error: no notification: %d\n", (int)res);
+        return res;
+    }
+    if ((coap_parse(&pdu, _buf, res) < 0)
+        || (coap_get_code_raw(&pdu) != COAP_CODE_CONTENT)
+        || !coap_has_observe(&pdu)
+        || (coap_get_token_len(&pdu) != 1) || (pdu.token[0] != obs->token)
+        || (pdu.payload_len != 1) || (pdu.payload[0] != _value)) {
+        puts("error: unexpected notification");
+        return -EBADMSG;
+    }
+    obs->msgid = coap_get_id(&pdu);
+    if ((coap_get_type(&pdu) == COAP_TYPE_CON) && obs->ack) {
+        res = _send_empty(obs, COAP_TYPE_ACK, obs->msgid);
+        if (res < 0) {
+            return res;
+        }
+    }
+    return coap_get_type(&pdu);
+}
+
+/* Receives a notification, which must be confirmable on every
+ * GCOAP_OBS_CON_EVERY-th notification only */
+static int _notified(observer_t *obs)
+{
+    int type = _expect(obs, RECV_TIMEOUT);
+
+    if (type < 0) {
+        return type;
+    }
+    if (++obs->notifications >= GCOAP_OBS_CON_EVERY) {
+        obs->notifications = 0;
+        if (type != COAP_TYPE_CON) {
+            puts("error: notification not confirmable");
+            return -EBADMSG;
+        }
+    }
+    else if (type != COAP_TYPE_NON) {
+        puts("error: notification confirmable");
+        return -EBADMSG;
+    }
+    return type;
+}
+
+static int _silent(observer_t *obs, uint32_t timeout)
+{
+    ssize_t res = sock_udp_recv(&obs->sock, _buf, sizeof(_buf), timeout,
+                                NULL);
+
+    if (res != -ETIMEDOUT) {
+        printf("error: unexpected message: %d\n", (int)res);
+        return -EBADMSG;
+    }
+    return 0;
+}
+
+/* Changes the value and notifies all observers until @p obs receives a
+ * confirmable notification */
+static int _notify_until_con(observer_t *obs)
+{
+    for (unsigned n = 0; n < GCOAP_OBS_CON_EVERY; n++) {
+        int type = 0;
+
+        _value++;
+        if (gcoap_obs_notify(&_resources[0]) < 0) {
+            return -1;
+        }
+        for (unsigned i = 0; i < OBSERVERS_NUMOF; i++) {
+            int res = _notified(&_observers[i]);
+            if (res < 0) {
+                return res;
+            }
+            if (&_observers[i] == obs) {
+                type = res;
+            }
+        }
+        if (type == COAP_TYPE_CON) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int _test_fanout(void)
+{
+    unsigned renders = _renders;
+
+    _value++;
+    if (gcoap_obs_notify(&_resources[0]) < 0) {
+        puts("error: unable to schedule notification");
+        return -1;
+    }
+    for (unsigned i = 0; i < OBSERVERS_NUMOF; i++) {
+        if (_notified(&_observers[i]) < 0) {
+            return -1;
+        }
+    }
+    printf("{ \"fanout\" : { \"observers\" : %u, \"renders\" : %u } }\n",
+           OBSERVERS_NUMOF, _renders - renders);
+    return (_renders - renders == 1) ? 0 : -1;
+}
+
+static int _test_coalesce(void)
+{
+    unsigned renders = _renders;
+
+    /* still within the interval of the previous notification */
+    for (unsigned n = 0; n < NOTIFY_NUMOF; n++) {
+        _value++;
+        if (gcoap_obs_notify(&_resources[0]) < 0) {
+            puts("error: unable to schedule notification");
+            return -1;
+        }
+    }
+    for (unsigned i = 0; i < OBSERVERS_NUMOF; i++) {
+        if (_notified(&_observers[i]) < 0) {
+            return -1;
+        }
+    }
+    for (unsigned i = 0; i < OBSERVERS_NUMOF; i++) {
+        if (_silent(&_observers[i], RECV_TIMEOUT) < 0) {
+            return -1;
+        }
+    }
+    printf("{ \"coalesce\" : { \"notify\" : %u, \"renders\" : %u } }\n",
+           NOTIFY_NUMOF, _renders - renders);
+    return (_renders - renders == 1) ? 0 : -1;
+}
+
+static int _test_con(void)
+{
+    observer_t *obs = &_observers[0];
+
+    obs->ack = false;
+    if (_notify_until_con(obs) < 0) {
+        puts("error: no confirmable notification");
+        return -1;
+    }
+    /* retransmitted with the current value */
+    _value++;
+    if (_expect(obs, _con_timeout(0)) != COAP_TYPE_CON) {
+        puts("error: not retransmitted");
+        return -1;
+    }
+    if (_send_empty(obs, COAP_TYPE_ACK, obs->msgid) < 0) {
+        return -1;
+    }
+    for (unsigned i = 0; i < OBSERVERS_NUMOF; i++) {
+        if (_silent(&_observers[i], _con_timeout(1)) < 0) {
+            return -1;
+        }
+    }
+    obs->ack = true;
+    puts("{ \"con\" : { \"retransmissions\" : 1 } }");
+    return 0;
+}
+
+static int _test_reset(void)
+{
+    observer_t *obs = &_observers[1];
+
+    if (_send_empty(obs, COAP_TYPE_RST, obs->msgid) < 0) {
+        return -1;
+    }
+    _value++;
+    if ((gcoap_obs_notify(&_resources[0]) < 0)
+        || (_notified(&_observers[0]) < 0)
+        || (_silent(obs, RECV_TIMEOUT) < 0)) {
+        return -1;
+    }
+    puts("{ \"reset\" : { \"observers\" : 1 } }");
+    return 0;
+}
+
+static int _test_timeout(void)
+{
+    observer_t *obs = &_observers[1];
+    unsigned retries;
+
+    if (_register(obs, obs->token + OBSERVERS_NUMOF) < 0) {
+        puts("error: unable to register observer");
+        return -1;
+    }
+    obs->ack = false;
+    if (_notify_until_con(obs) < 0) {
+        puts("error: no confirmable notification");
+        return -1;
+    }
+    for (retries = 0; retries < COAP_MAX_RETRANSMIT; retries++) {
+        if (_expect(obs, _con_timeout(retries)) != COAP_TYPE_CON) {
+            puts("error: not retransmitted");
+            return -1;
+        }
+    }
+    /* removed once the last retransmission times out */
+    if (_silent(obs, _con_timeout(retries)) < 0) {
+        return -1;
+    }
+    _value++;
+    if ((gcoap_obs_notify(&_resources[0]) < 0)
+        || (_notified(&_observers[0]) < 0)
+        || (_silent(obs, RECV_TIMEOUT) < 0)) {
+        return -1;
+    }
+    printf("{ \"timeout\" : { \"retransmissions\" : %u, "
+           "\"observers\" : 1 } }\n", retries);
+    return 0;
+}
+
+int main(void)
+{
+    int res = 0;
+
+    ipv6_addr_set_loopback((ipv6_addr_t *)&_server.addr.ipv6);
+    gcoap_init();
+    gcoap_register_listener(&_listener);
+
+    for (unsigned i = 0; i < OBSERVERS_NUMOF; i++) {
+        sock_udp_ep_t local = { .family = AF_INET6,
+                                .netif = SOCK_ADDR_ANY_NETIF,
+                                .port = OBSERVER_PORT + i };
+
+        _observers[i].ack = true;
+        if ((sock_udp_create(&_observers[i].sock, &local, NULL, 0) < 0)
+            || (_register(&_observers[i], i + 1) < 0)) {
+            puts("error: unable to register observer");
+            return 1;
+        }
+    }
+
+    if ((_test_fanout() < 0) || (_test_coalesce() < 0) || (_test_con() < 0)
+        || (_test_reset() < 0) || (_test_timeout() < 0)) {
+        res = -1;
+    }
+    puts((res == 0) ? "SUCCESS" : "FAILURE");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2019 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    child.expect_exact("{ \"fanout\" : { \"observers\" : 2, \"renders\" : 1 } }")
+    child.expect_exact("{ \"coalesce\" : { \"notify\" : 3, \"renders\" : 1 } }")
+    child.expect_exact("{ \"con\" : { \"retransmissions\" : 1 } }",
+                       timeout=20)
+    child.expect_exact("{ \"reset\" : { \"observers\" : 1 } }")
+    child.expect_exact("{ \"timeout\" : { \"retransmissions\" : 2, "
+                       "\"observers\" : 1 } }", timeout=30)
+    child.expect_exact("SUCCESS")
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
@@ -224,29 +224,78 @@ static void test_get_next_hop_l2addr__link_local_static_conf(void)
     TEST_ASSERT(gnrc_pktbuf_is_empty());
 }
 
-void _simulate_ndp_handshake(const ipv6_addr_t *src, const ipv6_addr_t *dst,
-                             uint8_t adv_flags)
+static void test_get_next_hop_l2addr__route_cache_hit(void)
 {
-    msg_t msg;
     gnrc_ipv6_nib_nc_t nce;
-    ndp_nbr_adv_t *nbr_adv = (ndp_nbr_adv_t *)icmpv6;
-    ndp_opt_t *tl2ao = (ndp_opt_t *)&_buffer[sizeof(ipv6_hdr_t) +
-                                             sizeof(ndp_nbr_adv_t)];
+    gnrc_ipv6_nib_rc_t rce;
+    gnrc_ipv6_nib_rc_stats_t stats;
+    void *state = NULL;
 
-    /* trigger sending of neighbor discovery */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_nc_set(&_rem_ll, _mock_netif->pid,
+                                                  _rem_l2, sizeof(_rem_l2)));
+    for (unsigned i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_get_next_hop_l2addr(&_rem_ll,
+                                                                   _mock_netif,
+                                                                   NULL, &nce));
+        TEST_ASSERT_EQUAL_INT(sizeof(_rem_l2), nce.l2addr_len);
+        TEST_ASSERT_MESSAGE((memcmp(&_rem_l2, &nce.l2addr,
+                                    nce.l2addr_len) == 0),
+                            "_rem_l2 != nce.l2addr");
+    }
+    gnrc_ipv6_nib_rc_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.hits);
+    TEST_ASSERT_EQUAL_INT(1, stats.misses);
+    TEST_ASSERT(gnrc_ipv6_nib_rc_iter(0, &state, &rce));
+    TEST_ASSERT_MESSAGE((memcmp(&_rem_ll, &rce.dst, sizeof(_rem_ll)) == 0),
+                        "_rem_ll != rce.dst");
+    TEST_ASSERT_MESSAGE((memcmp(&_rem_ll, &rce.next_hop.ipv6,
+                                sizeof(_rem_ll)) == 0),
+                        "_rem_ll != rce.next_hop.ipv6");
+    TEST_ASSERT(!gnrc_ipv6_nib_rc_iter(0, &state, &rce));
+    TEST_ASSERT_EQUAL_INT(0, msg_avail());
+}
+
+static void test_get_next_hop_l2addr__route_cache_invalidated(void)
+{
+    gnrc_ipv6_nib_nc_t nce;
+    gnrc_ipv6_nib_rc_t rce;
+    gnrc_ipv6_nib_rc_stats_t stats;
+    void *state = NULL;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_nc_set(&_rem_ll, _mock_netif->pid,
+                                                  _rem_l2, sizeof(_rem_l2)));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_get_next_hop_l2addr(&_rem_ll,
+                                                               _mock_netif,
+                                                               NULL, &nce));
+    gnrc_ipv6_nib_nc_del(&_rem_ll, _mock_netif->pid);
+    TEST_ASSERT(!gnrc_ipv6_nib_rc_iter(0, &state, &rce));
+    /* the deleted neighbor must not be returned from the cache */
     TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH,
-                          gnrc_ipv6_nib_get_next_hop_l2addr(dst,
+                          gnrc_ipv6_nib_get_next_hop_l2addr(&_rem_ll,
                                                             _mock_netif,
                                                             NULL, &nce));
-    TEST_ASSERT_EQUAL_INT(1, msg_avail());
-    /* clear message queue */
-    msg_receive(&msg);
-    TEST_ASSERT_EQUAL_INT(GNRC_NETAPI_MSG_TYPE_SND, msg.type);
-    gnrc_pktbuf_release(msg.content.ptr);
-    /* generate neighbor advertisement */
+    gnrc_ipv6_nib_rc_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(0, stats.hits);
+    TEST_ASSERT_EQUAL_INT(2, stats.misses);
+    /* clear neighbor solicitation */
+    while (msg_avail()) {
+        msg_t msg;
+
+        msg_receive(&msg);
+        gnrc_pktbuf_release(msg.content.ptr);
+    }
+}
+
+/* Handles a neighbor advertisement from dst to src announcing l2 */
+static void _recv_nbr_adv(const ipv6_addr_t *src, const ipv6_addr_t *dst,
+                          uint8_t adv_flags, const uint8_t *l2)
+{
+    ndp_nbr_adv_t *nbr_adv = (ndp_nbr_adv_t *)icmpv6;
+    ndp_opt_t *tl2ao = (ndp_opt_t *)&_buffer[sizeof(ipv6_hdr_t) +
+                                             sizeof(ndp_nbr_adv_t)];
+
     ipv6_hdr_set_version(ipv6);
     ipv6->hl = NDP_HOP_LIMIT;
-    /* this simulates a reply, so dst and src need to be switched */
     memcpy(&ipv6->src, dst, sizeof(ipv6->src));
     memcpy(&ipv6->dst, src, sizeof(ipv6->dst));
     nbr_adv->type = ICMPV6_NBR_ADV;
@@ -255,11 +304,59 @@ void _simulate_ndp_handshake(const ipv6_addr_t *src, const ipv6_addr_t *dst,
     memcpy(&nbr_adv->tgt, dst, sizeof(nbr_adv->tgt));
     tl2ao->type = NDP_OPT_TL2A;
     tl2ao->len = 1;
-    memcpy(tl2ao + 1, _rem_l2, sizeof(_rem_l2));
+    memcpy(tl2ao + 1, l2, sizeof(_rem_l2));
     gnrc_ipv6_nib_handle_pkt(_mock_netif, ipv6, (icmpv6_hdr_t *)nbr_adv,
                              sizeof(ndp_nbr_adv_t) + 8U);
 }
 
+void _simulate_ndp_handshake(const ipv6_addr_t *src, const ipv6_addr_t *dst,
+                             uint8_t adv_flags)
+{
+    msg_t msg;
+    gnrc_ipv6_nib_nc_t nce;
+
+    /* trigger sending of neighbor discovery */
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH,
+                          gnrc_ipv6_nib_get_next_hop_l2addr(dst,
+                                                            _mock_netif,
+                                                            NULL, &nce));
+    TEST_ASSERT_EQUAL_INT(1, msg_avail());
+    /* clear message queue */
+    msg_receive(&msg);
+    TEST_ASSERT_EQUAL_INT(GNRC_NETAPI_MSG_TYPE_SND, msg.type);
+    gnrc_pktbuf_release(msg.content.ptr);
+    /* generate neighbor advertisement, this simulates a reply */
+    _recv_nbr_adv(src, dst, adv_flags, _rem_l2);
+}
+
+static void test_get_next_hop_l2addr__route_cache_nud(void)
+{
+    static const uint8_t new_l2[] = { _LL0, _LL1, _LL2, _LL3, _LL4,
+                                      _LL5 + 2 };
+    gnrc_ipv6_nib_nc_t nce;
+    gnrc_ipv6_nib_rc_t rce;
+    void *state = NULL;
+
+    _simulate_ndp_handshake(&_loc_ll, &_rem_ll, NDP_NBR_ADV_FLAGS_S);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_get_next_hop_l2addr(&_rem_ll,
+                                                               _mock_netif,
+                                                               NULL, &nce));
+    TEST_ASSERT(gnrc_ipv6_nib_rc_iter(0, &state, &rce));
+    /* an unsolicited override of the link-layer address makes the neighbor
+     * STALE, which must not be hidden by the cache */
+    _recv_nbr_adv(&_loc_ll, &_rem_ll, NDP_NBR_ADV_FLAGS_O, new_l2);
+    state = NULL;
+    TEST_ASSERT(!gnrc_ipv6_nib_rc_iter(0, &state, &rce));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_ipv6_nib_get_next_hop_l2addr(&_rem_ll,
+                                                               _mock_netif,
+                                                               NULL, &nce));
+    TEST_ASSERT_EQUAL_INT(sizeof(new_l2), nce.l2addr_len);
+    TEST_ASSERT_MESSAGE((memcmp(&new_l2, &nce.l2addr, nce.l2addr_len) == 0),
+                        "new_l2 != nce.l2addr");
+    TEST_ASSERT_EQUAL_INT(GNRC_IPV6_NIB_NC_INFO_NUD_STATE_DELAY,
+                          gnrc_ipv6_nib_nc_get_nud_state(&nce));
+}
+
 static void test_get_next_hop_l2addr__link_local_after_handshake(uint8_t adv_flags)
 {
     gnrc_ipv6_nib_nc_t nce;
@@ -1292,6 +1389,9 @@ static Test *tests_gnrc_ipv6_nib(void)
         new_TestFixture(test_get_next_hop_l2addr__global_EHOSTUNREACH_iface_on_link),
         new_TestFixture(test_get_next_hop_l2addr__ENETUNREACH),
         new_TestFixture(test_get_next_hop_l2addr__link_local_static_conf),
+        new_TestFixture(test_get_next_hop_l2addr__route_cache_hit),
+        new_TestFixture(test_get_next_hop_l2addr__route_cache_invalidated),
+        new_TestFixture(test_get_next_hop_l2addr__route_cache_nud),
         new_TestFixture(test_get_next_hop_l2addr__link_local_after_handshake_iface),
         new_TestFixture(test_get_next_hop_l2addr__link_local_after_handshake_iface_router),
         new_TestFixture(test_get_next_hop_l2addr__link_local_after_handshake_no_iface),
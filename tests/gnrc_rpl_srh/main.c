@@ -19,6 +19,7 @@
  * @}
  */
 
+#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -31,6 +32,7 @@
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/pktdump.h"
 #include "net/gnrc/netreg.h"
+#include "net/gnrc/rpl/routes.h"
 #include "net/gnrc/rpl/srh.h"
 #include "net/gnrc/ipv6/ext/rh.h"
 
@@ -46,6 +48,10 @@
                                0x00, 0x00, 0x00, 0x00, \
                                0x00, 0x00, 0x00, 0x00, \
                                0x00, 0x00, 0x00, 0x03 }}
+#define IPV6_ADDR3          {{ 0x20, 0x01, 0xab, 0xcd, \
+                               0x00, 0x00, 0x00, 0x00, \
+                               0x00, 0x00, 0x00, 0x00, \
+                               0x00, 0x00, 0x00, 0x04 }}
 #define IPV6_MCAST_ADDR     {{ 0xff, 0x05, 0xab, 0xcd, \
                                0x00, 0x00, 0x00, 0x00, \
                                0x00, 0x00, 0x00, 0x00, \
@@ -57,9 +63,12 @@
 
 #define SRH_SEG_LEFT        (2)
 #define MAX_BUF_SIZE        ((sizeof(gnrc_rpl_srh_t) + 2) + sizeof(ipv6_addr_t))
+#define BUILD_BUF_SIZE      (sizeof(gnrc_rpl_srh_t) + (2 * sizeof(ipv6_addr_t)))
+#define ROUTE_LTIME         (300U)
 
 static ipv6_hdr_t hdr;
 static uint8_t buf[MAX_BUF_SIZE];
+static uint8_t build_buf[BUILD_BUF_SIZE];
 static char line_buf[SHELL_DEFAULT_BUFSIZE];
 static gnrc_netreg_entry_t ip_entry = GNRC_NETREG_ENTRY_INIT_PID(
         0, KERNEL_PID_UNDEF
@@ -69,6 +78,8 @@ static void set_up_tests(void)
 {
     memset(&hdr, 0, sizeof(hdr));
     memset(buf, 0, sizeof(buf));
+    memset(build_buf, 0, sizeof(build_buf));
+    gnrc_rpl_routes_init();
 }
 
 static inline void _init_hdrs(gnrc_rpl_srh_t **srh, uint8_t **vec,
@@ -199,6 +210,89 @@ static void test_rpl_srh_nexthop_prefix_elided(void)
     TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &expected2));
 }
 
+/* IPV6_DST is the root of IPV6_ADDR1 <- IPV6_ADDR2 <- IPV6_ADDR3 */
+static void _add_path(void)
+{
+    static const ipv6_addr_t root = IPV6_DST, a1 = IPV6_ADDR1;
+    static const ipv6_addr_t a2 = IPV6_ADDR2, a3 = IPV6_ADDR3;
+
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&a1, IPV6_ADDR_BIT_LEN, &root,
+                                                 KERNEL_PID_UNDEF,
+                                                 GNRC_RPL_ROUTES_NON_STORING,
+                                                 ROUTE_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&a2, IPV6_ADDR_BIT_LEN, &a1,
+                                                 KERNEL_PID_UNDEF,
+                                                 GNRC_RPL_ROUTES_NON_STORING,
+                                                 ROUTE_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&a3, IPV6_ADDR_BIT_LEN, &a2,
+                                                 KERNEL_PID_UNDEF,
+                                                 GNRC_RPL_ROUTES_NON_STORING,
+                                                 ROUTE_LTIME));
+}
+
+static void test_rpl_srh_build(void)
+{
+    static const ipv6_addr_t root = IPV6_DST, expected1 = IPV6_ADDR1;
+    static const ipv6_addr_t expected2 = IPV6_ADDR2, dst = IPV6_ADDR3;
+    gnrc_rpl_srh_t *srh = (gnrc_rpl_srh_t *)build_buf;
+    void *err_ptr;
+    int res;
+
+    _add_path();
+    res = gnrc_rpl_srh_build(&root, &dst, &hdr.dst, srh, sizeof(build_buf));
+    /* two addresses with 15 octets elided, padded to 8 octets */
+    TEST_ASSERT_EQUAL_INT(sizeof(gnrc_rpl_srh_t) + 8, res);
+    TEST_ASSERT_EQUAL_INT(1, srh->len);
+    TEST_ASSERT_EQUAL_INT(2, srh->seg_left);
+    TEST_ASSERT_EQUAL_INT(0xff, srh->compr);
+    TEST_ASSERT_EQUAL_INT(6 << 4, srh->pad_resv);
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &expected1));
+
+    /* the header leads along the path */
+    res = gnrc_rpl_srh_process(&hdr, srh, &err_ptr);
+    TEST_ASSERT_EQUAL_INT(res, GNRC_IPV6_EXT_RH_FORWARDED);
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &expected2));
+    res = gnrc_rpl_srh_process(&hdr, srh, &err_ptr);
+    TEST_ASSERT_EQUAL_INT(res, GNRC_IPV6_EXT_RH_FORWARDED);
+    TEST_ASSERT_EQUAL_INT(0, srh->seg_left);
+    TEST_ASSERT(ipv6_addr_equal(&hdr.dst, &dst));
+}
+
+static void test_rpl_srh_build_child(void)
+{
+    static const ipv6_addr_t root = IPV6_DST, dst = IPV6_ADDR1;
+    gnrc_rpl_srh_t *srh = (gnrc_rpl_srh_t *)build_buf;
+    ipv6_addr_t first_hop;
+
+    _add_path();
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_srh_build(&root, &dst, &first_hop, srh,
+                                                sizeof(build_buf)));
+    TEST_ASSERT(ipv6_addr_equal(&first_hop, &dst));
+}
+
+static void test_rpl_srh_build_unreachable(void)
+{
+    static const ipv6_addr_t root = IPV6_DST, dst = IPV6_ADDR3;
+    gnrc_rpl_srh_t *srh = (gnrc_rpl_srh_t *)build_buf;
+    ipv6_addr_t first_hop;
+
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH,
+                          gnrc_rpl_srh_build(&root, &dst, &first_hop, srh,
+                                             sizeof(build_buf)));
+}
+
+static void test_rpl_srh_build_no_buf(void)
+{
+    static const ipv6_addr_t root = IPV6_DST, dst = IPV6_ADDR3;
+    gnrc_rpl_srh_t *srh = (gnrc_rpl_srh_t *)build_buf;
+    ipv6_addr_t first_hop;
+
+    _add_path();
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS,
+                          gnrc_rpl_srh_build(&root, &dst, &first_hop, srh,
+                                             sizeof(build_buf) - 1));
+}
+
 /* tools for external interaction */
 static inline void _ipreg_usage(char *cmd)
 {
@@ -247,6 +341,10 @@ static void run_unittests(void)
         new_TestFixture(test_rpl_srh_too_many_seg_left),
         new_TestFixture(test_rpl_srh_nexthop_no_prefix_elided),
         new_TestFixture(test_rpl_srh_nexthop_prefix_elided),
+        new_TestFixture(test_rpl_srh_build),
+        new_TestFixture(test_rpl_srh_build_child),
+        new_TestFixture(test_rpl_srh_build_unreachable),
+        new_TestFixture(test_rpl_srh_build_no_buf),
     };
 
     EMB_UNIT_TESTCALLER(rpl_srh_tests, set_up_tests, NULL, fixtures);
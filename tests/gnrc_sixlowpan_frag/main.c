@@ -235,10 +235,18 @@ static void _test_entry(const gnrc_sixlowpan_rbuf_t *entry,
                         "entry->super.dst != TEST_NETIF_HDR_DST");
     TEST_ASSERT_EQUAL_INT(TEST_TAG, entry->super.tag);
     TEST_ASSERT_EQUAL_INT(exp_current_size, entry->super.current_size);
-    TEST_ASSERT_NOT_NULL(entry->super.ints);
-    TEST_ASSERT_NULL(entry->super.ints->next);
-    TEST_ASSERT_EQUAL_INT(exp_int_start, entry->super.ints->start);
-    TEST_ASSERT_EQUAL_INT(exp_int_end, entry->super.ints->end);
+    for (unsigned i = 0; i < GNRC_SIXLOWPAN_FRAG_RBUF_UNITS; i++) {
+        /* intentionally discarding const qualifier since bf_isset() does not
+         * write to the bitfield */
+        uint8_t *received = (uint8_t *)entry->super.received;
+        uint8_t *starts = (uint8_t *)entry->super.starts;
+        bool exp_received = ((exp_int_start / GNRC_SIXLOWPAN_FRAG_RBUF_UNIT) <= i) &&
+                            (i <= (exp_int_end / GNRC_SIXLOWPAN_FRAG_RBUF_UNIT));
+        bool exp_start = (i == (exp_int_start / GNRC_SIXLOWPAN_FRAG_RBUF_UNIT));
+
+        TEST_ASSERT(exp_received == bf_isset(received, i));
+        TEST_ASSERT(exp_start == bf_isset(starts, i));
+    }
 }
 
 static void _check_pktbuf(const gnrc_sixlowpan_rbuf_t *entry)
@@ -403,6 +411,20 @@ static void test_rbuf_add__too_big_fragment(void)
     _check_pktbuf(NULL);
 }
 
+static void test_rbuf_add__empty_fragment(void)
+{
+    /* only the FRAGN header of _fragment2 */
+    gnrc_pktsnip_t *pkt = gnrc_pktbuf_add(NULL, _fragment2,
+                                          sizeof(sixlowpan_frag_n_t),
+                                          GNRC_NETTYPE_SIXLOWPAN);
+
+    TEST_ASSERT_NOT_NULL(pkt);
+    rbuf_add(&_test_netif_hdr.hdr, pkt, TEST_FRAGMENT2_OFFSET, TEST_PAGE);
+    /* no reassembly buffer entry was created for the fragment */
+    TEST_ASSERT_NULL(_first_non_empty_rbuf());
+    _check_pktbuf(NULL);
+}
+
 static void test_rbuf_add__overlap_lhs(void)
 {
     static const size_t pkt2_offset = TEST_FRAGMENT2_OFFSET - 8U;
@@ -554,6 +576,7 @@ static void run_unittests(void)
         new_TestFixture(test_rbuf_add__success_complete),
         new_TestFixture(test_rbuf_add__full_rbuf),
         new_TestFixture(test_rbuf_add__too_big_fragment),
+        new_TestFixture(test_rbuf_add__empty_fragment),
         new_TestFixture(test_rbuf_add__overlap_lhs),
         new_TestFixture(test_rbuf_add__overlap_rhs),
         new_TestFixture(test_rbuf_rm),
@@ -23,6 +23,7 @@
 #include <stdio.h>
 
 #include "net/sock/udp.h"
+#include "thread.h"
 #include "xtimer.h"
 
 #include "constants.h"
@@ -421,6 +422,100 @@ static void test_sock_udp_recv__non_blocking(void)
     assert(_check_net());
 }
 
+static void test_sock_udp_recv_buf__success(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    sock_udp_ep_t result;
+    void *data = NULL, *ctx = NULL;
+
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                          _TEST_NETIF));
+    assert(sizeof("ABCD") == sock_udp_recv_buf(&_sock, &data, &ctx,
+                                               SOCK_NO_TIMEOUT, &result));
+    assert(data != NULL);
+    assert(ctx != NULL);
+    assert(memcmp(data, "ABCD", sizeof("ABCD")) == 0);
+    assert(AF_INET6 == result.family);
+    assert(memcmp(&result.addr, &src_addr, sizeof(result.addr)) == 0);
+    assert(_TEST_PORT_REMOTE == result.port);
+    assert(_TEST_NETIF == result.netif);
+    assert(0 == sock_udp_recv_buf(&_sock, &data, &ctx, 0, NULL));
+    assert(ctx == NULL);
+    assert(_check_net());
+}
+
+static void test_sock_udp_recv_batch__success(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    sock_udp_dgram_t dgrams[3];
+
+    assert(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "ABCD", sizeof("ABCD"),
+                          _TEST_NETIF));
+    assert(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                          _TEST_PORT_LOCAL, "EFG", sizeof("EFG"),
+                          _TEST_NETIF));
+    assert(2 == sock_udp_recv_batch(&_sock, dgrams, 3, SOCK_NO_TIMEOUT));
+    assert(sizeof("ABCD") == dgrams[0].len);
+    assert(memcmp(dgrams[0].data, "ABCD", sizeof("ABCD")) == 0);
+    assert(sizeof("EFG") == dgrams[1].len);
+    assert(memcmp(dgrams[1].data, "EFG", sizeof("EFG")) == 0);
+    for (unsigned i = 0; i < 2; i++) {
+        assert(_TEST_PORT_REMOTE == dgrams[i].remote.port);
+        assert(0 == sock_udp_recv_buf(&_sock, &dgrams[i].data,
+                                      &dgrams[i].buf_ctx, 0, NULL));
+    }
+    assert(-EAGAIN == sock_udp_recv_batch(&_sock, dgrams, 3, 0));
+    assert(_check_net());
+}
+
+static char _inject_stack[THREAD_STACKSIZE_DEFAULT];
+
+static void *_inject_wrong_remote(void *arg)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_WRONG };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+
+    (void)arg;
+    xtimer_usleep(_TEST_TIMEOUT / 2);
+    _inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE, _TEST_PORT_LOCAL,
+                   "ABCD", sizeof("ABCD"), _TEST_NETIF);
+    return NULL;
+}
+
+static void test_sock_udp_recv_batch__ETIMEDOUT(void)
+{
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    static const sock_udp_ep_t remote = { .addr = { .ipv6 = _TEST_ADDR_REMOTE },
+                                          .family = AF_INET6,
+                                          .port = _TEST_PORT_REMOTE };
+    sock_udp_dgram_t dgrams[3];
+    uint32_t start;
+
+    assert(0 == sock_udp_create(&_sock, &local, &remote, SOCK_FLAGS_REUSE_EP));
+    thread_create(_inject_stack, sizeof(_inject_stack),
+                  THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+                  _inject_wrong_remote, NULL, "inject");
+    puts(" * Calling sock_udp_recv_batch()");
+    start = xtimer_now_usec();
+    assert(-ETIMEDOUT == sock_udp_recv_batch(&_sock, dgrams, 3,
+                                             _TEST_TIMEOUT));
+    /* the message from the wrong remote must not restart the timeout */
+    assert((xtimer_now_usec() - start) < (_TEST_TIMEOUT + _TEST_TIMEOUT / 4));
+    printf(" * (timed out with timeout %lu)\n", (long unsigned)_TEST_TIMEOUT);
+    assert(_check_net());
+}
+
 static void test_sock_udp_send__EAFNOSUPPORT(void)
 {
     static const sock_udp_ep_t remote = { .addr = { .ipv6 = _TEST_ADDR_REMOTE },
@@ -693,6 +788,25 @@ static void test_sock_udp_send__no_sock(void)
     assert(_check_net());
 }
 
+static void test_sock_udp_sendv__no_sock(void)
+{
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const sock_udp_ep_t remote = { .addr = { .ipv6 = _TEST_ADDR_REMOTE },
+                                          .family = AF_INET6,
+                                          .netif = _TEST_NETIF,
+                                          .port = _TEST_PORT_REMOTE };
+    iolist_t tail = { NULL, "CD", sizeof("CD") };
+    iolist_t empty = { &tail, NULL, 0 };
+    iolist_t head = { &empty, "AB", sizeof("AB") - 1 };
+
+    assert(sizeof("ABCD") == sock_udp_sendv(NULL, &head, &remote));
+    assert(_check_packet(&ipv6_addr_unspecified, &dst_addr, 0,
+                         _TEST_PORT_REMOTE, "ABCD", sizeof("ABCD"),
+                         _TEST_NETIF, true));
+    xtimer_usleep(1000);    /* let GNRC stack finish */
+    assert(_check_net());
+}
+
 int main(void)
 {
     _net_init();
@@ -724,6 +838,9 @@ int main(void)
     CALL(test_sock_udp_recv__unsocketed_with_remote());
     CALL(test_sock_udp_recv__with_timeout());
     CALL(test_sock_udp_recv__non_blocking());
+    CALL(test_sock_udp_recv_buf__success());
+    CALL(test_sock_udp_recv_batch__success());
+    CALL(test_sock_udp_recv_batch__ETIMEDOUT());
     _prepare_send_checks();
     CALL(test_sock_udp_send__EAFNOSUPPORT());
     CALL(test_sock_udp_send__EINVAL_addr());
@@ -741,6 +858,7 @@ int main(void)
     CALL(test_sock_udp_send__unsocketed());
     CALL(test_sock_udp_send__no_sock_no_netif());
     CALL(test_sock_udp_send__no_sock());
+    CALL(test_sock_udp_sendv__no_sock());
 
     puts("ALL TESTS SUCCESSFUL");
 
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests for asynchronous MTD requests
+ *
+ * Uses two RAM-based devices, one without mtd_desc_t::async, whose requests
+ * are run with the blocking functions, and one that is polled like a flash
+ * that programs and erases in the background.
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "kernel_defines.h"
+#include "mtd.h"
+#include "mutex.h"
+
+#define SECTOR_COUNT    (4U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (64U)
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+#define MEMORY_SIZE     (SECTOR_COUNT * SECTOR_SIZE)
+
+/* time the polled device is busy after each request */
+#define BUSY_US         (10000U)
+
+typedef struct {
+    mtd_dev_t base;
+    unsigned polls;
+    uint8_t memory[MEMORY_SIZE];
+} _mock_t;
+
+static mtd_req_t *_done[4];
+static unsigned _done_num;
+
+static _mock_t *_mock(mtd_dev_t *dev)
+{
+    return container_of(dev, _mock_t, base);
+}
+
+static int _init(mtd_dev_t *dev)
+{
+    (void)dev;
+    return 0;
+}
+
+static int _read(mtd_dev_t *dev, void *buff, uint32_t addr, uint32_t size)
+{
+    if (addr + size > MEMORY_SIZE) {
+        return -EOVERFLOW;
+    }
+    memcpy(buff, _mock(dev)->memory + addr, size);
+    return size;
+}
+
+static int _write(mtd_dev_t *dev, const void *buff, uint32_t addr,
+                  uint32_t size)
+{
+    if (((addr % PAGE_SIZE) + size) > PAGE_SIZE) {
+        return -EOVERFLOW;
+    }
+    if (addr + size > MEMORY_SIZE) {
+        return -EOVERFLOW;
+    }
+    memcpy(_mock(dev)->memory + addr, buff, size);
+    return size;
+}
+
+static int _erase(mtd_dev_t *dev, uint32_t addr, uint32_t size)
+{
+    if ((addr % SECTOR_SIZE) || (size % SECTOR_SIZE)
+        || (addr + size > MEMORY_SIZE)) {
+        return -EOVERFLOW;
+    }
+    memset(_mock(dev)->memory + addr, 0xff, size);
+    return 0;
+}
+
+/* Runs the request on the first call and then reports the device busy
+ * once */
+static uint32_t _async(mtd_dev_t *dev, mtd_req_t *req)
+{
+    _mock(dev)->polls++;
+    if (req->state != 0) {
+        return 0;
+    }
+    req->state = 1;
+    switch (req->op) {
+        case MTD_REQ_READ:
+            req->res = _read(dev, req->buf, req->addr, req->size);
+            break;
+        case MTD_REQ_WRITE:
+            req->res = _write(dev, req->buf, req->addr, req->size);
+            break;
+        case MTD_REQ_ERASE:
+            req->res = _erase(dev, req->addr, req->size);
+            break;
+    }
+    return BUSY_US;
+}
+
+static const mtd_desc_t _blocking_driver = {
+    .init = _init,
+    .read = _read,
+    .write = _write,
+    .erase = _erase,
+};
+
+static const mtd_desc_t _polled_driver = {
+    .init = _init,
+    .read = _read,
+    .write = _write,
+    .erase = _erase,
+    .async = _async,
+};
+
+static _mock_t _blocking = {
+    .base = {
+        .driver = &_blocking_driver,
+        .sector_count = SECTOR_COUNT,
+        .pages_per_sector = PAGE_PER_SECTOR,
+        .page_size = PAGE_SIZE,
+    },
+};
+
+static _mock_t _polled = {
+    .base = {
+        .driver = &_polled_driver,
+        .sector_count = SECTOR_COUNT,
+        .pages_per_sector = PAGE_PER_SECTOR,
+        .page_size = PAGE_SIZE,
+    },
+};
+
+static void _cb(mtd_req_t *req)
+{
+    if (_done_num < (sizeof(_done) / sizeof(_done[0]))) {
+        _done[_done_num] = req;
+    }
+    _done_num++;
+    if (req->arg) {
+        mutex_unlock(req->arg);
+    }
+}
+
+static void set_up(void)
+{
+    memset(_blocking.memory, 0, MEMORY_SIZE);
+    memset(_polled.memory, 0, MEMORY_SIZE);
+    _polled.polls = 0;
+    _done_num = 0;
+}
+
+/* Erases the first sector of dev, writes to it and reads it back */
+static void _erase_write_read(mtd_dev_t *dev)
+{
+    const uint8_t buf[] = "abcdefghijklmno";
+    uint8_t buf_read[sizeof(buf) + 1];
+    mutex_t done = MUTEX_INIT_LOCKED;
+    mtd_req_t reqs[3] = {
+        { .op = MTD_REQ_ERASE, .addr = 0, .size = SECTOR_SIZE, .cb = _cb },
+        { .op = MTD_REQ_WRITE, .buf = (void *)buf, .addr = 0,
+          .size = sizeof(buf), .cb = _cb },
+        { .op = MTD_REQ_READ, .buf = buf_read, .addr = 0,
+          .size = sizeof(buf_read), .cb = _cb, .arg = &done },
+    };
+
+    memset(buf_read, 0, sizeof(buf_read));
+    /* the requests of a device are run in order */
+    for (unsigned i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_submit(dev, &reqs[i]));
+    }
+    mutex_lock(&done);
+
+    TEST_ASSERT_EQUAL_INT(3, _done_num);
+    for (unsigned i = 0; i < 3; i++) {
+        TEST_ASSERT(_done[i] == &reqs[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(0, reqs[0].res);
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), reqs[1].res);
+    TEST_ASSERT_EQUAL_INT(sizeof(buf_read), reqs[2].res);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, buf_read, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0xff, buf_read[sizeof(buf)]);
+    TEST_ASSERT_NULL(dev->queue);
+}
+
+static void test_mtd_async_blocking(void)
+{
+    _erase_write_read(&_blocking.base);
+}
+
+static void test_mtd_async_polled(void)
+{
+    _erase_write_read(&_polled.base);
+    /* each request is run and then polled once */
+    TEST_ASSERT_EQUAL_INT(6, _polled.polls);
+}
+
+static void test_mtd_async_devices(void)
+{
+    uint8_t buf[PAGE_SIZE];
+    mutex_t read_done = MUTEX_INIT_LOCKED;
+    mutex_t erase_done = MUTEX_INIT_LOCKED;
+    mtd_req_t erase = {
+        .op = MTD_REQ_ERASE, .addr = 0, .size = SECTOR_SIZE,
+        .cb = _cb, .arg = &erase_done,
+    };
+    mtd_req_t read = {
+        .op = MTD_REQ_READ, .buf = buf, .addr = 0, .size = sizeof(buf),
+        .cb = _cb, .arg = &read_done,
+    };
+
+    /* a device is served while another one is busy */
+    TEST_ASSERT_EQUAL_INT(0, mtd_submit(&_polled.base, &erase));
+    TEST_ASSERT_EQUAL_INT(0, mtd_submit(&_blocking.base, &read));
+    mutex_lock(&read_done);
+    TEST_ASSERT_EQUAL_INT(1, _done_num);
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), read.res);
+    TEST_ASSERT_NOT_NULL(_polled.base.queue);
+
+    mutex_lock(&erase_done);
+    TEST_ASSERT_EQUAL_INT(2, _done_num);
+    TEST_ASSERT(_done[1] == &erase);
+    TEST_ASSERT_EQUAL_INT(0, erase.res);
+    TEST_ASSERT_NULL(_polled.base.queue);
+}
+
+static void test_mtd_async_error(void)
+{
+    mutex_t done = MUTEX_INIT_LOCKED;
+    mtd_req_t req = {
+        .op = MTD_REQ_ERASE, .addr = 1, .size = SECTOR_SIZE,
+        .cb = _cb, .arg = &done,
+    };
+
+    TEST_ASSERT_EQUAL_INT(-ENODEV, mtd_submit(NULL, &req));
+
+    /* errors of the driver end up in the result */
+    TEST_ASSERT_EQUAL_INT(0, mtd_submit(&_polled.base, &req));
+    mutex_lock(&done);
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, req.res);
+}
+
+Test *tests_mtd_async(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_async_blocking),
+        new_TestFixture(test_mtd_async_polled),
+        new_TestFixture(test_mtd_async_devices),
+        new_TestFixture(test_mtd_async_error),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_async_tests, set_up, NULL, fixtures);
+
+    return (Test *)&mtd_async_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_mtd_async());
+    TESTS_END();
+    return 0;
+}
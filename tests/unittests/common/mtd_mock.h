@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief   RAM-based flash MTD for unittests of modules on top of an MTD
+ *
+ * Writes can only clear bits and must not cross a page, like on NOR flash.
+ * The mock counts the operations and can simulate a power loss: once
+ * mtd_mock_t::budget bytes were written, all further writes and erases fail.
+ *
+ * Each test suite including this header gets its own copy of the driver.
+ */
+#ifndef MTD_MOCK_H
+#define MTD_MOCK_H
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kernel_defines.h"
+#include "mtd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   RAM-based flash
+ */
+typedef struct {
+    mtd_dev_t base;             /**< MTD device */
+    uint8_t *flash;             /**< contents of the whole device */
+    unsigned *sector_erases;    /**< erases per sector, or NULL */
+    unsigned reads;             /**< number of reads */
+    unsigned writes;            /**< number of successful writes */
+    unsigned erases;            /**< number of successful erases */
+    int budget;                 /**< bytes that can still be written before
+                                     the power is lost, -1 for no limit */
+} mtd_mock_t;
+
+static int mtd_mock_init(mtd_dev_t *dev);
+static int mtd_mock_read(mtd_dev_t *dev, void *buff, uint32_t addr,
+                         uint32_t size);
+static int mtd_mock_write(mtd_dev_t *dev, const void *buff, uint32_t addr,
+                          uint32_t size);
+static int mtd_mock_erase(mtd_dev_t *dev, uint32_t addr, uint32_t size);
+
+/**
+ * @brief   Driver of the mock
+ */
+static const mtd_desc_t mtd_mock_driver = {
+    .init = mtd_mock_init,
+    .read = mtd_mock_read,
+    .write = mtd_mock_write,
+    .erase = mtd_mock_erase,
+};
+
+/**
+ * @brief   Static initializer for a @ref mtd_mock_t
+ *
+ * @param[in] buf       buffer of `sectors * pages * page` bytes
+ * @param[in] sectors   number of sectors
+ * @param[in] pages     number of pages per sector
+ * @param[in] page      size of a page in bytes
+ */
+#define MTD_MOCK_INIT(buf, sectors, pages, page) { \
+        .base = { \
+            .driver = &mtd_mock_driver, \
+            .sector_count = (sectors), \
+            .pages_per_sector = (pages), \
+            .page_size = (page), \
+        }, \
+        .flash = (buf), \
+        .budget = -1, \
+}
+
+static inline mtd_mock_t *_mtd_mock(mtd_dev_t *dev)
+{
+    return container_of(dev, mtd_mock_t, base);
+}
+
+static inline uint32_t _mtd_mock_size(mtd_dev_t *dev)
+{
+    return dev->sector_count * dev->pages_per_sector * dev->page_size;
+}
+
+static int mtd_mock_init(mtd_dev_t *dev)
+{
+    (void)dev;
+    return 0;
+}
+
+static int mtd_mock_read(mtd_dev_t *dev, void *buff, uint32_t addr,
+                         uint32_t size)
+{
+    mtd_mock_t *mock = _mtd_mock(dev);
+
+    if (addr + size > _mtd_mock_size(dev)) {
+        return -EOVERFLOW;
+    }
+    memcpy(buff, mock->flash + addr, size);
+    mock->reads++;
+    return size;
+}
+
+static int mtd_mock_write(mtd_dev_t *dev, const void *buff, uint32_t addr,
+                          uint32_t size)
+{
+    mtd_mock_t *mock = _mtd_mock(dev);
+
+    if (((addr % dev->page_size) + size) > dev->page_size) {
+        return -EOVERFLOW;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+        if (mock->budget == 0) {
+            return -EIO;
+        }
+        if (mock->budget > 0) {
+            mock->budget--;
+        }
+        mock->flash[addr + i] &= ((const uint8_t *)buff)[i];
+    }
+    mock->writes++;
+    return size;
+}
+
+static int mtd_mock_erase(mtd_dev_t *dev, uint32_t addr, uint32_t size)
+{
+    mtd_mock_t *mock = _mtd_mock(dev);
+    uint32_t sector_size = dev->pages_per_sector * dev->page_size;
+
+    if (mock->budget == 0) {
+        return -EIO;
+    }
+    memset(mock->flash + addr, 0xff, size);
+    if (mock->sector_erases) {
+        for (uint32_t i = 0; i < size; i += sector_size) {
+            mock->sector_erases[(addr + i) / sector_size]++;
+        }
+    }
+    mock->erases++;
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_MOCK_H */
+/** @} */
@@ -531,6 +531,79 @@ static void test_nib_nc_add__cache_out_crash(void)
     }
 }
 
+/*
+ * Creates GNRC_IPV6_NIB_NUMOF neighbor cache entries with different IP
+ * addresses and a garbage-collectible AR state, marks the first as used and
+ * then tries to add another.
+ * Expected result: the second entry should be replaced, the first should
+ * still be in the neighbor cache
+ */
+static void test_nib_nc_add__cache_out_lru(void)
+{
+    _nib_onl_entry_t *first = NULL, *second = NULL, *node;
+    ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                  { .u64 = TEST_UINT64 } } };
+    ipv6_addr_t first_addr = addr;
+
+    for (int i = 0; i < GNRC_IPV6_NIB_NUMOF; i++) {
+        TEST_ASSERT_NOT_NULL((node = _nib_nc_add(&addr, IFACE,
+                                                 GNRC_IPV6_NIB_NC_INFO_NUD_STATE_STALE)));
+        if (i == 0) {
+            first = node;
+        }
+        else if (i == 1) {
+            second = node;
+        }
+        addr.u64[1].u64++;
+    }
+    _nib_nc_touch(first);
+    TEST_ASSERT_NOT_NULL((node = _nib_nc_add(&addr, IFACE,
+                                             GNRC_IPV6_NIB_NC_INFO_NUD_STATE_STALE)));
+    if (GNRC_IPV6_NIB_NUMOF > 1) {
+        TEST_ASSERT(node == second);
+    }
+    TEST_ASSERT(ipv6_addr_equal(&addr, &node->ipv6));
+    TEST_ASSERT(node == _nib_onl_get(&addr, IFACE));
+    if (GNRC_IPV6_NIB_NUMOF > 1) {
+        TEST_ASSERT(first == _nib_onl_get(&first_addr, IFACE));
+    }
+}
+
+/*
+ * Creates GNRC_IPV6_NIB_NUMOF neighbor cache entries with different IP
+ * addresses, changes the address of some by removing and re-adding them and
+ * looks all of them up.
+ * Expected result: every entry should be found by its current address, but
+ * not by its old one
+ */
+static void test_nib_onl_get__hash_readd(void)
+{
+    _nib_onl_entry_t *node;
+    ipv6_addr_t addr = { .u64 = { { .u8 = GLOBAL_PREFIX },
+                                  { .u64 = TEST_UINT64 } } };
+    ipv6_addr_t old_addr;
+
+    for (int i = 0; i < GNRC_IPV6_NIB_NUMOF; i++) {
+        TEST_ASSERT_NOT_NULL(_nib_nc_add(&addr, IFACE,
+                                         GNRC_IPV6_NIB_NC_INFO_NUD_STATE_STALE));
+        addr.u64[1].u64++;
+    }
+    old_addr = addr;
+    old_addr.u64[1].u64 -= GNRC_IPV6_NIB_NUMOF;
+    TEST_ASSERT_NOT_NULL((node = _nib_onl_get(&old_addr, IFACE)));
+    _nib_nc_remove(node);
+    TEST_ASSERT_NULL(_nib_onl_get(&old_addr, IFACE));
+    TEST_ASSERT(node == _nib_nc_add(&addr, IFACE,
+                                    GNRC_IPV6_NIB_NC_INFO_NUD_STATE_STALE));
+    for (int i = 0; i < GNRC_IPV6_NIB_NUMOF; i++) {
+        TEST_ASSERT_NOT_NULL((node = _nib_onl_get(&addr, IFACE)));
+        TEST_ASSERT(ipv6_addr_equal(&addr, &node->ipv6));
+        /* also matches with unspecified interface */
+        TEST_ASSERT(node == _nib_onl_get(&addr, 0));
+        addr.u64[1].u64--;
+    }
+}
+
 /*
  * Creates a neighbor cache entry and sets it reachable
  * Expected result: node->info flags set to NUD_STATE_REACHABLE and NIB's event
@@ -2027,6 +2100,8 @@ Test *tests_gnrc_ipv6_nib_internal_tests(void)
         new_TestFixture(test_nib_nc_add__success),
         new_TestFixture(test_nib_nc_add__success_full_but_garbage_collectible),
         new_TestFixture(test_nib_nc_add__cache_out_crash),
+        new_TestFixture(test_nib_nc_add__cache_out_lru),
+        new_TestFixture(test_nib_onl_get__hash_readd),
         new_TestFixture(test_nib_nc_remove__uncleared),
         new_TestFixture(test_nib_nc_remove__cleared),
         new_TestFixture(test_nib_nc_set_reachable__success),
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <errno.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "net/gnrc/rpl/routes.h"
+#include "net/ipv6/addr.h"
+
+#include "tests-gnrc_rpl_routes.h"
+
+#define TEST_IFACE      (6)
+#define TEST_LTIME      (300U)
+
+/* 2001:db8::<i> */
+static void _global(ipv6_addr_t *addr, uint16_t i)
+{
+    ipv6_addr_from_str(addr, "2001:db8::");
+    addr->u16[7] = byteorder_htons(i);
+}
+
+/* fe80::<i> */
+static void _link_local(ipv6_addr_t *addr, uint16_t i)
+{
+    ipv6_addr_set_link_local_prefix(addr);
+    addr->u16[7] = byteorder_htons(i);
+}
+
+static void set_up(void)
+{
+    gnrc_rpl_routes_init();
+}
+
+static void test_gnrc_rpl_routes_get__empty(void)
+{
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst;
+
+    _global(&dst, 1);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, gnrc_rpl_routes_get(&dst, &route));
+}
+
+static void test_gnrc_rpl_routes_add__host(void)
+{
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst, next_hop;
+
+    _global(&dst, 1);
+    _link_local(&next_hop, 1);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                 &next_hop, TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get(&dst, &route));
+    TEST_ASSERT(ipv6_addr_equal(&dst, &route.dst));
+    TEST_ASSERT(ipv6_addr_equal(&next_hop, &route.parent));
+    TEST_ASSERT_EQUAL_INT(IPV6_ADDR_BIT_LEN, route.dst_len);
+    TEST_ASSERT_EQUAL_INT(TEST_IFACE, route.iface);
+    TEST_ASSERT_EQUAL_INT(GNRC_RPL_ROUTES_STORING, route.mode);
+    TEST_ASSERT(route.ltime <= TEST_LTIME);
+    TEST_ASSERT(route.ltime >= (TEST_LTIME - 1));
+    /* other hosts in the same prefix have no route */
+    _global(&dst, 2);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, gnrc_rpl_routes_get(&dst, &route));
+}
+
+static void test_gnrc_rpl_routes_add__replace(void)
+{
+    gnrc_rpl_routes_stats_t stats;
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst, next_hop;
+
+    _global(&dst, 1);
+    _link_local(&next_hop, 1);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                 &next_hop, TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    _link_local(&next_hop, 2);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                 &next_hop, TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get(&dst, &route));
+    TEST_ASSERT(ipv6_addr_equal(&next_hop, &route.parent));
+    gnrc_rpl_routes_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.routes);
+    /* target and both next hops, the prefixes are shared */
+    TEST_ASSERT_EQUAL_INT(3, stats.entries);
+    TEST_ASSERT_EQUAL_INT(2, stats.pfxs);
+}
+
+static void test_gnrc_rpl_routes_add__EINVAL(void)
+{
+    ipv6_addr_t dst;
+
+    _global(&dst, 1);
+    TEST_ASSERT_EQUAL_INT(-EINVAL, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                       &dst, TEST_IFACE,
+                                                       GNRC_RPL_ROUTES_STORING,
+                                                       TEST_LTIME));
+}
+
+static void test_gnrc_rpl_routes_get__longest_match(void)
+{
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst, pfx48, next_hop[3];
+
+    ipv6_addr_from_str(&pfx48, "2001:db8::");
+    for (unsigned i = 0; i < 3; i++) {
+        _link_local(&next_hop[i], i + 1);
+    }
+    _global(&dst, 1);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&pfx48, 48, &next_hop[0],
+                                                 TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, 64, &next_hop[1],
+                                                 TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                 &next_hop[2], TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get(&dst, &route));
+    TEST_ASSERT(ipv6_addr_equal(&next_hop[2], &route.parent));
+    _global(&dst, 2);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get(&dst, &route));
+    TEST_ASSERT(ipv6_addr_equal(&next_hop[1], &route.parent));
+    TEST_ASSERT_EQUAL_INT(64, route.dst_len);
+    ipv6_addr_from_str(&dst, "2001:db8:0:1::1");
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get(&dst, &route));
+    TEST_ASSERT(ipv6_addr_equal(&next_hop[0], &route.parent));
+    TEST_ASSERT(ipv6_addr_equal(&pfx48, &route.dst));
+    TEST_ASSERT_EQUAL_INT(48, route.dst_len);
+    ipv6_addr_from_str(&dst, "2001:db9::1");
+    TEST_ASSERT_EQUAL_INT(-ENOENT, gnrc_rpl_routes_get(&dst, &route));
+}
+
+static void test_gnrc_rpl_routes_del(void)
+{
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst, next_hop;
+
+    _global(&dst, 1);
+    _link_local(&next_hop, 1);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                 &next_hop, TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    gnrc_rpl_routes_del(&dst, IPV6_ADDR_BIT_LEN);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, gnrc_rpl_routes_get(&dst, &route));
+}
+
+static void test_gnrc_rpl_routes_add__ENOMEM(void)
+{
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst, next_hop;
+
+    _link_local(&next_hop, 1);
+    /* one entry is taken by the next hop */
+    for (unsigned i = 0; i < (GNRC_RPL_ROUTES_NUMOF - 1); i++) {
+        _global(&dst, i + 1);
+        TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                     &next_hop, TEST_IFACE,
+                                                     GNRC_RPL_ROUTES_STORING,
+                                                     TEST_LTIME));
+    }
+    _global(&dst, GNRC_RPL_ROUTES_NUMOF);
+    TEST_ASSERT_EQUAL_INT(-ENOMEM, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                       &next_hop, TEST_IFACE,
+                                                       GNRC_RPL_ROUTES_STORING,
+                                                       TEST_LTIME));
+    /* removed routes are reclaimed */
+    _global(&dst, 1);
+    gnrc_rpl_routes_del(&dst, IPV6_ADDR_BIT_LEN);
+    _global(&dst, GNRC_RPL_ROUTES_NUMOF);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                 &next_hop, TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get(&dst, &route));
+    for (unsigned i = 1; i < (GNRC_RPL_ROUTES_NUMOF - 1); i++) {
+        _global(&dst, i + 1);
+        TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get(&dst, &route));
+    }
+}
+
+static void test_gnrc_rpl_routes_add__ENOSPC(void)
+{
+    ipv6_addr_t dst, next_hop;
+
+    _link_local(&next_hop, 1);
+    for (unsigned i = 0; i < (GNRC_RPL_ROUTES_PFX_NUMOF - 1); i++) {
+        _global(&dst, 1);
+        dst.u16[1] = byteorder_htons(i);
+        TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                     &next_hop, TEST_IFACE,
+                                                     GNRC_RPL_ROUTES_STORING,
+                                                     TEST_LTIME));
+    }
+    dst.u16[1] = byteorder_htons(GNRC_RPL_ROUTES_PFX_NUMOF);
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                       &next_hop, TEST_IFACE,
+                                                       GNRC_RPL_ROUTES_STORING,
+                                                       TEST_LTIME));
+}
+
+static void test_gnrc_rpl_routes_get_parent(void)
+{
+    ipv6_addr_t root, node[3], parent;
+
+    _global(&root, 1);
+    for (unsigned i = 0; i < 3; i++) {
+        _global(&node[i], i + 2);
+    }
+    /* root <- node[0] <- node[1], node[2] is a storing route */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&node[0], IPV6_ADDR_BIT_LEN,
+                                                 &root, TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_NON_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&node[1], IPV6_ADDR_BIT_LEN,
+                                                 &node[0], TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_NON_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&node[2], IPV6_ADDR_BIT_LEN,
+                                                 &node[0], TEST_IFACE,
+                                                 GNRC_RPL_ROUTES_STORING,
+                                                 TEST_LTIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get_parent(&node[1], &parent));
+    TEST_ASSERT(ipv6_addr_equal(&node[0], &parent));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get_parent(&node[0], &parent));
+    TEST_ASSERT(ipv6_addr_equal(&root, &parent));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, gnrc_rpl_routes_get_parent(&root, &parent));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, gnrc_rpl_routes_get_parent(&node[2],
+                                                              &parent));
+    /* a removed parent stays part of the path of its children */
+    gnrc_rpl_routes_del(&node[0], IPV6_ADDR_BIT_LEN);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_get_parent(&node[0], &parent));
+    TEST_ASSERT(ipv6_addr_equal(&root, &parent));
+}
+
+static void test_gnrc_rpl_routes_iter(void)
+{
+    gnrc_rpl_route_t route;
+    ipv6_addr_t dst, next_hop;
+    void *state = NULL;
+    unsigned count = 0;
+
+    _link_local(&next_hop, 1);
+    for (unsigned i = 0; i < 4; i++) {
+        _global(&dst, i + 1);
+        TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_routes_add(&dst, IPV6_ADDR_BIT_LEN,
+                                                     &next_hop,
+                                                     TEST_IFACE + (i & 1),
+                                                     GNRC_RPL_ROUTES_STORING,
+                                                     TEST_LTIME));
+    }
+    gnrc_rpl_routes_del(&dst, IPV6_ADDR_BIT_LEN);
+    while (gnrc_rpl_routes_iter(KERNEL_PID_UNDEF, &state, &route)) {
+        TEST_ASSERT(ipv6_addr_equal(&next_hop, &route.parent));
+        count++;
+    }
+    TEST_ASSERT_EQUAL_INT(3, count);
+    count = 0;
+    while (gnrc_rpl_routes_iter(TEST_IFACE, &state, &route)) {
+        TEST_ASSERT_EQUAL_INT(TEST_IFACE, route.iface);
+        count++;
+    }
+    TEST_ASSERT_EQUAL_INT(2, count);
+}
+
+Test *tests_gnrc_rpl_routes_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_gnrc_rpl_routes_get__empty),
+        new_TestFixture(test_gnrc_rpl_routes_add__host),
+        new_TestFixture(test_gnrc_rpl_routes_add__replace),
+        new_TestFixture(test_gnrc_rpl_routes_add__EINVAL),
+        new_TestFixture(test_gnrc_rpl_routes_get__longest_match),
+        new_TestFixture(test_gnrc_rpl_routes_del),
+        new_TestFixture(test_gnrc_rpl_routes_add__ENOMEM),
+        new_TestFixture(test_gnrc_rpl_routes_add__ENOSPC),
+        new_TestFixture(test_gnrc_rpl_routes_get_parent),
+        new_TestFixture(test_gnrc_rpl_routes_iter),
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_rpl_routes_tests, set_up, NULL, fixtures);
+
+    return (Test *)&gnrc_rpl_routes_tests;
+}
+
+void tests_gnrc_rpl_routes(void)
+{
+    TESTS_RUN(tests_gnrc_rpl_routes_tests());
+}
+/** @} */
@@ -0,0 +1,464 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "embUnit.h"
+
+#include "fs/littlefs_fs.h"
+#include "hsfile.h"
+#include "mtd_mock.h"
+#include "vfs.h"
+
+#include "tests-hsfile.h"
+
+#define SECTOR_COUNT    (32U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (64U)
+#define FLASH_SIZE      (SECTOR_COUNT * PAGE_PER_SECTOR * PAGE_SIZE)
+
+#define FILE_NAME       "/test-hsfile/data"
+#define FILE_HDR_SIZE   (4U)
+#define CHUNK_HDR_SIZE  (4U)
+#define STORED          (0x8000U)
+#define FOOTER_SIZE     (16U)
+
+/* ends within the fourth chunk */
+#define DATA_SIZE       ((3U * HSFILE_CHUNK_SIZE) + (HSFILE_CHUNK_SIZE / 2U) \
+                         + 1U)
+/* sizes of the blocks written and read, which are not aligned to chunks */
+#define WRITE_SIZE      (100U)
+#define READ_SIZE       (77U)
+
+/* enough chunks for the index to drop every other entry twice, the last
+ * one is short */
+#define INDEX_CHUNKS    ((2U * HSFILE_INDEX_SIZE) + 3U)
+#define INDEX_DATA_SIZE (((INDEX_CHUNKS - 1U) * HSFILE_CHUNK_SIZE) \
+                         + (HSFILE_CHUNK_SIZE / 2U))
+
+static uint8_t _flash[FLASH_SIZE];
+static mtd_mock_t _mock = MTD_MOCK_INIT(_flash, SECTOR_COUNT, PAGE_PER_SECTOR,
+                                        PAGE_SIZE);
+
+static littlefs_desc_t _lfs = {
+    .dev = &_mock.base,
+};
+
+static vfs_mount_t _mount = {
+    .fs = &littlefs_file_system,
+    .mount_point = "/test-hsfile",
+    .private_data = &_lfs,
+};
+
+static const uint8_t _file_hdr[FILE_HDR_SIZE] = {
+    'H', 'S', HEATSHRINK_STATIC_WINDOW_BITS, HEATSHRINK_STATIC_LOOKAHEAD_BITS
+};
+
+static hsfile_t _f;
+static uint8_t _buf[DATA_SIZE];
+
+/* Byte at offset off of the test data, which is either compressible or
+ * pseudo-random */
+static uint8_t _byte(uint32_t off, bool compressible)
+{
+    if (compressible) {
+        return 'a' + ((off / 16) % 26);
+    }
+    off = (off * 1103515245) + 12345;
+    return off >> 16;
+}
+
+static bool _check(const uint8_t *buf, uint32_t off, size_t len,
+                   bool compressible)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != _byte(off + i, compressible)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void _write_data(bool compressible)
+{
+    uint8_t block[WRITE_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME,
+                                         O_CREAT | O_WRONLY, 0));
+    for (uint32_t off = 0; off < DATA_SIZE; off += WRITE_SIZE) {
+        size_t len = DATA_SIZE - off;
+        if (len > WRITE_SIZE) {
+            len = WRITE_SIZE;
+        }
+        for (size_t i = 0; i < len; i++) {
+            block[i] = _byte(off + i, compressible);
+        }
+        TEST_ASSERT_EQUAL_INT(len, hsfile_write(&_f, block, len));
+    }
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE, hsfile_lseek(&_f, 0, SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+/* Size of the file on the file system */
+static off_t _stored_size(void)
+{
+    struct stat st;
+    int res = vfs_stat(FILE_NAME, &st);
+    return (res < 0) ? res : st.st_size;
+}
+
+/* Writes a file as is, bypassing hsfile */
+static void _write_raw(const void *data, size_t len)
+{
+    int fd = vfs_open(FILE_NAME, O_CREAT | O_WRONLY | O_TRUNC, 0);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(len, vfs_write(fd, data, len));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+}
+
+/* Overwrites a part of a file */
+static void _patch(off_t off, const void *data, size_t len)
+{
+    int fd = vfs_open(FILE_NAME, O_WRONLY, 0);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(off, vfs_lseek(fd, off, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(len, vfs_write(fd, data, len));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+}
+
+/* Offset of the header of the second chunk */
+static off_t _second_chunk(void)
+{
+    uint8_t hdr[CHUNK_HDR_SIZE];
+    int fd = vfs_open(FILE_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        return fd;
+    }
+    vfs_lseek(fd, FILE_HDR_SIZE, SEEK_SET);
+    ssize_t res = vfs_read(fd, hdr, sizeof(hdr));
+    vfs_close(fd);
+    if (res != sizeof(hdr)) {
+        return -EIO;
+    }
+    return FILE_HDR_SIZE + CHUNK_HDR_SIZE
+           + ((hdr[2] | (hdr[3] << 8)) & ~STORED);
+}
+
+/* Writes INDEX_CHUNKS chunks, each filled with its index */
+static void _write_index_data(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME,
+                                         O_CREAT | O_WRONLY, 0));
+    for (unsigned i = 0; i < INDEX_CHUNKS; i++) {
+        size_t len = (i < INDEX_CHUNKS - 1) ? HSFILE_CHUNK_SIZE
+                                            : HSFILE_CHUNK_SIZE / 2;
+        memset(_buf, i, len);
+        TEST_ASSERT_EQUAL_INT(len, hsfile_write(&_f, _buf, len));
+    }
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+/* Reads the chunks backwards */
+static void _read_index_data(void)
+{
+    TEST_ASSERT_EQUAL_INT(INDEX_DATA_SIZE, hsfile_size(&_f));
+    for (unsigned i = INDEX_CHUNKS; i-- > 0;) {
+        off_t off = (off_t)i * HSFILE_CHUNK_SIZE;
+        TEST_ASSERT_EQUAL_INT(off, hsfile_lseek(&_f, off, SEEK_SET));
+        TEST_ASSERT_EQUAL_INT(1, hsfile_read(&_f, _buf, 1));
+        TEST_ASSERT_EQUAL_INT((uint8_t)i, _buf[0]);
+    }
+}
+
+/* Writes a file with a single chunk of raw uncompressed and stored bytes,
+ * of which only len bytes are present */
+static void _write_chunk(uint16_t raw, uint16_t stored, size_t len)
+{
+    uint8_t file[FILE_HDR_SIZE + CHUNK_HDR_SIZE + HSFILE_CHUNK_SIZE];
+
+    memcpy(file, _file_hdr, FILE_HDR_SIZE);
+    file[FILE_HDR_SIZE] = raw & 0xff;
+    file[FILE_HDR_SIZE + 1] = raw >> 8;
+    file[FILE_HDR_SIZE + 2] = stored & 0xff;
+    file[FILE_HDR_SIZE + 3] = stored >> 8;
+    memset(&file[FILE_HDR_SIZE + CHUNK_HDR_SIZE], 'a', HSFILE_CHUNK_SIZE);
+    _write_raw(file, len);
+}
+
+static void set_up(void)
+{
+    memset(_flash, 0xff, sizeof(_flash));
+    TEST_ASSERT_EQUAL_INT(0, vfs_format(&_mount));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount));
+}
+
+static void tear_down(void)
+{
+    vfs_umount(&_mount);
+}
+
+static void test_hsfile_round_trip(void)
+{
+    ssize_t res;
+    uint32_t off = 0;
+
+    _write_data(true);
+    TEST_ASSERT(_stored_size() < (off_t)DATA_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE, hsfile_size(&_f));
+    while ((res = hsfile_read(&_f, _buf, READ_SIZE)) > 0) {
+        TEST_ASSERT(_check(_buf, off, res, true));
+        off += res;
+    }
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE, off);
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+static void test_hsfile_stored(void)
+{
+    const unsigned chunks = (DATA_SIZE + HSFILE_CHUNK_SIZE - 1)
+                            / HSFILE_CHUNK_SIZE;
+    unsigned stride = 1;
+
+    while (chunks > stride * HSFILE_INDEX_SIZE) {
+        stride *= 2;
+    }
+    _write_data(false);
+    /* no chunk shrinks, so all are stored as is, followed by the empty
+     * chunk header, the index entries and the footer */
+    TEST_ASSERT_EQUAL_INT(FILE_HDR_SIZE + (chunks * CHUNK_HDR_SIZE)
+                          + DATA_SIZE + CHUNK_HDR_SIZE
+                          + (((chunks + stride - 1) / stride)
+                             * sizeof(uint32_t)) + FOOTER_SIZE,
+                          _stored_size());
+
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE, hsfile_read(&_f, _buf, sizeof(_buf)));
+    TEST_ASSERT(_check(_buf, 0, DATA_SIZE, false));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_read(&_f, _buf, sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+static void test_hsfile_lseek(void)
+{
+    _write_data(true);
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+
+    /* the end of the file */
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE - 10, hsfile_lseek(&_f, -10, SEEK_END));
+    TEST_ASSERT_EQUAL_INT(10, hsfile_read(&_f, _buf, 20));
+    TEST_ASSERT(_check(_buf, DATA_SIZE - 10, 10, true));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_read(&_f, _buf, 20));
+
+    /* backwards from the last chunk into the first one, across the end of
+     * the first chunk */
+    TEST_ASSERT_EQUAL_INT(HSFILE_CHUNK_SIZE - 5,
+                          hsfile_lseek(&_f, (off_t)HSFILE_CHUNK_SIZE - 5
+                                            - (off_t)DATA_SIZE, SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(10, hsfile_read(&_f, _buf, 10));
+    TEST_ASSERT(_check(_buf, HSFILE_CHUNK_SIZE - 5, 10, true));
+
+    /* forwards, skipping a chunk */
+    TEST_ASSERT_EQUAL_INT((2 * HSFILE_CHUNK_SIZE) + 5,
+                          hsfile_lseek(&_f, HSFILE_CHUNK_SIZE, SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(READ_SIZE, hsfile_read(&_f, _buf, READ_SIZE));
+    TEST_ASSERT(_check(_buf, (2 * HSFILE_CHUNK_SIZE) + 5, READ_SIZE, true));
+
+    /* behind the end, and before the start */
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE + 5, hsfile_lseek(&_f, 5, SEEK_END));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_read(&_f, _buf, 1));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, hsfile_lseek(&_f, -(off_t)DATA_SIZE - 1,
+                                                SEEK_END));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, hsfile_lseek(&_f, -(off_t)DATA_SIZE - 6,
+                                                SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_lseek(&_f, -(off_t)DATA_SIZE - 5,
+                                          SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(1, hsfile_read(&_f, _buf, 1));
+    TEST_ASSERT(_check(_buf, 0, 1, true));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+static void test_hsfile_bad_file_header(void)
+{
+    const uint8_t bad[FILE_HDR_SIZE] = {
+        'H', 'S', HEATSHRINK_STATIC_WINDOW_BITS + 1,
+        HEATSHRINK_STATIC_LOOKAHEAD_BITS
+    };
+
+    /* truncated */
+    for (size_t len = 0; len < FILE_HDR_SIZE; len++) {
+        _write_raw(_file_hdr, len);
+        TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_open(&_f, FILE_NAME,
+                                                   O_RDONLY, 0));
+    }
+    /* written with another window size */
+    _write_raw(bad, sizeof(bad));
+    TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    /* not a compressed file */
+    _write_raw("no hsfile", 9);
+    TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+
+    /* an empty compressed file */
+    _write_raw(_file_hdr, sizeof(_file_hdr));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_size(&_f));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_read(&_f, _buf, 1));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+static void test_hsfile_bad_chunk_header(void)
+{
+    static const struct {
+        uint16_t raw;
+        uint16_t stored;
+    } bad[] = {
+        { 0, STORED },                                      /* empty */
+        { HSFILE_CHUNK_SIZE + 1, (HSFILE_CHUNK_SIZE + 1) | STORED },
+        { 10, HSFILE_CHUNK_SIZE + 1 },                      /* too long */
+        { 10, 9 | STORED },                                 /* raw != stored */
+    };
+    const size_t len = FILE_HDR_SIZE + CHUNK_HDR_SIZE + 10;
+
+    for (unsigned i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        _write_chunk(bad[i].raw, bad[i].stored, len);
+        TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+        TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_read(&_f, _buf, 1));
+        TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_lseek(&_f, 0, SEEK_END));
+        TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+    }
+
+    /* truncated header */
+    _write_chunk(10, 10 | STORED, FILE_HDR_SIZE + CHUNK_HDR_SIZE - 1);
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_read(&_f, _buf, 1));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+
+    /* truncated data, which is only noticed when reading the chunk */
+    _write_chunk(10, 10 | STORED, len - 1);
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(10, hsfile_size(&_f));
+    TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_read(&_f, _buf, 1));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+
+    /* the chunks before a corrupt one are still readable */
+    _write_data(true);
+    off_t off = _second_chunk();
+    TEST_ASSERT(off > 0);
+    _patch(off, "\0\x80", 2);
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(HSFILE_CHUNK_SIZE,
+                          hsfile_read(&_f, _buf, sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_read(&_f, _buf, sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+static void test_hsfile_index(void)
+{
+    _write_index_data();
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    _read_index_data();
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+
+    /* without the index, the chunks are found by their headers */
+    off_t size = _stored_size();
+    TEST_ASSERT(size > 0);
+    _patch(size - 1, "Y", 1);
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    _read_index_data();
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+
+    /* with the index, the header of the second chunk is not needed to find
+     * the chunks from the fourth one on */
+    _write_index_data();
+    off_t off = _second_chunk();
+    TEST_ASSERT(off > 0);
+    _patch(off, "\0\x80", 2);
+    TEST_ASSERT_EQUAL_INT(0, hsfile_open(&_f, FILE_NAME, O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(INDEX_DATA_SIZE, hsfile_size(&_f));
+    off = (off_t)(INDEX_CHUNKS - 1) * HSFILE_CHUNK_SIZE;
+    TEST_ASSERT_EQUAL_INT(off, hsfile_lseek(&_f, off, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(1, hsfile_read(&_f, _buf, 1));
+    TEST_ASSERT_EQUAL_INT((uint8_t)(INDEX_CHUNKS - 1), _buf[0]);
+    TEST_ASSERT_EQUAL_INT(HSFILE_CHUNK_SIZE,
+                          hsfile_lseek(&_f, HSFILE_CHUNK_SIZE, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_read(&_f, _buf, 1));
+    TEST_ASSERT_EQUAL_INT(0, hsfile_close(&_f));
+}
+
+static void test_hsfile_vfs(void)
+{
+    struct stat st;
+    uint8_t block[WRITE_SIZE];
+
+    int fd = hsfile_vfs_open(&_f, FILE_NAME, O_CREAT | O_WRONLY, 0);
+    TEST_ASSERT(fd >= 0);
+    for (uint32_t off = 0; off < DATA_SIZE; off += WRITE_SIZE) {
+        size_t len = DATA_SIZE - off;
+        if (len > WRITE_SIZE) {
+            len = WRITE_SIZE;
+        }
+        for (size_t i = 0; i < len; i++) {
+            block[i] = _byte(off + i, true);
+        }
+        TEST_ASSERT_EQUAL_INT(len, vfs_write(fd, block, len));
+    }
+    TEST_ASSERT_EQUAL_INT(-EBADF, vfs_read(fd, _buf, 1));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+    TEST_ASSERT(_stored_size() < (off_t)DATA_SIZE);
+
+    fd = hsfile_vfs_open(&_f, FILE_NAME, O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(0, vfs_fstat(fd, &st));
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE, st.st_size);
+    TEST_ASSERT_EQUAL_INT(HSFILE_CHUNK_SIZE - 5,
+                          vfs_lseek(fd, HSFILE_CHUNK_SIZE - 5, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(READ_SIZE, vfs_read(fd, _buf, READ_SIZE));
+    TEST_ASSERT(_check(_buf, HSFILE_CHUNK_SIZE - 5, READ_SIZE, true));
+    TEST_ASSERT_EQUAL_INT(HSFILE_CHUNK_SIZE - 5 + READ_SIZE,
+                          vfs_lseek(fd, 0, SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+
+    /* the file is not opened if it is not a compressed file */
+    _write_raw("no hsfile", 9);
+    TEST_ASSERT_EQUAL_INT(-EILSEQ, hsfile_vfs_open(&_f, FILE_NAME,
+                                                   O_RDONLY, 0));
+}
+
+Test *tests_hsfile_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_hsfile_round_trip),
+        new_TestFixture(test_hsfile_stored),
+        new_TestFixture(test_hsfile_lseek),
+        new_TestFixture(test_hsfile_bad_file_header),
+        new_TestFixture(test_hsfile_bad_chunk_header),
+        new_TestFixture(test_hsfile_index),
+        new_TestFixture(test_hsfile_vfs),
+    };
+
+    EMB_UNIT_TESTCALLER(hsfile_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&hsfile_tests;
+}
+
+void tests_hsfile(void)
+{
+    TESTS_RUN(tests_hsfile_tests());
+}
+/** @} */
@@ -19,6 +19,10 @@
 #include "mtd.h"
 #include "board.h"
 
+#ifdef MODULE_MTD_NATIVE
+#include "mtd_native.h"
+#endif
+
 #if MODULE_VFS
 #include <fcntl.h>
 #include <stdio.h>
@@ -251,6 +255,41 @@ static void test_mtd_write_read_flash(void)
 }
 #endif
 
+#if defined(MODULE_MTD_NATIVE) && defined(MTD_0)
+static void test_mtd_native_stats(void)
+{
+    mtd_native_dev_t *native = (mtd_native_dev_t *)dev;
+    const uint8_t buf1[] = {0xf0, 0xf0};
+    const uint8_t buf2[] = {0x0f, 0xf0};
+    uint8_t buf_read[sizeof(buf1)];
+
+    memset(&native->stats, 0, sizeof(native->stats));
+
+    int ret = mtd_write(dev, buf1, 0, sizeof(buf1));
+    TEST_ASSERT_EQUAL_INT(sizeof(buf1), ret);
+    TEST_ASSERT_EQUAL_INT(0, native->stats.write_unerased);
+
+    /* bits can't be set again without an erase */
+    ret = mtd_write(dev, buf2, 0, sizeof(buf2));
+    TEST_ASSERT_EQUAL_INT(sizeof(buf2), ret);
+    TEST_ASSERT_EQUAL_INT(1, native->stats.write_unerased);
+    ret = mtd_read(dev, buf_read, 0, sizeof(buf_read));
+    TEST_ASSERT_EQUAL_INT(sizeof(buf_read), ret);
+    TEST_ASSERT_EQUAL_INT(0x00, buf_read[0]);
+    TEST_ASSERT_EQUAL_INT(0xf0, buf_read[1]);
+
+    ret = mtd_erase(dev, 0, dev->pages_per_sector * dev->page_size * 2);
+    TEST_ASSERT_EQUAL_INT(0, ret);
+
+    TEST_ASSERT_EQUAL_INT(2, native->stats.write_count);
+    TEST_ASSERT_EQUAL_INT(sizeof(buf1) + sizeof(buf2), native->stats.write_bytes);
+    TEST_ASSERT_EQUAL_INT(1, native->stats.read_count);
+    TEST_ASSERT_EQUAL_INT(sizeof(buf_read), native->stats.read_bytes);
+    TEST_ASSERT_EQUAL_INT(1, native->stats.erase_count);
+    TEST_ASSERT_EQUAL_INT(2, native->stats.erase_sectors);
+}
+#endif
+
 #if MODULE_VFS
 static void test_mtd_vfs(void)
 {
@@ -290,6 +329,9 @@ Test *tests_mtd_tests(void)
 #ifdef MTD_0
         new_TestFixture(test_mtd_write_read_flash),
 #endif
+#if defined(MODULE_MTD_NATIVE) && defined(MTD_0)
+        new_TestFixture(test_mtd_native_stats),
+#endif
 #if MODULE_VFS
         new_TestFixture(test_mtd_vfs),
 #endif
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <string.h>
+#include <errno.h>
+
+#include "embUnit.h"
+
+#include "mtd.h"
+#include "mtd_mock.h"
+#include "mtd_cache.h"
+
+#include "tests-mtd_cache.h"
+
+#define SECTOR_COUNT    (8U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (MTD_CACHE_LINE_SIZE / 2)
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+#define FLASH_SIZE      (SECTOR_COUNT * SECTOR_SIZE)
+
+static uint8_t _flash[FLASH_SIZE];
+static mtd_mock_t _mock = MTD_MOCK_INIT(_flash, SECTOR_COUNT, PAGE_PER_SECTOR,
+                                        PAGE_SIZE);
+
+static mtd_cache_t _cache = {
+    .base = { .driver = &mtd_cache_driver },
+    .mtd = &_mock.base,
+};
+
+static mtd_dev_t *dev = &_cache.base;
+
+static void set_up(void)
+{
+    memset(&_cache.lines, 0, sizeof(_cache.lines));
+    _cache.next_addr = 0;
+    for (unsigned i = 0; i < sizeof(_flash); i++) {
+        _flash[i] = i;
+    }
+    mtd_init(dev);
+    _mock.reads = 0;
+    _mock.writes = 0;
+    _mock.erases = 0;
+}
+
+static void test_mtd_cache_init(void)
+{
+    TEST_ASSERT_EQUAL_INT(SECTOR_COUNT, dev->sector_count);
+    TEST_ASSERT_EQUAL_INT(PAGE_PER_SECTOR, dev->pages_per_sector);
+    TEST_ASSERT_EQUAL_INT(PAGE_SIZE, dev->page_size);
+}
+
+static void test_mtd_cache_read(void)
+{
+    uint8_t buf[16];
+
+    /* small sequential reads: one transfer for a line and the next */
+    for (unsigned addr = 0; addr < (2 * MTD_CACHE_LINE_SIZE);
+         addr += sizeof(buf)) {
+        TEST_ASSERT_EQUAL_INT(sizeof(buf), mtd_read(dev, buf, addr, sizeof(buf)));
+        TEST_ASSERT_EQUAL_INT((uint8_t)addr, buf[0]);
+        TEST_ASSERT_EQUAL_INT((uint8_t)(addr + sizeof(buf) - 1), buf[sizeof(buf) - 1]);
+    }
+    TEST_ASSERT_EQUAL_INT((MTD_CACHE_READAHEAD > 0) ? 1 : 2, _mock.reads);
+
+    /* read across lines, cached already */
+    TEST_ASSERT_EQUAL_INT(sizeof(buf),
+                          mtd_read(dev, buf, MTD_CACHE_LINE_SIZE - 8, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT((uint8_t)(MTD_CACHE_LINE_SIZE - 8), buf[0]);
+    TEST_ASSERT_EQUAL_INT((MTD_CACHE_READAHEAD > 0) ? 1 : 2, _mock.reads);
+
+    /* out of bounds */
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_read(dev, buf, FLASH_SIZE - 8, sizeof(buf)));
+}
+
+static void test_mtd_cache_read_bypass(void)
+{
+    static uint8_t buf[2 * MTD_CACHE_LINE_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(sizeof(buf),
+                          mtd_read(dev, buf, SECTOR_SIZE, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, _mock.reads);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, _flash + SECTOR_SIZE, sizeof(buf)));
+    /* nothing was cached */
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, buf, SECTOR_SIZE, 1));
+    TEST_ASSERT_EQUAL_INT(2, _mock.reads);
+}
+
+static void test_mtd_cache_write_back(void)
+{
+    const uint8_t buf1[] = { 0xf0, 0xf0 };
+    const uint8_t buf2[] = { 0x0f, 0xf0 };
+    uint8_t buf_read[sizeof(buf1)];
+
+    memset(_flash, 0xff, SECTOR_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(sizeof(buf1), mtd_write(dev, buf1, 4, sizeof(buf1)));
+    TEST_ASSERT_EQUAL_INT(sizeof(buf2), mtd_write(dev, buf2, 4, sizeof(buf2)));
+    TEST_ASSERT_EQUAL_INT(sizeof(buf1), mtd_write(dev, buf1, PAGE_SIZE, sizeof(buf1)));
+    TEST_ASSERT_EQUAL_INT(0, _mock.writes);
+
+    /* writes clear bits like on the flash */
+    TEST_ASSERT_EQUAL_INT(sizeof(buf_read), mtd_read(dev, buf_read, 4, sizeof(buf_read)));
+    TEST_ASSERT_EQUAL_INT(0x00, buf_read[0]);
+    TEST_ASSERT_EQUAL_INT(0xf0, buf_read[1]);
+    TEST_ASSERT_EQUAL_INT(0xff, _flash[4]);
+
+    /* written back page by page */
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(2, _mock.writes);
+    TEST_ASSERT_EQUAL_INT(0x00, _flash[4]);
+    TEST_ASSERT_EQUAL_INT(0xf0, _flash[5]);
+    TEST_ASSERT_EQUAL_INT(0xf0, _flash[PAGE_SIZE]);
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(2, _mock.writes);
+
+    /* writes must not cross pages */
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_write(dev, buf1, PAGE_SIZE - 1, sizeof(buf1)));
+}
+
+static void test_mtd_cache_evict(void)
+{
+    const uint8_t val = 0x5a;
+    uint8_t buf;
+
+    memset(_flash, 0xff, SECTOR_SIZE);
+    TEST_ASSERT_EQUAL_INT(1, mtd_write(dev, &val, 0, 1));
+
+    /* random reads of other lines evict the dirty one */
+    for (unsigned i = 1; i <= MTD_CACHE_LINES; i++) {
+        TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &buf, i * 2 * MTD_CACHE_LINE_SIZE + 1, 1));
+    }
+    TEST_ASSERT_EQUAL_INT(1, _mock.writes);
+    TEST_ASSERT_EQUAL_INT(val, _flash[0]);
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &buf, 0, 1));
+    TEST_ASSERT_EQUAL_INT(val, buf);
+}
+
+static void test_mtd_cache_erase(void)
+{
+    const uint8_t val = 0;
+    uint8_t buf;
+
+    TEST_ASSERT_EQUAL_INT(1, mtd_write(dev, &val, SECTOR_SIZE + 1, 1));
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_erase(dev, SECTOR_SIZE + 1, SECTOR_SIZE));
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase(dev, SECTOR_SIZE, SECTOR_SIZE));
+    TEST_ASSERT_EQUAL_INT(1, _mock.erases);
+
+    /* the unwritten data was discarded */
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(0, _mock.writes);
+    TEST_ASSERT_EQUAL_INT(1, mtd_read(dev, &buf, SECTOR_SIZE + 1, 1));
+    TEST_ASSERT_EQUAL_INT(0xff, buf);
+}
+
+Test *tests_mtd_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_cache_init),
+        new_TestFixture(test_mtd_cache_read),
+        new_TestFixture(test_mtd_cache_read_bypass),
+        new_TestFixture(test_mtd_cache_write_back),
+        new_TestFixture(test_mtd_cache_evict),
+        new_TestFixture(test_mtd_cache_erase),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_cache_tests, set_up, NULL, fixtures);
+
+    return (Test *)&mtd_cache_tests;
+}
+
+void tests_mtd_cache(void)
+{
+    TESTS_RUN(tests_mtd_cache_tests());
+}
+/** @} */
@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "embUnit.h"
+
+#include "mtd.h"
+#include "mtd_mock.h"
+#include "mtd_kv.h"
+
+#include "tests-mtd_kv.h"
+
+#define SECTOR_COUNT    (5U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (64U)
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+#define FLASH_SIZE      (SECTOR_COUNT * SECTOR_SIZE)
+
+#define KEYS            (4U)
+#define VALUE_SIZE      (12U)
+
+static uint8_t _flash[FLASH_SIZE];
+static unsigned _erases[SECTOR_COUNT];
+static mtd_mock_t _mock = MTD_MOCK_INIT(_flash, SECTOR_COUNT, PAGE_PER_SECTOR,
+                                        PAGE_SIZE);
+
+/* the first sector is not used by the store */
+static mtd_kv_t _kv = {
+    .mtd = &_mock.base,
+    .sector = 1,
+    .sector_count = SECTOR_COUNT - 1,
+};
+
+/* version of each key written last */
+static unsigned _versions[KEYS];
+
+static const char *_key(unsigned num)
+{
+    static char key[] = "key0";
+    key[3] = '0' + num;
+    return key;
+}
+
+static void _value(uint8_t *buf, unsigned key, unsigned version)
+{
+    for (unsigned i = 0; i < VALUE_SIZE; i++) {
+        buf[i] = key * 31 + version + i;
+    }
+}
+
+static int _put(unsigned key, unsigned version)
+{
+    uint8_t buf[VALUE_SIZE];
+    _value(buf, key, version);
+    return mtd_kv_put(&_kv, _key(key), buf, sizeof(buf));
+}
+
+/* checks that a key has the given version */
+static bool _check(unsigned key, unsigned version)
+{
+    uint8_t buf[VALUE_SIZE + 1];
+    uint8_t expected[VALUE_SIZE];
+
+    _value(expected, key, version);
+    return (mtd_kv_get(&_kv, _key(key), buf, sizeof(buf)) == VALUE_SIZE)
+           && (memcmp(buf, expected, VALUE_SIZE) == 0);
+}
+
+static void set_up(void)
+{
+    memset(_flash, 0, sizeof(_flash));
+    memset(_erases, 0, sizeof(_erases));
+    _mock.sector_erases = _erases;
+    memset(_versions, 0, sizeof(_versions));
+    _mock.budget = -1;
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+}
+
+static void test_mtd_kv_put_get(void)
+{
+    char buf[8];
+
+    /* no store found, the sectors of the store were erased */
+    for (unsigned i = 0; i < FLASH_SIZE; i++) {
+        if ((i % SECTOR_SIZE) < 8) {
+            continue;
+        }
+        TEST_ASSERT_EQUAL_INT((i < SECTOR_SIZE) ? 0 : 0xff, _flash[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOENT, mtd_kv_get(&_kv, "a", buf, sizeof(buf)));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "a", "1234", 4));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "b", "", 0));
+    TEST_ASSERT_EQUAL_INT(4, mtd_kv_get(&_kv, "a", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, "1234", 4));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_get(&_kv, "b", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_kv_get(&_kv, "a", buf, 3));
+
+    /* the newest value is returned */
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "a", "xy", 2));
+    TEST_ASSERT_EQUAL_INT(2, mtd_kv_get(&_kv, "a", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, "xy", 2));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, mtd_kv_get(&_kv, "ab", buf, sizeof(buf)));
+
+    /* a lookup reads the header, the key and the value */
+    _mock.reads = 0;
+    TEST_ASSERT_EQUAL_INT(2, mtd_kv_get(&_kv, "a", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(3, _mock.reads);
+}
+
+static void test_mtd_kv_delete(void)
+{
+    char buf[8];
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "a", "1", 1));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "b", "2", 1));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_delete(&_kv, "a"));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, mtd_kv_delete(&_kv, "a"));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, mtd_kv_get(&_kv, "a", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, mtd_kv_get(&_kv, "b", buf, sizeof(buf)));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, mtd_kv_get(&_kv, "a", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, mtd_kv_get(&_kv, "b", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT('2', buf[0]);
+}
+
+static void test_mtd_kv_limits(void)
+{
+    static const uint8_t big[SECTOR_SIZE] = { 0 };
+    char long_key[MTD_KV_KEY_MAX + 2];
+    char key[] = "k00";
+
+    memset(long_key, 'k', MTD_KV_KEY_MAX + 1);
+    long_key[MTD_KV_KEY_MAX + 1] = '\0';
+
+    TEST_ASSERT_EQUAL_INT(-EINVAL, mtd_kv_put(&_kv, "", "1", 1));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, mtd_kv_put(&_kv, long_key, "1", 1));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, mtd_kv_put(&_kv, "a", big, sizeof(big)));
+
+    /* the index is full */
+    for (unsigned i = 0; i < (MTD_KV_INDEX_SIZE * 3) / 4; i++) {
+        key[1] = '0' + i / 10;
+        key[2] = '0' + i % 10;
+        TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, key, "", 0));
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOMEM, mtd_kv_put(&_kv, "a", "", 0));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, key, "1", 1));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_delete(&_kv, key));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "a", "", 0));
+}
+
+static void test_mtd_kv_full(void)
+{
+    /* two entries fit into a sector, and the values of two sectors into the
+     * store */
+    static const uint8_t value[(SECTOR_SIZE / 2) - 17] = { 0 };
+    char buf[sizeof(value)];
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "a", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "b", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "c", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "d", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, mtd_kv_put(&_kv, "e", value, sizeof(value)));
+
+    /* existing keys can still be updated */
+    for (unsigned i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "a", value, sizeof(value)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_delete(&_kv, "b"));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "e", value, sizeof(value)));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, mtd_kv_get(&_kv, "b", buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(sizeof(value), mtd_kv_get(&_kv, "e", buf, sizeof(buf)));
+}
+
+static void test_mtd_kv_rotate(void)
+{
+    /* a rarely updated key is moved along with the others */
+    TEST_ASSERT_EQUAL_INT(0, _put(KEYS - 1, 0));
+    for (unsigned i = 0; i < 100; i++) {
+        unsigned key = i % (KEYS - 1);
+        TEST_ASSERT_EQUAL_INT(0, _put(key, i));
+        _versions[key] = i;
+    }
+    for (unsigned i = 0; i < KEYS; i++) {
+        TEST_ASSERT(_check(i, _versions[i]));
+    }
+
+    /* all sectors of the store wear evenly */
+    TEST_ASSERT_EQUAL_INT(0, _erases[0]);
+    for (unsigned i = 2; i < SECTOR_COUNT; i++) {
+        TEST_ASSERT(_erases[i] >= _erases[1] - 1);
+        TEST_ASSERT(_erases[i] <= _erases[1] + 1);
+    }
+    TEST_ASSERT(_erases[1] > 2);
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+    for (unsigned i = 0; i < KEYS; i++) {
+        TEST_ASSERT(_check(i, _versions[i]));
+    }
+}
+
+static void test_mtd_kv_power_loss(void)
+{
+    static uint8_t saved[FLASH_SIZE];
+
+    for (unsigned i = 0; i < KEYS; i++) {
+        TEST_ASSERT_EQUAL_INT(0, _put(i, 0));
+    }
+
+    /* every write of the updates, including the ones of the garbage
+     * collection, is interrupted once */
+    for (unsigned i = 1; i < 40; i++) {
+        unsigned key = i % KEYS;
+        int res;
+
+        memcpy(saved, _flash, sizeof(_flash));
+        for (int budget = 0; ; budget++) {
+            _mock.budget = budget;
+            res = _put(key, i);
+            _mock.budget = -1;
+            if (res == 0) {
+                break;
+            }
+            TEST_ASSERT_EQUAL_INT(-EIO, res);
+
+            /* the old value is kept */
+            TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+            for (unsigned j = 0; j < KEYS; j++) {
+                TEST_ASSERT(_check(j, _versions[j]));
+            }
+            memcpy(_flash, saved, sizeof(_flash));
+            TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+        }
+        _versions[key] = i;
+
+        /* writing goes on behind an interrupted write */
+        memcpy(_flash, saved, sizeof(_flash));
+        _mock.budget = 3;
+        TEST_ASSERT_EQUAL_INT(-EIO, _put(key, i));
+        _mock.budget = -1;
+        TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+        TEST_ASSERT_EQUAL_INT(0, _put(key, i));
+        TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+        for (unsigned j = 0; j < KEYS; j++) {
+            TEST_ASSERT(_check(j, _versions[j]));
+        }
+    }
+}
+
+static void test_mtd_kv_write_error(void)
+{
+    /* the write fails before the header, within it and behind it */
+    static const int budgets[] = { 0, 3, 10 };
+
+    for (unsigned i = 0; i < sizeof(budgets) / sizeof(budgets[0]); i++) {
+        unsigned key = i % KEYS;
+
+        TEST_ASSERT_EQUAL_INT(0, _put(key, 2 * i));
+        _versions[key] = 2 * i;
+        _mock.budget = budgets[i];
+        TEST_ASSERT_EQUAL_INT(-EIO, _put(key, (2 * i) + 1));
+        _mock.budget = -1;
+
+        /* the store is used on without being initialized again */
+        for (unsigned j = 0; j < KEYS; j++) {
+            TEST_ASSERT_EQUAL_INT(0, _put(j, (2 * i) + j + 100));
+            _versions[j] = (2 * i) + j + 100;
+        }
+        TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+        for (unsigned j = 0; j < KEYS; j++) {
+            TEST_ASSERT(_check(j, _versions[j]));
+        }
+    }
+}
+
+static void test_mtd_kv_gc_power_loss(void)
+{
+    /* entries of half a sector, and the header of a sector */
+    static uint8_t value[(SECTOR_SIZE / 2) - 17];
+    const int entry = (SECTOR_SIZE / 2) - 8;
+    const int sector_hdr = 8;
+    uint8_t buf[sizeof(value)];
+
+    /* a and b fill the first sector, c is updated until the head is in the
+     * sector before it */
+    memset(value, 'a', sizeof(value));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "a", value, sizeof(value)));
+    memset(value, 'b', sizeof(value));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "b", value, sizeof(value)));
+    memset(value, 'c', sizeof(value));
+    for (unsigned i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "c", value, sizeof(value)));
+    }
+
+    /* the power is lost while copying b, and again while copying a when
+     * collecting is resumed */
+    _mock.budget = sector_hdr + entry + (entry / 2);
+    TEST_ASSERT_EQUAL_INT(-EIO, mtd_kv_put(&_kv, "c", value, sizeof(value)));
+    _mock.budget = sector_hdr + (entry / 2);
+    TEST_ASSERT_EQUAL_INT(-EIO, mtd_kv_init(&_kv));
+    _mock.budget = -1;
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+
+    for (const char *key = "abc"; *key; key++) {
+        char name[] = { *key, '\0' };
+        memset(value, *key, sizeof(value));
+        TEST_ASSERT_EQUAL_INT(sizeof(value),
+                              mtd_kv_get(&_kv, name, buf, sizeof(buf)));
+        TEST_ASSERT_EQUAL_INT(0, memcmp(buf, value, sizeof(value)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_put(&_kv, "c", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_kv_init(&_kv));
+    TEST_ASSERT_EQUAL_INT(sizeof(value), mtd_kv_get(&_kv, "c", buf, sizeof(buf)));
+}
+
+Test *tests_mtd_kv_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_kv_put_get),
+        new_TestFixture(test_mtd_kv_delete),
+        new_TestFixture(test_mtd_kv_limits),
+        new_TestFixture(test_mtd_kv_full),
+        new_TestFixture(test_mtd_kv_rotate),
+        new_TestFixture(test_mtd_kv_power_loss),
+        new_TestFixture(test_mtd_kv_write_error),
+        new_TestFixture(test_mtd_kv_gc_power_loss),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_kv_tests, set_up, NULL, fixtures);
+
+    return (Test *)&mtd_kv_tests;
+}
+
+void tests_mtd_kv(void)
+{
+    TESTS_RUN(tests_mtd_kv_tests());
+}
+/** @} */
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <string.h>
+#include <errno.h>
+
+#include "embUnit.h"
+
+#include "mtd.h"
+#include "mtd_mock.h"
+#include "mtd_log.h"
+
+#include "tests-mtd_log.h"
+
+#define SECTOR_COUNT    (5U)
+#define PAGE_PER_SECTOR (4U)
+#define PAGE_SIZE       (64U)
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+#define FLASH_SIZE      (SECTOR_COUNT * SECTOR_SIZE)
+
+/* two records fit into a page */
+#define RECORD_SIZE     (20U)
+#define RECORDS_PER_SECTOR  (2 * PAGE_PER_SECTOR)
+
+static uint8_t _flash[FLASH_SIZE];
+static mtd_mock_t _mock = MTD_MOCK_INIT(_flash, SECTOR_COUNT, PAGE_PER_SECTOR,
+                                        PAGE_SIZE);
+
+/* the first sector is not used by the log */
+static mtd_log_t _log = {
+    .mtd = &_mock.base,
+    .sector = 1,
+    .sector_count = SECTOR_COUNT - 1,
+};
+
+static void _record(uint8_t *buf, unsigned num)
+{
+    for (unsigned i = 0; i < RECORD_SIZE; i++) {
+        buf[i] = num + i;
+    }
+}
+
+static void _append(unsigned first, unsigned num)
+{
+    uint8_t buf[RECORD_SIZE];
+    for (unsigned i = first; i < (first + num); i++) {
+        _record(buf, i);
+        TEST_ASSERT_EQUAL_INT(0, mtd_log_append(&_log, buf, sizeof(buf)));
+    }
+}
+
+/* reads records from cur until the end, returns the number or -1 if a
+ * record is not the expected one */
+static int _check(mtd_log_cursor_t *cur, unsigned first)
+{
+    uint8_t buf[RECORD_SIZE + 1];
+    uint8_t expected[RECORD_SIZE];
+    int num = 0;
+    int res;
+
+    while ((res = mtd_log_read(&_log, cur, buf, sizeof(buf))) > 0) {
+        _record(expected, first + num);
+        if ((res != RECORD_SIZE) || memcmp(buf, expected, RECORD_SIZE)) {
+            return -1;
+        }
+        num++;
+    }
+    return (res == 0) ? num : -1;
+}
+
+/* reads records 0 to num - 1 from the start of the log, except those of the
+ * third page, which failed to be written */
+static void _check_write_error(unsigned num)
+{
+    mtd_log_cursor_t cur;
+    uint8_t buf[RECORD_SIZE];
+    uint8_t expected[RECORD_SIZE];
+
+    mtd_log_cursor_init(&_log, &cur);
+    for (unsigned i = 0; i < num; i++) {
+        if ((i == 4) || (i == 5)) {
+            continue;
+        }
+        TEST_ASSERT_EQUAL_INT(RECORD_SIZE,
+                              mtd_log_read(&_log, &cur, buf, sizeof(buf)));
+        _record(expected, i);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(buf, expected, sizeof(buf)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_read(&_log, &cur, buf, sizeof(buf)));
+}
+
+static void set_up(void)
+{
+    memset(_flash, 0, sizeof(_flash));
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    _mock.reads = 0;
+    _mock.writes = 0;
+    _mock.erases = 0;
+}
+
+static void test_mtd_log_format(void)
+{
+    mtd_log_cursor_t cur;
+
+    /* no log found, the sectors of the log were erased */
+    for (unsigned i = 0; i < FLASH_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT((i < SECTOR_SIZE) ? 0 : 0xff, _flash[i]);
+    }
+    mtd_log_cursor_init(&_log, &cur);
+    TEST_ASSERT_EQUAL_INT(0, _check(&cur, 0));
+
+    /* an empty log is not formatted again */
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    TEST_ASSERT_EQUAL_INT(0, _mock.erases);
+    _append(0, 1);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    mtd_log_cursor_init(&_log, &cur);
+    TEST_ASSERT_EQUAL_INT(1, _check(&cur, 0));
+}
+
+static void test_mtd_log_append(void)
+{
+    mtd_log_cursor_t cur;
+    uint8_t buf[RECORD_SIZE] = { 0 };
+
+    TEST_ASSERT_EQUAL_INT(-EINVAL, mtd_log_append(&_log, buf, 0));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, mtd_log_append(&_log, buf,
+                          PAGE_SIZE - MTD_LOG_RECORD_OVERHEAD + 1));
+
+    /* records are collected per page */
+    _append(0, 5);
+    TEST_ASSERT_EQUAL_INT(2, _mock.writes);
+
+    /* buffered records are read as well */
+    mtd_log_cursor_init(&_log, &cur);
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_log_read(&_log, &cur, buf, 1));
+    TEST_ASSERT_EQUAL_INT(5, _check(&cur, 0));
+
+    /* new records show up at the cursor */
+    _append(5, 1);
+    TEST_ASSERT_EQUAL_INT(1, _check(&cur, 5));
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(3, _mock.writes);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(3, _mock.writes);
+    TEST_ASSERT_EQUAL_INT(0, _check(&cur, 6));
+}
+
+static void test_mtd_log_recover(void)
+{
+    mtd_log_cursor_t cur;
+
+    /* the flushed page is only partially used */
+    _append(0, 5);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    _append(5, 2);
+
+    /* unflushed records are lost */
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    mtd_log_cursor_init(&_log, &cur);
+    TEST_ASSERT_EQUAL_INT(5, _check(&cur, 0));
+
+    /* the log continues in the next page */
+    _append(5, 4);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    mtd_log_cursor_init(&_log, &cur);
+    TEST_ASSERT_EQUAL_INT(9, _check(&cur, 0));
+}
+
+static void test_mtd_log_recover_reads(void)
+{
+    /* fill two sectors and a half */
+    _append(0, 2 * RECORDS_PER_SECTOR + 4);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    _mock.reads = 0;
+    _mock.erases = 0;
+
+    /* one read per sector header, two to find the page and the check of the
+     * sector ahead */
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    TEST_ASSERT_EQUAL_INT(4 + 2 + 2 + PAGE_PER_SECTOR, _mock.reads);
+    TEST_ASSERT_EQUAL_INT(0, _mock.erases);
+}
+
+static void test_mtd_log_wrap(void)
+{
+    mtd_log_cursor_t cur, old;
+    uint8_t buf[RECORD_SIZE];
+    unsigned total = 10 * RECORDS_PER_SECTOR + 3;
+
+    mtd_log_cursor_init(&_log, &old);
+    _append(0, total);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+
+    /* all sectors but the one ahead of the head are used */
+    int kept = 2 * RECORDS_PER_SECTOR + 3;
+    mtd_log_cursor_init(&_log, &cur);
+    TEST_ASSERT_EQUAL_INT(kept, _check(&cur, total - kept));
+
+    /* a cursor to dropped records moves to the oldest one */
+    TEST_ASSERT_EQUAL_INT(-ESTALE, mtd_log_read(&_log, &old, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(kept, _check(&old, total - kept));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    mtd_log_cursor_init(&_log, &cur);
+    TEST_ASSERT_EQUAL_INT(kept, _check(&cur, total - kept));
+    _append(total, 1);
+    TEST_ASSERT_EQUAL_INT(1, _check(&cur, total));
+
+    /* the first sector of the device was never touched */
+    for (unsigned i = 0; i < SECTOR_SIZE; i++) {
+        TEST_ASSERT_EQUAL_INT(0, _flash[i]);
+    }
+}
+
+static void test_mtd_log_corrupt(void)
+{
+    mtd_log_cursor_t cur;
+    uint8_t buf[RECORD_SIZE];
+    uint8_t expected[RECORD_SIZE];
+
+    _append(0, RECORDS_PER_SECTOR);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+
+    /* damage the first record of the second page, the page is skipped */
+    _flash[SECTOR_SIZE + PAGE_SIZE + 6] ^= 1;
+    mtd_log_cursor_init(&_log, &cur);
+    for (unsigned i = 0; i < RECORDS_PER_SECTOR; i++) {
+        if ((i == 2) || (i == 3)) {
+            continue;
+        }
+        TEST_ASSERT_EQUAL_INT(RECORD_SIZE,
+                              mtd_log_read(&_log, &cur, buf, sizeof(buf)));
+        _record(expected, i);
+        TEST_ASSERT_EQUAL_INT(0, memcmp(buf, expected, sizeof(buf)));
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_read(&_log, &cur, buf, sizeof(buf)));
+}
+
+static void test_mtd_log_write_error(void)
+{
+    /* the third page is not written */
+    _append(0, 6);
+    _mock.budget = 0;
+    TEST_ASSERT_EQUAL_INT(-EIO, mtd_log_flush(&_log));
+    _mock.budget = -1;
+
+    /* the log continues without a gap in front of written pages */
+    _append(6, 2);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    _check_write_error(8);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    _check_write_error(8);
+
+    _append(8, 4);
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_flush(&_log));
+    TEST_ASSERT_EQUAL_INT(0, mtd_log_init(&_log));
+    _check_write_error(12);
+}
+
+Test *tests_mtd_log_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_log_format),
+        new_TestFixture(test_mtd_log_append),
+        new_TestFixture(test_mtd_log_recover),
+        new_TestFixture(test_mtd_log_recover_reads),
+        new_TestFixture(test_mtd_log_wrap),
+        new_TestFixture(test_mtd_log_corrupt),
+        new_TestFixture(test_mtd_log_write_error),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_log_tests, set_up, NULL, fixtures);
+
+    return (Test *)&mtd_log_tests;
+}
+
+void tests_mtd_log(void)
+{
+    TESTS_RUN(tests_mtd_log_tests());
+}
+/** @} */
@@ -0,0 +1,378 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ *
+ * The tests run against a stub DNS server on the loopback address.
+ */
+#include <errno.h>
+#include <string.h>
+
+#include "embUnit.h"
+
+#include "byteorder.h"
+#include "net/ipv6/addr.h"
+#include "net/sock/dns.h"
+#include "net/sock/udp.h"
+#include "thread.h"
+#include "xtimer.h"
+
+#include "tests-sock_dns.h"
+
+#define TEST_PORT           (10053U)
+#define TEST_TTL            (300U)
+#define TEST_NEG_MINIMUM    (30U)
+
+#define TEST_AAAA           { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, \
+                              0, 0, 0, 0, 0, 0, 0, 0x01 }
+#define TEST_A              { 192, 0, 2, 1 }
+
+#define RCODE_NXDOMAIN      (3U)
+
+typedef struct {
+    const char *name;
+    uint16_t type;
+    uint8_t rcode;
+    uint32_t ttl;
+    uint8_t addr_len;               /* 0 for no answer */
+    uint8_t addr[16];
+} _record_t;
+
+static const _record_t _records[] = {
+    { "a.example", DNS_TYPE_AAAA, 0, TEST_TTL, 16, TEST_AAAA },
+    { "a.example", DNS_TYPE_A, 0, TEST_TTL, 4, TEST_A },
+    { "v4.example", DNS_TYPE_AAAA, 0, 0, 0, { 0 } },
+    { "v4.example", DNS_TYPE_A, 0, TEST_TTL, 4, TEST_A },
+    { "ttl0.example", DNS_TYPE_AAAA, 0, 0, 16, TEST_AAAA },
+    { "nx.example", DNS_TYPE_AAAA, RCODE_NXDOMAIN, 0, 0, { 0 } },
+};
+
+static char _stack[THREAD_STACKSIZE_DEFAULT];
+static kernel_pid_t _server_pid = KERNEL_PID_UNDEF;
+static sock_udp_t _server_sock;
+static uint8_t _server_buf[256];
+static unsigned _queries;
+static uint16_t _ids[2];
+
+static unsigned _async_calls;
+static int _async_res[2];
+static uint8_t _async_addr[2][16];
+
+static const _record_t *_find_record(const uint8_t *qname, uint16_t type)
+{
+    char name[SOCK_DNS_MAX_NAME_LEN + 1];
+    unsigned pos = 0;
+
+    /* decode "\1a\7example\0" to "a.example" */
+    while ((*qname != 0) && ((pos + *qname + 1) < sizeof(name))) {
+        if (pos > 0) {
+            name[pos++] = '.';
+        }
+        memcpy(&name[pos], qname + 1, *qname);
+        pos += *qname;
+        qname += *qname + 1;
+    }
+    name[pos] = '\0';
+    for (unsigned i = 0; i < sizeof(_records) / sizeof(_records[0]); i++) {
+        if ((_records[i].type == type) &&
+            (strcmp(_records[i].name, name) == 0)) {
+            return &_records[i];
+        }
+    }
+    return NULL;
+}
+
+static size_t _put_rr(uint8_t *buf, uint16_t type, uint32_t ttl,
+                      const void *rdata, uint16_t rdlength)
+{
+    network_uint16_t tmp16;
+    network_uint32_t tmp32;
+    size_t len = 0;
+
+    /* name: pointer to query name */
+    buf[len++] = 0xc0;
+    buf[len++] = sizeof(sock_dns_hdr_t);
+    tmp16 = byteorder_htons(type);
+    memcpy(&buf[len], &tmp16, sizeof(tmp16));
+    len += sizeof(tmp16);
+    tmp16 = byteorder_htons(DNS_CLASS_IN);
+    memcpy(&buf[len], &tmp16, sizeof(tmp16));
+    len += sizeof(tmp16);
+    tmp32 = byteorder_htonl(ttl);
+    memcpy(&buf[len], &tmp32, sizeof(tmp32));
+    len += sizeof(tmp32);
+    tmp16 = byteorder_htons(rdlength);
+    memcpy(&buf[len], &tmp16, sizeof(tmp16));
+    len += sizeof(tmp16);
+    memcpy(&buf[len], rdata, rdlength);
+    return len + rdlength;
+}
+
+static void *_server(void *arg)
+{
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = TEST_PORT };
+
+    (void)arg;
+    sock_udp_create(&_server_sock, &local, NULL, 0);
+    while (1) {
+        sock_dns_hdr_t *hdr = (sock_dns_hdr_t *)_server_buf;
+        const _record_t *record;
+        sock_udp_ep_t remote;
+        network_uint16_t type;
+        size_t qlen, len;
+        ssize_t res;
+
+        res = sock_udp_recv(&_server_sock, _server_buf, sizeof(_server_buf),
+                            SOCK_NO_TIMEOUT, &remote);
+        if (res <= (ssize_t)sizeof(sock_dns_hdr_t)) {
+            continue;
+        }
+        _ids[_queries % 2] = hdr->id;
+        _queries++;
+        qlen = strlen((char *)hdr->payload) + 1;
+        memcpy(&type, &hdr->payload[qlen], sizeof(type));
+        record = _find_record(hdr->payload, byteorder_ntohs(type));
+        /* reply keeps the query's header and question */
+        len = sizeof(sock_dns_hdr_t) + qlen + 4;
+        hdr->flags = byteorder_htons(0x8180 |
+                                     ((record) ? record->rcode
+                                               : RCODE_NXDOMAIN)).u16;
+        hdr->ancount = 0;
+        hdr->nscount = 0;
+        hdr->arcount = 0;
+        if ((record != NULL) && (record->addr_len > 0)) {
+            hdr->ancount = byteorder_htons(1).u16;
+            len += _put_rr(&_server_buf[len], record->type, record->ttl,
+                           record->addr, record->addr_len);
+        }
+        else if ((record != NULL) && (record->rcode == RCODE_NXDOMAIN)) {
+            /* root MNAME and RNAME, serial, refresh, retry, expire, minimum */
+            uint8_t soa[22] = { 0 };
+
+            soa[21] = TEST_NEG_MINIMUM;
+            hdr->nscount = byteorder_htons(1).u16;
+            len += _put_rr(&_server_buf[len], DNS_TYPE_SOA, TEST_TTL,
+                           soa, sizeof(soa));
+        }
+        sock_udp_send(&_server_sock, _server_buf, len, &remote);
+    }
+    return NULL;
+}
+
+static void _async_cb(int res, const void *addr, void *arg)
+{
+    unsigned idx = (uintptr_t)arg;
+
+    _async_res[idx] = res;
+    if (res > 0) {
+        memcpy(_async_addr[idx], addr, res);
+    }
+    _async_calls++;
+}
+
+static void _wait_for_async(unsigned calls)
+{
+    /* replies from the stub server arrive well within one second */
+    for (unsigned i = 0; (i < 100) && (_async_calls < calls); i++) {
+        xtimer_usleep(10000);
+    }
+}
+
+static void set_up(void)
+{
+    if (_server_pid == KERNEL_PID_UNDEF) {
+        _server_pid = thread_create(_stack, sizeof(_stack),
+                                    THREAD_PRIORITY_MAIN - 1,
+                                    THREAD_CREATE_STACKTEST, _server, NULL,
+                                    "dns_stub");
+    }
+    sock_dns_server.family = AF_INET6;
+    sock_dns_server.port = TEST_PORT;
+    sock_dns_server.netif = SOCK_ADDR_ANY_NETIF;
+    memcpy(sock_dns_server.addr.ipv6, &ipv6_addr_loopback,
+           sizeof(sock_dns_server.addr.ipv6));
+    sock_dns_cache_flush();
+    _queries = 0;
+    _async_calls = 0;
+    memset(_async_res, 0, sizeof(_async_res));
+}
+
+static void tear_down(void)
+{
+    memset(&sock_dns_server, 0, sizeof(sock_dns_server));
+}
+
+static void test_sock_dns_query__no_server(void)
+{
+    uint8_t addr[16];
+
+    sock_dns_server.port = 0;
+    TEST_ASSERT_EQUAL_INT(-ECONNREFUSED,
+                          sock_dns_query("a.example", addr, AF_INET6));
+}
+
+static void test_sock_dns_query__aaaa(void)
+{
+    static const uint8_t exp[] = TEST_AAAA;
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(sizeof(exp),
+                          sock_dns_query("a.example", addr, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(exp, addr, sizeof(exp)));
+    TEST_ASSERT_EQUAL_INT(1, _queries);
+}
+
+static void test_sock_dns_query__a(void)
+{
+    static const uint8_t exp[] = TEST_A;
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(sizeof(exp),
+                          sock_dns_query("a.example", addr, AF_INET));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(exp, addr, sizeof(exp)));
+    TEST_ASSERT_EQUAL_INT(1, _queries);
+}
+
+static void test_sock_dns_query__cached(void)
+{
+    static const uint8_t exp[] = TEST_AAAA;
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(sizeof(exp),
+                          sock_dns_query("a.example", addr, AF_INET6));
+    memset(addr, 0, sizeof(addr));
+    TEST_ASSERT_EQUAL_INT(sizeof(exp),
+                          sock_dns_query("a.example", addr, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(exp, addr, sizeof(exp)));
+    TEST_ASSERT_EQUAL_INT(1, _queries);
+}
+
+static void test_sock_dns_query__ttl0_not_cached(void)
+{
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(16, sock_dns_query("ttl0.example", addr, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(16, sock_dns_query("ttl0.example", addr, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(2, _queries);
+}
+
+static void test_sock_dns_query__nxdomain_cached(void)
+{
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(-ENOENT,
+                          sock_dns_query("nx.example", addr, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(-ENOENT,
+                          sock_dns_query("nx.example", addr, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(1, _queries);
+}
+
+static void test_sock_dns_query__unspec_prefers_aaaa(void)
+{
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(16, sock_dns_query("a.example", addr, AF_UNSPEC));
+}
+
+static void test_sock_dns_query__unspec_parallel(void)
+{
+    static const uint8_t exp[] = TEST_A;
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(sizeof(exp),
+                          sock_dns_query("v4.example", addr, AF_UNSPEC));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(exp, addr, sizeof(exp)));
+    /* one query per type, with distinct IDs */
+    TEST_ASSERT_EQUAL_INT(2, _queries);
+    TEST_ASSERT(_ids[0] != _ids[1]);
+    /* both the missing AAAA record and the A record are cached */
+    TEST_ASSERT_EQUAL_INT(sizeof(exp),
+                          sock_dns_query("v4.example", addr, AF_UNSPEC));
+    TEST_ASSERT_EQUAL_INT(2, _queries);
+}
+
+static void test_sock_dns_query__ENOSPC(void)
+{
+    static const char name[] = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+                               "aaaaaaaaaaaaaaaaaaaaaaaaa.example";
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, sock_dns_query(name, addr, AF_INET6));
+}
+
+static void test_sock_dns_query_async__parallel(void)
+{
+    static const uint8_t exp6[] = TEST_AAAA;
+    static const uint8_t exp4[] = TEST_A;
+
+    TEST_ASSERT_EQUAL_INT(0, sock_dns_query_async("a.example", AF_INET6,
+                                                  _async_cb, (void *)0));
+    TEST_ASSERT_EQUAL_INT(0, sock_dns_query_async("v4.example", AF_INET,
+                                                  _async_cb, (void *)1));
+    _wait_for_async(2);
+    TEST_ASSERT_EQUAL_INT(2, _async_calls);
+    TEST_ASSERT_EQUAL_INT(sizeof(exp6), _async_res[0]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(exp6, _async_addr[0], sizeof(exp6)));
+    TEST_ASSERT_EQUAL_INT(sizeof(exp4), _async_res[1]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(exp4, _async_addr[1], sizeof(exp4)));
+}
+
+static void test_sock_dns_query_async__nxdomain(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, sock_dns_query_async("nx.example", AF_INET6,
+                                                  _async_cb, (void *)0));
+    _wait_for_async(1);
+    TEST_ASSERT_EQUAL_INT(1, _async_calls);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _async_res[0]);
+}
+
+static void test_sock_dns_query_async__cached(void)
+{
+    uint8_t addr[16];
+
+    TEST_ASSERT_EQUAL_INT(16, sock_dns_query("a.example", addr, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(0, sock_dns_query_async("a.example", AF_INET6,
+                                                  _async_cb, (void *)0));
+    /* answered from cache before sock_dns_query_async() returned */
+    TEST_ASSERT_EQUAL_INT(1, _async_calls);
+    TEST_ASSERT_EQUAL_INT(16, _async_res[0]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(addr, _async_addr[0], sizeof(addr)));
+    TEST_ASSERT_EQUAL_INT(1, _queries);
+}
+
+Test *tests_sock_dns_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_sock_dns_query__no_server),
+        new_TestFixture(test_sock_dns_query__aaaa),
+        new_TestFixture(test_sock_dns_query__a),
+        new_TestFixture(test_sock_dns_query__cached),
+        new_TestFixture(test_sock_dns_query__ttl0_not_cached),
+        new_TestFixture(test_sock_dns_query__nxdomain_cached),
+        new_TestFixture(test_sock_dns_query__unspec_prefers_aaaa),
+        new_TestFixture(test_sock_dns_query__unspec_parallel),
+        new_TestFixture(test_sock_dns_query__ENOSPC),
+        new_TestFixture(test_sock_dns_query_async__parallel),
+        new_TestFixture(test_sock_dns_query_async__nxdomain),
+        new_TestFixture(test_sock_dns_query_async__cached),
+    };
+
+    EMB_UNIT_TESTCALLER(sock_dns_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&sock_dns_tests;
+}
+
+void tests_sock_dns(void)
+{
+    TESTS_RUN(tests_sock_dns_tests());
+}
+/** @} */
@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -55,6 +56,30 @@ static const constfs_t fs_data = {
     .nfiles = sizeof(_files) / sizeof(_files[0]),
 };
 
+/* djb2 hashes of the paths, "/test.txt" sorts before "/data.bin" */
+static const uint32_t _hashes[] = {
+    0xd6134982,
+    0xdf0a10f5,
+};
+
+static const constfs_t fs_data_indexed = {
+    .files = _files,
+    .nfiles = sizeof(_files) / sizeof(_files[0]),
+    .hashes = _hashes,
+};
+
+/* all paths have the same hash, the files are told apart by their path */
+static const uint32_t _same_hashes[] = {
+    0xdf0a10f5,
+    0xdf0a10f5,
+};
+
+static const constfs_t fs_data_same_hashes = {
+    .files = _files,
+    .nfiles = sizeof(_files) / sizeof(_files[0]),
+    .hashes = _same_hashes,
+};
+
 static vfs_mount_t _test_vfs_mount_invalid_mount = {
     .mount_point = "test",
     .fs = &constfs_file_system,
@@ -67,6 +92,18 @@ static vfs_mount_t _test_vfs_mount = {
     .private_data = (void *)&fs_data,
 };
 
+static vfs_mount_t _test_vfs_mount_indexed = {
+    .mount_point = "/idx",
+    .fs = &constfs_file_system,
+    .private_data = (void *)&fs_data_indexed,
+};
+
+static vfs_mount_t _test_vfs_mount_same_hashes = {
+    .mount_point = "/same",
+    .fs = &constfs_file_system,
+    .private_data = (void *)&fs_data_same_hashes,
+};
+
 static void test_vfs_mount_umount(void)
 {
     int res;
@@ -171,6 +208,82 @@ static void test_vfs_constfs_read_lseek(void)
     TEST_ASSERT_EQUAL_INT(0, res);
 }
 
+static void test_vfs_constfs_index(void)
+{
+    struct stat stat_buf;
+    int res;
+    res = vfs_mount(&_test_vfs_mount_indexed);
+    TEST_ASSERT_EQUAL_INT(0, res);
+    res = vfs_mount(&_test_vfs_mount_same_hashes);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_stat("/idx/test.txt", &stat_buf);
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(sizeof(str_data), stat_buf.st_size);
+    res = vfs_stat("/idx/data.bin", &stat_buf);
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(sizeof(bin_data), stat_buf.st_size);
+    res = vfs_stat("/idx/data.bi", &stat_buf);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, res);
+
+    res = vfs_stat("/same/test.txt", &stat_buf);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, res);
+    res = vfs_stat("/same/data.bin", &stat_buf);
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(sizeof(bin_data), stat_buf.st_size);
+
+    int fd = vfs_open("/idx/data.bin", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+    uint8_t buf[4];
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), vfs_read(fd, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, bin_data, sizeof(buf)));
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_umount(&_test_vfs_mount_same_hashes);
+    TEST_ASSERT_EQUAL_INT(0, res);
+    res = vfs_umount(&_test_vfs_mount_indexed);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+
+static void test_vfs_constfs_mmap_pread(void)
+{
+    int res;
+    res = vfs_mount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    int fd = vfs_open("/test/data.bin", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+
+    const void *data = NULL;
+    TEST_ASSERT_EQUAL_INT(sizeof(bin_data), vfs_mmap(fd, &data));
+    TEST_ASSERT(data == bin_data);
+    TEST_ASSERT_EQUAL_INT(-EFAULT, vfs_mmap(fd, NULL));
+    TEST_ASSERT_EQUAL_INT(-EBADF, vfs_mmap(VFS_MAX_OPEN_FILES, &data));
+
+    /* reading at a position does not move the file position */
+    uint8_t a[2], b[4];
+    struct iovec iov[] = {
+        { .iov_base = a, .iov_len = sizeof(a) },
+        { .iov_base = b, .iov_len = sizeof(b) },
+    };
+    TEST_ASSERT_EQUAL_INT(1, vfs_lseek(fd, 1, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(6, vfs_preadv(fd, iov, 2, 8));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(a, &bin_data[8], sizeof(a)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(b, &bin_data[10], sizeof(b)));
+    TEST_ASSERT_EQUAL_INT(3, vfs_preadv(fd, iov, 2, sizeof(bin_data) - 3));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(a, &bin_data[sizeof(bin_data) - 3], sizeof(a)));
+    TEST_ASSERT_EQUAL_INT(bin_data[sizeof(bin_data) - 1], b[0]);
+    TEST_ASSERT_EQUAL_INT(0, vfs_preadv(fd, iov, 2, sizeof(bin_data)));
+    TEST_ASSERT_EQUAL_INT(1, vfs_lseek(fd, 0, SEEK_CUR));
+
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_umount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+
 #if MODULE_NEWLIB || defined(BOARD_NATIVE)
 static void test_vfs_constfs__posix(void)
 {
@@ -210,6 +323,8 @@ Test *tests_vfs_mount_constfs_tests(void)
         new_TestFixture(test_vfs_umount__invalid_mount),
         new_TestFixture(test_vfs_constfs_open),
         new_TestFixture(test_vfs_constfs_read_lseek),
+        new_TestFixture(test_vfs_constfs_index),
+        new_TestFixture(test_vfs_constfs_mmap_pread),
 #if MODULE_NEWLIB || defined(BOARD_NATIVE)
         new_TestFixture(test_vfs_constfs__posix),
 #endif
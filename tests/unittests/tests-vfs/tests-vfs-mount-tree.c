@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief Unit tests of the mount point lookup with nested mounts and of the
+ * file descriptor allocation
+ */
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "embUnit/embUnit.h"
+
+#include "vfs.h"
+
+#include "tests-vfs.h"
+
+static vfs_mount_t *_stat_mountp;
+static const char *_stat_path;
+
+static int _stat(vfs_mount_t *mountp, const char *restrict path,
+                 struct stat *restrict buf)
+{
+    (void)buf;
+    _stat_mountp = mountp;
+    _stat_path = path;
+    return 0;
+}
+
+static const vfs_file_system_ops_t _tree_fs_ops = {
+    .stat = _stat,
+};
+
+static const vfs_file_ops_t _tree_file_ops = {
+    .close = NULL,
+};
+
+static const vfs_file_system_t _tree_file_system = {
+    .f_op  = &_tree_file_ops,
+    .fs_op = &_tree_fs_ops,
+};
+
+static vfs_mount_t _mount_root = { .mount_point = "/", .fs = &_tree_file_system };
+static vfs_mount_t _mount_a    = { .mount_point = "/a", .fs = &_tree_file_system };
+static vfs_mount_t _mount_a_b  = { .mount_point = "/a/b", .fs = &_tree_file_system };
+static vfs_mount_t _mount_ab   = { .mount_point = "/ab", .fs = &_tree_file_system };
+static vfs_mount_t _mount_a2   = { .mount_point = "/a", .fs = &_tree_file_system };
+
+static void teardown(void)
+{
+    vfs_umount(&_mount_a2);
+    vfs_umount(&_mount_ab);
+    vfs_umount(&_mount_a_b);
+    vfs_umount(&_mount_a);
+    vfs_umount(&_mount_root);
+}
+
+static void _assert_lookup(const char *path, vfs_mount_t *mountp,
+                           const char *rel_path)
+{
+    struct stat buf;
+    _stat_mountp = NULL;
+    _stat_path = NULL;
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat(path, &buf));
+    TEST_ASSERT(_stat_mountp == mountp);
+    TEST_ASSERT_EQUAL_STRING(rel_path, _stat_path);
+}
+
+static void _assert_mounted(void)
+{
+    _assert_lookup("/a/b/c", &_mount_a_b, "/c");
+    _assert_lookup("/a/b", &_mount_a_b, "");
+    _assert_lookup("/a/bc", &_mount_a, "/bc");
+    _assert_lookup("/a", &_mount_a, "");
+    _assert_lookup("/ab/c", &_mount_ab, "/c");
+    _assert_lookup("/abc", &_mount_root, "/abc");
+    _assert_lookup("/x/y", &_mount_root, "/x/y");
+}
+
+static void test_vfs_mount_tree__order(void)
+{
+    /* parents first */
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_root));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a_b));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_ab));
+    _assert_mounted();
+    teardown();
+
+    /* children first */
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_ab));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a_b));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_root));
+    _assert_mounted();
+}
+
+static void test_vfs_mount_tree__umount(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a_b));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_root));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_ab));
+
+    /* the children of /a move up to / */
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_mount_a));
+    _assert_lookup("/a/b/c", &_mount_a_b, "/c");
+    _assert_lookup("/a/c", &_mount_root, "/a/c");
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_mount_root));
+    _assert_lookup("/a/b/c", &_mount_a_b, "/c");
+    _assert_lookup("/ab", &_mount_ab, "");
+
+    struct stat buf;
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/a/c", &buf));
+
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_root));
+    _assert_mounted();
+}
+
+static void test_vfs_mount_tree__same_mount_point(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a_b));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a2));
+
+    /* the newest mount wins */
+    _assert_lookup("/a/c", &_mount_a2, "/c");
+    _assert_lookup("/a/b/c", &_mount_a_b, "/c");
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_mount_a2));
+    _assert_lookup("/a/c", &_mount_a, "/c");
+    _assert_lookup("/a/b/c", &_mount_a_b, "/c");
+}
+
+static void test_vfs_mount_tree__busy(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a));
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mount_a_b));
+
+    int fd = vfs_open("/a/foo", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(-EBUSY, vfs_umount(&_mount_a));
+    _assert_lookup("/a/b/c", &_mount_a_b, "/c");
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_mount_a));
+}
+
+static void test_vfs_mount_tree__fds(void)
+{
+    int fds[VFS_MAX_OPEN_FILES];
+    unsigned num = 0;
+
+    /* fill the table */
+    while (num < VFS_MAX_OPEN_FILES) {
+        int fd = vfs_bind(VFS_ANY_FD, O_RDONLY, &_tree_file_ops, NULL);
+        if (fd < 0) {
+            TEST_ASSERT_EQUAL_INT(-ENFILE, fd);
+            break;
+        }
+        TEST_ASSERT(fd > STDERR_FILENO);
+        TEST_ASSERT(fd < VFS_MAX_OPEN_FILES);
+        if (num > 0) {
+            TEST_ASSERT(fd > fds[num - 1]);
+        }
+        fds[num++] = fd;
+    }
+    TEST_ASSERT(num > 1);
+
+    /* the lowest free fd is reused */
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fds[1]));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fds[0]));
+    TEST_ASSERT_EQUAL_INT(fds[0], vfs_bind(VFS_ANY_FD, O_RDONLY, &_tree_file_ops, NULL));
+    TEST_ASSERT_EQUAL_INT(-EEXIST, vfs_bind(fds[0], O_RDONLY, &_tree_file_ops, NULL));
+    TEST_ASSERT_EQUAL_INT(fds[1], vfs_bind(fds[1], O_RDONLY, &_tree_file_ops, NULL));
+
+    for (unsigned i = 0; i < num; i++) {
+        TEST_ASSERT_EQUAL_INT(0, vfs_close(fds[i]));
+    }
+}
+
+Test *tests_vfs_mount_tree_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_vfs_mount_tree__order),
+        new_TestFixture(test_vfs_mount_tree__umount),
+        new_TestFixture(test_vfs_mount_tree__same_mount_point),
+        new_TestFixture(test_vfs_mount_tree__busy),
+        new_TestFixture(test_vfs_mount_tree__fds),
+    };
+
+    EMB_UNIT_TESTCALLER(vfs_mount_tree_tests, NULL, teardown, fixtures);
+
+    return (Test *)&vfs_mount_tree_tests;
+}
+
+/** @} */
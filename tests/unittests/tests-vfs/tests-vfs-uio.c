@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2019 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief Unit tests of vectored and positional I/O on a file system that
+ * only implements read and write
+ */
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "embUnit/embUnit.h"
+
+#include "vfs.h"
+
+#include "tests-vfs.h"
+
+#define _UIO_FILE_SIZE  (16)
+
+static char _file[_UIO_FILE_SIZE];
+
+static ssize_t _mem_read(vfs_file_t *filp, void *dest, size_t nbytes)
+{
+    if ((size_t)filp->pos >= sizeof(_file)) {
+        return 0;
+    }
+    if (nbytes > (sizeof(_file) - filp->pos)) {
+        nbytes = sizeof(_file) - filp->pos;
+    }
+    memcpy(dest, &_file[filp->pos], nbytes);
+    filp->pos += nbytes;
+    return nbytes;
+}
+
+static ssize_t _mem_write(vfs_file_t *filp, const void *src, size_t nbytes)
+{
+    if ((size_t)filp->pos >= sizeof(_file)) {
+        return -ENOSPC;
+    }
+    if (nbytes > (sizeof(_file) - filp->pos)) {
+        nbytes = sizeof(_file) - filp->pos;
+    }
+    memcpy(&_file[filp->pos], src, nbytes);
+    filp->pos += nbytes;
+    return nbytes;
+}
+
+static const vfs_file_ops_t _mem_ops = {
+    .read = _mem_read,
+    .write = _mem_write,
+};
+
+static int _fd = -1;
+
+static void setup(void)
+{
+    memset(_file, '.', sizeof(_file));
+    _fd = vfs_bind(VFS_ANY_FD, O_RDWR, &_mem_ops, NULL);
+}
+
+static void teardown(void)
+{
+    vfs_close(_fd);
+}
+
+static void test_vfs_uio__writev_readv(void)
+{
+    char a[3], b[5];
+    struct iovec out[] = {
+        { .iov_base = "abc", .iov_len = 3 },
+        { .iov_base = NULL, .iov_len = 0 },
+        { .iov_base = "defgh", .iov_len = 5 },
+    };
+    struct iovec in[] = {
+        { .iov_base = a, .iov_len = sizeof(a) },
+        { .iov_base = b, .iov_len = sizeof(b) },
+    };
+
+    TEST_ASSERT(_fd >= 0);
+    TEST_ASSERT_EQUAL_INT(8, vfs_writev(_fd, out, 3));
+    TEST_ASSERT_EQUAL_INT(8, vfs_lseek(_fd, 0, SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_file, "abcdefgh........", sizeof(_file)));
+
+    TEST_ASSERT_EQUAL_INT(0, vfs_lseek(_fd, 0, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(8, vfs_readv(_fd, in, 2));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(a, "abc", sizeof(a)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(b, "defgh", sizeof(b)));
+
+    /* stops at the end of the file */
+    TEST_ASSERT_EQUAL_INT(12, vfs_lseek(_fd, 12, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(4, vfs_readv(_fd, in, 2));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(a, "...", sizeof(a)));
+    TEST_ASSERT_EQUAL_INT('.', b[0]);
+}
+
+static void test_vfs_uio__pwritev_preadv(void)
+{
+    char buf[4];
+    struct iovec out[] = {
+        { .iov_base = "xy", .iov_len = 2 },
+        { .iov_base = "z", .iov_len = 1 },
+    };
+    struct iovec in[] = {
+        { .iov_base = buf, .iov_len = sizeof(buf) },
+    };
+
+    TEST_ASSERT(_fd >= 0);
+    TEST_ASSERT_EQUAL_INT(5, vfs_lseek(_fd, 5, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(3, vfs_pwritev(_fd, out, 2, 10));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_file, "..........xyz...", sizeof(_file)));
+    TEST_ASSERT_EQUAL_INT(4, vfs_preadv(_fd, in, 1, 9));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, ".xyz", sizeof(buf)));
+
+    /* the file position is kept */
+    TEST_ASSERT_EQUAL_INT(5, vfs_lseek(_fd, 0, SEEK_CUR));
+
+    /* short read at the end of the file */
+    TEST_ASSERT_EQUAL_INT(2, vfs_preadv(_fd, in, 1, _UIO_FILE_SIZE - 2));
+    TEST_ASSERT_EQUAL_INT(0, vfs_preadv(_fd, in, 1, _UIO_FILE_SIZE));
+}
+
+static void test_vfs_uio__errors(void)
+{
+    char buf[4];
+    struct iovec iov[] = {
+        { .iov_base = buf, .iov_len = sizeof(buf) },
+        { .iov_base = NULL, .iov_len = 1 },
+    };
+
+    TEST_ASSERT(_fd >= 0);
+    TEST_ASSERT_EQUAL_INT(-EINVAL, vfs_preadv(_fd, iov, 1, -1));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, vfs_readv(_fd, iov, -1));
+    TEST_ASSERT_EQUAL_INT(-EFAULT, vfs_writev(_fd, iov, 2));
+    TEST_ASSERT_EQUAL_INT(0, vfs_readv(_fd, iov, 0));
+    TEST_ASSERT_EQUAL_INT(-EBADF, vfs_preadv(VFS_MAX_OPEN_FILES, iov, 1, 0));
+
+    int fd = vfs_bind(VFS_ANY_FD, O_RDONLY, &_mem_ops, NULL);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(-EBADF, vfs_pwritev(fd, iov, 1, 0));
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), vfs_preadv(fd, iov, 1, 0));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+}
+
+Test *tests_vfs_uio_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_vfs_uio__writev_readv),
+        new_TestFixture(test_vfs_uio__pwritev_preadv),
+        new_TestFixture(test_vfs_uio__errors),
+    };
+
+    EMB_UNIT_TESTCALLER(vfs_uio_tests, setup, teardown, fixtures);
+
+    return (Test *)&vfs_uio_tests;
+}
+
+/** @} */